@@ -26,14 +26,28 @@ pub fn build_exe(
 ) *Build.Step.Compile {
     const dir = prefix_path ++ "src/shdc/";
     const sources = [_][]const u8{
+        "allocstats.cc",
         "args.cc",
         "bytecode.cc",
         "input.cc",
+        "libshdc.cc",
         "main.cc",
+        "pipeline.cc",
         "reflection.cc",
         "spirv.cc",
         "spirvcross.cc",
+        "stats.cc",
+        "layout.cc",
+        "unused.cc",
+        "precision.cc",
+        "varyings.cc",
+        "vertexformats.cc",
+        "sharedtypes.cc",
+        "distrib.cc",
+        "watch.cc",
         "generators/bare.cc",
+        "generators/barebin.cc",
+        "generators/barepack.cc",
         "generators/generate.cc",
         "generators/generator.cc",
         "generators/sokolc.cc",
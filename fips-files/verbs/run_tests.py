@@ -1,5 +1,5 @@
-import sys, os
-from mod import log, project, settings
+import sys, os, subprocess, shutil, hashlib, socket, time, struct, re
+from mod import log, project, settings, util
 
 shaders = [
     'chipvis.glsl',
@@ -7,6 +7,7 @@ shaders = [
     'imgui.glsl',
     'infinity.glsl',
     'inout_mismatch.glsl',
+    'optimize_layout.glsl',
     'sgl.glsl',
     'shared_ub.glsl',
     'test1.glsl',
@@ -81,10 +82,477 @@ def run_sokol_shdc(fips_dir, proj_dir, cfg_name, out_path, shader_filename):
     if exit_code != 0:
         sys.exit(exit_code)
 
+# the feature tests below run the sokol-shdc executable directly to check its
+# output and exit code, each test function takes a Ctx and calls ctx.fail() on errors
+class Ctx:
+    def __init__(self, fips_dir, proj_dir, cfg_name, out_path):
+        proj_name = util.get_project_name_from_dir(proj_dir)
+        self.exe = util.get_deploy_dir(fips_dir, proj_name, cfg_name) + '/sokol-shdc'
+        if util.get_host_platform() == 'win':
+            self.exe += '.exe'
+        self.test_dir = proj_dir + '/test'
+        self.src_dir = proj_dir + '/src/shdc'
+        self.out_path = out_path
+        self.name = None
+        self.num_failed = 0
+
+    # run sokol-shdc in cwd (default: the test directory), returns (exit_code, stdout+stderr)
+    def shdc(self, args, cwd=None, env=None):
+        res = subprocess.run([self.exe] + args, cwd=cwd or self.test_dir, env=env, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+        return res.returncode, res.stdout
+
+    def fail(self, msg, output=None):
+        log.error(f'{self.name}: {msg}', False)
+        if output:
+            print(output)
+        self.num_failed += 1
+
+    def read(self, path):
+        with open(path, 'r') as f:
+            return f.read()
+
+    # compile C sources with the host C compiler into an executable in the output directory,
+    # returns the executable path, or None if the compilation failed or there's no C compiler
+    def compile_c(self, name, sources, defines=[]):
+        cc = os.environ.get('CC') or shutil.which('cc') or shutil.which('gcc') or shutil.which('clang')
+        if (util.get_host_platform() == 'win') or not cc:
+            log.info('skipped (no C compiler found)')
+            return None
+        exe = f'{self.out_path}/{name}'
+        args = [cc, '-std=c11', '-Wall', '-o', exe, f'-I{self.test_dir}', f'-I{self.src_dir}', f'-I{self.out_path}']
+        args += [f'-D{define}' for define in defines] + sources
+        res = subprocess.run(args, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+        if res.returncode != 0:
+            self.fail(f'failed to compile {name}', res.stdout)
+            return None
+        return exe
+
+    # run a program built with compile_c(), returns (exit_code, stdout+stderr)
+    def run(self, exe, args=[]):
+        res = subprocess.run([exe] + args, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+        return res.returncode, res.stdout
+
+def test_bytecode_cmd(ctx):
+    cmd = f'"{sys.executable}" "{ctx.test_dir}/bytecode_cmd.py" {{src}} {{out}}'
+    out = f'{ctx.out_path}/bytecode_cmd.h'
+    code, output = ctx.shdc(['-i', 'test1.glsl', '-o', out, '-l', 'hlsl5:metal_macos', '-b', '--bytecode-cmd', cmd])
+    if code != 0:
+        return ctx.fail('compilation with stand-in compiler failed', output)
+    src = ctx.read(out)
+    for name in ['bla_vs1_bytecode_hlsl5', 'bla_fs1_bytecode_metal_macos']:
+        if name not in src:
+            ctx.fail(f'{name} not found in {out}')
+    code, output = ctx.shdc(['-i', 'test1.glsl', '-o', out, '-l', 'hlsl5', '-b', '--bytecode-cmd', cmd + ' 3'])
+    if code == 0:
+        ctx.fail('failing stand-in compiler not detected')
+    elif ('stand-in compiler failed' not in output) or ('(exit status 3)' not in output):
+        ctx.fail('unexpected error output for failing stand-in compiler', output)
+
+# concurrent shdc_compile() calls with a custom load_file callback (see src/libshdc-test)
+def test_libshdc_threads(ctx):
+    exe = os.path.dirname(ctx.exe) + '/libshdc-test' + ('.exe' if ctx.exe.endswith('.exe') else '')
+    code, output = ctx.run(exe)
+    if code != 0:
+        ctx.fail('concurrent compilation failed', output)
+
+# validate a bare_bin reflection file, and check that the shader files it
+# references are identical with the '-f bare' output
+def test_bare_bin(ctx):
+    exe = ctx.compile_c('bin_check', [f'{ctx.test_dir}/bin_check.c'])
+    if not exe:
+        return
+    out_dir = f'{ctx.out_path}/bare_bin'
+    shutil.rmtree(out_dir, ignore_errors=True)
+    os.makedirs(f'{out_dir}/bin')
+    os.makedirs(f'{out_dir}/bare')
+    cmd = f'"{sys.executable}" "{ctx.test_dir}/bytecode_cmd.py" {{src}} {{out}}'
+    args = ['-i', 'test1.glsl', '-l', 'glsl430:hlsl5', '-b', '--bytecode-cmd', cmd]
+    for fmt in ['bare_bin', 'bare']:
+        code, output = ctx.shdc(args + ['-o', f'{out_dir}/{fmt.replace("_", "")}/test1', '-f', fmt])
+        if code != 0:
+            return ctx.fail(f'{fmt}: compilation failed', output)
+    bin_path = f'{out_dir}/bin/test1_bla_reflection.bin'
+    with open(bin_path, 'rb') as f:
+        magic, version = struct.unpack('<II', f.read(8))
+    if (magic != 0x4E494253) or (version != 2):
+        return ctx.fail(f'unexpected header magic {magic:#x} or version {version}')
+    code, output = ctx.run(exe, [bin_path])
+    if code != 0:
+        return ctx.fail('invalid reflection file', output)
+    codes = [line.split(' ', 2)[1:] for line in output.splitlines() if line.startswith('code: ')]
+    if len(codes) != 8:
+        return ctx.fail(f'expected 8 shader files (2 programs, 2 stages, 2 slangs), got {len(codes)}', output)
+    if sum(1 for is_binary, _ in codes if is_binary == '1') != 4:
+        ctx.fail('expected one bytecode blob per HLSL shader', output)
+    for is_binary, path in codes:
+        bare_path = f'{out_dir}/bare/{os.path.basename(path)}'
+        if not os.path.isfile(path) or not os.path.isfile(bare_path):
+            ctx.fail(f'{path} or {bare_path} not found')
+            continue
+        with open(path, 'rb') as f0, open(bare_path, 'rb') as f1:
+            if f0.read() != f1.read():
+                ctx.fail(f'{path} differs from {bare_path}')
+
+# SPIR-V output is always bytecode, spirv_vk uses the WGSL bindings in descriptor sets 0 and 1
+def test_spirv(ctx):
+    out_dir = f'{ctx.out_path}/spirv'
+    shutil.rmtree(out_dir, ignore_errors=True)
+    os.makedirs(out_dir)
+    code, output = ctx.shdc(['-i', 'test1.glsl', '-o', f'{out_dir}/test1', '-l', 'spirv_vk:spirv_gl', '-f', 'bare'])
+    if code != 0:
+        return ctx.fail('bare: compilation failed', output)
+    for slang in ['spirv_vk', 'spirv_gl']:
+        for prog in ['prog1', 'prog2']:
+            for stage in ['vertex', 'fragment']:
+                path = f'{out_dir}/test1_bla_{prog}_{slang}_{stage}.spv'
+                if not os.path.isfile(path):
+                    ctx.fail(f'{path} not found')
+                    continue
+                with open(path, 'rb') as f:
+                    header = f.read(4)
+                if (len(header) != 4) or (struct.unpack('<I', header)[0] != 0x07230203):
+                    ctx.fail(f'{path} doesn\'t start with the SPIR-V magic number')
+    code, output = ctx.shdc(['-i', 'test1.glsl', '-o', f'{out_dir}/test1', '-l', 'spirv_vk:spirv_gl:wgsl', '-f', 'bare_yaml'])
+    if code != 0:
+        return ctx.fail('bare_yaml: compilation failed', output)
+    yaml = ctx.read(f'{out_dir}/test1_bla_reflection.yaml')
+    for spirv_key, wgsl_key in [('spirv_set0_binding_n', 'wgsl_group0_binding_n'), ('spirv_set1_binding_n', 'wgsl_group1_binding_n')]:
+        spirv_bindings = re.findall(spirv_key + r': (-?\d+)', yaml)
+        wgsl_bindings = re.findall(wgsl_key + r': (-?\d+)', yaml)
+        if not spirv_bindings:
+            ctx.fail(f'no {spirv_key} in bare_yaml output')
+        elif spirv_bindings != wgsl_bindings:
+            ctx.fail(f'{spirv_key} {spirv_bindings} differs from {wgsl_key} {wgsl_bindings}')
+
+# round trip of the bare_pack LZ4 compression: every entry of a --compress archive must
+# decompress with shdc_pack_decompress() to the entry of an uncompressed archive
+def test_bare_pack(ctx):
+    exe = ctx.compile_c('pack_check', [f'{ctx.test_dir}/pack_check.c'])
+    if not exe:
+        return
+    # shader sources, and payloads from a stand-in compiler which are shorter
+    # than the minimum match distance or need length extension bytes
+    payload_cmd = f'"{sys.executable}" "{ctx.test_dir}/pack_payload_cmd.py" {{stage}} {{out}}'
+    for name, args in [('src', ['-l', 'glsl430:hlsl5:metal_macos']), ('cmd', ['-l', 'hlsl5', '-b', '--bytecode-cmd', payload_cmd])]:
+        packs = []
+        for compress in [True, False]:
+            out = f'{ctx.out_path}/pack_{name}_{"lz4" if compress else "raw"}'
+            code, output = ctx.shdc(['-i', 'test1.glsl', '-o', out, '-f', 'bare_pack'] + args + (['--compress'] if compress else []))
+            if code != 0:
+                return ctx.fail(f'{name}: compilation failed', output)
+            packs.append(f'{out}_bla_shaders.pack')
+        code, output = ctx.run(exe, packs)
+        if code != 0:
+            ctx.fail(f'{name}: compressed pack doesn\'t match uncompressed pack', output)
+        elif 'compressed: 0' in output:
+            ctx.fail(f'{name}: no compressed entries', output)
+        elif (name == 'cmd') and ('short: 0' in output):
+            ctx.fail(f'{name}: no short entries', output)
+
+# the generated C reflection functions look up names with a perfect hash which must
+# match PerfectHash::hash(), check every name and a couple of unknown names
+def test_refl_lookup(ctx):
+    code, output = ctx.shdc(['-i', 'refl_lookup.glsl', '-o', f'{ctx.out_path}/refl_lookup.h', '-l', 'glsl430', '-r'])
+    if code != 0:
+        return ctx.fail('compilation failed', output)
+    exe = ctx.compile_c('refl_lookup_check', [f'{ctx.test_dir}/refl_lookup_check.c'])
+    if not exe:
+        return
+    code, output = ctx.run(exe)
+    if code != 0:
+        ctx.fail('reflection lookups don\'t match the bind slot constants', output)
+
+# compile the same shader in two different directories, once from inside the
+# directory, once from outside with --root, the outputs must be byte-identical
+def test_reproducible(ctx):
+    hashes = []
+    for dir_name, cwd_in_dir in [('repro_a', True), ('repro_b/nested', False)]:
+        root = f'{ctx.out_path}/{dir_name}'
+        shutil.rmtree(f'{ctx.out_path}/{dir_name.split("/")[0]}', ignore_errors=True)
+        os.makedirs(f'{root}/shd')
+        os.makedirs(f'{root}/gen')
+        shutil.copyfile(f'{ctx.test_dir}/test1.glsl', f'{root}/shd/test1.glsl')
+        common_args = ['-l', 'glsl430:hlsl5:metal_macos:wgsl', '--reproducible']
+        if cwd_in_dir:
+            code, output = ctx.shdc(['-i', 'shd/test1.glsl', '-o', 'gen/test1.h'] + common_args, cwd=root)
+            if code == 0:
+                code, output = ctx.shdc(['-i', 'shd/test1.glsl', '-o', 'gen/test1', '-f', 'bare_yaml'] + common_args, cwd=root)
+        else:
+            code, output = ctx.shdc(['-i', f'{root}/shd/test1.glsl', '-o', f'{root}/gen/test1.h', '--root', root] + common_args, cwd=ctx.test_dir)
+            if code == 0:
+                code, output = ctx.shdc(['-i', f'{root}/shd/test1.glsl', '-o', f'{root}/gen/test1', '-f', 'bare_yaml', '--root', root] + common_args, cwd=ctx.test_dir)
+        if code != 0:
+            return ctx.fail(f'compilation in {root} failed', output)
+        dir_hashes = {}
+        for name in sorted(os.listdir(f'{root}/gen')):
+            with open(f'{root}/gen/{name}', 'rb') as f:
+                dir_hashes[name] = hashlib.sha256(f.read()).hexdigest()
+        hashes.append(dir_hashes)
+    if not hashes[0]:
+        ctx.fail('no output files generated')
+    elif hashes[0] != hashes[1]:
+        diff = [name for name in sorted(set(hashes[0]) | set(hashes[1])) if hashes[0].get(name) != hashes[1].get(name)]
+        ctx.fail(f'output differs between directories: {", ".join(diff)}')
+
+def test_infer_mediump(ctx):
+    code, output = ctx.shdc(['-i', 'infer_mediump.glsl', '-o', f'{ctx.out_path}/infer_mediump.h', '-l', 'glsl300es', '--infer-mediump'])
+    if code != 0:
+        return ctx.fail('compilation failed', output)
+    if "float values in 'fs_norm' to mediump" not in output:
+        ctx.fail('values sampled from @image_normalized texture not demoted', output)
+    if "'fs_hdr'" in output:
+        ctx.fail('values sampled from untagged texture demoted', output)
+    if "'fs_mat'" in output:
+        ctx.fail('value combined from a matrix component demoted', output)
+
+def test_pack_varyings(ctx):
+    out = f'{ctx.out_path}/pack_varyings'
+    code, output = ctx.shdc(['-i', 'pack_varyings.glsl', '-o', out, '-l', 'glsl300es:hlsl4:metal_macos', '-f', 'bare', '--pack-varyings'])
+    if code != 0:
+        return ctx.fail('compilation failed', output)
+    for slang in ['glsl300es', 'hlsl4', 'metal_macos']:
+        for stage in ['vertex', 'fragment']:
+            path = f'{out}_pack_{slang}_{stage}' + ('.glsl' if slang == 'glsl300es' else '.hlsl' if slang == 'hlsl4' else '.metal')
+            if not os.path.isfile(path):
+                ctx.fail(f'{path} not found')
+                continue
+            src = ctx.read(path)
+            for name in ['shdc_varying_0', 'shdc_varying_1', 'shdc_varying_6', 'spill', 'color']:
+                if name not in src:
+                    ctx.fail(f'{name} not found in {path}')
+            for name in ['shdc_varying_3', 'shdc_varying_4', 'uv1', 'flat_uv']:
+                if name in src:
+                    ctx.fail(f'unexpected {name} in {path}')
+
+# suggested compact formats for normal, color and UV attributes, and the generated packed vertex struct
+def test_vertex_formats(ctx):
+    code, output = ctx.shdc(['-i', 'vertex_formats.glsl', '-o', f'{ctx.out_path}/vertex_formats.h', '-l', 'glsl430', '--vertex-formats'])
+    if code != 0:
+        return ctx.fail('compilation failed', output)
+    for attr, fmt in [('normal', 'SHORT4N'), ('color0', 'HALF4'), ('texcoord0', 'HALF2')]:
+        if f"vertex attribute '{attr}' could use SG_VERTEXFORMAT_{fmt}" not in output:
+            ctx.fail(f'SG_VERTEXFORMAT_{fmt} not suggested for {attr}', output)
+    if "'position'" in output:
+        ctx.fail('compact format suggested for position', output)
+    exe = ctx.compile_c('vertex_formats_check', [f'{ctx.test_dir}/vertex_formats_check.c'])
+    if exe:
+        code, output = ctx.run(exe)
+        if code != 0:
+            ctx.fail('unexpected packed vertex struct or layout', output)
+
+def test_unused_report(ctx):
+    code, output = ctx.shdc(['-i', 'unused_report.glsl', '-o', f'{ctx.out_path}/unused_report.h', '-l', 'glsl430', '--unused-report'])
+    if code != 0:
+        return ctx.fail('compilation failed', output)
+    if output.count("member 'params.unused' is never read") != 1:
+        ctx.fail("unused member 'params.unused' not reported exactly once", output)
+    if "programs 'a', 'b'" not in output:
+        ctx.fail('unused member not reported for both programs', output)
+    for name in ['scale', 'tint']:
+        if f"'params.{name}'" in output:
+            ctx.fail(f"'params.{name}' reported as unused", output)
+
+def test_stats(ctx):
+    code, output = ctx.shdc(['-i', 'test1.glsl', '-o', f'{ctx.out_path}/stats.h', '-l', 'glsl430', '--stats', f'{ctx.out_path}/stats.json'])
+    if code != 0:
+        return ctx.fail('compilation failed', output)
+    if '"programs"' not in ctx.read(f'{ctx.out_path}/stats.json'):
+        ctx.fail('stats file is incomplete')
+    # writes to /dev/full fail with ENOSPC
+    if util.get_host_platform() == 'linux':
+        code, output = ctx.shdc(['-i', 'test1.glsl', '-o', f'{ctx.out_path}/stats.h', '-l', 'glsl430', '--stats', '/dev/full'])
+        if (code == 0) or ('failed to write stats file' not in output):
+            ctx.fail('failed stats file write not detected', output)
+
+def test_unroll(ctx):
+    out = f'{ctx.out_path}/unroll'
+    code, output = ctx.shdc(['-i', 'unroll.glsl', '-o', out, '-l', 'glsl430:hlsl5:metal_macos', '-f', 'bare'])
+    if code != 0:
+        return ctx.fail('compilation failed', output)
+    if "@unroll in snippet 'fs_const'" in output:
+        ctx.fail('unexpected @unroll warning for constant-bound loop', output)
+    if "@unroll in snippet 'fs_dyn'" not in output:
+        ctx.fail('no @unroll warning for non-constant loop bound', output)
+    src = ctx.read(f'{out}_const_hlsl5_fragment.hlsl')
+    if ('for (' in src) or ('[unroll]' in src):
+        ctx.fail('constant-bound loop not unrolled in HLSL output')
+    if '[unroll]' not in ctx.read(f'{out}_dyn_hlsl5_fragment.hlsl'):
+        ctx.fail('non-constant loop lost its [unroll] attribute in HLSL output')
+
+# the --uniform-helpers layout asserts must compile with the @ctype_preset hmm types,
+# and the batch helpers must apply each filled uniform block before its draw callback
+def test_uniform_helpers(ctx):
+    code, output = ctx.shdc(['-i', 'uniform_helpers.glsl', '-o', f'{ctx.out_path}/uniform_helpers.h', '-l', 'glsl430', '--uniform-helpers'])
+    if code != 0:
+        return ctx.fail('compilation failed', output)
+    exe = ctx.compile_c('uniform_helpers_check', [f'{ctx.test_dir}/uniform_helpers_check.c'])
+    if exe:
+        code, output = ctx.run(exe)
+        if code != 0:
+            ctx.fail('unexpected batch helper behaviour', output)
+
+# dirty bits and ranges of the --uniform-shadow helpers for scalar, vector, matrix and array members
+def test_uniform_shadow(ctx):
+    code, output = ctx.shdc(['-i', 'uniform_shadow.glsl', '-o', f'{ctx.out_path}/uniform_shadow.h', '-l', 'glsl430', '--uniform-shadow'])
+    if code != 0:
+        return ctx.fail('compilation failed', output)
+    exe = ctx.compile_c('uniform_shadow_check', [f'{ctx.test_dir}/uniform_shadow_check.c'])
+    if exe:
+        code, output = ctx.run(exe)
+        if code != 0:
+            ctx.fail('unexpected dirty tracking', output)
+    code, output = ctx.shdc(['-i', 'uniform_shadow.glsl', '-o', f'{ctx.out_path}/uniform_shadow.zig', '-l', 'glsl430', '-f', 'sokol_zig', '--uniform-shadow'])
+    if (code == 0) or ('--uniform-shadow is only supported' not in output):
+        ctx.fail('--uniform-shadow not rejected for non-C output format', output)
+
+def test_soa(ctx):
+    code, output = ctx.shdc(['-i', 'soa.glsl', '-o', f'{ctx.out_path}/soa.h', '-l', 'glsl430'])
+    if code != 0:
+        return ctx.fail('compilation failed', output)
+    exe = ctx.compile_c('soa_check', [f'{ctx.test_dir}/soa_check.c'])
+    if exe:
+        code, output = ctx.run(exe)
+        if code != 0:
+            ctx.fail('unexpected @soa struct or pack function', output)
+
+def test_soa_clash(ctx):
+    code, output = ctx.shdc(['-i', 'soa_clash.glsl', '-o', f'{ctx.out_path}/soa_clash.h', '-l', 'glsl430'])
+    if (code == 0) or ("member name 'pos_x'" not in output):
+        ctx.fail('clashing @soa member names not detected', output)
+
+def test_shared_types(ctx):
+    out_dir = f'{ctx.out_path}/shared_types'
+    shutil.rmtree(out_dir, ignore_errors=True)
+    os.makedirs(f'{out_dir}/gen')
+    code, output = ctx.shdc(['-i', 'ub_equality_1.glsl', '-i', 'ub_equality_2.glsl', '--shared-types', f'{out_dir}/common.h', '-o', f'{out_dir}/gen', '-l', 'glsl430'])
+    if code != 0:
+        return ctx.fail('compilation failed', output)
+    if '#include "../common.h"' not in ctx.read(f'{out_dir}/gen/ub_equality_1.glsl.h'):
+        ctx.fail('shared header not included relative to the output directory')
+    code, output = ctx.shdc(['-i', 'texcube-sapp.glsl', '-i', 'sapp/texcube-sapp.glsl', '--shared-types', f'{out_dir}/common.h', '-o', f'{out_dir}/gen', '-l', 'glsl430'])
+    if (code == 0) or ('would both be written to' not in output):
+        ctx.fail('inputs with the same filename not detected', output)
+
+# HLSL bytecode on Linux via vkd3d-compiler, a failing vkd3d-compiler must fall back to source code
+def test_vkd3d(ctx):
+    if util.get_host_platform() != 'linux':
+        log.info('skipped (Linux only)')
+        return
+    out = f'{ctx.out_path}/vkd3d.h'
+    if shutil.which('vkd3d-compiler'):
+        code, output = ctx.shdc(['-i', 'test1.glsl', '-o', out, '-l', 'hlsl5', '-b'])
+        if code != 0:
+            return ctx.fail('compilation with vkd3d-compiler failed', output)
+        if 'bla_vs1_bytecode_hlsl5' not in ctx.read(out):
+            ctx.fail('no HLSL bytecode generated with vkd3d-compiler')
+    else:
+        log.info('vkd3d-compiler not found, only testing the fallback')
+    fake_dir = f'{ctx.out_path}/fake_vkd3d'
+    os.makedirs(fake_dir, exist_ok=True)
+    with open(f'{fake_dir}/vkd3d-compiler', 'w') as f:
+        f.write('#!/bin/sh\necho "fake vkd3d-compiler failure"\nexit 2\n')
+    os.chmod(f'{fake_dir}/vkd3d-compiler', 0o755)
+    env = dict(os.environ, PATH=fake_dir + os.pathsep + os.environ.get('PATH', ''))
+    code, output = ctx.shdc(['-i', 'test1.glsl', '-o', out, '-l', 'hlsl5', '-b'], env=env)
+    if code != 0:
+        return ctx.fail('failing vkd3d-compiler broke the build', output)
+    if 'vkd3d-compiler failed' not in output:
+        ctx.fail('no warning for failing vkd3d-compiler', output)
+    src = ctx.read(out)
+    if ('bla_vs1_bytecode_hlsl5' in src) or ('bla_vs1_source_hlsl5' not in src):
+        ctx.fail('no HLSL source code fallback for failing vkd3d-compiler')
+    # without vkd3d-compiler, the fallback warning is only printed once per run
+    empty_dir = f'{ctx.out_path}/no_vkd3d'
+    os.makedirs(empty_dir, exist_ok=True)
+    out_dir = f'{ctx.out_path}/no_vkd3d_out'
+    shutil.rmtree(out_dir, ignore_errors=True)
+    os.makedirs(out_dir)
+    code, output = ctx.shdc(['-i', 'ub_equality_1.glsl', '-i', 'ub_equality_2.glsl', '--shared-types', f'{out_dir}/common.h', '-o', out_dir, '-l', 'hlsl5', '-b'], env=dict(os.environ, PATH=empty_dir))
+    if code != 0:
+        return ctx.fail('missing vkd3d-compiler broke the build', output)
+    if output.count('vkd3d-compiler not found') != 1:
+        ctx.fail('vkd3d-compiler fallback warning not printed exactly once', output)
+
+# run a worker on localhost and compile a batch file through it
+def test_distrib(ctx):
+    if util.get_host_platform() == 'win':
+        log.info('skipped (not supported on Windows)')
+        return
+    work_dir = f'{ctx.out_path}/distrib'
+    shutil.rmtree(work_dir, ignore_errors=True)
+    os.makedirs(f'{work_dir}/with space')
+    shutil.copyfile(f'{ctx.test_dir}/test1.glsl', f'{work_dir}/with space/test1.glsl')
+    with socket.socket() as s:
+        s.bind(('127.0.0.1', 0))
+        port = s.getsockname()[1]
+    worker = subprocess.Popen([ctx.exe, '--worker', str(port)], stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    try:
+        for _ in range(100):
+            try:
+                socket.create_connection(('127.0.0.1', port), timeout=1).close()
+                break
+            except OSError:
+                time.sleep(0.1)
+        workers = f'127.0.0.1:{port},127.0.0.1:{port}'
+        with open(f'{work_dir}/batch.txt', 'w') as f:
+            f.write('# comment\n')
+            f.write(f'-i "{work_dir}/with space/test1.glsl" -o "{work_dir}/with space/test1.h" -l glsl430:hlsl5\n')
+            f.write(f'-i {ctx.test_dir}/ub_equality_1.glsl -o {work_dir}/ub_equality_1 -l glsl300es -f bare\n')
+        code, output = ctx.shdc(['--batch', f'{work_dir}/batch.txt', '--workers', workers])
+        if code != 0:
+            return ctx.fail('batch compilation failed', output)
+        if not os.path.isfile(f'{work_dir}/with space/test1.h'):
+            ctx.fail('output file with space in path not written')
+        if not any(name.startswith('ub_equality_1_') for name in os.listdir(work_dir)):
+            ctx.fail('bare output files not written')
+        with open(f'{work_dir}/bad_batch.txt', 'w') as f:
+            f.write(f'-i {ctx.test_dir}/test1.glsl -o {work_dir}/bad.h -l glsl430 -b --bytecode-cmd "touch {work_dir}/pwned"\n')
+        code, output = ctx.shdc(['--batch', f'{work_dir}/bad_batch.txt', '--workers', workers])
+        if (code == 0) or ('--bytecode-cmd' not in output) or os.path.exists(f'{work_dir}/pwned'):
+            ctx.fail('--bytecode-cmd not rejected in batch job', output)
+        # snippet names end up in compiler command lines, a name with shell syntax must be rejected
+        with open(f'{work_dir}/bad_snippet.glsl', 'w') as f:
+            f.write(f'@vs a$(touch${{IFS}}{work_dir}/pwned_snippet)\nvoid main() {{ gl_Position = vec4(0.0); }}\n@end\n')
+            f.write('@fs fs\nout vec4 c;\nvoid main() { c = vec4(1.0); }\n@end\n')
+            f.write('@program bad a$(touch${IFS}' + work_dir + '/pwned_snippet) fs\n')
+        with open(f'{work_dir}/bad_snippet_batch.txt', 'w') as f:
+            f.write(f'-i {work_dir}/bad_snippet.glsl -o {work_dir}/bad_snippet.h -l hlsl5:metal_macos -b\n')
+        code, output = ctx.shdc(['--batch', f'{work_dir}/bad_snippet_batch.txt', '--workers', workers])
+        if (code == 0) or ('must be a valid identifier' not in output) or os.path.exists(f'{work_dir}/pwned_snippet'):
+            ctx.fail('snippet name with shell syntax not rejected in batch job', output)
+    finally:
+        worker.kill()
+        worker.wait()
+
+tests = [
+    test_bytecode_cmd,
+    test_libshdc_threads,
+    test_bare_bin,
+    test_bare_pack,
+    test_spirv,
+    test_refl_lookup,
+    test_reproducible,
+    test_infer_mediump,
+    test_pack_varyings,
+    test_vertex_formats,
+    test_unused_report,
+    test_unroll,
+    test_stats,
+    test_uniform_helpers,
+    test_uniform_shadow,
+    test_soa,
+    test_soa_clash,
+    test_shared_types,
+    test_vkd3d,
+    test_distrib,
+]
+
 def run(fips_dir, proj_dir, args):
     cfg_name = None
     if len(args) > 0:
         cfg_name = args[0]
+    if cfg_name is None:
+        cfg_name = settings.get(proj_dir, 'config')
     out_path = f'{proj_dir}/test/out'
     if not os.path.isdir(out_path):
         os.makedirs(out_path)
@@ -92,6 +560,13 @@ def run(fips_dir, proj_dir, args):
         os.makedirs(f'{out_path}/sapp')
     for shader in shaders:
         run_sokol_shdc(fips_dir, proj_dir, cfg_name, out_path, shader)
+    ctx = Ctx(fips_dir, proj_dir, cfg_name, out_path)
+    for test in tests:
+        ctx.name = test.__name__
+        log.info(f'==> {ctx.name}:')
+        test(ctx)
+    if ctx.num_failed > 0:
+        log.error(f'{ctx.num_failed} test(s) failed')
 
 def help():
     log.info(log.YELLOW + 'fips run_tests [cfg]\n' + log.DEF + '    run shader compilation tests')
@@ -0,0 +1,148 @@
+/*
+    libshdc-test: compile two different shaders concurrently through the
+    libshdc C API with in-memory files provided by a load_file callback,
+    and check both results. Called by 'fips run_tests'.
+*/
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include "libshdc.h"
+
+namespace {
+
+struct Job {
+    const char* module;
+    const char* module_override;
+    const char* main_path;
+    const char* main_src;
+    const char* include_path;
+    const char* include_src;
+    const char* ub_name;
+    // the callback hands out this buffer, which is only valid until the next callback call
+    std::string buf;
+    int num_loads = 0;
+    int num_failed = 0;
+};
+
+bool load_file(const char* path, shdc_range* out_content, void* user_data) {
+    Job* job = (Job*)user_data;
+    job->num_loads++;
+    if (0 == strcmp(path, job->main_path)) {
+        job->buf = job->main_src;
+    } else if (0 == strcmp(path, job->include_path)) {
+        job->buf = job->include_src;
+    } else {
+        return false;
+    }
+    out_content->ptr = job->buf.data();
+    out_content->size = job->buf.size();
+    return true;
+}
+
+void fail(Job& job, int iter, const char* msg) {
+    fprintf(stderr, "%s (iteration %d): %s\n", job.module, iter, msg);
+    job.num_failed++;
+}
+
+void check_result(Job& job, int iter, const shdc_result* res) {
+    if (!res->valid) {
+        for (int i = 0; i < res->num_messages; i++) {
+            fprintf(stderr, "%s:%d: %s\n", res->messages[i].file, res->messages[i].line, res->messages[i].msg);
+        }
+        return fail(job, iter, "compilation failed");
+    }
+    if (0 != strcmp(res->module, job.module)) {
+        return fail(job, iter, "wrong module name");
+    }
+    if ((res->num_programs != 1) || (0 != strcmp(res->programs[0].name, "prog"))) {
+        return fail(job, iter, "wrong programs");
+    }
+    const shdc_program& prog = res->programs[0];
+    if ((prog.bindings.num_uniform_blocks != 1) || (0 != strcmp(prog.bindings.uniform_blocks[0].name, job.ub_name))) {
+        return fail(job, iter, "wrong uniform block");
+    }
+    const shdc_code& vs_code = prog.vs.code[SHDC_SLANGINDEX_GLSL430];
+    const shdc_code& fs_code = prog.fs.code[SHDC_SLANGINDEX_GLSL430];
+    if (!vs_code.valid || !fs_code.valid || !strstr(vs_code.source, job.ub_name)) {
+        return fail(job, iter, "wrong shader code");
+    }
+}
+
+void run_job(Job* job, int num_iters) {
+    for (int iter = 0; iter < num_iters; iter++) {
+        shdc_desc desc = {};
+        desc.path = job->main_path;
+        desc.load_file = load_file;
+        desc.user_data = job;
+        desc.slang = SHDC_SLANG_GLSL430;
+        desc.module = job->module_override;
+        const int num_loads = job->num_loads;
+        shdc_result* res = shdc_compile(&desc);
+        check_result(*job, iter, res);
+        // the main file, a failed attempt at the unresolved include path, and the include file
+        if (job->num_loads - num_loads != 3) {
+            fail(*job, iter, "unexpected number of load_file calls");
+        }
+        shdc_free_result(res);
+    }
+}
+
+const char* src_a =
+    "@module bla\n"
+    "@vs vs\n"
+    "@include common_a.glsl\n"
+    "in vec4 position;\n"
+    "void main() { gl_Position = position * scale_a; }\n"
+    "@end\n"
+    "@fs fs\n"
+    "out vec4 frag_color;\n"
+    "void main() { frag_color = vec4(1.0); }\n"
+    "@end\n"
+    "@program prog vs fs\n";
+
+const char* src_b =
+    "@vs vs\n"
+    "@include common_b.glsl\n"
+    "in vec4 position;\n"
+    "in vec4 color0;\n"
+    "out vec4 color;\n"
+    "void main() { gl_Position = mvp_b * position; color = color0; }\n"
+    "@end\n"
+    "@fs fs\n"
+    "in vec4 color;\n"
+    "out vec4 frag_color;\n"
+    "void main() { frag_color = color; }\n"
+    "@end\n"
+    "@program prog vs fs\n";
+
+} // namespace
+
+int main() {
+    Job jobs[2];
+    jobs[0].module = "bla";
+    jobs[0].module_override = nullptr;
+    jobs[0].main_path = "shaders/a.glsl";
+    jobs[0].main_src = src_a;
+    jobs[0].include_path = "shaders/common_a.glsl";
+    jobs[0].include_src = "layout(binding=0) uniform params_a { vec4 scale_a; };\n";
+    jobs[0].ub_name = "params_a";
+    jobs[1].module = "blub";
+    jobs[1].module_override = "blub";
+    jobs[1].main_path = "other/b.glsl";
+    jobs[1].main_src = src_b;
+    jobs[1].include_path = "other/common_b.glsl";
+    jobs[1].include_src = "layout(binding=0) uniform params_b { mat4 mvp_b; };\n";
+    jobs[1].ub_name = "params_b";
+
+    shdc_setup();
+    std::thread thread0(run_job, &jobs[0], 20);
+    std::thread thread1(run_job, &jobs[1], 20);
+    thread0.join();
+    thread1.join();
+    shdc_shutdown();
+
+    int num_failed = jobs[0].num_failed + jobs[1].num_failed;
+    printf("libshdc-test: %d failed\n", num_failed);
+    return (num_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,81 @@
+/*
+    heap allocation statistics per compilation phase (--alloc-stats)
+*/
+#include "allocstats.h"
+#include <string.h>
+#include <mutex>
+#include "fmt/format.h"
+
+namespace shdc {
+
+std::atomic<bool> AllocStats::enabled{false};
+std::atomic<uint64_t> AllocStats::num_allocs{0};
+std::atomic<uint64_t> AllocStats::num_bytes{0};
+
+// NOTE: the phase table is a fixed-size array so that recording a phase doesn't allocate.
+// Allocations are only counted by the operator new replacement in main.cc and begin() is
+// only called from sokol-shdc's main(), so programs linking the shdc library never record
+// anything (end_phase() returns early). In sokol-shdc, --alloc-stats can't be combined with
+// --worker, --batch or --watch and the pipelines run one after another, the mutex only keeps
+// the table consistent if end_phase() is ever called from several threads.
+static std::mutex phases_mutex;
+static AllocStats::Phase phases[AllocStats::MaxPhases];
+static int num_phases = 0;
+static uint64_t last_allocs = 0;
+static uint64_t last_bytes = 0;
+
+void AllocStats::begin() {
+    std::lock_guard<std::mutex> lock(phases_mutex);
+    for (Phase& phase: phases) {
+        phase = Phase();
+    }
+    num_phases = 0;
+    last_allocs = num_allocs.load();
+    last_bytes = num_bytes.load();
+    enabled = true;
+}
+
+void AllocStats::end_phase(const char* name) {
+    if (!enabled) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(phases_mutex);
+    const uint64_t cur_allocs = num_allocs.load();
+    const uint64_t cur_bytes = num_bytes.load();
+    Phase* phase = nullptr;
+    for (int i = 0; i < num_phases; i++) {
+        if (0 == strcmp(phases[i].name, name)) {
+            phase = &phases[i];
+            break;
+        }
+    }
+    if ((nullptr == phase) && (num_phases < MaxPhases)) {
+        phase = &phases[num_phases++];
+        phase->name = name;
+    }
+    if (phase) {
+        phase->num_allocs += cur_allocs - last_allocs;
+        phase->num_bytes += cur_bytes - last_bytes;
+    }
+    last_allocs = cur_allocs;
+    last_bytes = cur_bytes;
+}
+
+void AllocStats::end() {
+    if (!enabled) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(phases_mutex);
+    enabled = false;
+    uint64_t total_allocs = 0;
+    uint64_t total_bytes = 0;
+    fmt::print(stderr, "sokol-shdc: heap allocations per phase:\n");
+    for (int i = 0; i < num_phases; i++) {
+        fmt::print(stderr, "  {:<12} {:>10} allocs {:>14} bytes\n", phases[i].name, phases[i].num_allocs, phases[i].num_bytes);
+        total_allocs += phases[i].num_allocs;
+        total_bytes += phases[i].num_bytes;
+    }
+    fmt::print(stderr, "  {:<12} {:>10} allocs {:>14} bytes\n", "total", total_allocs, total_bytes);
+}
+
+} // namespace shdc
@@ -0,0 +1,42 @@
+#pragma once
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace shdc {
+
+// heap allocation counters per compilation phase for --alloc-stats, the counting
+// happens in the operator new replacement of the sokol-shdc executable, the
+// shdc library only records the counters at the end of each phase (and only
+// after sokol-shdc's main() called begin(), so library users never record anything)
+struct AllocStats {
+    static const int MaxPhases = 16;
+    struct Phase {
+        const char* name = nullptr;
+        uint64_t num_allocs = 0;
+        uint64_t num_bytes = 0;
+    };
+
+    // called from operator new, only counts while enabled
+    static void count(size_t size);
+    // reset all phases and start counting
+    static void begin();
+    // add the allocations since the previous end_phase() or begin() to a phase, phases with the same name accumulate
+    static void end_phase(const char* name);
+    // stop counting and print the allocations per phase to stderr
+    static void end();
+
+private:
+    static std::atomic<bool> enabled;
+    static std::atomic<uint64_t> num_allocs;
+    static std::atomic<uint64_t> num_bytes;
+};
+
+inline void AllocStats::count(size_t size) {
+    if (enabled.load(std::memory_order_relaxed)) {
+        num_allocs.fetch_add(1, std::memory_order_relaxed);
+        num_bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+}
+
+} // namespace shdc
@@ -4,6 +4,8 @@
 #include "args.h"
 #include "types/slang.h"
 #include <vector>
+#include <algorithm>
+#include <filesystem>
 #include <stdio.h>
 #include "fmt/format.h"
 #include "getopt/getopt.h"
@@ -11,8 +13,9 @@
 
 namespace shdc {
 
+// start above the ASCII range, getopt returns '!', '?' and '+' on errors
 enum {
-    OPTION_HELP = 1,
+    OPTION_HELP = 0x100,
     OPTION_INPUT,
     OPTION_OUTPUT,
     OPTION_SLANG,
@@ -28,18 +31,37 @@ enum {
     OPTION_NOIFDEF,
     OPTION_REFLECTION,
     OPTION_SAVE_INTERMEDIATE_SPIRV,
+    OPTION_WATCH,
+    OPTION_COMPRESS,
+    OPTION_STATS,
+    OPTION_LAYOUT_REPORT,
+    OPTION_UNUSED_REPORT,
+    OPTION_PACK_VARYINGS,
+    OPTION_INFER_MEDIUMP,
+    OPTION_VERTEX_FORMATS,
+    OPTION_UNIFORM_HELPERS,
+    OPTION_UNIFORM_SHADOW,
+    OPTION_SHARED_TYPES,
+    OPTION_REPRODUCIBLE,
+    OPTION_ROOT,
+    OPTION_WORKER,
+    OPTION_BATCH,
+    OPTION_WORKERS,
+    OPTION_BYTECODE_CMD,
+    OPTION_BYTECODE_JOBS,
+    OPTION_ALLOC_STATS,
 };
 
 static const getopt_option_t option_list[] = {
     { "help",               'h', GETOPT_OPTION_TYPE_NO_ARG,     0, OPTION_HELP,         "print this help text", 0},
-    { "input",              'i', GETOPT_OPTION_TYPE_REQUIRED,   0, OPTION_INPUT,        "input source file", "GLSL file" },
+    { "input",              'i', GETOPT_OPTION_TYPE_REQUIRED,   0, OPTION_INPUT,        "input source file (may be repeated with --shared-types)", "GLSL file" },
     { "output",             'o', GETOPT_OPTION_TYPE_REQUIRED,   0, OPTION_OUTPUT,       "output source file", "C header" },
     { "slang",              'l', GETOPT_OPTION_TYPE_REQUIRED,   0, OPTION_SLANG,        "output shader language(s), see above for list", "glsl430:glsl300es..." },
     { "defines",            0,   GETOPT_OPTION_TYPE_REQUIRED,   0, OPTION_DEFINES,      "optional preprocessor defines", "define1:define2..." },
     { "module",             'm', GETOPT_OPTION_TYPE_REQUIRED,   0, OPTION_MODULE,       "optional @module name override" },
     { "reflection",         'r', GETOPT_OPTION_TYPE_NO_ARG,     0, OPTION_REFLECTION,   "generate runtime reflection functions" },
     { "bytecode",           'b', GETOPT_OPTION_TYPE_NO_ARG,     0, OPTION_BYTECODE,     "output bytecode (HLSL and Metal)"},
-    { "format",             'f', GETOPT_OPTION_TYPE_REQUIRED,   0, OPTION_FORMAT,       "output format (default: sokol)", "[sokol|sokol_impl|sokol_zig|sokol_nim|sokol_odin|sokol_rust|sokol_d|sokol_jai|bare|bare_yaml]" },
+    { "format",             'f', GETOPT_OPTION_TYPE_REQUIRED,   0, OPTION_FORMAT,       "output format (default: sokol)", "[sokol|sokol_impl|sokol_zig|sokol_nim|sokol_odin|sokol_rust|sokol_d|sokol_jai|bare|bare_yaml|bare_bin|bare_pack]" },
     { "errfmt",             'e', GETOPT_OPTION_TYPE_REQUIRED,   0, OPTION_ERRFMT,       "error message format (default: gcc)", "[gcc|msvc]"},
     { "dump",               'd', GETOPT_OPTION_TYPE_NO_ARG,     0, OPTION_DUMP,         "dump debugging information to stderr"},
     { "genver",             'g', GETOPT_OPTION_TYPE_REQUIRED,   0, OPTION_GENVER,       "version-stamp for code-generation", "[int]"},
@@ -47,6 +69,25 @@ static const getopt_option_t option_list[] = {
     { "ifdef",              0,   GETOPT_OPTION_TYPE_NO_ARG,     0, OPTION_IFDEF,        "wrap backend-specific generated code in #ifdef/#endif"},
     { "noifdef",            'n', GETOPT_OPTION_TYPE_NO_ARG,     0, OPTION_NOIFDEF,      "obsolete, superseded by --ifdef"},
     { "save-intermediate-spirv", 0, GETOPT_OPTION_TYPE_NO_ARG,  0, OPTION_SAVE_INTERMEDIATE_SPIRV, "save intermediate SPIRV bytecode (for debug inspection)"},
+    { "watch",              'w', GETOPT_OPTION_TYPE_NO_ARG,     0, OPTION_WATCH,        "watch input files and recompile changed shaders"},
+    { "compress",           0,   GETOPT_OPTION_TYPE_NO_ARG,     0, OPTION_COMPRESS,     "LZ4-compress bare_pack archive entries"},
+    { "stats",              0,   GETOPT_OPTION_TYPE_REQUIRED,   0, OPTION_STATS,        "write static shader cost statistics (JSON, or CSV with .csv extension)", "[path]"},
+    { "layout-report",      0,   GETOPT_OPTION_TYPE_NO_ARG,     0, OPTION_LAYOUT_REPORT, "warn about padding in uniform blocks and suggest a better member order"},
+    { "unused-report",      0,   GETOPT_OPTION_TYPE_NO_ARG,     0, OPTION_UNUSED_REPORT, "warn about uniforms, vertex attributes and resources which are never read"},
+    { "pack-varyings",      0,   GETOPT_OPTION_TYPE_NO_ARG,     0, OPTION_PACK_VARYINGS, "pack float, vec2 and vec3 varyings into shared vec4 slots"},
+    { "infer-mediump",      0,   GETOPT_OPTION_TYPE_NO_ARG,     0, OPTION_INFER_MEDIUMP, "use mediump for fragment shader values with a small value range (glsl300es)"},
+    { "vertex-formats",     0,   GETOPT_OPTION_TYPE_NO_ARG,     0, OPTION_VERTEX_FORMATS, "suggest compact vertex formats and generate packed vertex structs (C output)"},
+    { "uniform-helpers",    0,   GETOPT_OPTION_TYPE_NO_ARG,     0, OPTION_UNIFORM_HELPERS, "generate uniform block layout asserts and staging buffer helpers (C output)"},
+    { "uniform-shadow",     0,   GETOPT_OPTION_TYPE_NO_ARG,     0, OPTION_UNIFORM_SHADOW, "generate uniform block shadow copies with dirty tracking (C output)"},
+    { "shared-types",       0,   GETOPT_OPTION_TYPE_REQUIRED,   0, OPTION_SHARED_TYPES, "write uniform blocks and storage buffers of all inputs into a shared header, output is a directory (C output)", "[path]"},
+    { "reproducible",       0,   GETOPT_OPTION_TYPE_NO_ARG,     0, OPTION_REPRODUCIBLE, "byte-identical output for identical inputs, with paths relative to --root"},
+    { "root",               0,   GETOPT_OPTION_TYPE_REQUIRED,   0, OPTION_ROOT,         "root directory for paths in the generated output (default: current directory)", "[dir]"},
+    { "worker",             0,   GETOPT_OPTION_TYPE_REQUIRED,   0, OPTION_WORKER,       "run as worker and accept compilation jobs on this address (default host: 127.0.0.1)", "[host:]port"},
+    { "batch",              0,   GETOPT_OPTION_TYPE_REQUIRED,   0, OPTION_BATCH,        "compile a batch file with one sokol-shdc command line per line on --workers", "[path]"},
+    { "workers",            0,   GETOPT_OPTION_TYPE_REQUIRED,   0, OPTION_WORKERS,      "worker addresses for --batch, one connection per entry", "host:port,..."},
+    { "bytecode-cmd",       0,   GETOPT_OPTION_TYPE_REQUIRED,   0, OPTION_BYTECODE_CMD, "external compiler command line template for -b (HLSL and Metal)", "\"cmd {src} {out}\""},
+    { "bytecode-jobs",      0,   GETOPT_OPTION_TYPE_REQUIRED,   0, OPTION_BYTECODE_JOBS, "number of parallel external bytecode compiler processes (default: number of CPU cores)", "[int]"},
+    { "alloc-stats",        0,   GETOPT_OPTION_TYPE_NO_ARG,     0, OPTION_ALLOC_STATS,  "print heap allocations per compilation phase to stderr"},
     GETOPT_OPTIONS_END
 };
 
@@ -69,7 +110,9 @@ static void print_help_string(getopt_context_t& ctx) {
         "  - metal_macos    Metal on macOS (SOKOL_METAL)\n"
         "  - metal_ios      Metal on iOS devices (SOKOL_METAL)\n"
         "  - metal_sim      Metal on iOS simulator (SOKOL_METAL)\n"
-        "  - wgsl           WebGPU (SOKOL_WGPU)\n\n"
+        "  - wgsl           WebGPU (SOKOL_WGPU)\n"
+        "  - spirv_vk       Vulkan SPIRV bytecode (bare formats only)\n"
+        "  - spirv_gl       GL 4.6 SPIRV bytecode (bare formats only)\n\n"
         "Output formats (used with -f --format):\n"
         "  - sokol          C header which includes both decl and inlined impl\n"
         "  - sokol_impl     C header with STB-style SOKOL_SHDC_IMPL wrapped impl\n"
@@ -81,9 +124,11 @@ static void print_help_string(getopt_context_t& ctx) {
         "  - sokol_jai      Jai module file\n"
         "  - sokol_c3       C3 module file\n"
         "  - bare           raw output of SPIRV-Cross compiler, in text or binary format\n"
-        "  - bare_yaml      like bare, but with reflection file in YAML format\n\n"
+        "  - bare_yaml      like bare, but with reflection file in YAML format\n"
+        "  - bare_bin       like bare, but with reflection file in binary format (see shdc_bin.h)\n"
+        "  - bare_pack      single archive file with all shaders and binary reflection (see shdc_pack.h)\n\n"
         "Options:\n\n");
-    char buf[4096];
+    char buf[8192];
     fmt::print(stderr, "{}", getopt_create_help_string(&ctx, buf, sizeof(buf)));
 }
 
@@ -130,19 +175,92 @@ static bool parse_slang(Args& args, const char* str) {
 
 static void validate(Args& args) {
     bool err = false;
-    if (args.input.empty()) {
-        fmt::print(stderr, "sokol-shdc: no input file (--input [path])\n");
+    // workers and batch coordinators get the input, output and shader languages from the jobs
+    const bool is_worker = !args.worker.empty();
+    const bool is_batch = !args.batch.empty();
+    if (!is_worker && !is_batch) {
+        if (args.input.empty()) {
+            fmt::print(stderr, "sokol-shdc: no input file (--input [path])\n");
+            err = true;
+        }
+        if (args.output.empty()) {
+            fmt::print(stderr, "sokol-shdc: no output file (--output [path])\n");
+            err = true;
+        }
+        if (args.slang == 0) {
+            fmt::print(stderr, "sokol-shdc: no shader languages (--slang ...)\n");
+            err = true;
+        }
+    }
+    if (is_worker && is_batch) {
+        fmt::print(stderr, "sokol-shdc: --worker and --batch can't be combined\n");
+        err = true;
+    }
+    if (is_batch && args.workers.empty()) {
+        fmt::print(stderr, "sokol-shdc: --batch requires --workers\n");
+        err = true;
+    }
+    if ((args.inputs.size() > 1) && args.shared_types.empty()) {
+        fmt::print(stderr, "sokol-shdc: multiple input files are only allowed with --shared-types\n");
+        err = true;
+    }
+    if (!args.shared_types.empty()) {
+        if ((args.output_format != Format::SOKOL) && (args.output_format != Format::SOKOL_IMPL)) {
+            fmt::print(stderr, "sokol-shdc: --shared-types is only supported for the sokol and sokol_impl output formats\n");
+            err = true;
+        }
+        if (args.watch || !args.stats.empty()) {
+            fmt::print(stderr, "sokol-shdc: --shared-types can't be combined with --watch or --stats\n");
+            err = true;
+        }
+    }
+    if (args.uniform_shadow && (args.output_format != Format::SOKOL) && (args.output_format != Format::SOKOL_IMPL)) {
+        fmt::print(stderr, "sokol-shdc: --uniform-shadow is only supported for the sokol and sokol_impl output formats\n");
+        err = true;
+    }
+    // sokol-gfx has no backend for SPIRV bytecode, so there's nothing to generate a shader desc for
+    const uint32_t spirv_slangs = Slang::bit(Slang::SPIRV_VK) | Slang::bit(Slang::SPIRV_GL);
+    if ((args.slang & spirv_slangs) && (args.output_format != Format::BARE) && (args.output_format != Format::BARE_YAML) && (args.output_format != Format::BARE_BIN)) {
+        fmt::print(stderr, "sokol-shdc: spirv_vk and spirv_gl are only supported for the bare, bare_yaml and bare_bin output formats\n");
         err = true;
     }
-    if (args.output.empty()) {
-        fmt::print(stderr, "sokol-shdc: no output file (--output [path])\n");
+    if (!args.bytecode_cmd.empty() && !args.byte_code) {
+        fmt::print(stderr, "sokol-shdc: --bytecode-cmd requires -b --bytecode\n");
         err = true;
     }
-    if (args.slang == 0) {
-        fmt::print(stderr, "sokol-shdc: no shader languages (--slang ...)\n");
+    if (args.bytecode_jobs < 0) {
+        fmt::print(stderr, "sokol-shdc: --bytecode-jobs must be a positive number\n");
         err = true;
     }
-    if (args.tmpdir.empty()) {
+    if (args.alloc_stats && (args.watch || !args.worker.empty() || is_batch)) {
+        fmt::print(stderr, "sokol-shdc: --alloc-stats can't be combined with --watch, --worker or --batch\n");
+        err = true;
+    }
+    if (!args.root.empty() && !args.reproducible) {
+        fmt::print(stderr, "sokol-shdc: --root requires --reproducible\n");
+        err = true;
+    }
+    if (args.reproducible) {
+        namespace fs = std::filesystem;
+        std::error_code ec;
+        fs::path root = fs::absolute(args.root.empty() ? fs::path(".") : fs::path(args.root), ec).lexically_normal();
+        if (!root.has_filename()) {
+            // strip the trailing separator
+            root = root.parent_path();
+        }
+        if (ec) {
+            fmt::print(stderr, "sokol-shdc: failed to resolve --root directory '{}'\n", args.root);
+            err = true;
+        }
+        args.root = root.generic_string();
+    }
+    if (args.tmpdir.empty() && !args.shared_types.empty()) {
+        // the output is a directory
+        args.tmpdir = args.output;
+        if (!args.tmpdir.empty() && !pystring::endswith(args.tmpdir, "/")) {
+            args.tmpdir += "/";
+        }
+    } else if (args.tmpdir.empty()) {
         std::string tail;
         pystring::os::path::split(args.tmpdir, tail, args.output);
         if (!args.tmpdir.empty()) {
@@ -162,6 +280,60 @@ static void validate(Args& args) {
     }
 }
 
+// the original command line with all paths relative to the --root directory, and
+// without the options which don't change the generated output (--tmpdir, --root and --bytecode-jobs)
+static std::string reproducible_cmdline(const Args& args, int argc, const char** argv) {
+    static const std::vector<std::string> path_opts = { "-i", "--input", "-o", "--output", "--stats", "--shared-types" };
+    static const std::vector<std::string> skip_opts = { "-t", "--tmpdir", "--root", "--bytecode-jobs" };
+    const auto contains = [](const std::vector<std::string>& opts, const std::string& opt) {
+        return std::find(opts.begin(), opts.end(), opt) != opts.end();
+    };
+    std::string res = "sokol-shdc";
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        std::string opt = arg;
+        std::string val;
+        const size_t eq_pos = arg.find('=');
+        const bool has_val = pystring::startswith(arg, "--") && (eq_pos != std::string::npos);
+        if (has_val) {
+            opt = arg.substr(0, eq_pos);
+            val = arg.substr(eq_pos + 1);
+        }
+        if (contains(skip_opts, opt)) {
+            if (!has_val) {
+                i++;
+            }
+            continue;
+        }
+        if (contains(path_opts, opt)) {
+            if (has_val) {
+                arg = fmt::format("{}={}", opt, args.embedded_path(val));
+            } else if ((i + 1) < argc) {
+                res.append(" ");
+                res.append(arg);
+                arg = args.embedded_path(argv[++i]);
+            }
+        }
+        res.append(" ");
+        res.append(arg);
+    }
+    return res;
+}
+
+std::string Args::embedded_path(const std::string& path) const {
+    if (!reproducible || path.empty()) {
+        return path;
+    }
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    const fs::path abs_path = fs::absolute(fs::path(path), ec).lexically_normal();
+    if (ec) {
+        return path;
+    }
+    const fs::path rel_path = abs_path.lexically_relative(fs::path(root));
+    return rel_path.empty() ? path : rel_path.generic_string();
+}
+
 Args Args::parse(int argc, const char** argv) {
     Args args;
 
@@ -192,7 +364,8 @@ Args Args::parse(int argc, const char** argv) {
                     args.valid = false;
                     return args;
                 case OPTION_INPUT:
-                    args.input = ctx.current_opt_arg;
+                    args.inputs.push_back(ctx.current_opt_arg);
+                    args.input = args.inputs[0];
                     break;
                 case OPTION_OUTPUT:
                     args.output = ctx.current_opt_arg;
@@ -215,7 +388,7 @@ Args Args::parse(int argc, const char** argv) {
                 case OPTION_FORMAT:
                     args.output_format = Format::from_str(ctx.current_opt_arg);
                     if (args.output_format == Format::INVALID) {
-                        fmt::print(stderr, "sokol-shdc: unknown output format {}, must be [sokol|sokol_impl|sokol_zig|sokol_nim|sokol_odin|sokol_rust|sokol_jai|sokol_c3|bare|base_yaml]\n", ctx.current_opt_arg);
+                        fmt::print(stderr, "sokol-shdc: unknown output format {}, must be [sokol|sokol_impl|sokol_zig|sokol_nim|sokol_odin|sokol_rust|sokol_jai|sokol_c3|bare|bare_yaml|bare_bin|bare_pack]\n", ctx.current_opt_arg);
                         args.valid = false;
                         args.exit_code = 10;
                         return args;
@@ -227,6 +400,66 @@ Args Args::parse(int argc, const char** argv) {
                 case OPTION_SAVE_INTERMEDIATE_SPIRV:
                     args.save_intermediate_spirv = true;
                     break;
+                case OPTION_WATCH:
+                    args.watch = true;
+                    break;
+                case OPTION_COMPRESS:
+                    args.compress = true;
+                    break;
+                case OPTION_STATS:
+                    args.stats = ctx.current_opt_arg;
+                    break;
+                case OPTION_LAYOUT_REPORT:
+                    args.layout_report = true;
+                    break;
+                case OPTION_UNUSED_REPORT:
+                    args.unused_report = true;
+                    break;
+                case OPTION_PACK_VARYINGS:
+                    args.pack_varyings = true;
+                    break;
+                case OPTION_INFER_MEDIUMP:
+                    args.infer_mediump = true;
+                    break;
+                case OPTION_VERTEX_FORMATS:
+                    args.vertex_formats = true;
+                    break;
+                case OPTION_UNIFORM_HELPERS:
+                    args.uniform_helpers = true;
+                    break;
+                case OPTION_UNIFORM_SHADOW:
+                    args.uniform_shadow = true;
+                    break;
+                case OPTION_SHARED_TYPES:
+                    args.shared_types = ctx.current_opt_arg;
+                    break;
+                case OPTION_REPRODUCIBLE:
+                    args.reproducible = true;
+                    break;
+                case OPTION_ROOT:
+                    args.root = ctx.current_opt_arg;
+                    break;
+                case OPTION_WORKER:
+                    args.worker = ctx.current_opt_arg;
+                    break;
+                case OPTION_BATCH:
+                    args.batch = ctx.current_opt_arg;
+                    break;
+                case OPTION_WORKERS:
+                    args.workers = ctx.current_opt_arg;
+                    break;
+                case OPTION_BYTECODE_CMD:
+                    args.bytecode_cmd = ctx.current_opt_arg;
+                    break;
+                case OPTION_BYTECODE_JOBS:
+                    args.bytecode_jobs = atoi(ctx.current_opt_arg);
+                    if (args.bytecode_jobs == 0) {
+                        args.bytecode_jobs = -1;
+                    }
+                    break;
+                case OPTION_ALLOC_STATS:
+                    args.alloc_stats = true;
+                    break;
                 case OPTION_SLANG:
                     if (!parse_slang(args, ctx.current_opt_arg)) {
                         /* error details have been filled by parse_slang() */
@@ -266,6 +499,9 @@ Args Args::parse(int argc, const char** argv) {
         }
     }
     validate(args);
+    if (args.valid && args.reproducible) {
+        args.cmdline = reproducible_cmdline(args, argc, argv);
+    }
     return args;
 }
 
@@ -284,6 +520,26 @@ void Args::dump_debug() const {
     fmt::print(stderr, "  debug_dump: {}\n", debug_dump);
     fmt::print(stderr, "  ifdef: {}\n", ifdef);
     fmt::print(stderr, "  gen_version: {}\n", gen_version);
+    fmt::print(stderr, "  watch: {}\n", watch);
+    fmt::print(stderr, "  compress: {}\n", compress);
+    fmt::print(stderr, "  stats: '{}'\n", stats);
+    fmt::print(stderr, "  layout_report: {}\n", layout_report);
+    fmt::print(stderr, "  unused_report: {}\n", unused_report);
+    fmt::print(stderr, "  pack_varyings: {}\n", pack_varyings);
+    fmt::print(stderr, "  infer_mediump: {}\n", infer_mediump);
+    fmt::print(stderr, "  vertex_formats: {}\n", vertex_formats);
+    fmt::print(stderr, "  uniform_helpers: {}\n", uniform_helpers);
+    fmt::print(stderr, "  uniform_shadow: {}\n", uniform_shadow);
+    fmt::print(stderr, "  inputs: '{}'\n", pystring::join(":", inputs));
+    fmt::print(stderr, "  shared_types: '{}'\n", shared_types);
+    fmt::print(stderr, "  reproducible: {}\n", reproducible);
+    fmt::print(stderr, "  root: '{}'\n", root);
+    fmt::print(stderr, "  worker: '{}'\n", worker);
+    fmt::print(stderr, "  batch: '{}'\n", batch);
+    fmt::print(stderr, "  workers: '{}'\n", workers);
+    fmt::print(stderr, "  bytecode_cmd: '{}'\n", bytecode_cmd);
+    fmt::print(stderr, "  bytecode_jobs: {}\n", bytecode_jobs);
+    fmt::print(stderr, "  alloc_stats: {}\n", alloc_stats);
     fmt::print(stderr, "  error_format: {}\n", ErrMsg::format_to_str(error_format));
     fmt::print(stderr, "\n");
 }
@@ -13,6 +13,7 @@ struct Args {
     std::string cmdline;
     int exit_code = 10;
     std::string input;                  // input file path
+    std::vector<std::string> inputs;    // all input file paths (multiple inputs with --shared-types)
     std::string output;                 // output file path
     std::string tmpdir;                 // directory for temporary files
     std::string module;                 // optional @module name override
@@ -24,10 +25,31 @@ struct Args {
     bool debug_dump = false;            // print debug-dump info
     bool ifdef = false;                 // wrap backend specific shaders into #ifdefs (SOKOL_D3D11 etc...)
     bool save_intermediate_spirv = false;   // save intermediate SPIRV bytecode (glslangvalidator output)
+    bool watch = false;                 // keep running and recompile when the input files change
+    bool compress = false;              // compress bare_pack archive entries
+    std::string stats;                  // optional path of a shader cost statistics file (.json or .csv)
+    bool layout_report = false;         // warn about uniform blocks which could be smaller with reordered members
+    bool unused_report = false;         // warn about uniform block members, vertex attributes and resources which are never read
+    bool pack_varyings = false;         // pack vertex shader outputs and fragment shader inputs into shared vec4 slots
+    bool infer_mediump = false;         // decorate fragment shader values with a small value range as mediump (GLSL ES only)
+    bool vertex_formats = false;        // find compact vertex attribute formats and generate packed vertex structs
+    bool uniform_helpers = false;       // generate uniform block layout asserts and staging buffer helpers
+    bool uniform_shadow = false;        // generate uniform block shadow copies with dirty tracking
+    std::string shared_types;           // optional path of a shared uniform block and storage buffer header, output is a directory
+    bool reproducible = false;          // byte-identical output for identical inputs, independent of the directory layout
+    std::string root;                   // with --reproducible, paths in the generated output are relative to this directory
+    std::string worker;                 // optional [host:]port to accept distributed compilation jobs on
+    std::string batch;                  // optional path of a batch file with one compilation job per line
+    std::string workers;                // comma-separated worker host:port addresses for --batch
+    std::string bytecode_cmd;           // optional external compiler command line template for -b
+    int bytecode_jobs = 0;              // number of parallel external compiler processes, 0 for one per CPU core
+    bool alloc_stats = false;           // print heap allocations per compilation phase
     int gen_version = 1;                // generator-version stamp
     ErrMsg::Format error_format = ErrMsg::GCC;  // format for error messages
 
     static Args parse(int argc, const char** argv);
+    // a path as it appears in generated output (relative to the root directory with --reproducible)
+    std::string embedded_path(const std::string& path) const;
     void dump_debug() const;
 };
 
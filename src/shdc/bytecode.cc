@@ -1,19 +1,44 @@
 /*
     Compile HLSL / Metal source code to bytecode, HLSL only works
-    when running on Windows, Metal only works when running on macOS.
+    when running on Windows or Linux, Metal only works when running on macOS.
 
     Uses d3dcompiler.dll for HLSL, and for Metal, invokes the Metal
-    compiler toolchain command line tools.
+    compiler toolchain command line tools. On Linux, HLSL is compiled
+    to DXBC with the vkd3d-compiler command line tool from vkd3d-shader,
+    if it isn't installed, HLSL source code is used.
 
     On Metal, bytecode compilation only happens for the macOS and iOS
     targets, but not for running in the simulator, in this case,
     shaders are compiled at runtime from source code.
+
+    With --bytecode-cmd, a user-provided compiler command line replaces
+    the builtin HLSL and Metal bytecode compilers on all platforms.
+
+    For the SPIRV output languages, the bytecode has already been
+    created in the Spirvcross step and is simply copied into blobs
+    on all platforms.
 */
 #include "bytecode.h"
 #include "fmt/format.h"
 #include "pystring.h"
 #include <stdio.h> // popen etc...
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <thread>
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+#if !defined(_WIN32)
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/wait.h>
+#endif
 #if defined(_WIN32)
+#include <mutex>
 #include <d3dcompiler.h>
 #include <d3dcommon.h>
 #endif
@@ -29,8 +54,32 @@ const BytecodeBlob* Bytecode::find_blob_by_snippet_index(int snippet_index) cons
     return nullptr;
 }
 
-// MacOS/Metal specific stuff...
-#if defined(__APPLE__)
+/*
+    External compiler tools (Metal, vkd3d and --bytecode-cmd) run in a
+    scratch directory which is unique per Bytecode::compile() call, so that
+    concurrent sokol-shdc processes sharing a tmpdir don't clobber each
+    other's intermediate files. Inside the scratch directory, file names
+    only depend on the input, shader language and snippet, and the tools are
+    invoked with relative paths, so that paths embedded into bytecode
+    don't depend on the tmpdir either. One job per snippet is executed
+    on a pool of threads, each thread runs one process at a time.
+*/
+#if defined(_WIN32)
+#define popen _popen
+#define pclose _pclose
+#define getpid _getpid
+#endif
+
+// one external compiler invocation for a snippet, the commands run in
+// sequence and the sequence stops at the first failing command
+struct ExtJob {
+    int snippet_index = -1;
+    std::vector<std::string> cmdlines;              // shell command lines (--bytecode-cmd)
+    std::vector<std::vector<std::string>> argvs;    // builtin compiler tools, started without a shell
+    std::string out_path;       // output file, relative to the scratch directory
+    std::string output;         // captured stdout and stderr of all commands
+    int exit_code = 0;
+};
 
 // write source code to file
 static bool write_source(const std::string& source_code, const std::string path) {
@@ -58,13 +107,248 @@ static bool read_binary(const std::string& path, std::vector<uint8_t>& out_blob)
         if (res) {
             out_blob = std::move(blob);
         }
-        return true;
+        return res;
     } else {
         out_blob.clear();
         return false;
     }
 }
 
+#if !defined(_WIN32)
+// the exit code of a child process, or 128 plus the signal number if it was killed by a signal
+static int exit_code_from_status(int status) {
+    if (status == -1) {
+        return 10;
+    } else if (WIFEXITED(status)) {
+        return WEXITSTATUS(status);
+    } else if (WIFSIGNALED(status)) {
+        return 128 + WTERMSIG(status);
+    }
+    return 10;
+}
+#endif
+
+// run a shell command line, capture its output (including stderr) and return the
+// exit code of the command, or 128 plus the signal number if it was killed by a signal
+static int run_cmdline(const std::string& cmd, std::string& output) {
+    int exit_code = 10;
+    FILE* p = popen(fmt::format("{} 2>&1", cmd).c_str(), "r");
+    if (p) {
+        char buf[1024];
+        buf[0] = 0;
+        while (fgets(buf, sizeof(buf), p)) {
+            output += buf;
+        }
+        const int status = pclose(p);
+        #if defined(_WIN32)
+        exit_code = status;
+        #else
+        exit_code = exit_code_from_status(status);
+        #endif
+    }
+    return exit_code;
+}
+
+#if !defined(_WIN32)
+// run a program inside a working directory without a shell, so that no argument is
+// ever interpreted by a shell, capture its output (including stderr) and return the
+// exit code like run_cmdline(), 127 if the program couldn't be started
+static int run_argv(const std::string& work_dir, const std::vector<std::string>& argv, std::string& output) {
+    // everything the child process needs is prepared before fork()
+    std::vector<char*> c_argv;
+    for (const std::string& arg: argv) {
+        c_argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    c_argv.push_back(nullptr);
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return 10;
+    }
+    // don't leak the pipe into processes started by other job threads
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    const pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return 10;
+    }
+    if (pid == 0) {
+        dup2(fds[1], 1);
+        dup2(fds[1], 2);
+        if (chdir(work_dir.c_str()) == 0) {
+            execvp(c_argv[0], c_argv.data());
+        }
+        _exit(127);
+    }
+    close(fds[1]);
+    char buf[1024];
+    for (;;) {
+        const ssize_t num_bytes = read(fds[0], buf, sizeof(buf));
+        if (num_bytes > 0) {
+            output.append(buf, (size_t)num_bytes);
+        } else if ((num_bytes == 0) || (errno != EINTR)) {
+            break;
+        }
+    }
+    close(fds[0]);
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) {
+            return 10;
+        }
+    }
+    return exit_code_from_status(status);
+}
+#endif
+
+// create a new scratch directory in the tmpdir, returns an empty string on failure
+static std::string make_scratch_dir(const Args& args) {
+    static std::atomic<int> counter{0};
+    const std::string dir = fmt::format("{}shdc_{}_{}", args.tmpdir, (int)getpid(), counter++);
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    return ec ? std::string() : dir + "/";
+}
+
+// intermediate files are kept for inspection with --dump
+static void remove_scratch_dir(const Args& args, const std::string& dir) {
+    if (!args.debug_dump && !dir.empty()) {
+        std::error_code ec;
+        std::filesystem::remove_all(dir, ec);
+    }
+}
+
+// common file name prefix of intermediate files in the scratch directory
+static std::string scratch_base_name(const Input& inp, Slang::Enum slang) {
+    std::string base_dir;
+    std::string base_filename;
+    pystring::os::path::split(base_dir, base_filename, inp.base_path);
+    return fmt::format("{}_{}_", base_filename, Slang::to_str(slang));
+}
+
+// run all jobs inside the scratch directory on --bytecode-jobs threads
+static void run_ext_jobs(const Args& args, const std::string& work_dir, std::vector<ExtJob>& jobs) {
+    int num_threads = (args.bytecode_jobs > 0) ? args.bytecode_jobs : (int)std::thread::hardware_concurrency();
+    num_threads = std::max(1, std::min(num_threads, (int)jobs.size()));
+    #if defined(_WIN32)
+    const std::string cd_cmd = fmt::format("cd /d \"{}\" && ", work_dir);
+    #else
+    const std::string cd_cmd = fmt::format("cd \"{}\" && ", work_dir);
+    #endif
+    std::atomic<size_t> next_job{0};
+    const auto run_jobs = [&]() {
+        size_t job_index;
+        while ((job_index = next_job++) < jobs.size()) {
+            ExtJob& job = jobs[job_index];
+            for (const std::string& cmdline: job.cmdlines) {
+                job.exit_code = run_cmdline(cd_cmd + cmdline, job.output);
+                if (job.exit_code != 0) {
+                    break;
+                }
+            }
+            #if !defined(_WIN32)
+            for (size_t i = 0; (i < job.argvs.size()) && (job.exit_code == 0); i++) {
+                job.exit_code = run_argv(work_dir, job.argvs[i], job.output);
+            }
+            #endif
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int i = 1; i < num_threads; i++) {
+        threads.emplace_back(run_jobs);
+    }
+    run_jobs();
+    for (std::thread& thread: threads) {
+        thread.join();
+    }
+}
+
+// read the output file of a successful job into a new bytecode blob
+static bool read_ext_job_blob(const Input& inp, const std::string& work_dir, const ExtJob& job, Bytecode& inout_bytecode) {
+    std::vector<uint8_t> data;
+    if (!read_binary(work_dir + job.out_path, data) || data.empty()) {
+        inout_bytecode.errors.push_back(ErrMsg::error(inp.base_path, 0, fmt::format("failed to read intermediate file '{}{}'!", work_dir, job.out_path)));
+        return false;
+    }
+    BytecodeBlob blob;
+    blob.valid = true;
+    blob.snippet_index = job.snippet_index;
+    blob.data = std::move(data);
+    inout_bytecode.blobs.push_back(std::move(blob));
+    return true;
+}
+
+static const char* hlsl_compile_target(Slang::Enum slang, Snippet::Type type) {
+    if (slang == Slang::HLSL4) {
+        return (type == Snippet::VS) ? "vs_4_0" : "ps_4_0";
+    } else {
+        return (type == Snippet::VS) ? "vs_5_0" : "ps_5_0";
+    }
+}
+
+// compile with the user provided --bytecode-cmd template, placeholders are:
+//  {src}: quoted path of the source file, relative to the working directory
+//  {out}: quoted path of the output file which must be written by the command
+//  {slang}: the shader language name (e.g. hlsl5 or metal_macos)
+//  {stage}: vs or fs
+//  {entry}: the entry point function name
+//  {target}: the HLSL compile target (e.g. vs_5_0), otherwise empty
+static Bytecode cmd_compile(const Args& args, const Input& inp, const Spirvcross& spirvcross, Slang::Enum slang) {
+    Bytecode bytecode;
+    const std::string work_dir = make_scratch_dir(args);
+    if (work_dir.empty()) {
+        bytecode.errors.push_back(ErrMsg::error(inp.base_path, 0, fmt::format("failed to create scratch directory in '{}'!", args.tmpdir)));
+        return bytecode;
+    }
+    const std::string base_name = scratch_base_name(inp, slang);
+    const char* src_ext = Slang::is_hlsl(slang) ? "hlsl" : "metal";
+    std::vector<ExtJob> jobs;
+    for (const SpirvcrossSource& src: spirvcross.sources) {
+        const Snippet& snippet = inp.snippets[src.snippet_index];
+        const std::string src_path = fmt::format("{}{}.{}", base_name, snippet.name, src_ext);
+        ExtJob job;
+        job.snippet_index = src.snippet_index;
+        job.out_path = fmt::format("{}{}.out", base_name, snippet.name);
+        if (!write_source(src.source_code, work_dir + src_path)) {
+            bytecode.errors.push_back(ErrMsg::error(inp.base_path, 0, fmt::format("failed to write intermediate file '{}{}'!", work_dir, src_path)));
+            remove_scratch_dir(args, work_dir);
+            return bytecode;
+        }
+        std::string cmdline = args.bytecode_cmd;
+        cmdline = pystring::replace(cmdline, "{src}", fmt::format("\"{}\"", src_path));
+        cmdline = pystring::replace(cmdline, "{out}", fmt::format("\"{}\"", job.out_path));
+        cmdline = pystring::replace(cmdline, "{slang}", Slang::to_str(slang));
+        cmdline = pystring::replace(cmdline, "{stage}", (snippet.type == Snippet::VS) ? "vs" : "fs");
+        cmdline = pystring::replace(cmdline, "{entry}", src.stage_refl->entry_point_by_slang(slang));
+        cmdline = pystring::replace(cmdline, "{target}", Slang::is_hlsl(slang) ? hlsl_compile_target(slang, snippet.type) : "");
+        job.cmdlines.push_back(cmdline);
+        jobs.push_back(std::move(job));
+    }
+    run_ext_jobs(args, work_dir, jobs);
+    for (const ExtJob& job: jobs) {
+        if (job.exit_code != 0) {
+            std::vector<std::string> lines;
+            pystring::splitlines(job.output, lines);
+            for (const std::string& line: lines) {
+                if (!line.empty()) {
+                    bytecode.errors.push_back(ErrMsg::error(inp.base_path, 0, line));
+                }
+            }
+            bytecode.errors.push_back(ErrMsg::error(inp.base_path, 0, fmt::format("--bytecode-cmd failed for snippet '{}' (exit status {})", inp.snippets[job.snippet_index].name, job.exit_code)));
+            break;
+        }
+        if (!read_ext_job_blob(inp, work_dir, job, bytecode)) {
+            break;
+        }
+    }
+    remove_scratch_dir(args, work_dir);
+    return bytecode;
+}
+
+// MacOS/Metal specific stuff...
+#if defined(__APPLE__)
+
 // convert errors from metal compiler format to ErrMsg objects
 static void mtl_parse_errors(const std::string& output, const Input& inp, int snippet_index, std::vector<ErrMsg>& out_errors) {
     /*
@@ -119,99 +403,174 @@ static void mtl_parse_errors(const std::string& output, const Input& inp, int sn
     }
 }
 
-// run a command line program via xcrun, capture its output and exit code
-static int xcrun(const std::string& cmdline, std::string& output, Slang::Enum slang) {
-    std::string cmd = "xcrun ";
-    if (slang == Slang::METAL_MACOS) {
-        cmd += "--sdk macosx ";
-    } else {
-        cmd += "--sdk iphoneos ";
-    }
-    cmd += cmdline;
-    cmd += " 2>&1";
-
-    int exit_code = 10;
-    FILE* p = popen(cmd.c_str(), "r");
-    if (p) {
-        char buf[1024];
-        buf[0] = 0;
-        while (fgets(buf, sizeof(buf), p)) {
-            output += buf;
-        }
-        exit_code = pclose(p);
-    }
-    return exit_code;
+// the arguments of a Metal toolchain program invoked via xcrun
+static std::vector<std::string> xcrun_argv(const std::vector<std::string>& args, Slang::Enum slang) {
+    std::vector<std::string> argv = { "xcrun", "--sdk", (slang == Slang::METAL_MACOS) ? "macosx" : "iphoneos" };
+    argv.insert(argv.end(), args.begin(), args.end());
+    return argv;
 }
 
-// run the metal compiler pass
-static bool mtl_cc(const std::string& src_path, const std::string& out_dia, const std::string& out_air, Slang::Enum slang, std::string& output) {
-    std::string cmdline;
-    cmdline =  "metal -arch air64 -emit-llvm -ffast-math -c -serialize-diagnostics ";
-    cmdline += out_dia;
-    cmdline += " -o ";
-    cmdline += out_air;
+// the metal compiler pass
+static std::vector<std::string> mtl_cc_argv(const std::string& src_path, const std::string& out_dia, const std::string& out_air, Slang::Enum slang) {
+    std::vector<std::string> args = { "metal", "-arch", "air64", "-emit-llvm", "-ffast-math", "-c", "-serialize-diagnostics", out_dia, "-o", out_air };
     if (slang == Slang::METAL_MACOS) {
-        cmdline += " -mmacosx-version-min=10.11 -std=osx-metal1.1 ";
+        args.insert(args.end(), { "-mmacosx-version-min=10.11", "-std=osx-metal1.1" });
     } else {
-        cmdline += " -miphoneos-version-min=9.0 -std=ios-metal1.1 ";
+        args.insert(args.end(), { "-miphoneos-version-min=9.0", "-std=ios-metal1.1" });
     }
-    cmdline += src_path;
-    return 0 == xcrun(cmdline, output, slang);
+    args.push_back(src_path);
+    return xcrun_argv(args, slang);
 }
 
-// run the metal linker pass
-static bool mtl_link(const std::string& lib_path, const std::string& bin_path, Slang::Enum slang) {
-    std::string dummy_output;
-    std::string cmdline = fmt::format("metallib -o {} {}", bin_path, lib_path);
-    return 0 == xcrun(cmdline, dummy_output, slang);
+// the metal linker pass
+static std::vector<std::string> mtl_link_argv(const std::string& lib_path, const std::string& bin_path, Slang::Enum slang) {
+    return xcrun_argv({ "metallib", "-o", bin_path, lib_path }, slang);
 }
 
 static Bytecode mtl_compile(const Args& args, const Input& inp, const Spirvcross& spirvcross, Slang::Enum slang) {
     Bytecode bytecode;
-    std::string base_dir;
-    std::string base_filename;
-    pystring::os::path::split(base_dir, base_filename, inp.base_path);
-    std::string base_path = fmt::format("{}{}_{}_", args.tmpdir, base_filename, Slang::to_str(slang));
-    std::string src_path, dia_path, air_path, lib_path, bin_path;
+    const std::string work_dir = make_scratch_dir(args);
+    if (work_dir.empty()) {
+        bytecode.errors.push_back(ErrMsg::error(inp.base_path, 0, fmt::format("failed to create scratch directory in '{}'!", args.tmpdir)));
+        return bytecode;
+    }
+    const std::string base_name = scratch_base_name(inp, slang);
 
-    // for each vertex/fragment shader source generated by SPIRV-Cross:
+    // for each vertex/fragment shader source generated by SPIRV-Cross, write
+    // the source to a file and setup a compile and link job
+    std::vector<ExtJob> jobs;
     for (const SpirvcrossSource& src: spirvcross.sources) {
-        std::string output;
         const Snippet& snippet = inp.snippets[src.snippet_index];
-        src_path = fmt::format("{}{}.metal", base_path, snippet.name);
-        dia_path = fmt::format("{}{}.dia", base_path, snippet.name);
-        air_path = fmt::format("{}{}.air", base_path, snippet.name);
-        bin_path = fmt::format("{}{}.metallib", base_path, snippet.name);
-        // write metal source code to temp file
-        if (!write_source(src.source_code, src_path)) {
-            bytecode.errors.push_back(ErrMsg::error(inp.base_path, 0, fmt::format("failed to write intermediate file '{}'!", src_path)));
+        const std::string src_path = fmt::format("{}{}.metal", base_name, snippet.name);
+        const std::string dia_path = fmt::format("{}{}.dia", base_name, snippet.name);
+        const std::string air_path = fmt::format("{}{}.air", base_name, snippet.name);
+        const std::string bin_path = fmt::format("{}{}.metallib", base_name, snippet.name);
+        if (!write_source(src.source_code, work_dir + src_path)) {
+            bytecode.errors.push_back(ErrMsg::error(inp.base_path, 0, fmt::format("failed to write intermediate file '{}{}'!", work_dir, src_path)));
+            remove_scratch_dir(args, work_dir);
+            return bytecode;
+        }
+        ExtJob job;
+        job.snippet_index = src.snippet_index;
+        job.out_path = bin_path;
+        job.argvs.push_back(mtl_cc_argv(src_path, dia_path, air_path, slang));
+        job.argvs.push_back(mtl_link_argv(air_path, bin_path, slang));
+        jobs.push_back(std::move(job));
+    }
+    run_ext_jobs(args, work_dir, jobs);
+
+    // collect messages and bytecode in snippet order, stop at the first failed snippet
+    for (const ExtJob& job: jobs) {
+        // if no hard error happened there may still have been warnings
+        const size_t num_errors = bytecode.errors.size();
+        mtl_parse_errors(job.output, inp, job.snippet_index, bytecode.errors);
+        if (job.exit_code != 0) {
+            if (num_errors == bytecode.errors.size()) {
+                bytecode.errors.push_back(ErrMsg::error(inp.base_path, 0, fmt::format("Metal compiler failed for snippet '{}'", inp.snippets[job.snippet_index].name)));
+            }
             break;
         }
-        // compiler, link, load generated bytecode
-        if (!mtl_cc(src_path, dia_path, air_path, slang, output)) {
-            mtl_parse_errors(output, inp, src.snippet_index, bytecode.errors);
+        if (!read_ext_job_blob(inp, work_dir, job, bytecode)) {
             break;
         }
-        if (!mtl_link(air_path, bin_path, slang)) {
-            mtl_parse_errors(output, inp, src.snippet_index, bytecode.errors);
+    }
+    remove_scratch_dir(args, work_dir);
+    return bytecode;
+}
+#endif
+
+/* Linux specific stuff, HLSL to DXBC via vkd3d-compiler */
+#if defined(__linux__)
+static void vkd3d_parse_errors(const std::string& output, const Input& inp, bool failed, std::vector<ErrMsg>& out_errors) {
+    /*
+        format for errors/warnings is:
+
+        PATH:LINE:COL: [E|W]NNNN: MESSAGE
+
+        NOTE: the line numbers refer to the generated HLSL source
+    */
+    std::vector<std::string> lines;
+    pystring::splitlines(output, lines);
+    std::vector<std::string> tokens;
+    static const std::string colon = ":";
+    for (const std::string& line: lines) {
+        pystring::split(line, tokens, colon);
+        if ((tokens.size() > 4) && (pystring::startswith(tokens[3], " E") || pystring::startswith(tokens[3], " W"))) {
+            std::string msg;
+            for (int i = 4; i < (int)tokens.size(); i++) {
+                if (msg.empty()) {
+                    msg = tokens[i];
+                } else {
+                    msg = fmt::format("{}:{}", msg, tokens[i]);
+                }
+            }
+            if (pystring::startswith(tokens[3], " E")) {
+                out_errors.push_back(ErrMsg::error(inp.base_path, 0, msg));
+            } else {
+                out_errors.push_back(ErrMsg::warning(inp.base_path, 0, msg));
+            }
+        } else if (failed && !line.empty()) {
+            // some error during parsing, output the original line so it isn't lost
+            out_errors.push_back(ErrMsg::error(inp.base_path, 0, line));
+        }
+    }
+}
+
+static Bytecode vkd3d_compile(const Args& args, const Input& inp, const Spirvcross& spirvcross, Slang::Enum slang) {
+    Bytecode bytecode;
+    const std::string work_dir = make_scratch_dir(args);
+    if (work_dir.empty()) {
+        bytecode.errors.push_back(ErrMsg::error(inp.base_path, 0, fmt::format("failed to create scratch directory in '{}'!", args.tmpdir)));
+        return bytecode;
+    }
+    const std::string base_name = scratch_base_name(inp, slang);
+    std::vector<ExtJob> jobs;
+    for (const SpirvcrossSource& src: spirvcross.sources) {
+        const Snippet& snippet = inp.snippets[src.snippet_index];
+        const std::string src_path = fmt::format("{}{}.hlsl", base_name, snippet.name);
+        const std::string bin_path = fmt::format("{}{}.dxbc", base_name, snippet.name);
+        if (!write_source(src.source_code, work_dir + src_path)) {
+            bytecode.errors.push_back(ErrMsg::error(inp.base_path, 0, fmt::format("failed to write intermediate file '{}{}'!", work_dir, src_path)));
+            remove_scratch_dir(args, work_dir);
+            return bytecode;
+        }
+        ExtJob job;
+        job.snippet_index = src.snippet_index;
+        job.out_path = bin_path;
+        job.argvs.push_back({ "vkd3d-compiler", "-x", "hlsl", "-b", "dxbc-tpf", "-p", hlsl_compile_target(slang, snippet.type),
+            "-e", src.stage_refl->entry_point, "-o", bin_path, src_path });
+        jobs.push_back(std::move(job));
+    }
+    run_ext_jobs(args, work_dir, jobs);
+    for (const ExtJob& job: jobs) {
+        if (job.exit_code == 127) {
+            // vkd3d-compiler not installed, fall back to HLSL source code (same as a missing d3dcompiler_47.dll on Windows),
+            // the warning is only printed for the first input file
+            static std::atomic<bool> not_found_warned{false};
+            if (!not_found_warned.exchange(true)) {
+                bytecode.errors.push_back(ErrMsg::warning(inp.base_path, 0, "vkd3d-compiler not found, HLSL bytecode generation skipped"));
+            }
+            bytecode.blobs.clear();
             break;
         }
-        std::vector<uint8_t> data;
-        if (!read_binary(bin_path, data)) {
-            mtl_parse_errors(output, inp, src.snippet_index, bytecode.errors);
+        if (job.exit_code != 0) {
+            // vkd3d-compiler doesn't support everything that d3dcompiler does, so a failure
+            // is only a warning and the HLSL source code is embedded instead, like without -b
+            std::vector<ErrMsg> msgs;
+            vkd3d_parse_errors(job.output, inp, true, msgs);
+            for (const ErrMsg& msg: msgs) {
+                bytecode.errors.push_back(ErrMsg::warning(msg.file, msg.line_index, msg.msg));
+            }
+            bytecode.errors.push_back(ErrMsg::warning(inp.base_path, 0, fmt::format("vkd3d-compiler failed for snippet '{}' (exit status {}), HLSL bytecode generation skipped", inp.snippets[job.snippet_index].name, job.exit_code)));
+            bytecode.blobs.clear();
             break;
         }
-        // if hard error happened there may still have been warnings
-        if (!output.empty()) {
-            mtl_parse_errors(output, inp, src.snippet_index, bytecode.errors);
+        vkd3d_parse_errors(job.output, inp, false, bytecode.errors);
+        if (!read_ext_job_blob(inp, work_dir, job, bytecode)) {
+            break;
         }
-
-        BytecodeBlob blob;
-        blob.valid = true;
-        blob.snippet_index = src.snippet_index;
-        blob.data = std::move(data);
-        bytecode.blobs.push_back(std::move(blob));
     }
+    remove_scratch_dir(args, work_dir);
     return bytecode;
 }
 #endif
@@ -221,13 +580,16 @@ static Bytecode mtl_compile(const Args& args, const Input& inp, const Spirvcross
 static HINSTANCE d3dcompiler_dll = 0;
 static pD3DCompile d3dcompile_func = 0;
 
+static std::once_flag d3dcompiler_once;
+
+// NOTE: may be called from multiple threads when used through libshdc
 static bool load_d3dcompiler_dll(void) {
-    if (0 == d3dcompiler_dll) {
+    std::call_once(d3dcompiler_once, []() {
         d3dcompiler_dll = LoadLibraryA("d3dcompiler_47.dll");
         if (0 != d3dcompiler_dll) {
             d3dcompile_func = (pD3DCompile) GetProcAddress(d3dcompiler_dll, "D3DCompile");
         }
-    }
+    });
     return 0 != d3dcompile_func;
 }
 
@@ -308,7 +670,7 @@ static Bytecode d3d_compile(const Input& inp, const Spirvcross& spirvcross, Slan
             NULL,                           // pSourceName
             NULL,                           // pDefines
             NULL,                           // pInclude
-            src.stage_refl.entry_point.c_str(), // entryPoint
+            src.stage_refl->entry_point.c_str(), // entryPoint
             compile_target,                 // pTarget
             D3DCOMPILE_PACK_MATRIX_COLUMN_MAJOR | D3DCOMPILE_OPTIMIZATION_LEVEL3, // Flags1
             0,                              // Flags2
@@ -338,8 +700,31 @@ static Bytecode d3d_compile(const Input& inp, const Spirvcross& spirvcross, Slan
 }
 #endif
 
+static Bytecode spirv_compile(const Spirvcross& spirvcross) {
+    Bytecode bytecode;
+    for (const SpirvcrossSource& src: spirvcross.sources) {
+        BytecodeBlob blob;
+        blob.valid = true;
+        blob.snippet_index = src.snippet_index;
+        blob.data.resize(src.spirv.size() * sizeof(uint32_t));
+        memcpy(blob.data.data(), src.spirv.data(), blob.data.size());
+        bytecode.blobs.push_back(std::move(blob));
+    }
+    return bytecode;
+}
+
 Bytecode Bytecode::compile(const Args& args, const Input& inp, const Spirvcross& spirvcross, Slang::Enum slang) {
     Bytecode bytecode;
+    if (Slang::is_spirv(slang)) {
+        return spirv_compile(spirvcross);
+    }
+    // an external compiler command replaces the builtin bytecode compilers on all platforms
+    if (!args.bytecode_cmd.empty()) {
+        if ((slang == Slang::HLSL4) || (slang == Slang::HLSL5) || (slang == Slang::METAL_MACOS) || (slang == Slang::METAL_IOS)) {
+            bytecode = cmd_compile(args, inp, spirvcross, slang);
+        }
+        return bytecode;
+    }
     #if defined(__APPLE__)
     // NOTE: for the iOS simulator case, don't compile bytecode but use source code
     if ((slang == Slang::METAL_MACOS) || (slang == Slang::METAL_IOS)) {
@@ -351,6 +736,11 @@ Bytecode Bytecode::compile(const Args& args, const Input& inp, const Spirvcross&
         bytecode = d3d_compile(inp, spirvcross, slang);
     }
     #endif
+    #if defined(__linux__)
+    if ((slang == Slang::HLSL4) || (slang == Slang::HLSL5)) {
+        bytecode = vkd3d_compile(args, inp, spirvcross, slang);
+    }
+    #endif
     return bytecode;
 }
 
@@ -0,0 +1,676 @@
+/*
+    distributed compilation of shader batches over TCP
+
+    Each coordinator thread keeps one connection to a worker and sends it
+    one job after another, a worker runs each connection on its own thread.
+    Messages are length-prefixed, all integers are little-endian uint32:
+
+    job:    magic, version, args, cmdline, input, output, root, files (path, content)
+    result: magic, exit code, messages (type, file, line, msg), files (path, content, is_text)
+*/
+#include "distrib.h"
+#include <deque>
+#include <map>
+#include <set>
+#include <mutex>
+#include <thread>
+#include <filesystem>
+#include <stdio.h>
+#include "fmt/format.h"
+#include "pystring.h"
+#include "pipeline.h"
+#include "generators/generate.h"
+#if !defined(_WIN32)
+#include <errno.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <unistd.h>
+#endif
+
+namespace shdc {
+
+using namespace gen;
+
+#if !defined(_WIN32)
+
+static const uint32_t job_magic = 0x4A444853;       // 'SHDJ'
+static const uint32_t result_magic = 0x52444853;    // 'SHDR'
+static const uint32_t protocol_version = 1;
+static const uint32_t max_message_size = 256 * 1024 * 1024;
+
+// a compilation job, one per line in the batch file
+struct Job {
+    Args args;
+    std::vector<std::string> argv;      // the batch file line split into args
+    std::vector<std::pair<std::string, std::string>> files;     // input file and @include files (path, content)
+};
+
+// the result of a job, sent back by a worker
+struct JobResult {
+    bool done = false;
+    int exit_code = 10;
+    std::vector<ErrMsg> messages;
+    std::vector<GenOutputFile> files;
+};
+
+struct WireWriter {
+    std::string buf;
+    void u32(uint32_t v) {
+        for (int i = 0; i < 4; i++) {
+            buf.push_back((char)((v >> (i * 8)) & 0xFF));
+        }
+    }
+    void str(const std::string& s) {
+        u32((uint32_t)s.size());
+        buf.append(s);
+    }
+};
+
+struct WireReader {
+    const std::string& buf;
+    size_t pos = 0;
+    bool ok = true;
+    WireReader(const std::string& b): buf(b) { };
+    uint32_t u32() {
+        if ((pos + 4) > buf.size()) {
+            ok = false;
+            return 0;
+        }
+        uint32_t v = 0;
+        for (int i = 0; i < 4; i++) {
+            v |= ((uint32_t)(uint8_t)buf[pos++]) << (i * 8);
+        }
+        return v;
+    }
+    std::string str() {
+        const uint32_t len = u32();
+        if (!ok || ((pos + len) > buf.size())) {
+            ok = false;
+            return std::string();
+        }
+        std::string s = buf.substr(pos, len);
+        pos += len;
+        return s;
+    }
+};
+
+// options which may be passed to a worker, everything else is rejected, especially
+// options which run programs (--bytecode-cmd) or read or write files on the worker
+// host (-o, -t, --stats, --save-intermediate-spirv...), the input and output paths
+// are sent separately and only name the files shipped with the job and sent back,
+// -b is fine since the builtin bytecode compilers are started without a shell
+static const std::set<std::string> job_opts_with_arg = {
+    "-l", "--slang", "--defines", "-m", "--module", "-f", "--format", "-e", "--errfmt", "-g", "--genver"
+};
+static const std::set<std::string> job_opts_no_arg = {
+    "-r", "--reflection", "-b", "--bytecode", "--ifdef", "-n", "--noifdef", "--compress",
+    "--layout-report", "--unused-report", "--pack-varyings", "--infer-mediump", "--vertex-formats",
+    "--uniform-helpers", "--uniform-shadow", "--reproducible"
+};
+// only allowed in batch file lines, the coordinator strips them before sending the job
+static const std::set<std::string> job_path_opts = { "-i", "--input", "-o", "--output" };
+
+// check job arguments against the allow-list, with allow_path_opts the input and output
+// options are accepted and removed from out_remote_argv, returns false and the rejected
+// argument if something isn't allowed
+static bool check_job_argv(const std::vector<std::string>& argv, bool allow_path_opts, std::vector<std::string>& out_remote_argv, std::string& out_rejected) {
+    out_remote_argv.clear();
+    for (size_t i = 0; i < argv.size(); i++) {
+        const std::string& arg = argv[i];
+        const size_t eq_pos = arg.find('=');
+        const bool has_val = pystring::startswith(arg, "--") && (eq_pos != std::string::npos);
+        const std::string opt = has_val ? arg.substr(0, eq_pos) : arg;
+        const bool is_path_opt = allow_path_opts && (job_path_opts.count(opt) > 0);
+        std::vector<std::string> opt_argv = { arg };
+        if (is_path_opt || (job_opts_with_arg.count(opt) > 0)) {
+            if (!has_val) {
+                if ((i + 1) >= argv.size()) {
+                    out_rejected = arg;
+                    return false;
+                }
+                opt_argv.push_back(argv[++i]);
+            }
+        } else if (has_val || (job_opts_no_arg.count(opt) == 0)) {
+            out_rejected = arg;
+            return false;
+        }
+        if (!is_path_opt) {
+            out_remote_argv.insert(out_remote_argv.end(), opt_argv.begin(), opt_argv.end());
+        }
+    }
+    return true;
+}
+
+static bool load_file(const std::string& path, std::string& out_content) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) {
+        return false;
+    }
+    out_content.clear();
+    char buf[4096];
+    size_t num_bytes;
+    while ((num_bytes = fread(buf, 1, sizeof(buf), f)) > 0) {
+        out_content.append(buf, num_bytes);
+    }
+    fclose(f);
+    return true;
+}
+
+static bool write_file(const GenOutputFile& file) {
+    FILE* f = fopen(file.path.c_str(), file.is_text ? "w" : "wb");
+    if (!f) {
+        return false;
+    }
+    const size_t written = fwrite(file.content.data(), 1, file.content.size(), f);
+    fclose(f);
+    return written == file.content.size();
+}
+
+// a generated file sent back by a worker must be the job's output file, or start
+// with the output path (bare formats) and be located in the output directory
+static bool is_valid_output_path(const std::string& path, const std::string& output) {
+    const std::filesystem::path norm_path = std::filesystem::path(path).lexically_normal();
+    return norm_path.is_absolute()
+        && pystring::startswith(norm_path.generic_string(), output)
+        && (norm_path.parent_path() == std::filesystem::path(output).parent_path());
+}
+
+// split a batch file line into arguments, arguments are separated by whitespace
+// and may be quoted with single or double quotes, a backslash escapes the next
+// character outside of single quotes, returns false on an unterminated quote
+static bool split_batch_line(const std::string& line, std::vector<std::string>& out_argv) {
+    out_argv.clear();
+    std::string arg;
+    bool in_arg = false;
+    char quote = 0;
+    for (size_t i = 0; i < line.size(); i++) {
+        const char c = line[i];
+        if ((c == '\\') && (quote != '\'') && ((i + 1) < line.size())) {
+            arg += line[++i];
+            in_arg = true;
+        } else if (quote != 0) {
+            if (c == quote) {
+                quote = 0;
+            } else {
+                arg += c;
+            }
+        } else if ((c == '"') || (c == '\'')) {
+            quote = c;
+            in_arg = true;
+        } else if ((c == ' ') || (c == '\t')) {
+            if (in_arg) {
+                out_argv.push_back(arg);
+                arg.clear();
+                in_arg = false;
+            }
+        } else {
+            arg += c;
+            in_arg = true;
+        }
+    }
+    if (in_arg) {
+        out_argv.push_back(arg);
+    }
+    return quote == 0;
+}
+
+static std::string encode_job(const Job& job) {
+    WireWriter w;
+    w.u32(job_magic);
+    w.u32(protocol_version);
+    w.u32((uint32_t)job.argv.size());
+    for (const std::string& arg: job.argv) {
+        w.str(arg);
+    }
+    w.str(job.args.cmdline);
+    w.str(job.args.input);
+    w.str(job.args.output);
+    w.str(job.args.root);
+    w.u32((uint32_t)job.files.size());
+    for (const auto& [path, content]: job.files) {
+        w.str(path);
+        w.str(content);
+    }
+    return w.buf;
+}
+
+static std::string encode_result(const JobResult& res) {
+    WireWriter w;
+    w.u32(result_magic);
+    w.u32((uint32_t)res.exit_code);
+    w.u32((uint32_t)res.messages.size());
+    for (const ErrMsg& msg: res.messages) {
+        w.u32((uint32_t)msg.type);
+        w.str(msg.file);
+        w.u32((uint32_t)msg.line_index);
+        w.str(msg.msg);
+    }
+    w.u32((uint32_t)res.files.size());
+    for (const GenOutputFile& file: res.files) {
+        w.str(file.path);
+        w.str(file.content);
+        w.u32(file.is_text ? 1 : 0);
+    }
+    return w.buf;
+}
+
+static bool decode_result(const std::string& buf, JobResult& out_res) {
+    WireReader r(buf);
+    if (r.u32() != result_magic) {
+        return false;
+    }
+    out_res.exit_code = (int)r.u32();
+    const uint32_t num_messages = r.u32();
+    for (uint32_t i = 0; r.ok && (i < num_messages); i++) {
+        ErrMsg msg;
+        msg.type = (ErrMsg::Type)r.u32();
+        msg.file = r.str();
+        msg.line_index = (int)r.u32();
+        msg.msg = r.str();
+        out_res.messages.push_back(msg);
+    }
+    const uint32_t num_files = r.u32();
+    for (uint32_t i = 0; r.ok && (i < num_files); i++) {
+        GenOutputFile file;
+        file.path = r.str();
+        file.content = r.str();
+        file.is_text = r.u32() != 0;
+        out_res.files.push_back(std::move(file));
+    }
+    out_res.done = r.ok;
+    return r.ok;
+}
+
+static bool send_all(int fd, const char* data, size_t num_bytes) {
+    while (num_bytes > 0) {
+        const ssize_t n = send(fd, data, num_bytes, 0);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        num_bytes -= (size_t)n;
+    }
+    return true;
+}
+
+static bool recv_all(int fd, char* data, size_t num_bytes) {
+    while (num_bytes > 0) {
+        const ssize_t n = recv(fd, data, num_bytes, 0);
+        if (n <= 0) {
+            if ((n < 0) && (errno == EINTR)) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        num_bytes -= (size_t)n;
+    }
+    return true;
+}
+
+static bool send_message(int fd, const std::string& msg) {
+    WireWriter header;
+    header.u32((uint32_t)msg.size());
+    return send_all(fd, header.buf.data(), header.buf.size()) && send_all(fd, msg.data(), msg.size());
+}
+
+static bool recv_message(int fd, std::string& out_msg) {
+    std::string header(4, 0);
+    if (!recv_all(fd, &header[0], header.size())) {
+        return false;
+    }
+    WireReader r(header);
+    const uint32_t size = r.u32();
+    if (size > max_message_size) {
+        return false;
+    }
+    out_msg.resize(size);
+    return (size == 0) || recv_all(fd, &out_msg[0], size);
+}
+
+// split a '[host:]port' address, the host is optional
+static void split_address(const std::string& address, const std::string& default_host, std::string& out_host, std::string& out_port) {
+    const size_t colon_pos = address.rfind(':');
+    if (colon_pos == std::string::npos) {
+        out_host = default_host;
+        out_port = address;
+    } else {
+        out_host = address.substr(0, colon_pos);
+        out_port = address.substr(colon_pos + 1);
+    }
+}
+
+// returns a connected socket, or -1
+static int connect_to(const std::string& address) {
+    std::string host, port;
+    split_address(address, "localhost", host, port);
+    addrinfo hints = { };
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addrs = nullptr;
+    if (0 != getaddrinfo(host.c_str(), port.c_str(), &hints, &addrs)) {
+        return -1;
+    }
+    int fd = -1;
+    for (addrinfo* ai = addrs; ai; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        if (0 == connect(fd, ai->ai_addr, ai->ai_addrlen)) {
+            break;
+        }
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(addrs);
+    if (fd >= 0) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    return fd;
+}
+
+// returns a listening socket, or -1, the host defaults to localhost only
+static int listen_on(const std::string& address) {
+    std::string host, port;
+    split_address(address, "127.0.0.1", host, port);
+    addrinfo hints = { };
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    addrinfo* addrs = nullptr;
+    if (0 != getaddrinfo(host.c_str(), port.c_str(), &hints, &addrs)) {
+        return -1;
+    }
+    int fd = -1;
+    for (addrinfo* ai = addrs; ai; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if ((0 == bind(fd, ai->ai_addr, ai->ai_addrlen)) && (0 == listen(fd, 64))) {
+            break;
+        }
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(addrs);
+    return fd;
+}
+
+// run a single job on the worker, returns the encoded result
+static std::string run_job(const std::string& request, const std::string& tmpdir) {
+    JobResult res;
+    WireReader r(request);
+    const uint32_t magic = r.u32();
+    const uint32_t version = r.u32();
+    std::vector<std::string> job_argv;
+    const uint32_t num_args = r.u32();
+    for (uint32_t i = 0; r.ok && (i < num_args); i++) {
+        job_argv.push_back(r.str());
+    }
+    const std::string cmdline = r.str();
+    const std::string input = r.str();
+    const std::string output = r.str();
+    const std::string root = r.str();
+    std::map<std::string, std::string> files;
+    const uint32_t num_files = r.u32();
+    for (uint32_t i = 0; r.ok && (i < num_files); i++) {
+        const std::string path = r.str();
+        files[path] = r.str();
+    }
+    if (!r.ok || (magic != job_magic) || (version != protocol_version)) {
+        res.messages.push_back(ErrMsg::error("sokol-shdc worker: invalid or incompatible job request"));
+        return encode_result(res);
+    }
+    // the input filename ends up in Metal compiler command lines
+    if (pystring::os::path::basename(input).find_first_not_of("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789_.-") != std::string::npos) {
+        res.messages.push_back(ErrMsg::error(input, 0, "sokol-shdc worker: unsupported characters in input filename"));
+        return encode_result(res);
+    }
+    // never trust the job arguments, they come from whoever can connect to the worker
+    std::vector<std::string> checked_argv;
+    std::string rejected_arg;
+    if (!check_job_argv(job_argv, false, checked_argv, rejected_arg)) {
+        res.messages.push_back(ErrMsg::error(input, 0, fmt::format("sokol-shdc worker: option '{}' not allowed in remote jobs", rejected_arg)));
+        return encode_result(res);
+    }
+    std::vector<const char*> argv = { "sokol-shdc", "-i", input.c_str(), "-o", output.c_str() };
+    for (const std::string& arg: checked_argv) {
+        argv.push_back(arg.c_str());
+    }
+    Args args = Args::parse((int)argv.size(), argv.data());
+    if (!args.valid) {
+        res.messages.push_back(ErrMsg::error(input, 0, "sokol-shdc worker: invalid job arguments"));
+        return encode_result(res);
+    }
+    // paths have been resolved by the coordinator, intermediate files go into the worker's tmpdir
+    args.input = input;
+    args.inputs = { input };
+    args.output = output;
+    args.cmdline = cmdline;
+    args.root = root;
+    args.tmpdir = tmpdir;
+
+    const Input::LoadFileFunc load_job_file = [&files](const std::string& path, std::string& out_content) -> bool {
+        const auto it = files.find(path);
+        if (it == files.end()) {
+            return false;
+        }
+        out_content = it->second;
+        return true;
+    };
+    const Pipeline pip = Pipeline::run(args, load_job_file);
+    res.messages = pip.messages;
+    if (pip.valid) {
+        GenInput gen_input(args, pip.inp, pip.spirvcross, pip.bytecode, pip.refl);
+        gen_input.output_files = &res.files;
+        const ErrMsg gen_error = generate(args.output_format, gen_input);
+        if (gen_error.valid()) {
+            res.messages.push_back(gen_error);
+            res.files.clear();
+        } else {
+            res.exit_code = 0;
+        }
+    }
+    return encode_result(res);
+}
+
+int Distrib::run_worker(const Args& args) {
+    signal(SIGPIPE, SIG_IGN);
+    const int listen_fd = listen_on(args.worker);
+    if (listen_fd < 0) {
+        fmt::print(stderr, "sokol-shdc: failed to listen on '{}'\n", args.worker);
+        return 10;
+    }
+    std::string tmpdir = args.tmpdir;
+    if (tmpdir.empty()) {
+        std::error_code ec;
+        tmpdir = (std::filesystem::temp_directory_path(ec) / "sokol-shdc-worker").generic_string() + "/";
+    }
+    fmt::print(stderr, "sokol-shdc: worker listening on '{}'\n", args.worker);
+    for (int conn_index = 0; ; conn_index++) {
+        const int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        // each connection gets its own directory for intermediate files
+        const std::string conn_tmpdir = fmt::format("{}{}_{}/", tmpdir, getpid(), conn_index);
+        std::thread([fd, conn_tmpdir]() {
+            std::error_code ec;
+            std::filesystem::create_directories(conn_tmpdir, ec);
+            std::string request;
+            while (recv_message(fd, request)) {
+                if (!send_message(fd, run_job(request, conn_tmpdir))) {
+                    break;
+                }
+            }
+            close(fd);
+            std::filesystem::remove_all(conn_tmpdir, ec);
+        }).detach();
+    }
+    close(listen_fd);
+    fmt::print(stderr, "sokol-shdc: worker failed to accept connections on '{}'\n", args.worker);
+    return 10;
+}
+
+int Distrib::run_batch(const Args& args) {
+    signal(SIGPIPE, SIG_IGN);
+    std::string batch_src;
+    if (!load_file(args.batch, batch_src)) {
+        fmt::print(stderr, "sokol-shdc: failed to load batch file '{}'\n", args.batch);
+        return 10;
+    }
+
+    // one job per line, the input file and its @include files are shipped with the job
+    std::vector<Job> jobs;
+    std::vector<std::string> lines;
+    pystring::splitlines(batch_src, lines);
+    bool jobs_valid = true;
+    for (size_t line_index = 0; line_index < lines.size(); line_index++) {
+        const std::string line = pystring::strip(lines[line_index]);
+        if (line.empty() || pystring::startswith(line, "#")) {
+            continue;
+        }
+        Job job;
+        std::vector<std::string> line_argv;
+        if (!split_batch_line(line, line_argv)) {
+            fmt::print(stderr, "{}:{}: unterminated quote\n", args.batch, line_index + 1);
+            jobs_valid = false;
+            continue;
+        }
+        std::string rejected_arg;
+        if (!check_job_argv(line_argv, true, job.argv, rejected_arg)) {
+            fmt::print(stderr, "{}:{}: option '{}' can't be used in batch jobs\n", args.batch, line_index + 1, rejected_arg);
+            jobs_valid = false;
+            continue;
+        }
+        std::vector<const char*> argv = { "sokol-shdc" };
+        for (const std::string& arg: line_argv) {
+            argv.push_back(arg.c_str());
+        }
+        job.args = Args::parse((int)argv.size(), argv.data());
+        if (!job.args.valid) {
+            fmt::print(stderr, "{}:{}: invalid job arguments\n", args.batch, line_index + 1);
+            jobs_valid = false;
+            continue;
+        }
+        // absolute paths, so that @include paths and output paths don't depend on the worker's current directory
+        job.args.input = std::filesystem::absolute(job.args.input).lexically_normal().generic_string();
+        job.args.output = std::filesystem::absolute(job.args.output).lexically_normal().generic_string();
+        Input::load_and_parse(job.args.input, job.args.module, [&job](const std::string& path, std::string& out_content) -> bool {
+            if (!load_file(path, out_content)) {
+                return false;
+            }
+            job.files.push_back({ path, out_content });
+            return true;
+        });
+        jobs.push_back(std::move(job));
+    }
+    if (!jobs_valid) {
+        return 10;
+    }
+
+    // one thread per worker connection takes jobs from the queue until it's empty,
+    // if a connection fails, its current job goes back into the queue
+    std::vector<JobResult> results(jobs.size());
+    std::deque<size_t> queue;
+    for (size_t i = 0; i < jobs.size(); i++) {
+        queue.push_back(i);
+    }
+    std::mutex mutex;
+    std::vector<std::thread> threads;
+    std::vector<std::string> workers;
+    pystring::split(args.workers, workers, ",");
+    for (const std::string& worker: workers) {
+        threads.emplace_back([&jobs, &results, &queue, &mutex, worker]() {
+            const int fd = connect_to(worker);
+            if (fd < 0) {
+                std::lock_guard<std::mutex> lock(mutex);
+                fmt::print(stderr, "sokol-shdc: failed to connect to worker '{}'\n", worker);
+                return;
+            }
+            while (true) {
+                size_t job_index = 0;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (queue.empty()) {
+                        break;
+                    }
+                    job_index = queue.front();
+                    queue.pop_front();
+                }
+                std::string response;
+                if (!send_message(fd, encode_job(jobs[job_index])) || !recv_message(fd, response) || !decode_result(response, results[job_index])) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    fmt::print(stderr, "sokol-shdc: lost connection to worker '{}'\n", worker);
+                    results[job_index] = JobResult();
+                    queue.push_front(job_index);
+                    break;
+                }
+            }
+            close(fd);
+        });
+    }
+    for (std::thread& thread: threads) {
+        thread.join();
+    }
+
+    // print messages and write generated files in batch file order
+    int res = 0;
+    for (size_t i = 0; i < jobs.size(); i++) {
+        const Job& job = jobs[i];
+        const JobResult& result = results[i];
+        if (!result.done) {
+            fmt::print(stderr, "sokol-shdc: no worker available to compile '{}'\n", job.args.input);
+            res = 10;
+            continue;
+        }
+        for (const ErrMsg& msg: result.messages) {
+            msg.print(job.args.error_format);
+        }
+        if (result.exit_code != 0) {
+            res = 10;
+            continue;
+        }
+        for (const GenOutputFile& file: result.files) {
+            if (!is_valid_output_path(file.path, job.args.output)) {
+                ErrMsg::error(job.args.input, 0, fmt::format("worker returned output file '{}' outside of '{}'", file.path, job.args.output)).print(job.args.error_format);
+                res = 10;
+            } else if (!write_file(file)) {
+                ErrMsg::error(job.args.input, 0, fmt::format("failed to write output file '{}'", file.path)).print(job.args.error_format);
+                res = 10;
+            }
+        }
+    }
+    return res;
+}
+
+#else
+
+int Distrib::run_worker(const Args& args) {
+    fmt::print(stderr, "sokol-shdc: --worker is not supported on Windows\n");
+    return 10;
+}
+
+int Distrib::run_batch(const Args& args) {
+    fmt::print(stderr, "sokol-shdc: --batch is not supported on Windows\n");
+    return 10;
+}
+
+#endif
+
+} // namespace shdc
@@ -0,0 +1,16 @@
+#pragma once
+#include "args.h"
+
+namespace shdc {
+
+// distributed compilation of shader batches over TCP: a coordinator (--batch) ships
+// each job's input file and @include files to worker processes (--worker), which
+// run the whole pipeline and send back the generated files and messages
+struct Distrib {
+    // accept and compile jobs on the --worker address until the process is killed
+    static int run_worker(const Args& args);
+    // compile all jobs of the --batch file on the --workers and write the results
+    static int run_batch(const Args& args);
+};
+
+} // namespace shdc
@@ -10,30 +10,6 @@ namespace shdc::gen {
 
 using namespace refl;
 
-static ErrMsg write_file(const std::string& file_path, const SpirvcrossSource* src, const BytecodeBlob* blob) {
-    FILE* f = fopen(file_path.c_str(), "wb");
-    if (f == nullptr) {
-        return ErrMsg::error(file_path, 0, fmt::format("failed to open output file '{}'", file_path));
-    }
-    const void* write_data;
-    size_t write_count;
-    if (blob) {
-        write_data = blob->data.data();
-        write_count = blob->data.size();
-    } else {
-        assert(src);
-        write_data = src->source_code.data();
-        write_count = src->source_code.length();
-    }
-    size_t written = fwrite(write_data, 1, write_count, f);
-    if (written != write_count) {
-        fclose(f);
-        return ErrMsg::error(file_path, 0, fmt::format("failed to write output file '{}'", file_path));
-    }
-    fclose(f);
-    return ErrMsg();
-}
-
 // completely override the generate function since there's no overlap with code-generators
 ErrMsg BareGenerator::generate(const GenInput& gen) {
     mod_prefix = gen.inp.module.empty() ? "" : fmt::format("{}_", gen.inp.module);
@@ -48,11 +24,16 @@ ErrMsg BareGenerator::generate(const GenInput& gen) {
             const Bytecode& bytecode = gen.bytecode[slang];
             for (const ProgramReflection& prog: gen.refl.progs) {
                 for (int stage_index = 0; stage_index < ShaderStage::Num; stage_index++) {
-                    const StageReflection& refl = prog.stages[stage_index];
+                    const StageReflection& refl = prog.stage(ShaderStage::from_index(stage_index));
                     const SpirvcrossSource* src = spirvcross.find_source_by_snippet_index(refl.snippet_index);
                     const BytecodeBlob* blob = bytecode.find_blob_by_snippet_index(refl.snippet_index);
                     const std::string file_path = shader_file_path(gen, prog.name, ShaderStage::to_str(refl.stage), slang, blob != nullptr);
-                    err = write_file(file_path, src, blob);
+                    if (blob) {
+                        err = write_output_file(gen, file_path, blob->data.data(), blob->data.size(), false);
+                    } else {
+                        assert(src);
+                        err = write_output_file(gen, file_path, src->source_code.data(), src->source_code.length(), false);
+                    }
                     if (err.valid()) {
                         return err;
                     }
@@ -73,9 +54,12 @@ static const char* slang_file_extension(Slang::Enum c, bool binary) {
     if (Slang::is_msl(c)) {
         return binary ? ".metallib" : ".metal";
     }
-    if (Slang::is_msl(c)) {
+    if (Slang::is_wgsl(c)) {
         return ".wgsl";
     }
+    if (Slang::is_spirv(c)) {
+        return binary ? ".spv" : ".spvasm";
+    }
     return "";
 }
 
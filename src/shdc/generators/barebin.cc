@@ -0,0 +1,259 @@
+/*
+    Generate bare output plus binary reflection file (see shdc_bin.h)
+*/
+#include "barebin.h"
+#include "fmt/format.h"
+#include <stdio.h>
+
+namespace shdc::gen {
+
+using namespace refl;
+
+// the binary file must not depend on C struct packing, all records must only consist of 32-bit words
+static_assert(sizeof(shdc_bin_type) == 13 * 4, "unexpected shdc_bin_type size");
+static_assert(sizeof(shdc_bin_bindings) == 10 * 4, "unexpected shdc_bin_bindings size");
+static_assert(sizeof(shdc_bin_code) == 5 * 4, "unexpected shdc_bin_code size");
+static_assert(sizeof(shdc_bin_header) == 17 * 4, "unexpected shdc_bin_header size");
+
+ErrMsg BareBinGenerator::generate(const GenInput& gen) {
+    // first run the BareGenerator to generate shader source/blob files
+    ErrMsg err = BareGenerator::generate(gen);
+    if (err.valid()) {
+        return err;
+    }
+    // next write the binary reflection file
+    gen_reflection(gen);
+    return bin_write(gen, fmt::format("{}_{}reflection.bin", gen.args.output, mod_prefix), bin);
+}
+
+void BareBinGenerator::gen_reflection(const GenInput& gen) {
+    // the header goes first so that no other record or string can end up at offset 0
+    bin.clear();
+    bin_strings.clear();
+    const uint32_t hdr_offset = bin_alloc(sizeof(shdc_bin_header));
+    shdc_bin_header hdr = {};
+    hdr.magic = SHDC_BIN_MAGIC;
+    hdr.version = SHDC_BIN_VERSION;
+    hdr.slang_mask = gen.args.slang;
+    hdr.module = bin_str(gen.inp.module);
+    hdr.programs.num = (uint32_t)gen.refl.progs.size();
+    hdr.programs.offset = bin_alloc(hdr.programs.num * sizeof(shdc_bin_program));
+    for (uint32_t prog_index = 0; prog_index < hdr.programs.num; prog_index++) {
+        const ProgramReflection& prog = gen.refl.progs[prog_index];
+        shdc_bin_program bin_prog = {};
+        bin_prog.name = bin_str(prog.name);
+        bin_prog.vs = gen_stage(gen, prog, ShaderStage::Vertex);
+        bin_prog.fs = gen_stage(gen, prog, ShaderStage::Fragment);
+        bin_prog.bindings = gen_bindings(prog.bindings);
+        bin_store(hdr.programs.offset + prog_index * sizeof(shdc_bin_program), bin_prog);
+    }
+    hdr.bindings = gen_bindings(gen.refl.bindings);
+    hdr.size = (uint32_t)bin.size();
+    bin_store(hdr_offset, hdr);
+}
+
+ErrMsg BareBinGenerator::bin_write(const GenInput& gen, const std::string& file_path, const std::vector<uint8_t>& buf) {
+    return write_output_file(gen, file_path, buf.data(), buf.size(), false);
+}
+
+uint32_t BareBinGenerator::bin_alloc(std::vector<uint8_t>& buf, size_t num_bytes, size_t align) {
+    assert((align & (align - 1)) == 0);
+    const size_t offset = (buf.size() + (align - 1)) & ~(align - 1);
+    buf.resize(offset + ((num_bytes + 3) & ~3), 0);
+    return (uint32_t)offset;
+}
+
+uint32_t BareBinGenerator::bin_alloc(size_t num_bytes) {
+    return bin_alloc(bin, num_bytes);
+}
+
+// store a zero-terminated string (identical strings are only stored once), returns the file offset
+uint32_t BareBinGenerator::bin_str(const std::string& str) {
+    auto it = bin_strings.find(str);
+    if (it != bin_strings.end()) {
+        return it->second;
+    }
+    const uint32_t offset = bin_alloc(str.length() + 1);
+    memcpy(bin.data() + offset, str.c_str(), str.length());
+    bin_strings[str] = offset;
+    return offset;
+}
+
+shdc_bin_array BareBinGenerator::gen_type_items(const std::vector<Type>& items) {
+    shdc_bin_array arr = {};
+    arr.num = (uint32_t)items.size();
+    arr.offset = bin_alloc(arr.num * sizeof(shdc_bin_type));
+    for (uint32_t i = 0; i < arr.num; i++) {
+        bin_store(arr.offset + i * sizeof(shdc_bin_type), gen_type(items[i]));
+    }
+    return arr;
+}
+
+shdc_bin_type BareBinGenerator::gen_type(const Type& type) {
+    shdc_bin_type res = {};
+    res.name = bin_str(type.name);
+    res.struct_typename = bin_str(type.struct_typename);
+    res.type = (uint32_t)type.type;
+    res.is_matrix = type.is_matrix;
+    res.is_array = type.is_array;
+    res.offset = type.offset;
+    res.size = type.size;
+    res.align = type.align;
+    res.matrix_stride = type.matrix_stride;
+    res.array_count = type.array_count;
+    res.array_stride = type.array_stride;
+    res.struct_items = gen_type_items(type.struct_items);
+    return res;
+}
+
+shdc_bin_array BareBinGenerator::gen_attrs(const std::array<StageAttr, StageAttr::Num>& attrs) {
+    shdc_bin_array arr = {};
+    for (const StageAttr& attr: attrs) {
+        if (attr.slot >= 0) {
+            arr.num++;
+        }
+    }
+    arr.offset = bin_alloc(arr.num * sizeof(shdc_bin_attr));
+    uint32_t i = 0;
+    for (const StageAttr& attr: attrs) {
+        if (attr.slot >= 0) {
+            shdc_bin_attr res = {};
+            res.slot = attr.slot;
+            res.name = bin_str(attr.name);
+            res.sem_name = bin_str(attr.sem_name);
+            res.sem_index = attr.sem_index;
+            res.type = (uint32_t)attr.type_info.type;
+            bin_store(arr.offset + (i++) * sizeof(shdc_bin_attr), res);
+        }
+    }
+    return arr;
+}
+
+shdc_bin_bindings BareBinGenerator::gen_bindings(const Bindings& bindings) {
+    shdc_bin_bindings res = {};
+
+    res.uniform_blocks.num = (uint32_t)bindings.uniform_blocks.size();
+    res.uniform_blocks.offset = bin_alloc(res.uniform_blocks.num * sizeof(shdc_bin_uniform_block));
+    for (uint32_t i = 0; i < res.uniform_blocks.num; i++) {
+        const UniformBlock& ub = bindings.uniform_blocks[i];
+        shdc_bin_uniform_block rec = {};
+        rec.stage = (uint32_t)ub.stage;
+        rec.sokol_slot = ub.sokol_slot;
+        rec.hlsl_register_b_n = ub.hlsl_register_b_n;
+        rec.msl_buffer_n = ub.msl_buffer_n;
+        rec.wgsl_group0_binding_n = ub.wgsl_group0_binding_n;
+        rec.spirv_set0_binding_n = ub.spirv_set0_binding_n;
+        rec.name = bin_str(ub.name);
+        rec.inst_name = bin_str(ub.inst_name);
+        rec.flattened = ub.flattened;
+        rec.struct_info = gen_type(ub.struct_info);
+        bin_store(res.uniform_blocks.offset + i * sizeof(shdc_bin_uniform_block), rec);
+    }
+
+    res.storage_buffers.num = (uint32_t)bindings.storage_buffers.size();
+    res.storage_buffers.offset = bin_alloc(res.storage_buffers.num * sizeof(shdc_bin_storage_buffer));
+    for (uint32_t i = 0; i < res.storage_buffers.num; i++) {
+        const StorageBuffer& sbuf = bindings.storage_buffers[i];
+        shdc_bin_storage_buffer rec = {};
+        rec.stage = (uint32_t)sbuf.stage;
+        rec.sokol_slot = sbuf.sokol_slot;
+        rec.hlsl_register_t_n = sbuf.hlsl_register_t_n;
+        rec.msl_buffer_n = sbuf.msl_buffer_n;
+        rec.wgsl_group1_binding_n = sbuf.wgsl_group1_binding_n;
+        rec.spirv_set1_binding_n = sbuf.spirv_set1_binding_n;
+        rec.glsl_binding_n = sbuf.glsl_binding_n;
+        rec.name = bin_str(sbuf.name);
+        rec.inst_name = bin_str(sbuf.inst_name);
+        rec.readonly = sbuf.readonly;
+        rec.struct_info = gen_type(sbuf.struct_info);
+        bin_store(res.storage_buffers.offset + i * sizeof(shdc_bin_storage_buffer), rec);
+    }
+
+    res.images.num = (uint32_t)bindings.images.size();
+    res.images.offset = bin_alloc(res.images.num * sizeof(shdc_bin_image));
+    for (uint32_t i = 0; i < res.images.num; i++) {
+        const Image& img = bindings.images[i];
+        shdc_bin_image rec = {};
+        rec.stage = (uint32_t)img.stage;
+        rec.sokol_slot = img.sokol_slot;
+        rec.hlsl_register_t_n = img.hlsl_register_t_n;
+        rec.msl_texture_n = img.msl_texture_n;
+        rec.wgsl_group1_binding_n = img.wgsl_group1_binding_n;
+        rec.spirv_set1_binding_n = img.spirv_set1_binding_n;
+        rec.name = bin_str(img.name);
+        rec.type = (uint32_t)img.type;
+        rec.sample_type = (uint32_t)img.sample_type;
+        rec.multisampled = img.multisampled;
+        bin_store(res.images.offset + i * sizeof(shdc_bin_image), rec);
+    }
+
+    res.samplers.num = (uint32_t)bindings.samplers.size();
+    res.samplers.offset = bin_alloc(res.samplers.num * sizeof(shdc_bin_sampler));
+    for (uint32_t i = 0; i < res.samplers.num; i++) {
+        const Sampler& smp = bindings.samplers[i];
+        shdc_bin_sampler rec = {};
+        rec.stage = (uint32_t)smp.stage;
+        rec.sokol_slot = smp.sokol_slot;
+        rec.hlsl_register_s_n = smp.hlsl_register_s_n;
+        rec.msl_sampler_n = smp.msl_sampler_n;
+        rec.wgsl_group1_binding_n = smp.wgsl_group1_binding_n;
+        rec.spirv_set1_binding_n = smp.spirv_set1_binding_n;
+        rec.name = bin_str(smp.name);
+        rec.type = (uint32_t)smp.type;
+        bin_store(res.samplers.offset + i * sizeof(shdc_bin_sampler), rec);
+    }
+
+    res.image_samplers.num = (uint32_t)bindings.image_samplers.size();
+    res.image_samplers.offset = bin_alloc(res.image_samplers.num * sizeof(shdc_bin_image_sampler));
+    for (uint32_t i = 0; i < res.image_samplers.num; i++) {
+        const ImageSampler& img_smp = bindings.image_samplers[i];
+        shdc_bin_image_sampler rec = {};
+        rec.stage = (uint32_t)img_smp.stage;
+        rec.sokol_slot = img_smp.sokol_slot;
+        rec.glsl_binding_n = img_smp.glsl_binding_n;
+        rec.name = bin_str(img_smp.name);
+        rec.image_name = bin_str(img_smp.image_name);
+        rec.sampler_name = bin_str(img_smp.sampler_name);
+        bin_store(res.image_samplers.offset + i * sizeof(shdc_bin_image_sampler), rec);
+    }
+    return res;
+}
+
+shdc_bin_stage BareBinGenerator::gen_stage(const GenInput& gen, const ProgramReflection& prog, ShaderStage::Enum stage) {
+    const StageReflection& refl = prog.stage(stage);
+    shdc_bin_stage res = {};
+    res.snippet_name = bin_str(refl.snippet_name);
+    res.stage = (uint32_t)stage;
+    res.inputs = gen_attrs(refl.inputs);
+    res.outputs = gen_attrs(refl.outputs);
+    res.bindings = gen_bindings(refl.bindings);
+    for (int i = 0; i < Slang::Num; i++) {
+        if (gen.args.slang & Slang::bit(Slang::from_index(i))) {
+            res.code.num++;
+        }
+    }
+    res.code.offset = bin_alloc(res.code.num * sizeof(shdc_bin_code));
+    uint32_t code_index = 0;
+    for (int i = 0; i < Slang::Num; i++) {
+        const Slang::Enum slang = Slang::from_index(i);
+        if (gen.args.slang & Slang::bit(slang)) {
+            const ShaderStageArrayInfo info = shader_stage_array_info(gen, prog, stage, slang);
+            const char* d3d11_tgt = "";
+            if (slang == Slang::HLSL4) {
+                d3d11_tgt = ShaderStage::is_vs(stage) ? "vs_4_0" : "ps_4_0";
+            } else if (slang == Slang::HLSL5) {
+                d3d11_tgt = ShaderStage::is_vs(stage) ? "vs_5_0" : "ps_5_0";
+            }
+            shdc_bin_code code = {};
+            code.slang = (uint32_t)slang;
+            code.is_binary = info.has_bytecode;
+            code.path = bin_str(bin_with_paths ? gen.args.embedded_path(shader_file_path(gen, prog.name, ShaderStage::to_str(stage), slang, info.has_bytecode)) : "");
+            code.entry_point = bin_str(refl.entry_point_by_slang(slang));
+            code.d3d11_target = bin_str(d3d11_tgt);
+            bin_store(res.code.offset + (code_index++) * sizeof(shdc_bin_code), code);
+        }
+    }
+    return res;
+}
+
+} // namespace
@@ -0,0 +1,53 @@
+#pragma once
+#include "bare.h"
+#include "shdc_bin.h"
+#include <assert.h>
+#include <string.h>
+#include <map>
+#include <vector>
+
+namespace shdc::gen {
+
+class BareBinGenerator: public BareGenerator {
+public:
+    virtual ErrMsg generate(const GenInput& gen);
+protected:
+    std::vector<uint8_t> bin;
+    std::map<std::string, uint32_t> bin_strings;
+    bool bin_with_paths = true;     // if false, shdc_bin_code.path is an empty string
+
+    // build the binary reflection data into bin
+    void gen_reflection(const GenInput& gen);
+
+    // allocate zero-initialized space at the end of a buffer, returns the buffer offset
+    static uint32_t bin_alloc(std::vector<uint8_t>& buf, size_t num_bytes, size_t align = 4);
+    // store a record at a buffer offset as little-endian 32-bit words
+    template<typename T> static void bin_store(std::vector<uint8_t>& buf, uint32_t offset, const T& rec);
+    // write a buffer into a file
+    static ErrMsg bin_write(const GenInput& gen, const std::string& file_path, const std::vector<uint8_t>& buf);
+private:
+    uint32_t bin_alloc(size_t num_bytes);
+    template<typename T> void bin_store(uint32_t offset, const T& rec) { bin_store(bin, offset, rec); };
+    uint32_t bin_str(const std::string& str);
+    shdc_bin_array gen_type_items(const std::vector<refl::Type>& items);
+    shdc_bin_type gen_type(const refl::Type& type);
+    shdc_bin_array gen_attrs(const std::array<refl::StageAttr, refl::StageAttr::Num>& attrs);
+    shdc_bin_bindings gen_bindings(const refl::Bindings& bindings);
+    shdc_bin_stage gen_stage(const GenInput& gen, const refl::ProgramReflection& prog, refl::ShaderStage::Enum stage);
+};
+
+template<typename T> void BareBinGenerator::bin_store(std::vector<uint8_t>& buf, uint32_t offset, const T& rec) {
+    static_assert((sizeof(T) & 3) == 0, "binary records must only contain 32-bit words");
+    assert((offset + sizeof(T)) <= buf.size());
+    uint32_t words[sizeof(T) / 4];
+    memcpy(words, &rec, sizeof(T));
+    uint8_t* dst = buf.data() + offset;
+    for (size_t i = 0; i < (sizeof(T) / 4); i++) {
+        dst[i*4 + 0] = (uint8_t)(words[i]);
+        dst[i*4 + 1] = (uint8_t)(words[i] >> 8);
+        dst[i*4 + 2] = (uint8_t)(words[i] >> 16);
+        dst[i*4 + 3] = (uint8_t)(words[i] >> 24);
+    }
+}
+
+} // namespace
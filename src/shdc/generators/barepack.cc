@@ -0,0 +1,221 @@
+/*
+    Generate a single archive file with all shader sources/blobs and binary reflection (see shdc_pack.h)
+*/
+#include "barepack.h"
+#include "fmt/format.h"
+#include <unordered_map>
+
+namespace shdc::gen {
+
+using namespace refl;
+
+static_assert(sizeof(shdc_pack_entry) == 8 * 4, "unexpected shdc_pack_entry size");
+static_assert(sizeof(shdc_pack_header) == 8 * 4, "unexpected shdc_pack_header size");
+
+// completely override the generate function, no separate shader files are written
+ErrMsg BarePackGenerator::generate(const GenInput& gen) {
+    mod_prefix = gen.inp.module.empty() ? "" : fmt::format("{}_", gen.inp.module);
+    ErrMsg err = check_errors(gen);
+    if (err.valid()) {
+        return err;
+    }
+
+    // gather payloads, identical payloads are only stored once
+    struct Payload {
+        std::vector<uint8_t> data;
+        uint32_t flags = 0;
+        uint32_t uncompressed_size = 0;
+        uint32_t offset = 0;
+    };
+    struct Entry {
+        std::string program;
+        uint32_t stage = 0;
+        uint32_t slang = 0;
+        size_t payload_index = 0;
+    };
+    std::vector<Payload> payloads;
+    std::vector<Entry> entries;
+    std::unordered_map<std::string, size_t> payload_index_by_content;
+    for (int i = 0; i < Slang::Num; i++) {
+        Slang::Enum slang = Slang::from_index(i);
+        if (gen.args.slang & Slang::bit(slang)) {
+            const Spirvcross& spirvcross = gen.spirvcross[slang];
+            const Bytecode& bytecode = gen.bytecode[slang];
+            for (const ProgramReflection& prog: gen.refl.progs) {
+                for (int stage_index = 0; stage_index < ShaderStage::Num; stage_index++) {
+                    const StageReflection& refl = prog.stage(ShaderStage::from_index(stage_index));
+                    const SpirvcrossSource* src = spirvcross.find_source_by_snippet_index(refl.snippet_index);
+                    const BytecodeBlob* blob = bytecode.find_blob_by_snippet_index(refl.snippet_index);
+                    std::string content;
+                    if (blob) {
+                        content = std::string("b") + std::string(blob->data.begin(), blob->data.end());
+                    } else {
+                        assert(src);
+                        // source code payloads include the terminating zero
+                        content = std::string("s") + src->source_code;
+                        content.push_back(0);
+                    }
+                    Entry entry;
+                    entry.program = prog.name;
+                    entry.stage = (uint32_t)refl.stage;
+                    entry.slang = (uint32_t)slang;
+                    auto it = payload_index_by_content.find(content);
+                    if (it != payload_index_by_content.end()) {
+                        entry.payload_index = it->second;
+                    } else {
+                        Payload payload;
+                        payload.data.assign(content.begin() + 1, content.end());
+                        payload.flags = blob ? SHDC_PACK_FLAG_BINARY : 0;
+                        payload.uncompressed_size = (uint32_t)payload.data.size();
+                        entry.payload_index = payloads.size();
+                        payload_index_by_content[content] = payloads.size();
+                        payloads.push_back(std::move(payload));
+                    }
+                    entries.push_back(entry);
+                }
+            }
+        }
+    }
+
+    // optionally compress payloads where this reduces the size
+    if (gen.args.compress) {
+        for (Payload& payload: payloads) {
+            std::vector<uint8_t> compressed = lz4_compress(payload.data);
+            if (compressed.size() < payload.data.size()) {
+                payload.data = std::move(compressed);
+                payload.flags |= SHDC_PACK_FLAG_COMPRESSED;
+            }
+        }
+    }
+
+    // binary reflection data, shader file paths don't make sense here
+    bin_with_paths = false;
+    gen_reflection(gen);
+
+    // build the archive: header, table of contents, program names, reflection, payloads
+    std::vector<uint8_t> pack;
+    const uint32_t hdr_offset = bin_alloc(pack, sizeof(shdc_pack_header));
+    shdc_pack_header hdr = {};
+    hdr.magic = SHDC_PACK_MAGIC;
+    hdr.version = SHDC_PACK_VERSION;
+    hdr.num_entries = (uint32_t)entries.size();
+    // keep the hash table at most half full
+    hdr.toc_num_slots = 1;
+    while (hdr.toc_num_slots < (entries.size() * 2)) {
+        hdr.toc_num_slots <<= 1;
+    }
+    hdr.toc_offset = bin_alloc(pack, hdr.toc_num_slots * sizeof(shdc_pack_entry));
+    std::unordered_map<std::string, uint32_t> program_name_offsets;
+    for (const ProgramReflection& prog: gen.refl.progs) {
+        const uint32_t offset = bin_alloc(pack, prog.name.length() + 1);
+        memcpy(pack.data() + offset, prog.name.c_str(), prog.name.length());
+        program_name_offsets[prog.name] = offset;
+    }
+    hdr.reflection_offset = bin_alloc(pack, bin.size(), SHDC_PACK_ALIGN);
+    hdr.reflection_size = (uint32_t)bin.size();
+    memcpy(pack.data() + hdr.reflection_offset, bin.data(), bin.size());
+    for (Payload& payload: payloads) {
+        payload.offset = bin_alloc(pack, payload.data.size(), SHDC_PACK_ALIGN);
+        if (!payload.data.empty()) {
+            memcpy(pack.data() + payload.offset, payload.data.data(), payload.data.size());
+        }
+    }
+
+    // fill the table of contents hash table, collisions are resolved with linear probing
+    std::vector<shdc_pack_entry> toc(hdr.toc_num_slots, shdc_pack_entry{});
+    const uint32_t mask = hdr.toc_num_slots - 1;
+    for (const Entry& entry: entries) {
+        const Payload& payload = payloads[entry.payload_index];
+        const uint32_t hash = shdc_pack_hash(entry.program.c_str(), entry.stage, entry.slang);
+        uint32_t slot = hash & mask;
+        while (toc[slot].flags & SHDC_PACK_FLAG_USED) {
+            slot = (slot + 1) & mask;
+        }
+        shdc_pack_entry& e = toc[slot];
+        e.hash = hash;
+        e.program = program_name_offsets[entry.program];
+        e.stage = entry.stage;
+        e.slang = entry.slang;
+        e.flags = SHDC_PACK_FLAG_USED | payload.flags;
+        e.offset = payload.offset;
+        e.size = (uint32_t)payload.data.size();
+        e.uncompressed_size = payload.uncompressed_size;
+    }
+    for (uint32_t i = 0; i < hdr.toc_num_slots; i++) {
+        bin_store(pack, hdr.toc_offset + i * sizeof(shdc_pack_entry), toc[i]);
+    }
+    hdr.size = (uint32_t)pack.size();
+    bin_store(pack, hdr_offset, hdr);
+
+    return bin_write(gen, fmt::format("{}_{}shaders.pack", gen.args.output, mod_prefix), pack);
+}
+
+// a simple greedy compressor producing the raw LZ4 block format, decompress with shdc_pack_decompress() or LZ4_decompress_safe()
+std::vector<uint8_t> BarePackGenerator::lz4_compress(const std::vector<uint8_t>& src) {
+    // LZ4 block format restrictions: the last match must start at least 12 bytes
+    // before the end of the input, and the last 5 bytes must always be literals
+    const size_t min_match = 4;
+    const size_t mf_limit = 12;
+    const size_t last_literals = 5;
+    const int hash_bits = 14;
+    const size_t num = src.size();
+    std::vector<uint8_t> dst;
+    dst.reserve(num + (num / 255) + 16);
+
+    auto read32 = [&src](size_t pos) -> uint32_t {
+        uint32_t val;
+        memcpy(&val, src.data() + pos, sizeof(val));
+        return val;
+    };
+    auto write_len = [&dst](size_t len) {
+        while (len >= 255) {
+            dst.push_back(255);
+            len -= 255;
+        }
+        dst.push_back((uint8_t)len);
+    };
+    auto write_literals = [&dst, &src, &write_len](size_t start, size_t len, uint8_t match_token) {
+        dst.push_back((uint8_t)(((len >= 15) ? 15 : len) << 4) | match_token);
+        if (len >= 15) {
+            write_len(len - 15);
+        }
+        dst.insert(dst.end(), src.begin() + start, src.begin() + start + len);
+    };
+
+    size_t anchor = 0;
+    if (num > mf_limit) {
+        std::vector<int32_t> table(1 << hash_bits, -1);
+        const size_t match_start_limit = num - mf_limit;
+        const size_t match_end_limit = num - last_literals;
+        size_t pos = 0;
+        while (pos < match_start_limit) {
+            const uint32_t seq = read32(pos);
+            const uint32_t h = (seq * 2654435761u) >> (32 - hash_bits);
+            const int32_t ref = table[h];
+            table[h] = (int32_t)pos;
+            if ((ref >= 0) && ((pos - ref) <= 0xFFFF) && (read32(ref) == seq)) {
+                size_t match_len = min_match;
+                while (((pos + match_len) < match_end_limit) && (src[ref + match_len] == src[pos + match_len])) {
+                    match_len++;
+                }
+                const size_t ml = match_len - min_match;
+                write_literals(anchor, pos - anchor, (uint8_t)((ml >= 15) ? 15 : ml));
+                const size_t offset = pos - ref;
+                dst.push_back((uint8_t)offset);
+                dst.push_back((uint8_t)(offset >> 8));
+                if (ml >= 15) {
+                    write_len(ml - 15);
+                }
+                pos += match_len;
+                anchor = pos;
+            } else {
+                pos++;
+            }
+        }
+    }
+    // the last sequence only contains literals
+    write_literals(anchor, num - anchor, 0);
+    return dst;
+}
+
+} // namespace
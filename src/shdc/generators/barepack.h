@@ -0,0 +1,14 @@
+#pragma once
+#include "barebin.h"
+#include "shdc_pack.h"
+
+namespace shdc::gen {
+
+class BarePackGenerator: public BareBinGenerator {
+public:
+    virtual ErrMsg generate(const GenInput& gen);
+private:
+    static std::vector<uint8_t> lz4_compress(const std::vector<uint8_t>& src);
+};
+
+} // namespace
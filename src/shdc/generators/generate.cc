@@ -4,6 +4,8 @@
 #include "generate.h"
 #include "types/format.h"
 #include "bare.h"
+#include "barebin.h"
+#include "barepack.h"
 #include "sokolc.h"
 #include "sokolnim.h"
 #include "sokolodin.h"
@@ -23,6 +25,10 @@ std::unique_ptr<Generator> make_generator(Format::Enum format) {
             return std::make_unique<BareGenerator>();
         case Format::BARE_YAML:
             return std::make_unique<YamlGenerator>();
+        case Format::BARE_BIN:
+            return std::make_unique<BareBinGenerator>();
+        case Format::BARE_PACK:
+            return std::make_unique<BarePackGenerator>();
         case Format::SOKOL_ZIG:
             return std::make_unique<SokolZigGenerator>();
         case Format::SOKOL_NIM:
@@ -46,4 +52,8 @@ ErrMsg generate(Format::Enum format, const GenInput& gen_input) {
     return make_generator(format)->generate(gen_input);
 }
 
+ErrMsg generate_shared_types(Format::Enum format, const GenInput& gen_input, const std::vector<std::string>& inputs) {
+    return make_generator(format)->generate_shared_types(gen_input, inputs);
+}
+
 } // namespace
\ No newline at end of file
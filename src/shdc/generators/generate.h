@@ -6,5 +6,6 @@
 namespace shdc::gen {
 
 ErrMsg generate(Format::Enum format, const GenInput& gen_input);
+ErrMsg generate_shared_types(Format::Enum format, const GenInput& gen_input, const std::vector<std::string>& inputs);
 
 }
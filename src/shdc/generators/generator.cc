@@ -21,9 +21,15 @@ ErrMsg Generator::generate(const GenInput& gen) {
     gen_bind_slot_consts(gen);
     gen_uniform_block_decls(gen);
     gen_storage_buffer_decls(gen);
+    if (gen.args.vertex_formats) {
+        gen_vertex_layout_decls(gen);
+    }
     gen_stb_impl_start(gen);
     gen_shader_arrays(gen);
     gen_shader_desc_funcs(gen);
+    if (gen.args.vertex_formats) {
+        gen_vertex_layout_funcs(gen);
+    }
     if (gen.args.reflection) {
         gen_reflection_funcs(gen);
     }
@@ -33,6 +39,21 @@ ErrMsg Generator::generate(const GenInput& gen) {
     return err;
 }
 
+ErrMsg Generator::generate_shared_types(const GenInput& gen, const std::vector<std::string>& inputs) {
+    return ErrMsg::error(gen.inp.base_path, 0, "--shared-types isn't supported by the output format");
+}
+
+// true if a uniform block or storage buffer bind slot constant is in the --shared-types header
+static bool is_shared_slot(const GenInput& gen, const UniformBlock& ub) {
+    const UniformBlock* shared_ub = gen.shared_types ? gen.shared_types->find_uniform_block_by_name(ub.name) : nullptr;
+    return shared_ub && (shared_ub->sokol_slot >= 0);
+}
+
+static bool is_shared_slot(const GenInput& gen, const StorageBuffer& sbuf) {
+    const StorageBuffer* shared_sbuf = gen.shared_types ? gen.shared_types->find_storage_buffer_by_name(sbuf.name) : nullptr;
+    return shared_sbuf && (shared_sbuf->sokol_slot >= 0);
+}
+
 Generator::ShaderStageArrayInfo Generator::shader_stage_array_info(const GenInput& gen, const ProgramReflection& prog, ShaderStage::Enum stage, Slang::Enum slang) {
     ShaderStageArrayInfo info;
     info.stage = stage;
@@ -145,10 +166,14 @@ void Generator::gen_vertex_attr_consts(const GenInput& gen) {
 
 void Generator::gen_bind_slot_consts(const GenInput& gen) {
     for (const UniformBlock& ub: gen.refl.bindings.uniform_blocks) {
-        l("{}\n", uniform_block_bind_slot_definition(ub));
+        if (!is_shared_slot(gen, ub)) {
+            l("{}\n", uniform_block_bind_slot_definition(ub));
+        }
     }
     for (const StorageBuffer& sbuf: gen.refl.bindings.storage_buffers) {
-        l("{}\n", storage_buffer_bind_slot_definition(sbuf));
+        if (!is_shared_slot(gen, sbuf)) {
+            l("{}\n", storage_buffer_bind_slot_definition(sbuf));
+        }
     }
     for (const Image& img: gen.refl.bindings.images) {
         l("{}\n", image_bind_slot_definition(img));
@@ -159,14 +184,52 @@ void Generator::gen_bind_slot_consts(const GenInput& gen) {
 }
 
 void Generator::gen_uniform_block_decls(const GenInput& gen) {
+    if (gen.shared_types) {
+        // declared in the shared types header
+        return;
+    }
     for (const UniformBlock& ub: gen.refl.bindings.uniform_blocks) {
         gen_uniform_block_decl(gen, ub);
     }
 }
 
 void Generator::gen_storage_buffer_decls(const GenInput& gen) {
+    if (gen.shared_types) {
+        // declared in the shared types header
+        return;
+    }
     for (const StorageBuffer& sbuf: gen.refl.bindings.storage_buffers) {
         gen_storage_buffer_decl(gen, sbuf);
+        if (sbuf.soa) {
+            gen_storage_buffer_soa_decl(gen, sbuf);
+        }
+    }
+}
+
+void Generator::gen_storage_buffer_soa_decl(const GenInput& gen, const StorageBuffer& sbuf) {
+    const auto& item = sbuf.struct_info.struct_items[0];
+    const std::string aos_struct = struct_name(item.struct_typename);
+    const std::string soa_struct = struct_name(item.struct_typename + "_soa");
+    const std::vector<SoaMember> members = sbuf.soa_members();
+    // one array per scalar member and vector component
+    gen_soa_struct_start(soa_struct);
+    for (const SoaMember& member: members) {
+        gen_soa_struct_member(member);
+    }
+    gen_soa_struct_end(soa_struct);
+    // copy a range of SoA items into std430 items
+    gen_soa_pack_func_start(item.struct_typename, aos_struct, soa_struct);
+    for (const SoaMember& member: members) {
+        gen_soa_pack_member(member);
+    }
+    gen_soa_pack_func_end();
+}
+
+void Generator::gen_vertex_layout_decls(const GenInput& gen) {
+    for (const auto& prog: gen.refl.progs) {
+        if (prog.vs().num_inputs() > 0) {
+            gen_vertex_layout_decl(gen, prog);
+        }
     }
 }
 
@@ -233,6 +296,14 @@ void Generator::gen_shader_desc_funcs(const GenInput& gen) {
     }
 }
 
+void Generator::gen_vertex_layout_funcs(const GenInput& gen) {
+    for (const auto& prog: gen.refl.progs) {
+        if (prog.vs().num_inputs() > 0) {
+            gen_vertex_layout_func(gen, prog);
+        }
+    }
+}
+
 void Generator::gen_reflection_funcs(const GenInput& gen) {
     for (const auto& prog: gen.refl.progs) {
         gen_attr_slot_refl_func(gen, prog);
@@ -248,12 +319,27 @@ void Generator::gen_reflection_funcs(const GenInput& gen) {
 
 // default behaviour of end() is to write the output file
 ErrMsg Generator::end(const GenInput& gen) {
-    FILE* f = fopen(gen.args.output.c_str(), "w");
+    return write_output_file(gen, gen.args.output, content.data(), content.length(), true);
+}
+
+ErrMsg Generator::write_output_file(const GenInput& gen, const std::string& path, const void* data, size_t num_bytes, bool is_text) {
+    if (gen.output_files) {
+        GenOutputFile file;
+        file.path = path;
+        file.content.assign((const char*)data, num_bytes);
+        file.is_text = is_text;
+        gen.output_files->push_back(std::move(file));
+        return ErrMsg();
+    }
+    FILE* f = fopen(path.c_str(), is_text ? "w" : "wb");
     if (!f) {
-        return ErrMsg::error(gen.inp.base_path, 0, fmt::format("failed to open output file '{}'", gen.args.output));
+        return ErrMsg::error(gen.inp.base_path, 0, fmt::format("failed to open output file '{}'", path));
     }
-    fwrite(content.c_str(), content.length(), 1, f);
+    const size_t written = fwrite(data, 1, num_bytes, f);
     fclose(f);
+    if (written != num_bytes) {
+        return ErrMsg::error(gen.inp.base_path, 0, fmt::format("failed to write output file '{}'", path));
+    }
     return ErrMsg();
 }
 
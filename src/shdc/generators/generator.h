@@ -1,4 +1,5 @@
 #pragma once
+#include <iterator>
 #include <string>
 #include "pystring.h"
 #include "types/gen_input.h"
@@ -10,6 +11,8 @@ class Generator {
 public:
     virtual ~Generator() {};
     virtual ErrMsg generate(const GenInput& gen);
+    // write the uniform blocks and storage buffers in gen.shared_types into a shared header
+    virtual ErrMsg generate_shared_types(const GenInput& gen, const std::vector<std::string>& inputs);
 
 protected:
     // called directly by generate() in this order
@@ -21,9 +24,11 @@ protected:
     virtual void gen_bind_slot_consts(const GenInput& gen);
     virtual void gen_uniform_block_decls(const GenInput& gen);
     virtual void gen_storage_buffer_decls(const GenInput& gen);
+    virtual void gen_vertex_layout_decls(const GenInput& gen);
     virtual void gen_stb_impl_start(const GenInput& gen) { };
     virtual void gen_shader_arrays(const GenInput& gen);
     virtual void gen_shader_desc_funcs(const GenInput& gen);
+    virtual void gen_vertex_layout_funcs(const GenInput& gen);
     virtual void gen_reflection_funcs(const GenInput& gen);
     virtual void gen_epilog(const GenInput& gen);
     virtual void gen_stb_impl_end(const GenInput& gen) { };
@@ -46,6 +51,21 @@ protected:
     // called by gen_shader_desc_funcs()
     virtual void gen_shader_desc_func(const GenInput& gen, const refl::ProgramReflection& prog) { assert(false && "implement me"); };
 
+    // called by gen_storage_buffer_decls() for storage buffers with @soa tag
+    virtual void gen_storage_buffer_soa_decl(const GenInput& gen, const refl::StorageBuffer& sbuf);
+
+    // optional, called by gen_storage_buffer_soa_decl(), generators without @soa support leave them empty
+    virtual void gen_soa_struct_start(const std::string& soa_struct) { };
+    virtual void gen_soa_struct_member(const refl::SoaMember& member) { };
+    virtual void gen_soa_struct_end(const std::string& soa_struct) { };
+    virtual void gen_soa_pack_func_start(const std::string& item_typename, const std::string& aos_struct, const std::string& soa_struct) { };
+    virtual void gen_soa_pack_member(const refl::SoaMember& member) { };
+    virtual void gen_soa_pack_func_end() { };
+
+    // optional, called by gen_vertex_layout_decls() and gen_vertex_layout_funcs()
+    virtual void gen_vertex_layout_decl(const GenInput& gen, const refl::ProgramReflection& prog) { };
+    virtual void gen_vertex_layout_func(const GenInput& gen, const refl::ProgramReflection& prog) { };
+
     // optional, called by gen_reflection_funcs()
     virtual void gen_attr_slot_refl_func(const GenInput& gen, const refl::ProgramReflection& prog) { };
     virtual void gen_image_slot_refl_func(const GenInput& gen, const refl::ProgramReflection& prog) { };
@@ -56,6 +76,9 @@ protected:
     virtual void gen_uniform_desc_refl_func(const GenInput& gen, const refl::ProgramReflection& prog) { };
     virtual void gen_storage_buffer_slot_refl_func(const GenInput& gen, const refl::ProgramReflection& prog) { };
 
+    // write a generated file, or add it to gen.output_files if provided
+    static ErrMsg write_output_file(const GenInput& gen, const std::string& path, const void* data, size_t num_bytes, bool is_text);
+
     // general helper methods
     virtual std::string lang_name() { assert(false && "implement me"); return ""; };
     virtual std::string get_shader_desc_help(const std::string& prog_name) { assert(false && "implement me"); return ""; };
@@ -73,6 +96,7 @@ protected:
     virtual std::string image_type(refl::ImageType::Enum e) { assert(false && "implement me"); return ""; };
     virtual std::string image_sample_type(refl::ImageSampleType::Enum e) { assert(false && "implement me"); return ""; };
     virtual std::string sampler_type(refl::SamplerType::Enum e) { assert(false && "implement me"); return ""; };
+    virtual std::string soa_scalar_type(refl::Type::Enum e) { return "INVALID"; };
     virtual std::string backend(Slang::Enum e) { assert(false && "implement me"); return ""; };
 
     virtual std::string struct_name(const std::string& name) { assert(false && "implement me"); return ""; };
@@ -98,14 +122,13 @@ protected:
     };
     ShaderStageArrayInfo shader_stage_array_info(const GenInput& gen, const refl::ProgramReflection& prog, refl::ShaderStage::Enum stage, Slang::Enum slang);
 
-    // line output
+    // line output, formats directly into content to avoid a temporary string per line
     template<typename... T> void l(fmt::format_string<T...> fmt, T&&... args) {
-        const std::string str = fmt::format("{}{}", indentation, fmt::format(fmt, args...));
-        content.append(str);
+        content.append(indentation);
+        fmt::format_to(std::back_inserter(content), fmt, args...);
     }
     template<typename... T> void l_append(fmt::format_string<T...> fmt, T&&... args) {
-        const std::string str = fmt::format(fmt, args...);
-        content.append(str);
+        fmt::format_to(std::back_inserter(content), fmt, args...);
     }
     template<typename... T> void l_open(fmt::format_string<T...> fmt, T&&... args) {
         l(fmt, args...);
@@ -123,9 +146,14 @@ protected:
         l_open("{}\n", comment_block_start());
     }
     template<typename... T> void cbl(fmt::format_string<T...> fmt, T&&... args) {
-        std::string str = pystring::rstrip(fmt::format("{}{}{}", comment_block_line_prefix(), indentation, fmt::format(fmt, args...)));
-        str += "\n";
-        content.append(str);
+        const size_t line_start = content.length();
+        content.append(comment_block_line_prefix());
+        content.append(indentation);
+        fmt::format_to(std::back_inserter(content), fmt, args...);
+        // strip trailing whitespace of the new line only
+        const size_t last = content.find_last_not_of(" \t\n\r\f\v");
+        content.resize(((last == std::string::npos) || (last < line_start)) ? line_start : last + 1);
+        content.push_back('\n');
     }
     template<typename... T> void cbl_open(fmt::format_string<T...> fmt, T&&... args) {
         cbl(fmt, args...);
@@ -4,7 +4,9 @@
 #include "sokolc.h"
 #include "fmt/format.h"
 #include "pystring.h"
+#include "types/perfect_hash.h"
 #include <stdio.h>
+#include <filesystem>
 
 namespace shdc::gen {
 
@@ -31,7 +33,25 @@ static const char* sokol_define(Slang::Enum slang) {
     }
 }
 
+// the packed vertex format of an attribute, or the full-precision format if there's no compact format
+static VertexFormat::Enum vertex_format(const StageAttr& attr) {
+    if (attr.packed_format != VertexFormat::INVALID) {
+        return attr.packed_format;
+    }
+    return VertexFormat::from_type(attr.type_info.type);
+}
+
 ErrMsg SokolCGenerator::begin(const GenInput& gen) {
+    if (gen.args.vertex_formats) {
+        // the vertex structs need a C type for each vertex attribute
+        for (const ProgramReflection& prog: gen.refl.progs) {
+            for (const StageAttr& attr: prog.vs().inputs) {
+                if ((attr.slot >= 0) && (vertex_format(attr) == VertexFormat::INVALID)) {
+                    return ErrMsg::error(gen.inp.base_path, 0, fmt::format("--vertex-formats: no vertex format for attribute '{}' of type '{}' in program '{}'", attr.name, Type::type_to_str(attr.type_info.type), prog.name));
+                }
+            }
+        }
+    }
     if (!gen.inp.module.empty()) {
         mod_prefix = fmt::format("{}_", gen.inp.module);
     }
@@ -52,10 +72,58 @@ void SokolCGenerator::gen_epilog(const GenInput& gen) {
     // empty
 }
 
-void SokolCGenerator::gen_prerequisites(const GenInput& gen) {
+ErrMsg SokolCGenerator::generate_shared_types(const GenInput& gen, const std::vector<std::string>& inputs) {
+    assert(gen.shared_types);
+    ErrMsg err = begin(gen);
+    if (err.valid()) {
+        return err;
+    }
+    gen_prolog(gen);
+    cbl_start();
+    cbl("#version:{}# (machine generated, don't edit!)\n", gen.args.gen_version);
+    cbl("\n");
+    cbl("Generated by sokol-shdc (https://github.com/floooh/sokol-tools)\n");
+    cbl("\n");
+    cbl_open("Shared uniform block and storage buffer types of:\n");
+    for (const std::string& input: inputs) {
+        cbl("{}\n", gen.args.embedded_path(input));
+    }
+    cbl_close();
+    cbl_end();
     l("#if !defined(SOKOL_GFX_INCLUDED)\n");
     l("#error \"Please include sokol_gfx.h before {}\"\n", pystring::os::path::basename(gen.args.output));
     l("#endif\n");
+    gen_struct_macros(gen);
+    // bind slot constants are only shared if they are identical in all input files
+    for (const UniformBlock& ub: gen.shared_types->uniform_blocks) {
+        if (ub.sokol_slot >= 0) {
+            l("{}\n", uniform_block_bind_slot_definition(ub));
+        }
+        if (gen.args.reflection) {
+            for (const Type& u: ub.struct_info.struct_items) {
+                l("#define UNIFORM_OFFSET_{}{}_{} ({})\n", mod_prefix, ub.name, u.name, u.offset);
+            }
+        }
+    }
+    for (const StorageBuffer& sbuf: gen.shared_types->storage_buffers) {
+        if (sbuf.sokol_slot >= 0) {
+            l("{}\n", storage_buffer_bind_slot_definition(sbuf));
+        }
+    }
+    for (const UniformBlock& ub: gen.shared_types->uniform_blocks) {
+        gen_uniform_block_decl(gen, ub);
+    }
+    for (const StorageBuffer& sbuf: gen.shared_types->storage_buffers) {
+        gen_storage_buffer_decl(gen, sbuf);
+        if (sbuf.soa) {
+            gen_storage_buffer_soa_decl(gen, sbuf);
+        }
+    }
+    return end(gen);
+}
+
+// macros used by uniform block and storage buffer declarations
+void SokolCGenerator::gen_struct_macros(const GenInput& gen) {
     l("#if !defined(SOKOL_SHDC_ALIGN)\n");
     l("#if defined(_MSC_VER)\n");
     l("#define SOKOL_SHDC_ALIGN(a) __declspec(align(a))\n");
@@ -63,10 +131,50 @@ void SokolCGenerator::gen_prerequisites(const GenInput& gen) {
     l("#define SOKOL_SHDC_ALIGN(a) __attribute__((aligned(a)))\n");
     l("#endif\n");
     l("#endif\n");
+    if (gen.args.uniform_helpers) {
+        l("#if !defined(SOKOL_SHDC_STATIC_ASSERT)\n");
+        l("#if defined(__cplusplus)\n");
+        l("#define SOKOL_SHDC_STATIC_ASSERT(c,m) static_assert(c,m)\n");
+        l("#else\n");
+        l("#define SOKOL_SHDC_STATIC_ASSERT(c,m) _Static_assert(c,m)\n");
+        l("#endif\n");
+        l("#endif\n");
+    }
+    if (gen.args.uniform_shadow) {
+        // set the dirty bits of all 16-byte slots touched by a uniform block member
+        l("#if !defined(SOKOL_SHDC_UNIFORM_SHADOW_INCLUDED)\n");
+        l("#define SOKOL_SHDC_UNIFORM_SHADOW_INCLUDED\n");
+        l("#include <string.h>\n");
+        l_open("static inline void _sokol_shdc_mark_dirty(uint32_t* dirty, size_t offset, size_t size) {{\n");
+        l_open("for (size_t slot = offset / 16; slot < (offset + size + 15) / 16; slot++) {{\n");
+        l("dirty[slot / 32] |= 1u << (slot % 32);\n");
+        l_close("}}\n");
+        l_close("}}\n");
+        l("#endif\n");
+    }
+}
+
+void SokolCGenerator::gen_prerequisites(const GenInput& gen) {
+    l("#if !defined(SOKOL_GFX_INCLUDED)\n");
+    l("#error \"Please include sokol_gfx.h before {}\"\n", pystring::os::path::basename(gen.args.output));
+    l("#endif\n");
+    if (gen.shared_types) {
+        // the shared header path relative to the directory of the generated header
+        namespace fs = std::filesystem;
+        const fs::path output_dir = fs::absolute(fs::path(gen.args.output)).lexically_normal().parent_path();
+        const fs::path shared_path = fs::absolute(fs::path(gen.args.shared_types)).lexically_normal();
+        const fs::path include_path = shared_path.lexically_relative(output_dir);
+        l("#include \"{}\"\n", include_path.empty() ? shared_path.generic_string() : include_path.generic_string());
+    } else {
+        gen_struct_macros(gen);
+    }
     if (gen.args.output_format == Format::SOKOL_IMPL) {
         for (const auto& item: gen.inp.programs) {
             const Program& prog = item.second;
             l("const sg_shader_desc* {}{}_shader_desc(sg_backend backend);\n", mod_prefix, prog.name);
+            if (gen.args.vertex_formats) {
+                l("sg_vertex_layout_state {}{}_vertex_layout(int buffer_index);\n", mod_prefix, prog.name);
+            }
             if (gen.args.reflection) {
                 l("int {}{}_attr_slot(const char* attr_name);\n", mod_prefix, prog.name);
                 l("int {}{}_image_slot(const char* img_name);\n", mod_prefix, prog.name);
@@ -81,6 +189,19 @@ void SokolCGenerator::gen_prerequisites(const GenInput& gen) {
     }
 }
 
+void SokolCGenerator::gen_bind_slot_consts(const GenInput& gen) {
+    Generator::gen_bind_slot_consts(gen);
+    if (gen.args.reflection && !gen.shared_types) {
+        // uniform offsets for direct access without going through the reflection functions
+        // (with --shared-types they are in the shared header)
+        for (const UniformBlock& ub: gen.refl.bindings.uniform_blocks) {
+            for (const Type& u: ub.struct_info.struct_items) {
+                l("#define UNIFORM_OFFSET_{}{}_{} ({})\n", mod_prefix, ub.name, u.name, u.offset);
+            }
+        }
+    }
+}
+
 void SokolCGenerator::gen_uniform_block_decl(const GenInput &gen, const UniformBlock& ub) {
     l("#pragma pack(push,1)\n");
     int cur_offset = 0;
@@ -131,6 +252,174 @@ void SokolCGenerator::gen_uniform_block_decl(const GenInput &gen, const UniformB
     }
     l_close("}} {};\n", struct_name(ub.name));
     l("#pragma pack(pop)\n");
+    if (gen.args.uniform_helpers) {
+        gen_uniform_block_helpers(gen, ub, round16);
+    }
+    if (gen.args.uniform_shadow) {
+        gen_uniform_block_shadow(gen, ub, round16);
+    }
+}
+
+// static layout asserts, and a batch of uniform blocks which are filled directly in a
+// caller-provided staging buffer and applied one by one for per-draw or per-instance updates
+void SokolCGenerator::gen_uniform_block_helpers(const GenInput& gen, const UniformBlock& ub, int struct_size) {
+    const std::string ub_struct = struct_name(ub.name);
+    const std::string batch_struct = struct_name(ub.name + "_batch");
+    const std::string prefix = fmt::format("{}{}", mod_prefix, ub.name);
+    l("SOKOL_SHDC_STATIC_ASSERT(sizeof({}) == {}, \"{}: size mismatch\");\n", ub_struct, struct_size, ub_struct);
+    for (const Type& uniform: ub.struct_info.struct_items) {
+        l("SOKOL_SHDC_STATIC_ASSERT(offsetof({}, {}) == {}, \"{}.{}: offset mismatch\");\n", ub_struct, uniform.name, uniform.offset, ub_struct, uniform.name);
+    }
+    l_open("typedef struct {} {{\n", batch_struct);
+    l("{}* items;\n", ub_struct);
+    l("int capacity;\n");
+    l("int count;\n");
+    l_close("}} {};\n", batch_struct);
+    // the staging buffer must be aligned to the uniform block alignment
+    l_open("static inline {} {}_batch(void* staging, size_t staging_size) {{\n", batch_struct, prefix);
+    l("{} batch;\n", batch_struct);
+    l("batch.items = ({}*)staging;\n", ub_struct);
+    l("batch.capacity = (int)(staging_size / sizeof({}));\n", ub_struct);
+    l("batch.count = 0;\n");
+    l("return batch;\n");
+    l_close("}}\n");
+    // the returned item isn't cleared, all members must be written
+    l_open("static inline {}* {}_batch_push({}* batch) {{\n", ub_struct, prefix, batch_struct);
+    l_open("if (batch->count >= batch->capacity) {{\n");
+    l("return 0;\n");
+    l_close("}}\n");
+    l("return &batch->items[batch->count++];\n");
+    l_close("}}\n");
+    l_open("static inline void {}_batch_reset({}* batch) {{\n", prefix, batch_struct);
+    l("batch->count = 0;\n");
+    l_close("}}\n");
+    // all filled items, for instance to upload them into a storage buffer with sg_update_buffer()
+    l_open("static inline sg_range {}_batch_range(const {}* batch) {{\n", prefix, batch_struct);
+    l("sg_range range;\n");
+    l("range.ptr = batch->items;\n");
+    l("range.size = (size_t)batch->count * sizeof({});\n", ub_struct);
+    l("return range;\n");
+    l_close("}}\n");
+    // with --shared-types, the bind slot constant only exists if it is the same in all inputs
+    if (ub.sokol_slot >= 0) {
+        l_open("static inline int {}_batch_submit({}* batch, void (*draw)(int index, void* user_data), void* user_data) {{\n", prefix, batch_struct);
+        l("const int count = batch->count;\n");
+        l_open("for (int i = 0; i < count; i++) {{\n");
+        l("const sg_range range = {{ &batch->items[i], sizeof({}) }};\n", ub_struct);
+        l("sg_apply_uniforms({}, &range);\n", uniform_block_bind_slot_name(ub));
+        l("draw(i, user_data);\n");
+        l_close("}}\n");
+        l("batch->count = 0;\n");
+        l("return count;\n");
+        l_close("}}\n");
+    }
+}
+
+// the value argument of a uniform shadow setter function, scalars are passed by value
+std::string SokolCGenerator::uniform_shadow_setter_arg(const GenInput& gen, const Type& uniform) {
+    if (gen.inp.ctype_map.count(uniform.type_as_glsl()) > 0) {
+        // user-provided type names may be array types (e.g. cglm), so always pass a pointer
+        const std::string& ctype = gen.inp.ctype_map.at(uniform.type_as_glsl());
+        if (uniform.array_count == 0) {
+            return fmt::format("const {}* v", ctype);
+        } else {
+            return fmt::format("const {} v[{}]", ctype, uniform.array_count);
+        }
+    }
+    if (uniform.array_count == 0) {
+        switch (uniform.type) {
+            case Type::Float:   return "float v";
+            case Type::Float2:  return "const float v[2]";
+            case Type::Float3:  return "const float v[3]";
+            case Type::Float4:  return "const float v[4]";
+            case Type::Int:     return "int v";
+            case Type::Int2:    return "const int v[2]";
+            case Type::Int3:    return "const int v[3]";
+            case Type::Int4:    return "const int v[4]";
+            case Type::Mat4x4:  return "const float v[16]";
+            default:            return "INVALID_UNIFORM_TYPE";
+        }
+    } else {
+        switch (uniform.type) {
+            case Type::Float4:  return fmt::format("const float v[{}][4]", uniform.array_count);
+            case Type::Int4:    return fmt::format("const int v[{}][4]", uniform.array_count);
+            case Type::Mat4x4:  return fmt::format("const float v[{}][16]", uniform.array_count);
+            default:            return "INVALID_UNIFORM_TYPE";
+        }
+    }
+}
+
+// a shadow copy of a uniform block with per-member setters which track changed 16-byte slots,
+// so that redundant sg_apply_uniforms() calls can be skipped
+void SokolCGenerator::gen_uniform_block_shadow(const GenInput& gen, const UniformBlock& ub, int struct_size) {
+    const std::string ub_struct = struct_name(ub.name);
+    const std::string shadow_struct = struct_name(ub.name + "_shadow");
+    const std::string prefix = fmt::format("{}{}", mod_prefix, ub.name);
+    const int num_slots = struct_size / 16;
+    const int num_dirty_words = (num_slots + 31) / 32;
+    l_open("typedef struct {} {{\n", shadow_struct);
+    l("{} data;\n", ub_struct);
+    l("uint32_t dirty[{}];\n", num_dirty_words);
+    l_close("}} {};\n", shadow_struct);
+    // initially everything is dirty so that the first apply call uploads the uniform block
+    l_open("static inline void {}_invalidate({}* s) {{\n", prefix, shadow_struct);
+    l("_sokol_shdc_mark_dirty(s->dirty, 0, sizeof({}));\n", ub_struct);
+    l_close("}}\n");
+    l_open("static inline void {}_shadow_init({}* s) {{\n", prefix, shadow_struct);
+    l("memset(s, 0, sizeof({}));\n", shadow_struct);
+    l("{}_invalidate(s);\n", prefix);
+    l_close("}}\n");
+    for (const Type& uniform: ub.struct_info.struct_items) {
+        const bool by_value = (uniform.array_count == 0)
+            && (gen.inp.ctype_map.count(uniform.type_as_glsl()) == 0)
+            && ((uniform.type == Type::Float) || (uniform.type == Type::Int));
+        const std::string src = by_value ? "&v" : "v";
+        l_open("static inline void {}_set_{}({}* s, {}) {{\n", prefix, uniform.name, shadow_struct, uniform_shadow_setter_arg(gen, uniform));
+        l_open("if (0 != memcmp(&s->data.{}, {}, sizeof(s->data.{}))) {{\n", uniform.name, src, uniform.name);
+        l("memcpy(&s->data.{}, {}, sizeof(s->data.{}));\n", uniform.name, src, uniform.name);
+        l("_sokol_shdc_mark_dirty(s->dirty, offsetof({}, {}), sizeof(s->data.{}));\n", ub_struct, uniform.name, uniform.name);
+        l_close("}}\n");
+        l_close("}}\n");
+    }
+    l_open("static inline bool {}_changed(const {}* s) {{\n", prefix, shadow_struct);
+    l("uint32_t any = 0;\n");
+    l_open("for (int i = 0; i < {}; i++) {{\n", num_dirty_words);
+    l("any |= s->dirty[i];\n");
+    l_close("}}\n");
+    l("return any != 0;\n");
+    l_close("}}\n");
+    // the byte range from the first to the last changed 16-byte slot, for partial updates of
+    // a uniform buffer managed outside of sokol-gfx (the range is empty if nothing changed)
+    l_open("static inline sg_range {}_dirty_range(const {}* s) {{\n", prefix, shadow_struct);
+    l("int first = -1, last = -1;\n");
+    l_open("for (int slot = 0; slot < {}; slot++) {{\n", num_slots);
+    l_open("if (s->dirty[slot / 32] & (1u << (slot % 32))) {{\n");
+    l("if (first < 0) {{ first = slot; }}\n");
+    l("last = slot;\n");
+    l_close("}}\n");
+    l_close("}}\n");
+    l("sg_range range = {{ 0, 0 }};\n");
+    l_open("if (first >= 0) {{\n");
+    l("range.ptr = ((const uint8_t*)&s->data) + first * 16;\n");
+    l("range.size = (size_t)(last - first + 1) * 16;\n");
+    l_close("}}\n");
+    l("return range;\n");
+    l_close("}}\n");
+    l_open("static inline void {}_clear_dirty({}* s) {{\n", prefix, shadow_struct);
+    l("memset(s->dirty, 0, sizeof(s->dirty));\n");
+    l_close("}}\n");
+    // with --shared-types, the bind slot constant only exists if it is the same in all inputs
+    if (ub.sokol_slot >= 0) {
+        l_open("static inline bool {}_apply({}* s) {{\n", prefix, shadow_struct);
+        l_open("if (!{}_changed(s)) {{\n", prefix);
+        l("return false;\n");
+        l_close("}}\n");
+        l("const sg_range range = {{ &s->data, sizeof(s->data) }};\n");
+        l("sg_apply_uniforms({}, &range);\n", uniform_block_bind_slot_name(ub));
+        l("{}_clear_dirty(s);\n", prefix);
+        l("return true;\n");
+        l_close("}}\n");
+    }
 }
 
 void SokolCGenerator::gen_struct_interior_decl_std430(const GenInput& gen, const Type& struc, int pad_to_size) {
@@ -248,6 +537,47 @@ void SokolCGenerator::gen_storage_buffer_decl(const GenInput& gen, const Storage
     l("#pragma pack(pop)\n");
 }
 
+// C type of an SoA member array
+std::string SokolCGenerator::soa_scalar_type(Type::Enum type) {
+    switch (type) {
+        case Type::Int:     return "int32_t";
+        case Type::UInt:    return "uint32_t";
+        case Type::Float:   return "float";
+        default:            return "INVALID_TYPE";
+    }
+}
+
+void SokolCGenerator::gen_soa_struct_start(const std::string& soa_struct) {
+    l_open("typedef struct {} {{\n", soa_struct);
+}
+
+void SokolCGenerator::gen_soa_struct_member(const SoaMember& member) {
+    l("{}* {};\n", soa_scalar_type(member.scalar_type), member.name);
+}
+
+void SokolCGenerator::gen_soa_struct_end(const std::string& soa_struct) {
+    l_close("}} {};\n", soa_struct);
+}
+
+// pack 'count' items starting at SoA index 'first' into std430 items
+void SokolCGenerator::gen_soa_pack_func_start(const std::string& item_typename, const std::string& aos_struct, const std::string& soa_struct) {
+    l_open("static inline void {}{}_soa_pack({}* dst, const {}* src, int first, int count) {{\n", mod_prefix, item_typename, aos_struct, soa_struct);
+    l_open("for (int i = 0; i < count; i++) {{\n");
+}
+
+void SokolCGenerator::gen_soa_pack_member(const SoaMember& member) {
+    if (member.component < 0) {
+        l("dst[i].{} = src->{}[first + i];\n", member.aos_name, member.name);
+    } else {
+        l("dst[i].{}[{}] = src->{}[first + i];\n", member.aos_name, member.component, member.name);
+    }
+}
+
+void SokolCGenerator::gen_soa_pack_func_end() {
+    l_close("}}\n");
+    l_close("}}\n");
+}
+
 void SokolCGenerator::gen_shader_desc_func(const GenInput& gen, const ProgramReflection& prog) {
     l_open("{}const sg_shader_desc* {}{}_shader_desc(sg_backend backend) {{\n", func_prefix, mod_prefix, prog.name);
     for (int i = 0; i < Slang::Num; i++) {
@@ -257,157 +587,311 @@ void SokolCGenerator::gen_shader_desc_func(const GenInput& gen, const ProgramRef
                 l("#if defined({})\n", sokol_define(slang));
             }
             l_open("if (backend == {}) {{\n", backend(slang));
-            l("static sg_shader_desc desc;\n");
-            l("static bool valid;\n");
-            l_open("if (!valid) {{\n");
-            l("valid = true;\n");
-            for (int stage_index = 0; stage_index < ShaderStage::Num; stage_index++) {
-                const ShaderStageArrayInfo& info = shader_stage_array_info(gen, prog, ShaderStage::from_index(stage_index), slang);
-                const StageReflection& refl = prog.stages[stage_index];
-                const std::string dsn = fmt::format("desc.{}", info.stage == ShaderStage::Vertex ? "vertex_func" : "fragment_func");
-                if (info.has_bytecode) {
-                    l("{}.bytecode.ptr = {};\n", dsn, info.bytecode_array_name);
-                    l("{}.bytecode.size = {};\n", dsn, info.bytecode_array_size);
-                } else {
-                    l("{}.source = (const char*){};\n", dsn, info.source_array_name);
-                    const char* d3d11_tgt = nullptr;
-                    if (slang == Slang::HLSL4) {
-                        d3d11_tgt = (0 == stage_index) ? "vs_4_0" : "ps_4_0";
-                    } else if (slang == Slang::HLSL5) {
-                        d3d11_tgt = (0 == stage_index) ? "vs_5_0" : "ps_5_0";
-                    }
-                    if (d3d11_tgt) {
-                        l("{}.d3d11_target = \"{}\";\n", dsn, d3d11_tgt);
-                    }
-                }
-                l("{}.entry = \"{}\";\n", dsn, refl.entry_point_by_slang(slang));
+            gen_shader_desc_init(gen, prog, slang);
+            l("return &desc;\n");
+            l_close("}}\n");
+            if (gen.args.ifdef) {
+                l("#endif /* {} */\n", sokol_define(slang));
             }
-            for (int attr_index = 0; attr_index < StageAttr::Num; attr_index++) {
-                const StageAttr& attr = prog.vs().inputs[attr_index];
-                if (attr.slot >= 0) {
-                    if (Slang::is_glsl(slang)) {
-                        l("desc.attrs[{}].glsl_name = \"{}\";\n", attr_index, attr.name);
-                    } else if (Slang::is_hlsl(slang)) {
-                        l("desc.attrs[{}].hlsl_sem_name = \"{}\";\n", attr_index, attr.sem_name);
-                        l("desc.attrs[{}].hlsl_sem_index = {};\n", attr_index, attr.sem_index);
-                    }
-                }
+        }
+    }
+    l("return 0;\n");
+    l_close("}}\n");
+}
+
+// C type of a vertex struct member for a vertex format
+static std::string vertex_member_decl(VertexFormat::Enum fmt, const std::string& name) {
+    switch (fmt) {
+        case VertexFormat::FLOAT:       return fmt::format("float {}", name);
+        case VertexFormat::FLOAT2:      return fmt::format("float {}[2]", name);
+        case VertexFormat::FLOAT3:      return fmt::format("float {}[3]", name);
+        case VertexFormat::FLOAT4:      return fmt::format("float {}[4]", name);
+        case VertexFormat::INT:         return fmt::format("int32_t {}", name);
+        case VertexFormat::INT2:        return fmt::format("int32_t {}[2]", name);
+        case VertexFormat::INT3:        return fmt::format("int32_t {}[3]", name);
+        case VertexFormat::INT4:        return fmt::format("int32_t {}[4]", name);
+        case VertexFormat::UINT:        return fmt::format("uint32_t {}", name);
+        case VertexFormat::UINT2:       return fmt::format("uint32_t {}[2]", name);
+        case VertexFormat::UINT3:       return fmt::format("uint32_t {}[3]", name);
+        case VertexFormat::UINT4:       return fmt::format("uint32_t {}[4]", name);
+        case VertexFormat::BYTE4N:      return fmt::format("int8_t {}[4]", name);
+        case VertexFormat::UBYTE4N:     return fmt::format("uint8_t {}[4]", name);
+        case VertexFormat::SHORT2N:     return fmt::format("int16_t {}[2]", name);
+        case VertexFormat::USHORT2N:    return fmt::format("uint16_t {}[2]", name);
+        case VertexFormat::SHORT4N:     return fmt::format("int16_t {}[4]", name);
+        case VertexFormat::USHORT4N:    return fmt::format("uint16_t {}[4]", name);
+        case VertexFormat::UINT10_N2:   return fmt::format("uint32_t {}", name);
+        case VertexFormat::HALF2:       return fmt::format("uint16_t {}[2]", name);
+        case VertexFormat::HALF4:       return fmt::format("uint16_t {}[4]", name);
+        default:
+            // rejected in SokolCGenerator::begin()
+            assert(false);
+            return "";
+    }
+}
+
+void SokolCGenerator::gen_vertex_layout_decl(const GenInput& gen, const ProgramReflection& prog) {
+    l("#pragma pack(push,1)\n");
+    l_open("typedef struct {} {{\n", struct_name(prog.name + "_vertex"));
+    for (const StageAttr& attr: prog.vs().inputs) {
+        if (attr.slot >= 0) {
+            l("{}; /* SG_VERTEXFORMAT_{} */\n", vertex_member_decl(vertex_format(attr), attr.name), VertexFormat::to_str(vertex_format(attr)));
+        }
+    }
+    l_close("}} {};\n", struct_name(prog.name + "_vertex"));
+    l("#pragma pack(pop)\n");
+}
+
+void SokolCGenerator::gen_vertex_layout_func(const GenInput& gen, const ProgramReflection& prog) {
+    const std::string vertex_struct = struct_name(prog.name + "_vertex");
+    l_open("{}sg_vertex_layout_state {}{}_vertex_layout(int buffer_index) {{\n", func_prefix, mod_prefix, prog.name);
+    l("#if defined(__cplusplus)\n");
+    l("sg_vertex_layout_state layout = {{}};\n");
+    l("#else\n");
+    l("sg_vertex_layout_state layout = {{0}};\n");
+    l("#endif\n");
+    l("layout.buffers[buffer_index].stride = sizeof({});\n", vertex_struct);
+    for (const StageAttr& attr: prog.vs().inputs) {
+        if (attr.slot >= 0) {
+            const std::string attr_slot = vertex_attr_name(prog.name, attr);
+            l("layout.attrs[{}].buffer_index = buffer_index;\n", attr_slot);
+            l("layout.attrs[{}].offset = offsetof({}, {});\n", attr_slot, vertex_struct, attr.name);
+            l("layout.attrs[{}].format = SG_VERTEXFORMAT_{};\n", attr_slot, VertexFormat::to_str(vertex_format(attr)));
+        }
+    }
+    l("return layout;\n");
+    l_close("}}\n");
+}
+
+// emit a constant-initialized 'static const sg_shader_desc desc' for one backend
+void SokolCGenerator::gen_shader_desc_init(const GenInput& gen, const ProgramReflection& prog, Slang::Enum slang) {
+    // first gather the desc items as (member path, value) pairs
+    std::vector<std::pair<std::string, std::string>> items;
+    auto item = [&items](const std::string& path, const std::string& value) {
+        items.push_back({ path, value });
+    };
+    for (int stage_index = 0; stage_index < ShaderStage::Num; stage_index++) {
+        const ShaderStageArrayInfo& info = shader_stage_array_info(gen, prog, ShaderStage::from_index(stage_index), slang);
+        const StageReflection& refl = prog.stage(ShaderStage::from_index(stage_index));
+        const std::string dsn = info.stage == ShaderStage::Vertex ? "vertex_func" : "fragment_func";
+        if (info.has_bytecode) {
+            item(dsn + ".bytecode.ptr", info.bytecode_array_name);
+            item(dsn + ".bytecode.size", fmt::format("{}", info.bytecode_array_size));
+        } else {
+            item(dsn + ".source", fmt::format("(const char*){}", info.source_array_name));
+            const char* d3d11_tgt = nullptr;
+            if (slang == Slang::HLSL4) {
+                d3d11_tgt = (0 == stage_index) ? "vs_4_0" : "ps_4_0";
+            } else if (slang == Slang::HLSL5) {
+                d3d11_tgt = (0 == stage_index) ? "vs_5_0" : "ps_5_0";
             }
-            for (int ub_index = 0; ub_index < Bindings::MaxUniformBlocks; ub_index++) {
-                const UniformBlock* ub = prog.bindings.find_uniform_block_by_sokol_slot(ub_index);
-                if (ub) {
-                    const std::string ubn = fmt::format("desc.uniform_blocks[{}]", ub_index);
-                    l("{}.stage = {};\n", ubn, shader_stage(ub->stage));
-                    l("{}.layout = SG_UNIFORMLAYOUT_STD140;\n", ubn);
-                    l("{}.size = {};\n", ubn, roundup(ub->struct_info.size, 16));
-                    if (Slang::is_hlsl(slang)) {
-                        l("{}.hlsl_register_b_n = {};\n", ubn, ub->hlsl_register_b_n);
-                    } else if (Slang::is_msl(slang)) {
-                        l("{}.msl_buffer_n = {};\n", ubn, ub->msl_buffer_n);
-                    } else if (Slang::is_wgsl(slang)) {
-                        l("{}.wgsl_group0_binding_n = {};\n", ubn, ub->wgsl_group0_binding_n);
-                    } else if (Slang::is_glsl(slang) && (ub->struct_info.struct_items.size() > 0)) {
-                        if (ub->flattened) {
-                            // NOT A BUG (to take the type from the first struct item, but the size from the toplevel ub)
-                            l("{}.glsl_uniforms[0].type = {};\n", ubn, flattened_uniform_type(ub->struct_info.struct_items[0].type));
-                            l("{}.glsl_uniforms[0].array_count = {};\n", ubn, roundup(ub->struct_info.size, 16) / 16);
-                            l("{}.glsl_uniforms[0].glsl_name = \"{}\";\n", ubn, ub->name);
-                        } else {
-                            for (int u_index = 0; u_index < (int)ub->struct_info.struct_items.size(); u_index++) {
-                                const Type& u = ub->struct_info.struct_items[u_index];
-                                const std::string un = fmt::format("{}.glsl_uniforms[{}]", ubn, u_index);
-                                l("{}.type = {};\n", un, uniform_type(u.type));
-                                l("{}.array_count = {};\n", un, u.array_count);
-                                l("{}.glsl_name = \"{}.{}\";\n", un, ub->inst_name, u.name);
-                            }
-                        }
-                    }
-                }
+            if (d3d11_tgt) {
+                item(dsn + ".d3d11_target", fmt::format("\"{}\"", d3d11_tgt));
             }
-            for (int sbuf_index = 0; sbuf_index < Bindings::MaxStorageBuffers; sbuf_index++) {
-                const StorageBuffer* sbuf = prog.bindings.find_storage_buffer_by_sokol_slot(sbuf_index);
-                if (sbuf) {
-                    const std::string& sbn = fmt::format("desc.storage_buffers[{}]", sbuf_index);
-                    l("{}.stage = {};\n", sbn, shader_stage(sbuf->stage));
-                    l("{}.readonly = {};\n", sbn, sbuf->readonly);
-                    if (Slang::is_hlsl(slang)) {
-                        l("{}.hlsl_register_t_n = {};\n", sbn, sbuf->hlsl_register_t_n);
-                    } else if (Slang::is_msl(slang)) {
-                        l("{}.msl_buffer_n = {};\n", sbn, sbuf->msl_buffer_n);
-                    } else if (Slang::is_wgsl(slang)) {
-                        l("{}.wgsl_group1_binding_n = {};\n", sbn, sbuf->wgsl_group1_binding_n);
-                    } else if (Slang::is_glsl(slang)) {
-                        l("{}.glsl_binding_n = {};\n", sbn, sbuf->glsl_binding_n);
-                    }
-                }
+        }
+        item(dsn + ".entry", fmt::format("\"{}\"", refl.entry_point_by_slang(slang)));
+    }
+    for (int attr_index = 0; attr_index < StageAttr::Num; attr_index++) {
+        const StageAttr& attr = prog.vs().inputs[attr_index];
+        if (attr.slot >= 0) {
+            const std::string an = fmt::format("attrs[{}]", attr_index);
+            if (Slang::is_glsl(slang)) {
+                item(an + ".glsl_name", fmt::format("\"{}\"", attr.name));
+            } else if (Slang::is_hlsl(slang)) {
+                item(an + ".hlsl_sem_name", fmt::format("\"{}\"", attr.sem_name));
+                item(an + ".hlsl_sem_index", fmt::format("{}", attr.sem_index));
             }
-            for (int img_index = 0; img_index < Bindings::MaxImages; img_index++) {
-                const Image* img = prog.bindings.find_image_by_sokol_slot(img_index);
-                if (img) {
-                    const std::string in = fmt::format("desc.images[{}]", img_index);
-                    l("{}.stage = {};\n", in, shader_stage(img->stage));
-                    l("{}.image_type = {};\n", in, image_type(img->type));
-                    l("{}.sample_type = {};\n", in, image_sample_type(img->sample_type));
-                    l("{}.multisampled = {};\n", in, img->multisampled ? "true" : "false");
-                    if (Slang::is_hlsl(slang)) {
-                        l("{}.hlsl_register_t_n = {};\n", in, img->hlsl_register_t_n);
-                    } else if (Slang::is_msl(slang)) {
-                        l("{}.msl_texture_n = {};\n", in, img->msl_texture_n);
-                    } else if (Slang::is_wgsl(slang)) {
-                        l("{}.wgsl_group1_binding_n = {};\n", in, img->wgsl_group1_binding_n);
+        }
+    }
+    for (int ub_index = 0; ub_index < Bindings::MaxUniformBlocks; ub_index++) {
+        const UniformBlock* ub = prog.bindings.find_uniform_block_by_sokol_slot(ub_index);
+        if (ub) {
+            const std::string ubn = fmt::format("uniform_blocks[{}]", ub_index);
+            item(ubn + ".stage", shader_stage(ub->stage));
+            item(ubn + ".layout", "SG_UNIFORMLAYOUT_STD140");
+            item(ubn + ".size", fmt::format("{}", roundup(ub->struct_info.size, 16)));
+            if (Slang::is_hlsl(slang)) {
+                item(ubn + ".hlsl_register_b_n", fmt::format("{}", ub->hlsl_register_b_n));
+            } else if (Slang::is_msl(slang)) {
+                item(ubn + ".msl_buffer_n", fmt::format("{}", ub->msl_buffer_n));
+            } else if (Slang::is_wgsl(slang)) {
+                item(ubn + ".wgsl_group0_binding_n", fmt::format("{}", ub->wgsl_group0_binding_n));
+            } else if (Slang::is_glsl(slang) && (ub->struct_info.struct_items.size() > 0)) {
+                if (ub->flattened) {
+                    // NOT A BUG (to take the type from the first struct item, but the size from the toplevel ub)
+                    item(ubn + ".glsl_uniforms[0].type", flattened_uniform_type(ub->struct_info.struct_items[0].type));
+                    item(ubn + ".glsl_uniforms[0].array_count", fmt::format("{}", roundup(ub->struct_info.size, 16) / 16));
+                    item(ubn + ".glsl_uniforms[0].glsl_name", fmt::format("\"{}\"", ub->name));
+                } else {
+                    for (int u_index = 0; u_index < (int)ub->struct_info.struct_items.size(); u_index++) {
+                        const Type& u = ub->struct_info.struct_items[u_index];
+                        const std::string un = fmt::format("{}.glsl_uniforms[{}]", ubn, u_index);
+                        item(un + ".type", uniform_type(u.type));
+                        item(un + ".array_count", fmt::format("{}", u.array_count));
+                        item(un + ".glsl_name", fmt::format("\"{}.{}\"", ub->inst_name, u.name));
                     }
                 }
             }
-            for (int smp_index = 0; smp_index < Bindings::MaxSamplers; smp_index++) {
-                const Sampler* smp = prog.bindings.find_sampler_by_sokol_slot(smp_index);
-                if (smp) {
-                    const std::string sn = fmt::format("desc.samplers[{}]", smp_index);
-                    l("{}.stage = {};\n", sn, shader_stage(smp->stage));
-                    l("{}.sampler_type = {};\n", sn, sampler_type(smp->type));
-                    if (Slang::is_hlsl(slang)) {
-                        l("{}.hlsl_register_s_n = {};\n", sn, smp->hlsl_register_s_n);
-                    } else if (Slang::is_msl(slang)) {
-                        l("{}.msl_sampler_n = {};\n", sn, smp->msl_sampler_n);
-                    } else if (Slang::is_wgsl(slang)) {
-                        l("{}.wgsl_group1_binding_n = {};\n", sn, smp->wgsl_group1_binding_n);
-                    }
-                }
+        }
+    }
+    for (int sbuf_index = 0; sbuf_index < Bindings::MaxStorageBuffers; sbuf_index++) {
+        const StorageBuffer* sbuf = prog.bindings.find_storage_buffer_by_sokol_slot(sbuf_index);
+        if (sbuf) {
+            const std::string sbn = fmt::format("storage_buffers[{}]", sbuf_index);
+            item(sbn + ".stage", shader_stage(sbuf->stage));
+            item(sbn + ".readonly", sbuf->readonly ? "true" : "false");
+            if (Slang::is_hlsl(slang)) {
+                item(sbn + ".hlsl_register_t_n", fmt::format("{}", sbuf->hlsl_register_t_n));
+            } else if (Slang::is_msl(slang)) {
+                item(sbn + ".msl_buffer_n", fmt::format("{}", sbuf->msl_buffer_n));
+            } else if (Slang::is_wgsl(slang)) {
+                item(sbn + ".wgsl_group1_binding_n", fmt::format("{}", sbuf->wgsl_group1_binding_n));
+            } else if (Slang::is_glsl(slang)) {
+                item(sbn + ".glsl_binding_n", fmt::format("{}", sbuf->glsl_binding_n));
             }
-            for (int img_smp_index = 0; img_smp_index < Bindings::MaxImageSamplers; img_smp_index++) {
-                const ImageSampler* img_smp = prog.bindings.find_image_sampler_by_sokol_slot(img_smp_index);
-                if (img_smp) {
-                    const std::string isn = fmt::format("desc.image_sampler_pairs[{}]", img_smp_index);
-                    l("{}.stage = {};\n", isn, shader_stage(img_smp->stage));
-                    l("{}.image_slot = {};\n", isn, prog.bindings.find_image_by_name(img_smp->image_name)->sokol_slot);
-                    l("{}.sampler_slot = {};\n", isn, prog.bindings.find_sampler_by_name(img_smp->sampler_name)->sokol_slot);
-                    if (Slang::is_glsl(slang)) {
-                        l("{}.glsl_name = \"{}\";\n", isn, img_smp->name);
-                    }
-                }
+        }
+    }
+    for (int img_index = 0; img_index < Bindings::MaxImages; img_index++) {
+        const Image* img = prog.bindings.find_image_by_sokol_slot(img_index);
+        if (img) {
+            const std::string in = fmt::format("images[{}]", img_index);
+            item(in + ".stage", shader_stage(img->stage));
+            item(in + ".image_type", image_type(img->type));
+            item(in + ".sample_type", image_sample_type(img->sample_type));
+            item(in + ".multisampled", img->multisampled ? "true" : "false");
+            if (Slang::is_hlsl(slang)) {
+                item(in + ".hlsl_register_t_n", fmt::format("{}", img->hlsl_register_t_n));
+            } else if (Slang::is_msl(slang)) {
+                item(in + ".msl_texture_n", fmt::format("{}", img->msl_texture_n));
+            } else if (Slang::is_wgsl(slang)) {
+                item(in + ".wgsl_group1_binding_n", fmt::format("{}", img->wgsl_group1_binding_n));
             }
-            l("desc.label = \"{}{}_shader\";\n", mod_prefix, prog.name);
-            l_close("}}\n");
-            l("return &desc;\n");
-            l_close("}}\n");
-            if (gen.args.ifdef) {
-                l("#endif /* {} */\n", sokol_define(slang));
+        }
+    }
+    for (int smp_index = 0; smp_index < Bindings::MaxSamplers; smp_index++) {
+        const Sampler* smp = prog.bindings.find_sampler_by_sokol_slot(smp_index);
+        if (smp) {
+            const std::string sn = fmt::format("samplers[{}]", smp_index);
+            item(sn + ".stage", shader_stage(smp->stage));
+            item(sn + ".sampler_type", sampler_type(smp->type));
+            if (Slang::is_hlsl(slang)) {
+                item(sn + ".hlsl_register_s_n", fmt::format("{}", smp->hlsl_register_s_n));
+            } else if (Slang::is_msl(slang)) {
+                item(sn + ".msl_sampler_n", fmt::format("{}", smp->msl_sampler_n));
+            } else if (Slang::is_wgsl(slang)) {
+                item(sn + ".wgsl_group1_binding_n", fmt::format("{}", smp->wgsl_group1_binding_n));
             }
         }
     }
-    l("return 0;\n");
+    for (int img_smp_index = 0; img_smp_index < Bindings::MaxImageSamplers; img_smp_index++) {
+        const ImageSampler* img_smp = prog.bindings.find_image_sampler_by_sokol_slot(img_smp_index);
+        if (img_smp) {
+            const std::string isn = fmt::format("image_sampler_pairs[{}]", img_smp_index);
+            item(isn + ".stage", shader_stage(img_smp->stage));
+            item(isn + ".image_slot", fmt::format("{}", prog.bindings.find_image_by_name(img_smp->image_name)->sokol_slot));
+            item(isn + ".sampler_slot", fmt::format("{}", prog.bindings.find_sampler_by_name(img_smp->sampler_name)->sokol_slot));
+            if (Slang::is_glsl(slang)) {
+                item(isn + ".glsl_name", fmt::format("\"{}\"", img_smp->name));
+            }
+        }
+    }
+    item("label", fmt::format("\"{}{}_shader\"", mod_prefix, prog.name));
+
+    // C has designated initializers with array indices, so the desc can live
+    // in read-only data, C++ has no array designators, so fall back to a
+    // (thread-safe) function-local static
+    l("#if defined(__cplusplus)\n");
+    l_open("static const sg_shader_desc desc = []() {{\n");
+    l("sg_shader_desc res = {{}};\n");
+    for (const auto& it: items) {
+        l("res.{} = {};\n", it.first, it.second);
+    }
+    l("return res;\n");
+    l_close("}}();\n");
+    l("#else\n");
+    l_open("static const sg_shader_desc desc = {{\n");
+    for (const auto& it: items) {
+        l(".{} = {},\n", it.first, it.second);
+    }
+    l_close("}};\n");
+    l("#endif\n");
+}
+
+void SokolCGenerator::gen_reflection_funcs(const GenInput& gen) {
+    // shared helpers for the perfect-hash name lookups, must match PerfectHash::hash()
+    l("#if !defined(SOKOL_SHDC_REFL_LOOKUP_INCLUDED)\n");
+    l("#define SOKOL_SHDC_REFL_LOOKUP_INCLUDED\n");
+    l("typedef struct sokol_shdc_refl_item {{ const char* name0; const char* name1; int value; }} sokol_shdc_refl_item;\n");
+    l_open("static inline uint32_t sokol_shdc_refl_hash(uint32_t seed, const char* str0, const char* str1) {{\n");
+    l("uint32_t h = 0x811C9DC5u ^ (seed * 0x9E3779B9u);\n");
+    l("do {{ h = (h ^ (uint8_t)*str0) * 0x01000193u; }} while (*str0++);\n");
+    l("if (str1) {{ do {{ h = (h ^ (uint8_t)*str1) * 0x01000193u; }} while (*str1++); }}\n");
+    l("h ^= h >> 16; h *= 0x85EBCA6Bu; h ^= h >> 13; h *= 0xC2B2AE35u; h ^= h >> 16;\n");
+    l("return h;\n");
+    l_close("}}\n");
+    l("#endif\n");
+    Generator::gen_reflection_funcs(gen);
+}
+
+// emit a static lookup table with minimal perfect hash, and open a scope where 'item' is the matching table item
+void SokolCGenerator::gen_refl_lookup_begin(const std::vector<ReflItem>& items, const std::string& arg0, const std::string& arg1) {
+    std::vector<std::vector<std::string>> keys;
+    for (const ReflItem& item: items) {
+        keys.push_back(item.key);
+    }
+    const PerfectHash phf = PerfectHash::build(keys);
+    const size_t num = items.size();
+    const bool two_keys = !arg1.empty();
+    const std::string hash_arg1 = two_keys ? arg1 : "0";
+    const std::string cond = two_keys
+        ? fmt::format("(0 == strcmp(item->name0, {})) && (0 == strcmp(item->name1, {}))", arg0, arg1)
+        : fmt::format("0 == strcmp(item->name0, {})", arg0);
+    l_open("static const sokol_shdc_refl_item items[{}] = {{\n", num);
+    for (size_t i = 0; i < num; i++) {
+        // with a valid perfect hash, the table is in slot order
+        const ReflItem& item = items[phf.valid ? phf.slots[i] : i];
+        l("{{ \"{}\", {}, {} }},\n", item.key[0], two_keys ? fmt::format("\"{}\"", item.key[1]) : "0", item.value);
+    }
+    l_close("}};\n");
+    refl_lookup_linear = !phf.valid;
+    if (phf.valid) {
+        std::string seeds;
+        for (size_t i = 0; i < num; i++) {
+            seeds += fmt::format("{}{}", (i > 0) ? ", " : "", phf.seeds[i]);
+        }
+        l("static const uint32_t seeds[{}] = {{ {} }};\n", num, seeds);
+        l("const uint32_t slot = sokol_shdc_refl_hash(seeds[sokol_shdc_refl_hash(0, {}, {}) % {}], {}, {}) % {};\n",
+            arg0, hash_arg1, num, arg0, hash_arg1, num);
+        l("const sokol_shdc_refl_item* item = &items[slot];\n");
+    } else {
+        // fallback if no perfect hash was found (shouldn't happen in practice)
+        l_open("for (int i = 0; i < {}; i++) {{\n", num);
+        l("const sokol_shdc_refl_item* item = &items[i];\n");
+    }
+    l_open("if ({}) {{\n", cond);
+}
+
+void SokolCGenerator::gen_refl_lookup_end() {
     l_close("}}\n");
+    if (refl_lookup_linear) {
+        l_close("}}\n");
+    }
 }
 
 void SokolCGenerator::gen_attr_slot_refl_func(const GenInput& gen, const ProgramReflection& prog) {
     l_open("{}int {}{}_attr_slot(const char* attr_name) {{\n", func_prefix, mod_prefix, prog.name);
     l("(void)attr_name;\n");
+    std::vector<ReflItem> items;
     for (const StageAttr& attr: prog.vs().inputs) {
         if (attr.slot >= 0) {
-            l_open("if (0 == strcmp(attr_name, \"{}\")) {{\n", attr.name);
-            l("return {};\n", attr.slot);
-            l_close("}}\n");
+            items.push_back({ { attr.name }, fmt::format("{}", attr.slot) });
         }
     }
+    if (!items.empty()) {
+        gen_refl_lookup_begin(items, "attr_name");
+        l("return item->value;\n");
+        gen_refl_lookup_end();
+    }
     l("return -1;\n");
     l_close("}}\n");
 }
@@ -415,13 +899,17 @@ void SokolCGenerator::gen_attr_slot_refl_func(const GenInput& gen, const Program
 void SokolCGenerator::gen_image_slot_refl_func(const GenInput& gen, const ProgramReflection& prog) {
     l_open("{}int {}{}_image_slot(const char* img_name) {{\n", func_prefix, mod_prefix, prog.name);
     l("(void)img_name;\n");
+    std::vector<ReflItem> items;
     for (const Image& img: prog.bindings.images) {
         if (img.sokol_slot >= 0) {
-            l_open("if (0 == strcmp(img_name, \"{}\")) {{\n", img.name);
-            l("return {};\n", img.sokol_slot);
-            l_close("}}\n");
+            items.push_back({ { img.name }, fmt::format("{}", img.sokol_slot) });
         }
     }
+    if (!items.empty()) {
+        gen_refl_lookup_begin(items, "img_name");
+        l("return item->value;\n");
+        gen_refl_lookup_end();
+    }
     l("return -1;\n");
     l_close("}}\n");
 }
@@ -429,13 +917,17 @@ void SokolCGenerator::gen_image_slot_refl_func(const GenInput& gen, const Progra
 void SokolCGenerator::gen_sampler_slot_refl_func(const GenInput& gen, const ProgramReflection& prog) {
     l_open("{}int {}{}_sampler_slot(const char* smp_name) {{\n", func_prefix, mod_prefix, prog.name);
     l("(void)smp_name;\n");
+    std::vector<ReflItem> items;
     for (const Sampler& smp: prog.bindings.samplers) {
         if (smp.sokol_slot >= 0) {
-            l_open("if (0 == strcmp(smp_name, \"{}\")) {{\n", smp.name);
-            l("return {};\n", smp.sokol_slot);
-            l_close("}}\n");
+            items.push_back({ { smp.name }, fmt::format("{}", smp.sokol_slot) });
         }
     }
+    if (!items.empty()) {
+        gen_refl_lookup_begin(items, "smp_name");
+        l("return item->value;\n");
+        gen_refl_lookup_end();
+    }
     l("return -1;\n");
     l_close("}}\n");
 }
@@ -443,13 +935,17 @@ void SokolCGenerator::gen_sampler_slot_refl_func(const GenInput& gen, const Prog
 void SokolCGenerator::gen_uniform_block_slot_refl_func(const GenInput& gen, const ProgramReflection& prog) {
     l_open("{}int {}{}_uniformblock_slot(const char* ub_name) {{\n", func_prefix, mod_prefix, prog.name);
     l("(void)ub_name;\n");
+    std::vector<ReflItem> items;
     for (const UniformBlock& ub: prog.bindings.uniform_blocks) {
         if (ub.sokol_slot >= 0) {
-            l_open("if (0 == strcmp(ub_name, \"{}\")) {{\n", ub.name);
-            l("return {};\n", ub.sokol_slot);
-            l_close("}}\n");
+            items.push_back({ { ub.name }, fmt::format("{}", ub.sokol_slot) });
         }
     }
+    if (!items.empty()) {
+        gen_refl_lookup_begin(items, "ub_name");
+        l("return item->value;\n");
+        gen_refl_lookup_end();
+    }
     l("return -1;\n");
     l_close("}}\n");
 }
@@ -457,13 +953,17 @@ void SokolCGenerator::gen_uniform_block_slot_refl_func(const GenInput& gen, cons
 void SokolCGenerator::gen_uniform_block_size_refl_func(const GenInput& gen, const ProgramReflection& prog) {
     l_open("{}size_t {}{}_uniformblock_size(const char* ub_name) {{\n", func_prefix, mod_prefix, prog.name);
     l("(void)ub_name;\n");
+    std::vector<ReflItem> items;
     for (const UniformBlock& ub: prog.bindings.uniform_blocks) {
         if (ub.sokol_slot >= 0) {
-            l_open("if (0 == strcmp(ub_name, \"{}\")) {{\n", ub.name);
-            l("return sizeof({});\n", struct_name(ub.name));
-            l_close("}}\n");
+            items.push_back({ { ub.name }, fmt::format("(int)sizeof({})", struct_name(ub.name)) });
         }
     }
+    if (!items.empty()) {
+        gen_refl_lookup_begin(items, "ub_name");
+        l("return (size_t)item->value;\n");
+        gen_refl_lookup_end();
+    }
     l("return 0;\n");
     l_close("}}\n");
 }
@@ -471,13 +971,17 @@ void SokolCGenerator::gen_uniform_block_size_refl_func(const GenInput& gen, cons
 void SokolCGenerator::gen_storage_buffer_slot_refl_func(const GenInput& gen, const ProgramReflection& prog) {
     l_open("{}int {}{}_storagebuffer_slot(const char* sbuf_name) {{\n", func_prefix, mod_prefix, prog.name);
     l("(void)sbuf_name;\n");
+    std::vector<ReflItem> items;
     for (const StorageBuffer& sbuf: prog.bindings.storage_buffers) {
         if (sbuf.sokol_slot >= 0) {
-            l_open("if (0 == strcmp(sbuf_name, \"{}\")) {{\n", sbuf.name);
-            l("return {};\n", sbuf.sokol_slot);
-            l_close("}}\n");
+            items.push_back({ { sbuf.name }, fmt::format("{}", sbuf.sokol_slot) });
         }
     }
+    if (!items.empty()) {
+        gen_refl_lookup_begin(items, "sbuf_name");
+        l("return item->value;\n");
+        gen_refl_lookup_end();
+    }
     l("return -1;\n");
     l_close("}}\n");
 }
@@ -485,17 +989,19 @@ void SokolCGenerator::gen_storage_buffer_slot_refl_func(const GenInput& gen, con
 void SokolCGenerator::gen_uniform_offset_refl_func(const GenInput& gen, const ProgramReflection& prog) {
     l_open("{}int {}{}_uniform_offset(const char* ub_name, const char* u_name) {{\n", func_prefix, mod_prefix, prog.name);
     l("(void)ub_name; (void)u_name;\n");
+    std::vector<ReflItem> items;
     for (const UniformBlock& ub: prog.bindings.uniform_blocks) {
         if (ub.sokol_slot >= 0) {
-            l_open("if (0 == strcmp(ub_name, \"{}\")) {{\n", ub.name);
             for (const Type& u: ub.struct_info.struct_items) {
-                l_open("if (0 == strcmp(u_name, \"{}\")) {{\n", u.name);
-                l("return {};\n", u.offset);
-                l_close("}}\n");
+                items.push_back({ { ub.name, u.name }, fmt::format("{}", u.offset) });
             }
-            l_close("}}\n");
         }
     }
+    if (!items.empty()) {
+        gen_refl_lookup_begin(items, "ub_name", "u_name");
+        l("return item->value;\n");
+        gen_refl_lookup_end();
+    }
     l("return -1;\n");
     l_close("}}\n");
 }
@@ -508,20 +1014,33 @@ void SokolCGenerator::gen_uniform_desc_refl_func(const GenInput& gen, const Prog
     l("#else\n");
     l("sg_glsl_shader_uniform res = {{0}};\n");
     l("#endif\n");
+    std::vector<ReflItem> items;
+    std::vector<const Type*> uniforms;
     for (const UniformBlock& ub: prog.bindings.uniform_blocks) {
         if (ub.sokol_slot >= 0) {
-            l_open("if (0 == strcmp(ub_name, \"{}\")) {{\n", ub.name);
             for (const Type& u: ub.struct_info.struct_items) {
-                l_open("if (0 == strcmp(u_name, \"{}\")) {{\n", u.name);
-                l("res.type = {};\n", uniform_type(u.type));
-                l("res.array_count = {};\n", u.array_count);
-                l("res.glsl_name = \"{}\";\n", u.name);
-                l("return res;\n");
-                l_close("}}\n");
+                items.push_back({ { ub.name, u.name }, fmt::format("{}", uniforms.size()) });
+                uniforms.push_back(&u);
             }
-            l_close("}}\n");
         }
     }
+    if (!items.empty()) {
+        gen_refl_lookup_begin(items, "ub_name", "u_name");
+        l_open("switch (item->value) {{\n");
+        for (size_t i = 0; i < uniforms.size(); i++) {
+            const Type& u = *uniforms[i];
+            l_open("case {}:\n", i);
+            l("res.type = {};\n", uniform_type(u.type));
+            l("res.array_count = {};\n", u.array_count);
+            l("res.glsl_name = \"{}\";\n", u.name);
+            l("break;\n");
+            l_close();
+        }
+        l("default: break;\n");
+        l_close("}}\n");
+        l("return res;\n");
+        gen_refl_lookup_end();
+    }
     l("return res;\n");
     l_close("}}\n");
 }
@@ -6,18 +6,31 @@ namespace shdc::gen {
 class SokolCGenerator: public Generator {
     std::string mod_prefix;
     std::string func_prefix;
+    bool refl_lookup_linear = false;
+public:
+    virtual ErrMsg generate_shared_types(const GenInput& gen, const std::vector<std::string>& inputs);
 protected:
     virtual ErrMsg begin(const GenInput& gen);
     virtual void gen_prolog(const GenInput& gen);
     virtual void gen_epilog(const GenInput& gen);
     virtual void gen_prerequisites(const GenInput& gen);
+    virtual void gen_bind_slot_consts(const GenInput& gen);
     virtual void gen_uniform_block_decl(const GenInput& gen, const refl::UniformBlock& ub);
     virtual void gen_storage_buffer_decl(const GenInput& gen, const refl::StorageBuffer& sbuf);
+    virtual void gen_soa_struct_start(const std::string& soa_struct);
+    virtual void gen_soa_struct_member(const refl::SoaMember& member);
+    virtual void gen_soa_struct_end(const std::string& soa_struct);
+    virtual void gen_soa_pack_func_start(const std::string& item_typename, const std::string& aos_struct, const std::string& soa_struct);
+    virtual void gen_soa_pack_member(const refl::SoaMember& member);
+    virtual void gen_soa_pack_func_end();
     virtual void gen_shader_array_start(const GenInput& gen, const std::string& array_name, size_t num_bytes, Slang::Enum slang);
     virtual void gen_shader_array_end(const GenInput& gen);
     virtual void gen_stb_impl_start(const GenInput& gen);
     virtual void gen_stb_impl_end(const GenInput& gen);
     virtual void gen_shader_desc_func(const GenInput& gen, const refl::ProgramReflection& prog);
+    virtual void gen_vertex_layout_decl(const GenInput& gen, const refl::ProgramReflection& prog);
+    virtual void gen_vertex_layout_func(const GenInput& gen, const refl::ProgramReflection& prog);
+    virtual void gen_reflection_funcs(const GenInput& gen);
     virtual void gen_attr_slot_refl_func(const GenInput& gen, const refl::ProgramReflection& prog);
     virtual void gen_image_slot_refl_func(const GenInput& gen, const refl::ProgramReflection& prog);
     virtual void gen_sampler_slot_refl_func(const GenInput& gen, const refl::ProgramReflection& progm);
@@ -39,6 +52,7 @@ protected:
     virtual std::string image_type(refl::ImageType::Enum e);
     virtual std::string image_sample_type(refl::ImageSampleType::Enum e);
     virtual std::string sampler_type(refl::SamplerType::Enum e);
+    virtual std::string soa_scalar_type(refl::Type::Enum e);
     virtual std::string backend(Slang::Enum e);
     virtual std::string struct_name(const std::string& name);
     virtual std::string vertex_attr_name(const std::string& prog_name, const refl::StageAttr& attr);
@@ -52,6 +66,17 @@ protected:
     virtual std::string uniform_block_bind_slot_definition(const refl::UniformBlock& ub);
     virtual std::string storage_buffer_bind_slot_definition(const refl::StorageBuffer& sbuf);
 private:
+    struct ReflItem {
+        std::vector<std::string> key;
+        std::string value;
+    };
+    void gen_refl_lookup_begin(const std::vector<ReflItem>& items, const std::string& arg0, const std::string& arg1 = "");
+    void gen_refl_lookup_end();
+    void gen_struct_macros(const GenInput& gen);
+    void gen_uniform_block_helpers(const GenInput& gen, const refl::UniformBlock& ub, int struct_size);
+    void gen_uniform_block_shadow(const GenInput& gen, const refl::UniformBlock& ub, int struct_size);
+    std::string uniform_shadow_setter_arg(const GenInput& gen, const refl::Type& uniform);
+    void gen_shader_desc_init(const GenInput& gen, const refl::ProgramReflection& prog, Slang::Enum slang);
     virtual void gen_struct_interior_decl_std430(const GenInput& gen, const refl::Type& struc, int pad_to_size);
 };
 
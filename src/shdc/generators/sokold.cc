@@ -213,7 +213,7 @@ void SokolDGenerator::gen_shader_desc_func(const GenInput& gen, const ProgramRef
             l_open("case {}:\n", backend(slang));
             for (int stage_index = 0; stage_index < ShaderStage::Num; stage_index++) {
                 const ShaderStageArrayInfo& info = shader_stage_array_info(gen, prog, ShaderStage::from_index(stage_index), slang);
-                const StageReflection& refl = prog.stages[stage_index];
+                const StageReflection& refl = prog.stage(ShaderStage::from_index(stage_index));
                 const std::string dsn = fmt::format("desc.{}", info.stage == ShaderStage::Vertex ? "vertex_func" : "fragment_func");
                 if (info.has_bytecode) {
                     l("{}.bytecode.ptr = {}.ptr;\n", dsn, info.bytecode_array_name);
@@ -280,7 +280,7 @@ void SokolNimGenerator::gen_shader_desc_func(const GenInput& gen, const ProgramR
             l_open("of {}:\n", backend(slang));
             for (int stage_index = 0; stage_index < ShaderStage::Num; stage_index++) {
                 const ShaderStageArrayInfo& info = shader_stage_array_info(gen, prog, ShaderStage::from_index(stage_index), slang);
-                const StageReflection& refl = prog.stages[stage_index];
+                const StageReflection& refl = prog.stage(ShaderStage::from_index(stage_index));
                 const std::string dsn = fmt::format("result.{}", info.stage == ShaderStage::Vertex ? "vertexFunc" : "fragmentFunc");
                 if (info.has_bytecode) {
                     l("{}.bytecode.ptr = {}\n", dsn, info.bytecode_array_name);
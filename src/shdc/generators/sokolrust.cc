@@ -202,6 +202,48 @@ void SokolRustGenerator::gen_storage_buffer_decl(const GenInput& gen, const Stor
     recurse_unfold_structs(gen, item, item.struct_typename, sbuf.struct_info.align, sbuf.struct_info.size);
 }
 
+// Rust type of an SoA member slice
+std::string SokolRustGenerator::soa_scalar_type(Type::Enum type) {
+    switch (type) {
+        case Type::Int:     return "i32";
+        case Type::UInt:    return "u32";
+        case Type::Float:   return "f32";
+        default:            return "INVALID_TYPE";
+    }
+}
+
+void SokolRustGenerator::gen_soa_struct_start(const std::string& soa_struct) {
+    l_open("pub struct {}<'a> {{\n", soa_struct);
+}
+
+void SokolRustGenerator::gen_soa_struct_member(const SoaMember& member) {
+    l("pub {}: &'a [{}],\n", member.name, soa_scalar_type(member.scalar_type));
+}
+
+void SokolRustGenerator::gen_soa_struct_end(const std::string& soa_struct) {
+    l_close("}}\n");
+}
+
+// pack dst.len() items starting at SoA index 'first' into std430 items
+void SokolRustGenerator::gen_soa_pack_func_start(const std::string& item_typename, const std::string& aos_struct, const std::string& soa_struct) {
+    l_open("pub fn {}_soa_pack(dst: &mut [{}], src: &{}, first: usize) {{\n", item_typename, aos_struct, soa_struct);
+    l_open("for (i, item) in dst.iter_mut().enumerate() {{\n");
+    l("let j = first + i;\n");
+}
+
+void SokolRustGenerator::gen_soa_pack_member(const SoaMember& member) {
+    if (member.component < 0) {
+        l("item.{} = src.{}[j];\n", member.aos_name, member.name);
+    } else {
+        l("item.{}[{}] = src.{}[j];\n", member.aos_name, member.component, member.name);
+    }
+}
+
+void SokolRustGenerator::gen_soa_pack_func_end() {
+    l_close("}}\n");
+    l_close("}}\n");
+}
+
 void SokolRustGenerator::gen_shader_desc_func(const GenInput& gen, const ProgramReflection& prog) {
     l_open("pub fn {}_shader_desc(backend: sg::Backend) -> sg::ShaderDesc {{\n", prog.name);
     l("let mut desc = sg::ShaderDesc::new();\n");
@@ -213,7 +255,7 @@ void SokolRustGenerator::gen_shader_desc_func(const GenInput& gen, const Program
             l_open("{} => {{\n", backend(slang));
             for (int stage_index = 0; stage_index < ShaderStage::Num; stage_index++) {
                 const ShaderStageArrayInfo& info = shader_stage_array_info(gen, prog, ShaderStage::from_index(stage_index), slang);
-                const StageReflection& refl = prog.stages[stage_index];
+                const StageReflection& refl = prog.stage(ShaderStage::from_index(stage_index));
                 const std::string dsn = fmt::format("desc.{}", info.stage == ShaderStage::Vertex ? "vertex_func" : "fragment_func");
                 if (info.has_bytecode) {
                     l("{}.bytecode.ptr = &{} as *const _ as *const _;\n", dsn, info.bytecode_array_name);
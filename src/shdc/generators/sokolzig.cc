@@ -200,6 +200,47 @@ void SokolZigGenerator::gen_storage_buffer_decl(const GenInput& gen, const Stora
     l_close("}};\n");
 }
 
+// Zig type of an SoA member slice
+std::string SokolZigGenerator::soa_scalar_type(Type::Enum type) {
+    switch (type) {
+        case Type::Int:     return "i32";
+        case Type::UInt:    return "u32";
+        case Type::Float:   return "f32";
+        default:            return "INVALID_TYPE";
+    }
+}
+
+void SokolZigGenerator::gen_soa_struct_start(const std::string& soa_struct) {
+    l_open("pub const {} = struct {{\n", soa_struct);
+}
+
+void SokolZigGenerator::gen_soa_struct_member(const SoaMember& member) {
+    l("{}: []const {},\n", member.name, soa_scalar_type(member.scalar_type));
+}
+
+void SokolZigGenerator::gen_soa_struct_end(const std::string& soa_struct) {
+    l_close("}};\n");
+}
+
+// pack dst.len items starting at SoA index 'first' into std430 items
+void SokolZigGenerator::gen_soa_pack_func_start(const std::string& item_typename, const std::string& aos_struct, const std::string& soa_struct) {
+    l_open("pub fn {}SoaPack(dst: []{}, src: {}, first: usize) void {{\n", to_camel_case(item_typename), aos_struct, soa_struct);
+    l_open("for (dst, first..) |*item, i| {{\n");
+}
+
+void SokolZigGenerator::gen_soa_pack_member(const SoaMember& member) {
+    if (member.component < 0) {
+        l("item.{} = src.{}[i];\n", member.aos_name, member.name);
+    } else {
+        l("item.{}[{}] = src.{}[i];\n", member.aos_name, member.component, member.name);
+    }
+}
+
+void SokolZigGenerator::gen_soa_pack_func_end() {
+    l_close("}}\n");
+    l_close("}}\n");
+}
+
 void SokolZigGenerator::gen_shader_desc_func(const GenInput& gen, const ProgramReflection& prog) {
     l_open("pub fn {}ShaderDesc(backend: sg.Backend) sg.ShaderDesc {{\n", to_camel_case(prog.name));
     l("var desc: sg.ShaderDesc = .{{}};\n");
@@ -211,7 +252,7 @@ void SokolZigGenerator::gen_shader_desc_func(const GenInput& gen, const ProgramR
             l_open("{} => {{\n", backend(slang));
             for (int stage_index = 0; stage_index < ShaderStage::Num; stage_index++) {
                 const ShaderStageArrayInfo& info = shader_stage_array_info(gen, prog, ShaderStage::from_index(stage_index), slang);
-                const StageReflection& refl = prog.stages[stage_index];
+                const StageReflection& refl = prog.stage(ShaderStage::from_index(stage_index));
                 const std::string dsn = fmt::format("desc.{}", info.stage == ShaderStage::Vertex ? "vertex_func" : "fragment_func");
                 if (info.has_bytecode) {
                     l("{}.bytecode.ptr = &{};\n", dsn, info.bytecode_array_name);
@@ -10,6 +10,12 @@ protected:
     virtual void gen_prerequisites(const GenInput& gen);
     virtual void gen_uniform_block_decl(const GenInput& gen, const refl::UniformBlock& ub);
     virtual void gen_storage_buffer_decl(const GenInput& gen, const refl::StorageBuffer& sbuf);
+    virtual void gen_soa_struct_start(const std::string& soa_struct);
+    virtual void gen_soa_struct_member(const refl::SoaMember& member);
+    virtual void gen_soa_struct_end(const std::string& soa_struct);
+    virtual void gen_soa_pack_func_start(const std::string& item_typename, const std::string& aos_struct, const std::string& soa_struct);
+    virtual void gen_soa_pack_member(const refl::SoaMember& member);
+    virtual void gen_soa_pack_func_end();
     virtual void gen_shader_array_start(const GenInput& gen, const std::string& array_name, size_t num_bytes, Slang::Enum slang);
     virtual void gen_shader_array_end(const GenInput& gen);
     virtual void gen_shader_desc_func(const GenInput& gen, const refl::ProgramReflection& prog);
@@ -34,6 +40,7 @@ protected:
     virtual std::string image_type(refl::ImageType::Enum e);
     virtual std::string image_sample_type(refl::ImageSampleType::Enum e);
     virtual std::string sampler_type(refl::SamplerType::Enum e);
+    virtual std::string soa_scalar_type(refl::Type::Enum e);
     virtual std::string backend(Slang::Enum e);
     virtual std::string struct_name(const std::string& name);
     virtual std::string vertex_attr_name(const std::string& prog_name, const refl::StageAttr& attr);
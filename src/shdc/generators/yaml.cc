@@ -32,10 +32,10 @@ ErrMsg YamlGenerator::generate(const GenInput& gen) {
                 l("name: {}\n", prog.name);
                 for (int stage_index = 0; stage_index < ShaderStage::Num; stage_index++) {
                     const ShaderStageArrayInfo& info = shader_stage_array_info(gen, prog, ShaderStage::from_index(stage_index), slang);
-                    const StageReflection& refl = prog.stages[stage_index];
+                    const StageReflection& refl = prog.stage(ShaderStage::from_index(stage_index));
                     l_open("{}:\n", info.stage == ShaderStage::Vertex ? "vertex_func" : "fragment_func");
                     const std::string file_path = shader_file_path(gen, prog.name, ShaderStage::to_str(info.stage), slang, info.has_bytecode);
-                    l("path: {}\n", file_path);
+                    l("path: {}\n", gen.args.embedded_path(file_path));
                     l("is_binary: {}\n", info.has_bytecode);
                     l("entry_point: {}\n", refl.entry_point_by_slang(slang));
                     const char* d3d11_tgt = nullptr;
@@ -103,13 +103,7 @@ ErrMsg YamlGenerator::generate(const GenInput& gen) {
 
     // write result into output file
     const std::string file_path = fmt::format("{}_{}reflection.yaml", gen.args.output, mod_prefix);
-    FILE* f = fopen(file_path.c_str(), "w");
-    if (!f) {
-        return ErrMsg::error(gen.inp.base_path, 0, fmt::format("failed to open output file '{}'", file_path));
-    }
-    fwrite(content.c_str(), content.length(), 1, f);
-    fclose(f);
-    return ErrMsg();
+    return write_output_file(gen, file_path, content.data(), content.length(), true);
 }
 
 void YamlGenerator::gen_attr(const StageAttr& attr, Slang::Enum slang) {
@@ -138,6 +132,11 @@ void YamlGenerator::gen_uniform_block(const GenInput& gen, const UniformBlock& u
         l("msl_buffer_n: {}\n", ub.msl_buffer_n);
     } else if (Slang::is_wgsl(slang)) {
         l("wgsl_group0_binding_n: {}\n", ub.wgsl_group0_binding_n);
+    } else if (slang == Slang::SPIRV_VK) {
+        l("spirv_set0_binding_n: {}\n", ub.spirv_set0_binding_n);
+    } else if (slang == Slang::SPIRV_GL) {
+        // GL uniform blocks use the sokol bind slot as binding
+        l("glsl_binding_n: {}\n", ub.sokol_slot);
     } else if (Slang::is_glsl(slang)) {
         l_open("glsl_uniforms:\n");
         if (ub.flattened) {
@@ -195,7 +194,9 @@ void YamlGenerator::gen_storage_buffer(const StorageBuffer& sbuf, Slang::Enum sl
         l("msl_buffer_n: {}\n", sbuf.msl_buffer_n);
     } else if (Slang::is_wgsl(slang)) {
         l("wgsl_group1_binding_n: {}\n", sbuf.wgsl_group1_binding_n);
-    } else if (Slang::is_glsl(slang)) {
+    } else if (slang == Slang::SPIRV_VK) {
+        l("spirv_set1_binding_n: {}\n", sbuf.spirv_set1_binding_n);
+    } else if (Slang::is_glsl(slang) || (slang == Slang::SPIRV_GL)) {
         l("glsl_binding_n: {}\n", sbuf.glsl_binding_n);
     }
     l_close();
@@ -215,6 +216,8 @@ void YamlGenerator::gen_image(const Image& img, Slang::Enum slang) {
         l("msl_texture_n: {}\n", img.msl_texture_n);
     } else if (Slang::is_wgsl(slang)) {
         l("wgsl_group1_binding_n: {}\n", img.wgsl_group1_binding_n);
+    } else if (slang == Slang::SPIRV_VK) {
+        l("spirv_set1_binding_n: {}\n", img.spirv_set1_binding_n);
     }
     l_close();
 }
@@ -231,6 +234,8 @@ void YamlGenerator::gen_sampler(const Sampler& smp, Slang::Enum slang) {
         l("msl_sampler_n: {}\n", smp.msl_sampler_n);
     } else if (Slang::is_wgsl(slang)) {
         l("wgsl_group1_binding_n: {}\n", smp.wgsl_group1_binding_n);
+    } else if (slang == Slang::SPIRV_VK) {
+        l("spirv_set1_binding_n: {}\n", smp.spirv_set1_binding_n);
     }
     l_close();
 }
@@ -244,6 +249,8 @@ void YamlGenerator::gen_image_sampler(const ImageSampler& img_smp, Slang::Enum s
     l("sampler_name: {}\n", img_smp.sampler_name);
     if (Slang::is_glsl(slang)) {
         l("glsl_name: {}\n", img_smp.name);
+    } else if (slang == Slang::SPIRV_GL) {
+        l("glsl_binding_n: {}\n", img_smp.glsl_binding_n);
     }
     l_close();
 }
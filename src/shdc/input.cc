@@ -7,6 +7,7 @@
 #include "types/option.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <ctype.h>
 #include <assert.h>
 #include "fmt/format.h"
 #include "pystring.h"
@@ -141,6 +142,7 @@ static bool remove_comments(std::string& str) {
 
 static const std::string module_tag = "@module";
 static const std::string ctype_tag = "@ctype";
+static const std::string ctype_preset_tag = "@ctype_preset";
 static const std::string header_tag = "@header";
 static const std::string vs_tag = "@vs";
 static const std::string fs_tag = "@fs";
@@ -154,6 +156,11 @@ static const std::string msl_options_tag = "@msl_options";
 static const std::string include_tag = "@include";
 static const std::string image_sample_type_tag = "@image_sample_type";
 static const std::string sampler_type_tag = "@sampler_type";
+static const std::string image_normalized_tag = "@image_normalized";
+static const std::string optimize_layout_tag = "@optimize_layout";
+static const std::string soa_tag = "@soa";
+static const std::string unroll_tag = "@unroll";
+static const std::string dont_unroll_tag = "@dont_unroll";
 
 static bool normalize_pragma_sokol(std::vector<std::string>& toks, std::string &line, int line_index, Input& inp) {
     // Returns true if it saw no errors, even if it did nothing.
@@ -189,6 +196,19 @@ static bool normalize_pragma_sokol(std::vector<std::string>& toks, std::string &
 }
 
 // validate source tags for errors, on error returns false and sets error object in inp
+// snippet, program and module names end up in generated C identifiers and in file names
+static bool is_identifier(const std::string& str) {
+    if (str.empty() || !(isalpha((unsigned char)str[0]) || (str[0] == '_'))) {
+        return false;
+    }
+    for (char c: str) {
+        if (!(isalnum((unsigned char)c) || (c == '_'))) {
+            return false;
+        }
+    }
+    return true;
+}
+
 static bool validate_module_tag(const std::vector<std::string>& tokens, bool in_snippet, int line_index, Input& inp) {
     if (tokens.size() != 2) {
         inp.out_error = inp.error(line_index, "@module tag must have exactly one arg (@lib name)");
@@ -202,6 +222,10 @@ static bool validate_module_tag(const std::vector<std::string>& tokens, bool in_
         inp.out_error = inp.error(line_index, "only one @module tag per file allowed.");
         return false;
     }
+    if (!is_identifier(tokens[1])) {
+        inp.out_error = inp.error(line_index, fmt::format("@module name '{}' must be a valid identifier.", tokens[1]));
+        return false;
+    }
     return true;
 }
 
@@ -221,6 +245,57 @@ static bool validate_ctype_tag(const std::vector<std::string>& tokens, bool in_s
     return true;
 }
 
+// GLSL to C type mappings of the @ctype_preset tag
+static bool ctype_preset(const std::string& name, std::map<std::string, std::string>& out_map) {
+    if (name == "sse") {
+        out_map = {
+            { "vec4", "__m128" },
+            { "ivec4", "__m128i" },
+        };
+    } else if (name == "hmm") {
+        out_map = {
+            { "vec2", "HMM_Vec2" },
+            { "vec3", "HMM_Vec3" },
+            { "vec4", "HMM_Vec4" },
+            { "mat4", "HMM_Mat4" },
+        };
+    } else if (name == "cglm") {
+        out_map = {
+            { "vec2", "vec2" },
+            { "vec3", "vec3" },
+            { "vec4", "vec4" },
+            { "ivec2", "ivec2" },
+            { "ivec3", "ivec3" },
+            { "ivec4", "ivec4" },
+            { "mat4", "mat4" },
+        };
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool validate_ctype_preset_tag(const std::vector<std::string>& tokens, bool in_snippet, int line_index, Input& inp) {
+    std::map<std::string, std::string> preset;
+    if (tokens.size() != 2) {
+        inp.out_error = inp.error(line_index, "@ctype_preset tag must have exactly one arg (@ctype_preset [sse|hmm|cglm])");
+        return false;
+    }
+    if (in_snippet) {
+        inp.out_error = inp.error(line_index, "@ctype_preset tag cannot be inside a tag block (missing @end?).");
+        return false;
+    }
+    if (!inp.ctype_preset.empty()) {
+        inp.out_error = inp.error(line_index, "only one @ctype_preset tag per file allowed.");
+        return false;
+    }
+    if (!ctype_preset(tokens[1], preset)) {
+        inp.out_error = inp.error(line_index, "arg of @ctype_preset tag must be one of sse|hmm|cglm");
+        return false;
+    }
+    return true;
+}
+
 static bool validate_header_tag(const std::vector<std::string>& tokens, bool in_snippet, int line_index, Input& inp) {
     if (tokens.size() < 2) {
         inp.out_error = inp.error(line_index, "@header tag must have at least one arg (@header ...)");
@@ -246,6 +321,10 @@ static bool validate_block_tag(const std::vector<std::string>& tokens, bool in_s
         inp.out_error = inp.error(line_index, fmt::format("@block, @vs and @fs tag names must be unique (@block {}).", tokens[1]));
         return false;
     }
+    if (!is_identifier(tokens[1])) {
+        inp.out_error = inp.error(line_index, fmt::format("@block name '{}' must be a valid identifier.", tokens[1]));
+        return false;
+    }
     return true;
 }
 
@@ -262,6 +341,10 @@ static bool validate_vs_tag(const std::vector<std::string>& tokens, bool in_snip
         inp.out_error = inp.error(line_index, fmt::format("@block, @vs and @fs tag names must be unique (@vs {}).", tokens[1]));
         return false;
     }
+    if (!is_identifier(tokens[1])) {
+        inp.out_error = inp.error(line_index, fmt::format("@vs name '{}' must be a valid identifier.", tokens[1]));
+        return false;
+    }
     return true;
 }
 
@@ -278,6 +361,10 @@ static bool validate_fs_tag(const std::vector<std::string>& tokens, bool in_snip
         inp.out_error = inp.error(line_index, fmt::format("@block, @vs and @fs tag names must be unique (@fs {}).", tokens[1]));
         return false;
     }
+    if (!is_identifier(tokens[1])) {
+        inp.out_error = inp.error(line_index, fmt::format("@fs name '{}' must be a valid identifier.", tokens[1]));
+        return false;
+    }
     return true;
 }
 
@@ -322,6 +409,10 @@ static bool validate_program_tag(const std::vector<std::string>& tokens, bool in
         inp.out_error = inp.error(line_index, fmt::format("@program '{}' already defined.", tokens[1]));
         return false;
     }
+    if (!is_identifier(tokens[1])) {
+        inp.out_error = inp.error(line_index, fmt::format("@program name '{}' must be a valid identifier.", tokens[1]));
+        return false;
+    }
     if (inp.vs_map.count(tokens[2]) != 1) {
         inp.out_error = inp.error(line_index, fmt::format("@vs '{}' not found for @program '{}'.", tokens[2], tokens[1]));
         return false;
@@ -383,6 +474,60 @@ static bool validate_sampler_type_tag(const std::vector<std::string>& tokens, in
     return true;
 }
 
+static bool validate_image_normalized_tag(const std::vector<std::string>& tokens, int line_index, Input& inp) {
+    if (tokens.size() < 2) {
+        inp.out_error = inp.error(line_index, "@image_normalized must have at least one arg (@image_normalized [texture]...)");
+        return false;
+    }
+    for (int i = 1; i < (int)tokens.size(); i++) {
+        if (inp.image_normalized_tags.count(tokens[i]) > 0) {
+            inp.out_error = inp.error(line_index, fmt::format("duplicate @image_normalized for texture '{}'", tokens[i]));
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool validate_optimize_layout_tag(const std::vector<std::string>& tokens, int line_index, Input& inp) {
+    if (tokens.size() < 2) {
+        inp.out_error = inp.error(line_index, "@optimize_layout must have at least one arg (@optimize_layout [uniform block]...)");
+        return false;
+    }
+    for (int i = 1; i < (int)tokens.size(); i++) {
+        if (inp.optimize_layout_tags.count(tokens[i]) > 0) {
+            inp.out_error = inp.error(line_index, fmt::format("duplicate @optimize_layout for uniform block '{}'", tokens[i]));
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool validate_soa_tag(const std::vector<std::string>& tokens, int line_index, Input& inp) {
+    if (tokens.size() < 2) {
+        inp.out_error = inp.error(line_index, "@soa must have at least one arg (@soa [storage buffer]...)");
+        return false;
+    }
+    for (int i = 1; i < (int)tokens.size(); i++) {
+        if (inp.soa_tags.count(tokens[i]) > 0) {
+            inp.out_error = inp.error(line_index, fmt::format("duplicate @soa for storage buffer '{}'", tokens[i]));
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool validate_loop_hint_tag(const std::vector<std::string>& tokens, bool in_snippet, int line_index, Input& inp) {
+    if (tokens.size() != 1) {
+        inp.out_error = inp.error(line_index, fmt::format("{} must not have args", tokens[0]));
+        return false;
+    }
+    if (!in_snippet) {
+        inp.out_error = inp.error(line_index, fmt::format("{} must be inside a @vs, @fs or @block", tokens[0]));
+        return false;
+    }
+    return true;
+}
+
 /* This parses the split input line array for custom tags (@vs, @fs, @block,
     @end and @program), and fills the respective members. If a parsing error
     happens, the inp.error object is setup accordingly.
@@ -412,6 +557,11 @@ static bool parse(Input& inp) {
                     return false;
                 }
                 inp.ctype_map[tokens[1]] = tokens[2];
+            } else if (tokens[0] == ctype_preset_tag) {
+                if (!validate_ctype_preset_tag(tokens, in_snippet, line_index, inp)) {
+                    return false;
+                }
+                inp.ctype_preset = tokens[1];
             } else if (tokens[0] == header_tag) {
                 if (!validate_header_tag(tokens, in_snippet, line_index, inp)) {
                     return false;
@@ -428,6 +578,7 @@ static bool parse(Input& inp) {
                     cur_snippet.options[Slang::GLSL410] |= option_bit;
                     cur_snippet.options[Slang::GLSL430] |= option_bit;
                     cur_snippet.options[Slang::GLSL300ES] |= option_bit;
+                    cur_snippet.options[Slang::SPIRV_GL] |= option_bit;
                 }
                 add_line = false;
             } else if (tokens[0] == hlsl_options_tag) {
@@ -521,6 +672,35 @@ static bool parse(Input& inp) {
                 }
                 inp.sampler_type_tags[tokens[1]] = SamplerTypeTag(tokens[1], SamplerType::from_str(tokens[2]), line_index);
                 add_line = false;
+            } else if (tokens[0] == image_normalized_tag) {
+                if (!validate_image_normalized_tag(tokens, line_index, inp)) {
+                    return false;
+                }
+                for (int i = 1; i < (int)tokens.size(); i++) {
+                    inp.image_normalized_tags[tokens[i]] = line_index;
+                }
+                add_line = false;
+            } else if (tokens[0] == optimize_layout_tag) {
+                if (!validate_optimize_layout_tag(tokens, line_index, inp)) {
+                    return false;
+                }
+                for (int i = 1; i < (int)tokens.size(); i++) {
+                    inp.optimize_layout_tags[tokens[i]] = line_index;
+                }
+                add_line = false;
+            } else if (tokens[0] == soa_tag) {
+                if (!validate_soa_tag(tokens, line_index, inp)) {
+                    return false;
+                }
+                for (int i = 1; i < (int)tokens.size(); i++) {
+                    inp.soa_tags[tokens[i]] = line_index;
+                }
+                add_line = false;
+            } else if ((tokens[0] == unroll_tag) || (tokens[0] == dont_unroll_tag)) {
+                if (!validate_loop_hint_tag(tokens, in_snippet, line_index, inp)) {
+                    return false;
+                }
+                // NOTE: the line stays in the snippet, it's replaced with a loop attribute in merge_source()
             } else if (tokens[0][0] == '@') {
                 inp.out_error = inp.error(line_index, fmt::format("unknown meta tag: {}", tokens[0]));
                 return false;
@@ -535,6 +715,14 @@ static bool parse(Input& inp) {
         inp.out_error = inp.error(line_index - 1, "final @end missing.");
         return false;
     }
+    // explicit @ctype tags take precedence over the @ctype_preset mappings
+    if (!inp.ctype_preset.empty()) {
+        std::map<std::string, std::string> preset;
+        ctype_preset(inp.ctype_preset, preset);
+        for (const auto& item: preset) {
+            inp.ctype_map.emplace(item.first, item.second);
+        }
+    }
     return true;
 }
 
@@ -546,15 +734,28 @@ static bool validate_include_tag(const std::vector<std::string>& tokens, int lin
     return true;
 }
 
+static std::string load_file_content(const Input::LoadFileFunc& load_file_func, const std::string& path) {
+    if (load_file_func) {
+        std::string str;
+        if (load_file_func(path, str)) {
+            return str;
+        } else {
+            return std::string();
+        }
+    } else {
+        return load_file_into_str(path);
+    }
+}
+
 static bool load_and_preprocess(const std::string& path, const std::vector<std::string>& include_dirs,
-                                Input& inp, int parent_line_index) {
+                                const Input::LoadFileFunc& load_file_func, Input& inp, int parent_line_index) {
     std::string path_used = path;
-    std::string str = load_file_into_str(path_used);
+    std::string str = load_file_content(load_file_func, path_used);
     if (str.empty()) {
         // check include directories
         for (const std::string& include_dir : include_dirs) {
             path_used = pystring::os::path::join(include_dir, path);
-            str = load_file_into_str(path_used);
+            str = load_file_content(load_file_func, path_used);
             if (!str.empty()) {
                 break;
             }
@@ -585,10 +786,11 @@ static bool load_and_preprocess(const std::string& path, const std::vector<std::
         inp.out_error = ErrMsg::error(path_used, 0, fmt::format("(FIXME) Error during removing comments in '{}'", path_used));
     }
 
-    // split source file into lines
+    // split source file into lines, the line strings are moved into inp.lines
     int line_index = 0;
     std::vector<std::string> lines;
     pystring::splitlines(str, lines);
+    inp.lines.reserve(inp.lines.size() + lines.size());
 
     // preprocess
     std::vector<std::string> tokens;
@@ -605,17 +807,17 @@ static bool load_and_preprocess(const std::string& path, const std::vector<std::
                 }
                 // insert included file
                 const std::string& include_filename = tokens[1];
-                if (!load_and_preprocess(include_filename, include_dirs, inp, line_index)) {
+                if (!load_and_preprocess(include_filename, include_dirs, load_file_func, inp, line_index)) {
                     return false;
                 }
             } else {
                 // otherwise process file as normal
-                inp.lines.push_back({line, filename_index, line_index});
+                inp.lines.push_back({ std::move(line), filename_index, line_index });
             }
         } else {
             // this is an empty line, but add it anyway so the error line
             // indices are always correct
-            inp.lines.push_back({ line, filename_index, line_index});
+            inp.lines.push_back({ std::move(line), filename_index, line_index });
         }
         line_index++;
     }
@@ -626,7 +828,7 @@ static bool load_and_preprocess(const std::string& path, const std::vector<std::
 /* load file and parse into an Input object,
    check valid and error fields in returned object
 */
-Input Input::load_and_parse(const std::string& path, const std::string& module_override) {
+Input Input::load_and_parse(const std::string& path, const std::string& module_override, const LoadFileFunc& load_file) {
     std::string dir;
     std::string filename;
     pystring::os::path::split(dir, filename, path);
@@ -634,7 +836,7 @@ Input Input::load_and_parse(const std::string& path, const std::string& module_o
 
     Input inp;
     inp.base_path = path;
-    if (load_and_preprocess(path, include_dirs, inp, 0)) {
+    if (load_and_preprocess(path, include_dirs, load_file, inp, 0)) {
         parse(inp);
     }
     if (!module_override.empty()) {
@@ -681,6 +883,7 @@ void Input::dump_debug(ErrMsg::Format err_fmt) const {
             fmt::print(stderr, "    {}: {}\n", line.index + 1, line.line);
         }
     }
+    fmt::print(stderr, "  ctype_preset: {}\n", ctype_preset);
     fmt::print(stderr, "  types:\n");
     for (const auto& item: ctype_map) {
         fmt::print(stderr, "    {}: {}\n", item.first, item.second);
@@ -733,6 +936,14 @@ void Input::dump_debug(ErrMsg::Format err_fmt) const {
     for (const auto& [key, val]: sampler_type_tags) {
         fmt::print(stderr, "      {}: {} (line: {})\n", key, SamplerType::to_str(val.type), val.line_index);
     }
+    fmt::print(stderr, "    image normalized tags:\n");
+    for (const auto& [key, val]: image_normalized_tags) {
+        fmt::print(stderr, "      {} (line: {})\n", key, val);
+    }
+    fmt::print(stderr, "    optimize layout tags:\n");
+    for (const auto& [key, val]: optimize_layout_tags) {
+        fmt::print(stderr, "      {} (line: {})\n", key, val);
+    }
     fmt::print("\n");
 }
 
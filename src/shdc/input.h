@@ -2,6 +2,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <functional>
 #include "types/errmsg.h"
 #include "types/line.h"
 #include "types/snippet.h"
@@ -18,6 +19,7 @@ struct Input {
     std::vector<Line> lines;          // input source files split into lines
     std::vector<Snippet> snippets;    // @block, @vs and @fs snippets
     std::map<std::string, std::string> ctype_map;    // @ctype uniform type definitions
+    std::string ctype_preset;               // optional @ctype_preset name
     std::vector<std::string> headers;       // @header statements
     std::map<std::string, int> snippet_map; // name-index mapping for all code snippets
     std::map<std::string, int> block_map;   // name-index mapping for @block snippets
@@ -30,8 +32,15 @@ struct Input {
     std::map<std::string, int> sbuf_slots;      // storagebuffer bindslot definitions
     std::map<std::string, ImageSampleTypeTag> image_sample_type_tags;
     std::map<std::string, SamplerTypeTag> sampler_type_tags;
+    std::map<std::string, int> image_normalized_tags;   // @image_normalized texture names => line index
+    std::map<std::string, int> optimize_layout_tags;    // @optimize_layout uniform block names => line index
+    std::map<std::string, int> soa_tags;                // @soa storage buffer names => line index
 
-    static Input load_and_parse(const std::string& path, const std::string& module_override);
+    // optional callback to load the input file and @include files from somewhere else
+    // than the filesystem (e.g. from memory), must return false if the file doesn't exist
+    using LoadFileFunc = std::function<bool(const std::string& path, std::string& out_content)>;
+
+    static Input load_and_parse(const std::string& path, const std::string& module_override, const LoadFileFunc& load_file = nullptr);
     ErrMsg error(int line_index, const std::string& msg) const;
     ErrMsg warning(int line_index, const std::string& msg) const;
     void dump_debug(ErrMsg::Format err_fmt) const;
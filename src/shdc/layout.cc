@@ -0,0 +1,280 @@
+/*
+    Uniform block layout analysis and member reordering.
+*/
+#include "layout.h"
+#include "fmt/format.h"
+#include "pystring.h"
+#include <numeric>
+
+namespace shdc {
+
+using namespace refl;
+
+// a uniform block declaration in the source code
+struct SourceBlock {
+    std::vector<int> member_line_indices;   // one line per member
+    std::vector<LayoutItem> items;
+};
+
+int Layout::block_size(const std::vector<LayoutItem>& items, const std::vector<int>& order) {
+    int offset = 0;
+    for (int item_index: order) {
+        const LayoutItem& item = items[item_index];
+        offset = (offset + item.align - 1) & ~(item.align - 1);
+        offset += item.size;
+    }
+    return (offset + 15) & ~15;
+}
+
+/* Find a member order which minimizes std140 padding:
+
+    - members which fill complete 16-byte slots go first (vec4, matrices, arrays)
+    - each vec3 is followed by a scalar which fills the remaining 4 bytes of its slot
+    - all vec2 follow next, they pack without gaps, and a trailing odd vec2
+      is followed by the remaining scalars
+
+    Within each group the original order is preserved.
+*/
+std::vector<int> Layout::optimize(const std::vector<LayoutItem>& items) {
+    std::vector<int> slots;
+    std::vector<int> vec3s;
+    std::vector<int> vec2s;
+    std::vector<int> scalars;
+    for (int i = 0; i < (int)items.size(); i++) {
+        const LayoutItem& item = items[i];
+        if ((item.align == 16) && ((item.size & 15) == 12)) {
+            vec3s.push_back(i);
+        } else if ((item.align == 8) && (item.size == 8)) {
+            vec2s.push_back(i);
+        } else if ((item.align == 4) && (item.size == 4)) {
+            scalars.push_back(i);
+        } else {
+            slots.push_back(i);
+        }
+    }
+    std::vector<int> res = slots;
+    size_t scalar_index = 0;
+    for (int i: vec3s) {
+        res.push_back(i);
+        if (scalar_index < scalars.size()) {
+            res.push_back(scalars[scalar_index++]);
+        }
+    }
+    res.insert(res.end(), vec2s.begin(), vec2s.end());
+    res.insert(res.end(), scalars.begin() + scalar_index, scalars.end());
+    return res;
+}
+
+// std140 size and alignment of a uniform block member type
+static bool std140_type(const std::string& type, int& out_size, int& out_align) {
+    if ((type == "float") || (type == "int") || (type == "uint") || (type == "bool")) {
+        out_size = 4;
+        out_align = 4;
+        return true;
+    }
+    for (const std::string prefix: { "vec", "ivec", "uvec", "bvec" }) {
+        if (pystring::startswith(type, prefix) && (type.length() == (prefix.length() + 1))) {
+            const int n = type.back() - '0';
+            if ((n >= 2) && (n <= 4)) {
+                out_size = 4 * n;
+                out_align = (n == 2) ? 8 : 16;
+                return true;
+            }
+        }
+    }
+    if (pystring::startswith(type, "mat") && ((type.length() == 4) || ((type.length() == 6) && (type[4] == 'x')))) {
+        // each matrix column occupies a complete 16-byte slot
+        const int cols = type[3] - '0';
+        const int rows = (type.length() == 6) ? (type[5] - '0') : cols;
+        if ((cols >= 2) && (cols <= 4) && (rows >= 2) && (rows <= 4)) {
+            out_size = 16 * cols;
+            out_align = 16;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool is_identifier(const std::string& str) {
+    if (str.empty() || isdigit((unsigned char)str[0])) {
+        return false;
+    }
+    for (char c: str) {
+        if (!(isalnum((unsigned char)c) || (c == '_'))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// parse a single uniform block member declaration like 'vec4 colors[4];'
+static bool parse_member(const std::string& line, LayoutItem& out_item) {
+    std::string str = pystring::strip(line);
+    if (!pystring::endswith(str, ";") || (str.find_first_of(",;{}", 0) != (str.length() - 1))) {
+        return false;
+    }
+    std::vector<std::string> tokens;
+    pystring::split(str.substr(0, str.length() - 1), tokens);
+    if (!tokens.empty() && ((tokens[0] == "lowp") || (tokens[0] == "mediump") || (tokens[0] == "highp"))) {
+        tokens.erase(tokens.begin());
+    }
+    if (tokens.size() < 2) {
+        return false;
+    }
+    const std::string& type = tokens[0];
+    int size = 0;
+    int align = 0;
+    if (!std140_type(type, size, align)) {
+        return false;
+    }
+    tokens.erase(tokens.begin());
+    const std::string decl = pystring::join("", tokens);
+    const size_t bracket = decl.find('[');
+    if (bracket == std::string::npos) {
+        if (!is_identifier(decl)) {
+            return false;
+        }
+        out_item.decl = fmt::format("{} {}", type, decl);
+        out_item.size = size;
+        out_item.align = align;
+    } else {
+        // array elements are padded to 16 bytes
+        const std::string name = decl.substr(0, bracket);
+        const std::string count = decl.substr(bracket + 1, decl.length() - bracket - 2);
+        if (!is_identifier(name) || !pystring::endswith(decl, "]") || count.empty() || !pystring::isdigit(count)) {
+            return false;
+        }
+        out_item.decl = fmt::format("{} {}[{}]", type, name, count);
+        out_item.size = atoi(count.c_str()) * ((size + 15) & ~15);
+        out_item.align = 16;
+    }
+    return true;
+}
+
+// find the line indices of all declarations of a uniform block (the same
+// uniform block may be declared in different snippets)
+static std::vector<int> find_block_decls(const Input& inp, const std::string& name) {
+    std::vector<int> res;
+    std::vector<std::string> tokens;
+    for (int line_index = 0; line_index < (int)inp.lines.size(); line_index++) {
+        pystring::split(pystring::replace(inp.lines[line_index].line, "{", " { "), tokens);
+        for (size_t i = 0; (i + 1) < tokens.size(); i++) {
+            if ((tokens[i] == "uniform") && (tokens[i + 1] == name)) {
+                res.push_back(line_index);
+                break;
+            }
+        }
+    }
+    return res;
+}
+
+// parse the members of a uniform block declaration, members must be declared one per line
+static ErrMsg parse_source_block(const Input& inp, const std::string& name, int decl_line_index, SourceBlock& out_block) {
+    const int num_lines = (int)inp.lines.size();
+    int line_index = decl_line_index;
+    std::string str = pystring::strip(inp.lines[line_index].line);
+    if (!pystring::endswith(str, "{")) {
+        // opening brace must be on the next line
+        do {
+            line_index++;
+        } while ((line_index < num_lines) && pystring::strip(inp.lines[line_index].line).empty());
+        if ((line_index >= num_lines) || (pystring::strip(inp.lines[line_index].line) != "{")) {
+            return inp.error(decl_line_index, fmt::format("@optimize_layout: expected '{{' at end of line or on the next line in uniform block '{}'", name));
+        }
+    }
+    for (line_index++; line_index < num_lines; line_index++) {
+        str = pystring::strip(inp.lines[line_index].line);
+        if (str.empty()) {
+            continue;
+        }
+        if (str[0] == '}') {
+            return ErrMsg();
+        }
+        LayoutItem item;
+        if (!parse_member(str, item)) {
+            return inp.error(line_index, fmt::format("@optimize_layout: can't parse member declaration in uniform block '{}' (members must be declared one per line)", name));
+        }
+        out_block.member_line_indices.push_back(line_index);
+        out_block.items.push_back(item);
+    }
+    return inp.error(decl_line_index, fmt::format("@optimize_layout: closing '}}' not found in uniform block '{}'", name));
+}
+
+ErrMsg Layout::apply_optimize_layout_tags(Input& inp) {
+    for (const auto& [name, tag_line_index]: inp.optimize_layout_tags) {
+        const std::vector<int> decl_line_indices = find_block_decls(inp, name);
+        if (decl_line_indices.empty()) {
+            return inp.error(tag_line_index, fmt::format("@optimize_layout: uniform block '{}' not found", name));
+        }
+        for (int decl_line_index: decl_line_indices) {
+            SourceBlock block;
+            ErrMsg err = parse_source_block(inp, name, decl_line_index, block);
+            if (err.valid()) {
+                return err;
+            }
+            std::vector<int> order(block.items.size());
+            std::iota(order.begin(), order.end(), 0);
+            const std::vector<int> optimized_order = optimize(block.items);
+            if (block_size(block.items, optimized_order) < block_size(block.items, order)) {
+                // move complete lines, so that error messages still point to the original source location
+                std::vector<Line> member_lines;
+                for (int line_index: block.member_line_indices) {
+                    member_lines.push_back(inp.lines[line_index]);
+                }
+                for (size_t i = 0; i < optimized_order.size(); i++) {
+                    inp.lines[block.member_line_indices[i]] = member_lines[optimized_order[i]];
+                }
+            }
+        }
+    }
+    return ErrMsg();
+}
+
+std::vector<LayoutItem> Layout::items_from_struct(const Type& struct_info) {
+    std::vector<LayoutItem> res;
+    for (const Type& member: struct_info.struct_items) {
+        const std::string type = (member.type == Type::Struct) ? member.struct_typename : member.type_as_glsl();
+        LayoutItem item;
+        if (member.is_array) {
+            item.decl = fmt::format("{} {}[{}]", type, member.name, member.array_count);
+            item.size = member.array_count * member.array_stride;
+            item.align = 16;
+        } else {
+            item.decl = fmt::format("{} {}", type, member.name);
+            item.size = member.size;
+            item.align = (member.is_matrix || (member.type == Type::Struct)) ? 16 : member.align;
+        }
+        res.push_back(item);
+    }
+    return res;
+}
+
+std::vector<ErrMsg> Layout::report(const Input& inp, const Reflection& refl) {
+    std::vector<ErrMsg> res;
+    for (const UniformBlock& ub: refl.bindings.uniform_blocks) {
+        const std::vector<LayoutItem> items = items_from_struct(ub.struct_info);
+        int used_bytes = 0;
+        for (const LayoutItem& item: items) {
+            used_bytes += item.size;
+        }
+        std::vector<int> order(items.size());
+        std::iota(order.begin(), order.end(), 0);
+        const int size = block_size(items, order);
+        const std::vector<int> optimized_order = optimize(items);
+        const int optimized_size = block_size(items, optimized_order);
+        if (optimized_size < size) {
+            std::vector<std::string> decls;
+            for (int item_index: optimized_order) {
+                decls.push_back(items[item_index].decl);
+            }
+            const std::vector<int> decl_line_indices = find_block_decls(inp, ub.name);
+            const int line_index = decl_line_indices.empty() ? (int)inp.lines.size() : decl_line_indices[0];
+            res.push_back(inp.warning(line_index, fmt::format(
+                "uniform block '{}' wastes {} of {} bytes ({} slots) on padding, reordered members need {} bytes ({} slots): '{};' (apply with '@optimize_layout {}')",
+                ub.name, size - used_bytes, size, size / 16, optimized_size, optimized_size / 16, pystring::join("; ", decls), ub.name)));
+        }
+    }
+    return res;
+}
+
+} // namespace shdc
@@ -0,0 +1,31 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "input.h"
+#include "reflection.h"
+#include "types/errmsg.h"
+
+namespace shdc {
+
+// a uniform block member with its std140 size and alignment
+struct LayoutItem {
+    std::string decl;   // GLSL declaration without precision qualifier, e.g. 'vec4 colors[4]'
+    int size = 0;
+    int align = 4;
+};
+
+// uniform block layout analysis (--layout-report) and member reordering (@optimize_layout)
+struct Layout {
+    // std140 size of a uniform block with members in the given order, rounded up to 16 bytes
+    static int block_size(const std::vector<LayoutItem>& items, const std::vector<int>& order);
+    // return the layout items of a reflected uniform block struct
+    static std::vector<LayoutItem> items_from_struct(const refl::Type& struct_info);
+    // return a member order which minimizes the uniform block size
+    static std::vector<int> optimize(const std::vector<LayoutItem>& items);
+    // reorder the uniform block member declarations in the source for all @optimize_layout tags
+    static ErrMsg apply_optimize_layout_tags(Input& inp);
+    // return a warning for each uniform block which would be smaller with a different member order
+    static std::vector<ErrMsg> report(const Input& inp, const refl::Reflection& refl);
+};
+
+} // namespace shdc
@@ -0,0 +1,301 @@
+/*
+    implementation of the libshdc C API, see libshdc.h
+*/
+#include "libshdc.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <deque>
+#include <memory>
+#include "pipeline.h"
+
+using namespace shdc;
+using namespace shdc::refl;
+
+static_assert((int)SHDC_SLANGINDEX_NUM == (int)Slang::REFLECTION, "shdc_slang_index out of sync with Slang::Enum");
+static_assert((int)SHDC_SLANG_SPIRV_GL == (1<<Slang::SPIRV_GL), "shdc_slang out of sync with Slang::Enum");
+static_assert((int)SHDC_SHADERSTAGE_NUM == (int)ShaderStage::Num, "shdc_shader_stage out of sync with ShaderStage::Enum");
+static_assert((int)SHDC_BASETYPE_STRUCT == (int)Type::Struct, "shdc_base_type out of sync with Type::Enum");
+static_assert((int)SHDC_IMAGETYPE_ARRAY == (int)ImageType::ARRAY, "shdc_image_type out of sync with ImageType::Enum");
+static_assert((int)SHDC_IMAGESAMPLETYPE_UNFILTERABLE_FLOAT == (int)ImageSampleType::UNFILTERABLE_FLOAT, "shdc_image_sample_type out of sync with ImageSampleType::Enum");
+static_assert((int)SHDC_SAMPLERTYPE_NONFILTERING == (int)SamplerType::NONFILTERING, "shdc_sampler_type out of sync with SamplerType::Enum");
+
+// owns all memory referenced by a shdc_result
+struct ResultStorage {
+    std::deque<std::string> strings;
+    std::vector<std::shared_ptr<void>> arrays;
+
+    const char* str(const std::string& s) {
+        strings.push_back(s);
+        return strings.back().c_str();
+    }
+    template<class T> T* array(size_t num) {
+        if (num == 0) {
+            return nullptr;
+        }
+        std::shared_ptr<T> ptr(new T[num](), std::default_delete<T[]>());
+        arrays.push_back(ptr);
+        return ptr.get();
+    }
+};
+
+static void to_c_type(ResultStorage& st, const Type& src, shdc_type& dst) {
+    dst.name = st.str(src.name);
+    dst.struct_typename = st.str(src.struct_typename);
+    dst.type = (shdc_base_type)src.type;
+    dst.is_matrix = src.is_matrix;
+    dst.is_array = src.is_array;
+    dst.offset = src.offset;
+    dst.size = src.size;
+    dst.align = src.align;
+    dst.matrix_stride = src.matrix_stride;
+    dst.array_count = src.array_count;
+    dst.array_stride = src.array_stride;
+    shdc_type* items = st.array<shdc_type>(src.struct_items.size());
+    for (size_t i = 0; i < src.struct_items.size(); i++) {
+        to_c_type(st, src.struct_items[i], items[i]);
+    }
+    dst.struct_items = items;
+    dst.num_struct_items = (int)src.struct_items.size();
+}
+
+static void to_c_bindings(ResultStorage& st, const Bindings& src, shdc_bindings& dst) {
+    shdc_uniform_block* ubs = st.array<shdc_uniform_block>(src.uniform_blocks.size());
+    for (size_t i = 0; i < src.uniform_blocks.size(); i++) {
+        const UniformBlock& ub = src.uniform_blocks[i];
+        ubs[i].stage = (shdc_shader_stage)ub.stage;
+        ubs[i].sokol_slot = ub.sokol_slot;
+        ubs[i].hlsl_register_b_n = ub.hlsl_register_b_n;
+        ubs[i].msl_buffer_n = ub.msl_buffer_n;
+        ubs[i].wgsl_group0_binding_n = ub.wgsl_group0_binding_n;
+        ubs[i].spirv_set0_binding_n = ub.spirv_set0_binding_n;
+        ubs[i].name = st.str(ub.name);
+        ubs[i].inst_name = st.str(ub.inst_name);
+        ubs[i].flattened = ub.flattened;
+        to_c_type(st, ub.struct_info, ubs[i].struct_info);
+    }
+    dst.uniform_blocks = ubs;
+    dst.num_uniform_blocks = (int)src.uniform_blocks.size();
+
+    shdc_storage_buffer* sbufs = st.array<shdc_storage_buffer>(src.storage_buffers.size());
+    for (size_t i = 0; i < src.storage_buffers.size(); i++) {
+        const StorageBuffer& sbuf = src.storage_buffers[i];
+        sbufs[i].stage = (shdc_shader_stage)sbuf.stage;
+        sbufs[i].sokol_slot = sbuf.sokol_slot;
+        sbufs[i].hlsl_register_t_n = sbuf.hlsl_register_t_n;
+        sbufs[i].msl_buffer_n = sbuf.msl_buffer_n;
+        sbufs[i].wgsl_group1_binding_n = sbuf.wgsl_group1_binding_n;
+        sbufs[i].spirv_set1_binding_n = sbuf.spirv_set1_binding_n;
+        sbufs[i].glsl_binding_n = sbuf.glsl_binding_n;
+        sbufs[i].name = st.str(sbuf.name);
+        sbufs[i].inst_name = st.str(sbuf.inst_name);
+        sbufs[i].readonly = sbuf.readonly;
+        to_c_type(st, sbuf.struct_info, sbufs[i].struct_info);
+    }
+    dst.storage_buffers = sbufs;
+    dst.num_storage_buffers = (int)src.storage_buffers.size();
+
+    shdc_image* imgs = st.array<shdc_image>(src.images.size());
+    for (size_t i = 0; i < src.images.size(); i++) {
+        const Image& img = src.images[i];
+        imgs[i].stage = (shdc_shader_stage)img.stage;
+        imgs[i].sokol_slot = img.sokol_slot;
+        imgs[i].hlsl_register_t_n = img.hlsl_register_t_n;
+        imgs[i].msl_texture_n = img.msl_texture_n;
+        imgs[i].wgsl_group1_binding_n = img.wgsl_group1_binding_n;
+        imgs[i].spirv_set1_binding_n = img.spirv_set1_binding_n;
+        imgs[i].name = st.str(img.name);
+        imgs[i].type = (shdc_image_type)img.type;
+        imgs[i].sample_type = (shdc_image_sample_type)img.sample_type;
+        imgs[i].multisampled = img.multisampled;
+    }
+    dst.images = imgs;
+    dst.num_images = (int)src.images.size();
+
+    shdc_sampler* smps = st.array<shdc_sampler>(src.samplers.size());
+    for (size_t i = 0; i < src.samplers.size(); i++) {
+        const Sampler& smp = src.samplers[i];
+        smps[i].stage = (shdc_shader_stage)smp.stage;
+        smps[i].sokol_slot = smp.sokol_slot;
+        smps[i].hlsl_register_s_n = smp.hlsl_register_s_n;
+        smps[i].msl_sampler_n = smp.msl_sampler_n;
+        smps[i].wgsl_group1_binding_n = smp.wgsl_group1_binding_n;
+        smps[i].spirv_set1_binding_n = smp.spirv_set1_binding_n;
+        smps[i].name = st.str(smp.name);
+        smps[i].type = (shdc_sampler_type)smp.type;
+    }
+    dst.samplers = smps;
+    dst.num_samplers = (int)src.samplers.size();
+
+    shdc_image_sampler* img_smps = st.array<shdc_image_sampler>(src.image_samplers.size());
+    for (size_t i = 0; i < src.image_samplers.size(); i++) {
+        const ImageSampler& img_smp = src.image_samplers[i];
+        img_smps[i].stage = (shdc_shader_stage)img_smp.stage;
+        img_smps[i].sokol_slot = img_smp.sokol_slot;
+        img_smps[i].glsl_binding_n = img_smp.glsl_binding_n;
+        img_smps[i].name = st.str(img_smp.name);
+        img_smps[i].image_name = st.str(img_smp.image_name);
+        img_smps[i].sampler_name = st.str(img_smp.sampler_name);
+    }
+    dst.image_samplers = img_smps;
+    dst.num_image_samplers = (int)src.image_samplers.size();
+}
+
+static void to_c_attrs(ResultStorage& st, const std::array<StageAttr, StageAttr::Num>& src, const shdc_attr*& out_attrs, int& out_num) {
+    int num = 0;
+    for (const StageAttr& attr: src) {
+        if (attr.slot >= 0) {
+            num++;
+        }
+    }
+    shdc_attr* attrs = st.array<shdc_attr>(num);
+    int i = 0;
+    for (const StageAttr& attr: src) {
+        if (attr.slot >= 0) {
+            attrs[i].slot = attr.slot;
+            attrs[i].name = st.str(attr.name);
+            attrs[i].sem_name = st.str(attr.sem_name);
+            attrs[i].sem_index = attr.sem_index;
+            attrs[i].type = (shdc_base_type)attr.type_info.type;
+            i++;
+        }
+    }
+    out_attrs = attrs;
+    out_num = num;
+}
+
+static void to_c_stage(ResultStorage& st, const Pipeline& pip, const StageReflection& src, shdc_stage& dst) {
+    dst.snippet_name = st.str(src.snippet_name);
+    dst.stage = (shdc_shader_stage)src.stage;
+    to_c_attrs(st, src.inputs, dst.inputs, dst.num_inputs);
+    to_c_attrs(st, src.outputs, dst.outputs, dst.num_outputs);
+    to_c_bindings(st, src.bindings, dst.bindings);
+    for (int i = 0; i < SHDC_SLANGINDEX_NUM; i++) {
+        const Slang::Enum slang = Slang::from_index(i);
+        const SpirvcrossSource* src_code = pip.spirvcross[i].find_source_by_snippet_index(src.snippet_index);
+        if (nullptr == src_code) {
+            continue;
+        }
+        shdc_code& code = dst.code[i];
+        code.valid = true;
+        code.source = st.str(src_code->source_code);
+        code.entry_point = st.str(src.entry_point_by_slang(slang));
+        const BytecodeBlob* blob = pip.bytecode[i].find_blob_by_snippet_index(src.snippet_index);
+        if (blob && blob->valid) {
+            uint8_t* data = st.array<uint8_t>(blob->data.size());
+            if (data) {
+                memcpy(data, blob->data.data(), blob->data.size());
+            }
+            code.bytecode.ptr = data;
+            code.bytecode.size = blob->data.size();
+        }
+    }
+}
+
+static bool load_from_filesystem(const std::string& path, std::string& out_content) {
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (!fp) {
+        return false;
+    }
+    char buf[4096];
+    size_t num_bytes = 0;
+    while ((num_bytes = fread(buf, 1, sizeof(buf), fp)) > 0) {
+        out_content.append(buf, num_bytes);
+    }
+    fclose(fp);
+    return true;
+}
+
+void shdc_setup(void) {
+    Spirv::initialize_spirv_tools();
+}
+
+void shdc_shutdown(void) {
+    Spirv::finalize_spirv_tools();
+}
+
+shdc_result* shdc_compile(const shdc_desc* desc) {
+    assert(desc && desc->path);
+    ResultStorage* st = new ResultStorage();
+    shdc_result* res = st->array<shdc_result>(1);
+    res->_private = st;
+
+    Args args;
+    args.input = desc->path;
+    args.slang = desc->slang & ((1<<SHDC_SLANGINDEX_NUM) - 1);
+    args.byte_code = desc->bytecode;
+    if (desc->module) {
+        args.module = desc->module;
+    }
+    for (int i = 0; i < desc->num_defines; i++) {
+        args.defines.push_back(desc->defines[i]);
+    }
+    if (desc->tmpdir) {
+        args.tmpdir = desc->tmpdir;
+        if (!args.tmpdir.empty() && (args.tmpdir.back() != '/')) {
+            args.tmpdir += "/";
+        }
+    }
+
+    // the input file comes from desc.source if provided, everything else from the
+    // load_file callback, or from the filesystem if no callback was provided
+    const std::string base_path = desc->path;
+    Input::LoadFileFunc load_file = nullptr;
+    if ((desc->source.ptr && (desc->source.size > 0)) || desc->load_file) {
+        load_file = [desc, &base_path](const std::string& path, std::string& out_content) -> bool {
+            if ((path == base_path) && desc->source.ptr && (desc->source.size > 0)) {
+                out_content.assign((const char*)desc->source.ptr, desc->source.size);
+                return true;
+            }
+            if (desc->load_file) {
+                shdc_range content = { };
+                if (desc->load_file(path.c_str(), &content, desc->user_data) && content.ptr) {
+                    out_content.assign((const char*)content.ptr, content.size);
+                    return true;
+                }
+                return false;
+            }
+            return load_from_filesystem(path, out_content);
+        };
+    }
+
+    Pipeline pip;
+    if (args.slang == 0) {
+        pip.messages.push_back(ErrMsg::error(args.input, 0, "no shader languages in shdc_desc.slang"));
+    } else {
+        pip = Pipeline::run(args, load_file);
+    }
+
+    shdc_message* msgs = st->array<shdc_message>(pip.messages.size());
+    for (size_t i = 0; i < pip.messages.size(); i++) {
+        const ErrMsg& err = pip.messages[i];
+        msgs[i].error = (err.type == ErrMsg::ERROR);
+        msgs[i].file = st->str(err.file);
+        msgs[i].line = (err.line_index >= 0) ? (err.line_index + 1) : 0;
+        msgs[i].msg = st->str(err.msg);
+    }
+    res->messages = msgs;
+    res->num_messages = (int)pip.messages.size();
+    res->valid = pip.valid;
+    if (pip.valid) {
+        res->module = st->str(pip.inp.module);
+        shdc_program* progs = st->array<shdc_program>(pip.refl.progs.size());
+        for (size_t i = 0; i < pip.refl.progs.size(); i++) {
+            const ProgramReflection& prog = pip.refl.progs[i];
+            progs[i].name = st->str(prog.name);
+            to_c_stage(*st, pip, prog.vs(), progs[i].vs);
+            to_c_stage(*st, pip, prog.fs(), progs[i].fs);
+            to_c_bindings(*st, prog.bindings, progs[i].bindings);
+        }
+        res->programs = progs;
+        res->num_programs = (int)pip.refl.progs.size();
+        to_c_bindings(*st, pip.refl.bindings, res->bindings);
+    }
+    return res;
+}
+
+void shdc_free_result(shdc_result* result) {
+    if (result) {
+        delete (ResultStorage*)result->_private;
+    }
+}
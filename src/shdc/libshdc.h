@@ -0,0 +1,320 @@
+#if !defined(LIBSHDC_H)
+#define LIBSHDC_H
+/*
+    libshdc.h -- C API for embedding the sokol-shdc compiler into other programs
+
+    Compiles an annotated GLSL file (see docs/sokol-shdc.md) into per-slang
+    shader sources (and bytecode where supported) and returns the result
+    together with the shader reflection info as plain C structs. No output
+    files are written (except intermediate files for Metal bytecode
+    compilation).
+
+    Usage:
+
+        shdc_setup();   // once at startup
+
+        shdc_desc desc = {0};
+        desc.path = "shaders/triangle.glsl";
+        desc.source.ptr = src;
+        desc.source.size = strlen(src);
+        desc.load_file = my_include_callback;   // optional
+        desc.slang = SHDC_SLANG_GLSL430 | SHDC_SLANG_METAL_MACOS;
+        shdc_result* res = shdc_compile(&desc);
+        if (res->valid) {
+            const shdc_program* prog = &res->programs[0];
+            const char* vs_src = prog->vs.code[SHDC_SLANGINDEX_GLSL430].source;
+            ...
+        } else {
+            for (int i = 0; i < res->num_messages; i++) { ... }
+        }
+        shdc_free_result(res);
+
+        shdc_shutdown();    // once at shutdown
+
+    shdc_compile() is reentrant, multiple threads may compile concurrently
+    between shdc_setup() and shdc_shutdown(). When compiling Metal bytecode
+    concurrently, each thread needs to provide its own desc.tmpdir.
+*/
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// output shader languages, bit mask values for shdc_desc.slang
+typedef enum shdc_slang {
+    SHDC_SLANG_GLSL410 = (1<<0),
+    SHDC_SLANG_GLSL430 = (1<<1),
+    SHDC_SLANG_GLSL300ES = (1<<2),
+    SHDC_SLANG_HLSL4 = (1<<3),
+    SHDC_SLANG_HLSL5 = (1<<4),
+    SHDC_SLANG_METAL_MACOS = (1<<5),
+    SHDC_SLANG_METAL_IOS = (1<<6),
+    SHDC_SLANG_METAL_SIM = (1<<7),
+    SHDC_SLANG_WGSL = (1<<8),
+    SHDC_SLANG_SPIRV_VK = (1<<9),
+    SHDC_SLANG_SPIRV_GL = (1<<10),
+} shdc_slang;
+
+// output shader languages, array index values for shdc_stage.code[]
+typedef enum shdc_slang_index {
+    SHDC_SLANGINDEX_GLSL410 = 0,
+    SHDC_SLANGINDEX_GLSL430,
+    SHDC_SLANGINDEX_GLSL300ES,
+    SHDC_SLANGINDEX_HLSL4,
+    SHDC_SLANGINDEX_HLSL5,
+    SHDC_SLANGINDEX_METAL_MACOS,
+    SHDC_SLANGINDEX_METAL_IOS,
+    SHDC_SLANGINDEX_METAL_SIM,
+    SHDC_SLANGINDEX_WGSL,
+    SHDC_SLANGINDEX_SPIRV_VK,
+    SHDC_SLANGINDEX_SPIRV_GL,
+    SHDC_SLANGINDEX_NUM,
+} shdc_slang_index;
+
+typedef enum shdc_shader_stage {
+    SHDC_SHADERSTAGE_VERTEX = 0,
+    SHDC_SHADERSTAGE_FRAGMENT,
+    SHDC_SHADERSTAGE_NUM,
+} shdc_shader_stage;
+
+typedef enum shdc_base_type {
+    SHDC_BASETYPE_INVALID,
+    SHDC_BASETYPE_BOOL,
+    SHDC_BASETYPE_BOOL2,
+    SHDC_BASETYPE_BOOL3,
+    SHDC_BASETYPE_BOOL4,
+    SHDC_BASETYPE_INT,
+    SHDC_BASETYPE_INT2,
+    SHDC_BASETYPE_INT3,
+    SHDC_BASETYPE_INT4,
+    SHDC_BASETYPE_UINT,
+    SHDC_BASETYPE_UINT2,
+    SHDC_BASETYPE_UINT3,
+    SHDC_BASETYPE_UINT4,
+    SHDC_BASETYPE_FLOAT,
+    SHDC_BASETYPE_FLOAT2,
+    SHDC_BASETYPE_FLOAT3,
+    SHDC_BASETYPE_FLOAT4,
+    SHDC_BASETYPE_MAT2X1,
+    SHDC_BASETYPE_MAT2X2,
+    SHDC_BASETYPE_MAT2X3,
+    SHDC_BASETYPE_MAT2X4,
+    SHDC_BASETYPE_MAT3X1,
+    SHDC_BASETYPE_MAT3X2,
+    SHDC_BASETYPE_MAT3X3,
+    SHDC_BASETYPE_MAT3X4,
+    SHDC_BASETYPE_MAT4X1,
+    SHDC_BASETYPE_MAT4X2,
+    SHDC_BASETYPE_MAT4X3,
+    SHDC_BASETYPE_MAT4X4,
+    SHDC_BASETYPE_STRUCT,
+} shdc_base_type;
+
+typedef enum shdc_image_type {
+    SHDC_IMAGETYPE_INVALID,
+    SHDC_IMAGETYPE_2D,
+    SHDC_IMAGETYPE_CUBE,
+    SHDC_IMAGETYPE_3D,
+    SHDC_IMAGETYPE_ARRAY,
+} shdc_image_type;
+
+typedef enum shdc_image_sample_type {
+    SHDC_IMAGESAMPLETYPE_INVALID,
+    SHDC_IMAGESAMPLETYPE_FLOAT,
+    SHDC_IMAGESAMPLETYPE_SINT,
+    SHDC_IMAGESAMPLETYPE_UINT,
+    SHDC_IMAGESAMPLETYPE_DEPTH,
+    SHDC_IMAGESAMPLETYPE_UNFILTERABLE_FLOAT,
+} shdc_image_sample_type;
+
+typedef enum shdc_sampler_type {
+    SHDC_SAMPLERTYPE_INVALID,
+    SHDC_SAMPLERTYPE_FILTERING,
+    SHDC_SAMPLERTYPE_COMPARISON,
+    SHDC_SAMPLERTYPE_NONFILTERING,
+} shdc_sampler_type;
+
+typedef struct shdc_range {
+    const void* ptr;
+    size_t size;
+} shdc_range;
+
+/*
+    Callback to load the input file (if shdc_desc.source is empty) and @include
+    files. Return false if the file doesn't exist. The content must stay valid
+    until the callback is called again or shdc_compile() returns, so the same
+    buffer may be reused for each call.
+*/
+typedef bool (*shdc_load_file_func)(const char* path, shdc_range* out_content, void* user_data);
+
+typedef struct shdc_desc {
+    const char* path;               // path of the input file, used for resolving @include and in error messages
+    shdc_range source;              // optional input file content, otherwise loaded via load_file or from the filesystem
+    shdc_load_file_func load_file;  // optional file loader callback, default is loading from the filesystem
+    void* user_data;                // passed into load_file
+    uint32_t slang;                 // combined shdc_slang bits
+    const char* module;             // optional @module name override
+    const char** defines;           // optional preprocessor defines
+    int num_defines;
+    bool bytecode;                  // compile to bytecode where supported (HLSL on Windows, Metal on macOS)
+    const char* tmpdir;             // directory for intermediate files (only used for Metal bytecode)
+} shdc_desc;
+
+// an error or warning message
+typedef struct shdc_message {
+    bool error;
+    const char* file;
+    int line;                       // 1-based line number
+    const char* msg;
+} shdc_message;
+
+// uniform block member or storage buffer struct item, may be nested
+typedef struct shdc_type {
+    const char* name;
+    const char* struct_typename;
+    shdc_base_type type;
+    bool is_matrix;
+    bool is_array;
+    int offset;
+    int size;
+    int align;
+    int matrix_stride;
+    int array_count;                // may be zero for unbounded arrays
+    int array_stride;
+    const struct shdc_type* struct_items;
+    int num_struct_items;
+} shdc_type;
+
+typedef struct shdc_uniform_block {
+    shdc_shader_stage stage;
+    int sokol_slot;
+    int hlsl_register_b_n;
+    int msl_buffer_n;
+    int wgsl_group0_binding_n;
+    int spirv_set0_binding_n;
+    const char* name;
+    const char* inst_name;
+    bool flattened;
+    shdc_type struct_info;
+} shdc_uniform_block;
+
+typedef struct shdc_storage_buffer {
+    shdc_shader_stage stage;
+    int sokol_slot;
+    int hlsl_register_t_n;
+    int msl_buffer_n;
+    int wgsl_group1_binding_n;
+    int spirv_set1_binding_n;
+    int glsl_binding_n;
+    const char* name;
+    const char* inst_name;
+    bool readonly;
+    shdc_type struct_info;
+} shdc_storage_buffer;
+
+typedef struct shdc_image {
+    shdc_shader_stage stage;
+    int sokol_slot;
+    int hlsl_register_t_n;
+    int msl_texture_n;
+    int wgsl_group1_binding_n;
+    int spirv_set1_binding_n;
+    const char* name;
+    shdc_image_type type;
+    shdc_image_sample_type sample_type;
+    bool multisampled;
+} shdc_image;
+
+typedef struct shdc_sampler {
+    shdc_shader_stage stage;
+    int sokol_slot;
+    int hlsl_register_s_n;
+    int msl_sampler_n;
+    int wgsl_group1_binding_n;
+    int spirv_set1_binding_n;
+    const char* name;
+    shdc_sampler_type type;
+} shdc_sampler;
+
+typedef struct shdc_image_sampler {
+    shdc_shader_stage stage;
+    int sokol_slot;
+    int glsl_binding_n;
+    const char* name;
+    const char* image_name;
+    const char* sampler_name;
+} shdc_image_sampler;
+
+typedef struct shdc_bindings {
+    const shdc_uniform_block* uniform_blocks;
+    int num_uniform_blocks;
+    const shdc_storage_buffer* storage_buffers;
+    int num_storage_buffers;
+    const shdc_image* images;
+    int num_images;
+    const shdc_sampler* samplers;
+    int num_samplers;
+    const shdc_image_sampler* image_samplers;
+    int num_image_samplers;
+} shdc_bindings;
+
+// a vertex shader input or fragment shader output/input
+typedef struct shdc_attr {
+    int slot;
+    const char* name;
+    const char* sem_name;
+    int sem_index;
+    shdc_base_type type;
+} shdc_attr;
+
+// the shader code of one stage for one output shader language
+typedef struct shdc_code {
+    bool valid;                     // false if this slang wasn't requested
+    const char* source;             // zero-terminated source code
+    shdc_range bytecode;            // only if bytecode was requested and supported for the slang
+    const char* entry_point;
+} shdc_code;
+
+typedef struct shdc_stage {
+    const char* snippet_name;
+    shdc_shader_stage stage;
+    const shdc_attr* inputs;
+    int num_inputs;
+    const shdc_attr* outputs;
+    int num_outputs;
+    shdc_bindings bindings;
+    shdc_code code[SHDC_SLANGINDEX_NUM];
+} shdc_stage;
+
+typedef struct shdc_program {
+    const char* name;
+    shdc_stage vs;
+    shdc_stage fs;
+    shdc_bindings bindings;         // merged vertex- and fragment-stage bindings
+} shdc_program;
+
+typedef struct shdc_result {
+    bool valid;                     // false if there was an error, check messages
+    const shdc_message* messages;   // errors and warnings
+    int num_messages;
+    const char* module;             // value of the @module tag
+    const shdc_program* programs;
+    int num_programs;
+    shdc_bindings bindings;         // merged bindings across all programs
+    void* _private;
+} shdc_result;
+
+// one-time setup and shutdown
+void shdc_setup(void);
+void shdc_shutdown(void);
+// compile annotated GLSL, never returns a null pointer, free the result with shdc_free_result()
+shdc_result* shdc_compile(const shdc_desc* desc);
+void shdc_free_result(shdc_result* result);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif // LIBSHDC_H
@@ -1,131 +1,213 @@
 /*
     sokol-shdc main source file.
 */
+#include <chrono>
+#include <map>
+#include <new>
+#include <stdlib.h>
+#include "pystring.h"
 #include "spirv.h"
 #include "args.h"
-#include "input.h"
-#include "spirvcross.h"
-#include "bytecode.h"
-#include "reflection.h"
+#include "pipeline.h"
+#include "stats.h"
+#include "allocstats.h"
+#include "watch.h"
+#include "sharedtypes.h"
+#include "distrib.h"
+#include "types/compile_cache.h"
 #include "generators/generate.h"
 
 using namespace shdc;
 using namespace shdc::refl;
 using namespace shdc::gen;
 
-int main(int argc, const char** argv) {
-    Spirv::initialize_spirv_tools();
+// count heap allocations for --alloc-stats, this is only replaced in the executable
+// so that programs linking the shdc library keep their own allocator
+void* operator new(size_t size) {
+    AllocStats::count(size);
+    void* ptr = malloc((size > 0) ? size : 1);
+    if (nullptr == ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
 
-    // parse command line args
-    const Args args = Args::parse(argc, argv);
-    if (args.debug_dump) {
-        args.dump_debug();
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+// run the whole compilation pipeline once, cache is optional (only used in watch mode),
+// out_filenames receives the input file and all its @include files
+static int compile(const Args& args, CompileCache* cache, std::vector<std::string>& out_filenames) {
+    const Pipeline pip = Pipeline::run(args, nullptr, cache);
+    if (!pip.inp.filenames.empty()) {
+        out_filenames = pip.inp.filenames;
     }
-    if (!args.valid) {
-        return args.exit_code;
+    pip.print_messages(args.error_format);
+    if (!pip.valid) {
+        return 10;
     }
 
-    // load the source and parse tagged blocks
-    Input inp = Input::load_and_parse(args.input, args.module);
-    if (args.debug_dump) {
-        inp.dump_debug(args.error_format);
-    }
-    if (inp.out_error.valid()) {
-        inp.out_error.print(args.error_format);
+    // generate output files
+    const GenInput gen_input(args, pip.inp, pip.spirvcross, pip.bytecode, pip.refl);
+    ErrMsg gen_error = generate(args.output_format, gen_input);
+    if (gen_error.valid()) {
+        gen_error.print(args.error_format);
         return 10;
     }
+    AllocStats::end_phase("generate");
 
-    // compile source snippets to SPIRV blobs (multiple compilations is necessary
-    // because of conditional compilation by target language)
-    std::array<Spirv,Slang::Num> spirv;
-    for (int i = 0; i < Slang::Num; i++) {
-        Slang::Enum slang = Slang::from_index(i);
-        if (args.slang & Slang::bit(slang)) {
-            spirv[i] = Spirv::compile_glsl_and_extract_bindings(inp, slang, args.defines);
-            if (args.debug_dump) {
-                spirv[i].dump_debug(inp, args.error_format);
-            }
-            if (!spirv[i].errors.empty()) {
-                bool has_errors = false;
-                for (const ErrMsg& err: spirv[i].errors) {
-                    if (err.type == ErrMsg::ERROR) {
-                        has_errors = true;
-                    }
-                    err.print(args.error_format);
-                }
-                if (has_errors) {
-                    return 10;
-                }
-            }
-            if (args.save_intermediate_spirv) {
-                if (!spirv[i].write_to_file(args, inp, slang)) {
-                    return 10;
-                }
-            }
+    // optional shader cost statistics
+    if (!args.stats.empty()) {
+        const Stats stats = Stats::build(args, pip.spirv, pip.spirvcross, pip.bytecode, pip.refl);
+        ErrMsg stats_error = stats.write(args, pip.inp);
+        if (stats_error.valid()) {
+            stats_error.print(args.error_format);
+            return 10;
         }
+        AllocStats::end_phase("stats");
     }
 
-    // cross-translate SPIRV to shader dialects
-    std::array<Spirvcross,Slang::Num> spirvcross;
-    for (int i = 0; i < Slang::Num; i++) {
-        Slang::Enum slang = Slang::from_index(i);
-        if (args.slang & Slang::bit(slang)) {
-            spirvcross[i] = Spirvcross::translate(inp, spirv[i], slang);
-            if (args.debug_dump) {
-                spirvcross[i].dump_debug(args.error_format, slang);
-            }
-            if (spirvcross[i].error.valid()) {
-                spirvcross[i].error.print(args.error_format);
-                return 10;
-            }
+    // success
+    return 0;
+}
+
+// compile all input files, write the uniform blocks and storage buffers of all
+// inputs into a shared header, and one header per input file which includes it
+static int compile_shared_types(const Args& args) {
+    std::vector<Pipeline> pips;
+    std::vector<Args> input_args;
+    // each input is written to [output dir]/[input filename].h, inputs from different
+    // directories with the same filename would silently overwrite each other
+    std::map<std::string, std::string> output_to_input = { { args.shared_types, "--shared-types" } };
+    for (const std::string& input: args.inputs) {
+        const std::string output = pystring::os::path::join(args.output, pystring::os::path::basename(input) + ".h");
+        const auto it = output_to_input.find(output);
+        if (it != output_to_input.end()) {
+            fmt::print(stderr, "sokol-shdc: '{}' and '{}' would both be written to '{}'\n", it->second, input, output);
+            return 10;
         }
+        output_to_input[output] = input;
     }
-
-    // compile shader-byte code if requested (HLSL / Metal)
-    std::array<Bytecode, Slang::Num> bytecode;
-    if (args.byte_code) {
-        for (int i = 0; i < Slang::Num; i++) {
-            Slang::Enum slang = Slang::from_index(i);
-            if (args.slang & Slang::bit(slang)) {
-                bytecode[i] = Bytecode::compile(args, inp, spirvcross[i], slang);
-                if (args.debug_dump) {
-                    bytecode[i].dump_debug();
-                }
-                if (!bytecode[i].errors.empty()) {
-                    bool has_errors = false;
-                    for (const ErrMsg& err: bytecode[i].errors) {
-                        if (err.type == ErrMsg::ERROR) {
-                            has_errors = true;
-                        }
-                        err.print(args.error_format);
-                    }
-                    if (has_errors) {
-                        return 10;
-                    }
-                }
-            }
+    for (const std::string& input: args.inputs) {
+        Args input_arg = args;
+        input_arg.input = input;
+        input_arg.output = pystring::os::path::join(args.output, pystring::os::path::basename(input) + ".h");
+        pips.push_back(Pipeline::run(input_arg));
+        pips.back().print_messages(args.error_format);
+        if (!pips.back().valid) {
+            return 10;
         }
+        input_args.push_back(std::move(input_arg));
     }
-
-    // build merged Reflection info
-    const Reflection refl = Reflection::build(args, inp, spirvcross);
-    if (refl.error.valid()) {
-        refl.error.print(args.error_format);
+    const SharedTypes shared = SharedTypes::build(pips);
+    if (shared.error.valid()) {
+        shared.error.print(args.error_format);
         return 10;
     }
-    if (args.debug_dump) {
-        refl.dump_debug(args.error_format);
-    }
+    AllocStats::end_phase("sharedtypes");
 
-    // generate output files
-    const GenInput gen_input(args, inp, spirvcross, bytecode, refl);
-    ErrMsg gen_error = generate(args.output_format, gen_input);
+    // the shared header takes the @header, @module and @ctype tags from the first input
+    Args shared_args = args;
+    shared_args.output = args.shared_types;
+    GenInput shared_gen_input(shared_args, pips[0].inp, pips[0].spirvcross, pips[0].bytecode, pips[0].refl);
+    shared_gen_input.shared_types = &shared.bindings;
+    ErrMsg gen_error = generate_shared_types(args.output_format, shared_gen_input, shared.inputs);
     if (gen_error.valid()) {
         gen_error.print(args.error_format);
         return 10;
     }
-
-    // success
-    Spirv::finalize_spirv_tools();
+    for (size_t i = 0; i < pips.size(); i++) {
+        GenInput gen_input(input_args[i], pips[i].inp, pips[i].spirvcross, pips[i].bytecode, pips[i].refl);
+        gen_input.shared_types = &shared.bindings;
+        gen_error = generate(args.output_format, gen_input);
+        if (gen_error.valid()) {
+            gen_error.print(args.error_format);
+            return 10;
+        }
+    }
+    AllocStats::end_phase("generate");
     return 0;
 }
+
+// recompile whenever the input file or one of its @include files changes,
+// only modified snippets go through glslang and SPIRV-Cross again
+static int watch(const Args& args) {
+    CompileCache cache;
+    std::vector<std::string> filenames = { args.input };
+    // start watching before the first compilation, so that no change gets lost
+    Watch watcher;
+    if (!watcher.set_paths(filenames)) {
+        fmt::print(stderr, "sokol-shdc: failed to watch input files\n");
+        return 10;
+    }
+    for (;;) {
+        const auto start = std::chrono::steady_clock::now();
+        cache.begin();
+        const int res = compile(args, &cache, filenames);
+        if (res == 0) {
+            // only drop stale cache entries after a successful run, so that fixing
+            // an error doesn't require recompiling everything
+            cache.end();
+        }
+        const auto end = std::chrono::steady_clock::now();
+        const long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+        fmt::print(stderr, "sokol-shdc: {} '{}' in {} ms ({} of {} snippet compilations reused), watching for changes...\n",
+            (res == 0) ? "compiled" : "failed to compile", args.input, ms, cache.hits, cache.hits + cache.misses);
+        if (!watcher.set_paths(filenames) || !watcher.wait_for_change()) {
+            fmt::print(stderr, "sokol-shdc: failed to watch input files\n");
+            return 10;
+        }
+    }
+}
+
+int main(int argc, const char** argv) {
+    Spirv::initialize_spirv_tools();
+
+    // parse command line args
+    const Args args = Args::parse(argc, argv);
+    if (args.debug_dump) {
+        args.dump_debug();
+    }
+    if (!args.valid) {
+        return args.exit_code;
+    }
+
+    if (args.alloc_stats) {
+        AllocStats::begin();
+    }
+    int res = 0;
+    if (!args.worker.empty()) {
+        res = Distrib::run_worker(args);
+    } else if (!args.batch.empty()) {
+        res = Distrib::run_batch(args);
+    } else if (args.watch) {
+        res = watch(args);
+    } else if (!args.shared_types.empty()) {
+        res = compile_shared_types(args);
+    } else {
+        std::vector<std::string> filenames;
+        res = compile(args, nullptr, filenames);
+    }
+    AllocStats::end();
+    if (res == 0) {
+        Spirv::finalize_spirv_tools();
+    }
+    return res;
+}
@@ -0,0 +1,160 @@
+/*
+    run the compilation pipeline: load and parse the input file, compile
+    snippets to SPIRV, translate SPIRV to target languages, compile to
+    bytecode and build the reflection info
+*/
+#include "pipeline.h"
+#include "allocstats.h"
+#include "layout.h"
+#include "precision.h"
+#include "unused.h"
+#include "vertexformats.h"
+#include "varyings.h"
+
+namespace shdc {
+
+using namespace refl;
+
+// append errors and warnings, return true if there was at least one error
+static bool add_messages(const std::vector<ErrMsg>& errors, std::vector<ErrMsg>& out_messages) {
+    bool has_errors = false;
+    for (const ErrMsg& err: errors) {
+        if (err.type == ErrMsg::ERROR) {
+            has_errors = true;
+        }
+        out_messages.push_back(err);
+    }
+    return has_errors;
+}
+
+Pipeline Pipeline::run(const Args& args, const Input::LoadFileFunc& load_file, CompileCache* cache) {
+    Pipeline res;
+
+    // load the source and parse tagged blocks
+    res.inp = Input::load_and_parse(args.input, args.module, load_file);
+    if (args.debug_dump) {
+        res.inp.dump_debug(args.error_format);
+    }
+    if (res.inp.out_error.valid()) {
+        res.messages.push_back(res.inp.out_error);
+        return res;
+    }
+
+    // apply @optimize_layout tags by reordering uniform block members in the source
+    ErrMsg layout_error = Layout::apply_optimize_layout_tags(res.inp);
+    if (layout_error.valid()) {
+        res.messages.push_back(layout_error);
+        return res;
+    }
+    AllocStats::end_phase("input");
+
+    // compile source snippets to SPIRV blobs (multiple compilations is necessary
+    // because of conditional compilation by target language)
+    bool unroll_checked = false;
+    for (int i = 0; i < Slang::Num; i++) {
+        Slang::Enum slang = Slang::from_index(i);
+        if (args.slang & Slang::bit(slang)) {
+            res.spirv[i] = Spirv::compile_glsl_and_extract_bindings(res.inp, slang, args.defines, cache);
+            if (args.debug_dump) {
+                res.spirv[i].dump_debug(res.inp, args.error_format);
+            }
+            if (add_messages(res.spirv[i].errors, res.messages)) {
+                return res;
+            }
+            // loops are only unrolled for the non-WebGL slangs, check the first of those
+            if (!unroll_checked && (slang != Slang::GLSL300ES) && (slang != Slang::WGSL)) {
+                add_messages(res.spirv[i].check_unrolled_loops(res.inp), res.messages);
+                unroll_checked = true;
+            }
+            if (args.pack_varyings) {
+                ErrMsg pack_error = Varyings::pack(res.inp, res.spirv[i]);
+                if (pack_error.valid()) {
+                    res.messages.push_back(pack_error);
+                    return res;
+                }
+            }
+            if (args.infer_mediump && (slang == Slang::GLSL300ES)) {
+                add_messages(Precision::infer_mediump(res.inp, res.spirv[i]), res.messages);
+            }
+            if (args.save_intermediate_spirv) {
+                if (!res.spirv[i].write_to_file(args, res.inp, slang)) {
+                    return res;
+                }
+            }
+        }
+    }
+
+    AllocStats::end_phase("spirv");
+
+    // cross-translate SPIRV to shader dialects
+    for (int i = 0; i < Slang::Num; i++) {
+        Slang::Enum slang = Slang::from_index(i);
+        if (args.slang & Slang::bit(slang)) {
+            res.spirvcross[i] = Spirvcross::translate(res.inp, res.spirv[i], slang, cache);
+            if (args.debug_dump) {
+                res.spirvcross[i].dump_debug(args.error_format, slang);
+            }
+            if (res.spirvcross[i].error.valid()) {
+                res.messages.push_back(res.spirvcross[i].error);
+                return res;
+            }
+        }
+    }
+
+    AllocStats::end_phase("spirvcross");
+
+    // compile shader-byte code if requested (HLSL / Metal), SPIRV output is always bytecode
+    for (int i = 0; i < Slang::Num; i++) {
+        Slang::Enum slang = Slang::from_index(i);
+        if ((args.slang & Slang::bit(slang)) && (args.byte_code || Slang::is_spirv(slang))) {
+            res.bytecode[i] = Bytecode::compile(args, res.inp, res.spirvcross[i], slang);
+            if (args.debug_dump) {
+                res.bytecode[i].dump_debug();
+            }
+            if (add_messages(res.bytecode[i].errors, res.messages)) {
+                return res;
+            }
+        }
+    }
+
+    AllocStats::end_phase("bytecode");
+
+    // build merged Reflection info
+    res.refl = Reflection::build(args, res.inp, res.spirvcross);
+    if (res.refl.error.valid()) {
+        res.messages.push_back(res.refl.error);
+        return res;
+    }
+    if (args.debug_dump) {
+        res.refl.dump_debug(args.error_format);
+    }
+    if (args.layout_report) {
+        add_messages(Layout::report(res.inp, res.refl), res.messages);
+    }
+    if (args.unused_report) {
+        add_messages(Unused::report(res.inp, res.refl), res.messages);
+    }
+    if (args.vertex_formats) {
+        // attribute usage doesn't depend on the output language, so the first SPIRV is good enough
+        for (int i = 0; i < Slang::Num; i++) {
+            if (args.slang & Slang::bit(Slang::from_index(i))) {
+                add_messages(VertexFormats::analyze(res.inp, res.spirv[i], res.refl), res.messages);
+                break;
+            }
+        }
+    }
+
+    AllocStats::end_phase("reflection");
+
+    // success
+    res.valid = true;
+    return res;
+}
+
+void Pipeline::print_messages(ErrMsg::Format err_fmt) const {
+    for (const ErrMsg& msg: messages) {
+        msg.print(err_fmt);
+    }
+}
+
+} // namespace shdc
@@ -0,0 +1,32 @@
+#pragma once
+#include <array>
+#include <vector>
+#include "args.h"
+#include "input.h"
+#include "spirv.h"
+#include "spirvcross.h"
+#include "bytecode.h"
+#include "reflection.h"
+#include "types/errmsg.h"
+#include "types/slang.h"
+#include "types/compile_cache.h"
+
+namespace shdc {
+
+// the compilation pipeline for one input file, everything except code generation
+struct Pipeline {
+    bool valid = false;
+    std::vector<ErrMsg> messages;   // errors and warnings in the order they happened
+    Input inp;
+    std::array<Spirv,Slang::Num> spirv;
+    std::array<Spirvcross,Slang::Num> spirvcross;
+    std::array<Bytecode,Slang::Num> bytecode;
+    refl::Reflection refl;
+
+    // load_file and cache are optional, check the valid and messages fields in the returned object
+    static Pipeline run(const Args& args, const Input::LoadFileFunc& load_file = nullptr, CompileCache* cache = nullptr);
+    // print all errors and warnings to stderr
+    void print_messages(ErrMsg::Format err_fmt) const;
+};
+
+} // namespace shdc
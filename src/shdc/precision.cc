@@ -0,0 +1,652 @@
+/*
+    Infer mediump precision for fragment shader values by value range analysis.
+*/
+#include "precision.h"
+#include "spirvutil.h"
+#include "GLSL.std.450.h"
+#include "fmt/format.h"
+#include "pystring.h"
+#include <algorithm>
+#include <map>
+#include <set>
+#include <math.h>
+
+namespace shdc {
+
+using namespace refl;
+
+// the smallest mediump range guaranteed by GLSL ES 3.00 is (-2^14, 2^14)
+static const double mediump_max = 16384.0;
+
+// after this many changes the range of a value is widened to unbounded, this guarantees termination for loops
+static const int max_range_changes = 8;
+
+// the value range of a float or of all components of a float vector, empty if lo > hi
+struct Range {
+    double lo = INFINITY;
+    double hi = -INFINITY;
+
+    static Range of(double lo, double hi) {
+        Range r;
+        r.lo = lo;
+        r.hi = hi;
+        return r;
+    }
+    static Range unbounded() {
+        return of(-INFINITY, INFINITY);
+    }
+    bool empty() const {
+        return lo > hi;
+    }
+    bool fits_mediump() const {
+        return !empty() && (lo >= -mediump_max) && (hi <= mediump_max);
+    }
+    double abs_max() const {
+        return std::max(-lo, hi);
+    }
+    bool operator==(const Range& other) const {
+        return (lo == other.lo) && (hi == other.hi);
+    }
+    bool operator!=(const Range& other) const {
+        return !(*this == other);
+    }
+};
+
+static Range range_union(const Range& a, const Range& b) {
+    if (a.empty()) {
+        return b;
+    }
+    if (b.empty()) {
+        return a;
+    }
+    return Range::of(std::min(a.lo, b.lo), std::max(a.hi, b.hi));
+}
+
+static Range range_neg(const Range& a) {
+    if (a.empty()) {
+        return a;
+    }
+    return Range::of(-a.hi, -a.lo);
+}
+
+static Range range_add(const Range& a, const Range& b) {
+    if (a.empty() || b.empty()) {
+        return Range();
+    }
+    return Range::of(a.lo + b.lo, a.hi + b.hi);
+}
+
+static Range range_sub(const Range& a, const Range& b) {
+    return range_add(a, range_neg(b));
+}
+
+// a multiplication where zero times infinity is zero
+static double mul_bound(double x, double y) {
+    return ((x == 0.0) || (y == 0.0)) ? 0.0 : x * y;
+}
+
+static Range range_mul(const Range& a, const Range& b) {
+    if (a.empty() || b.empty()) {
+        return Range();
+    }
+    const double p[4] = { mul_bound(a.lo, b.lo), mul_bound(a.lo, b.hi), mul_bound(a.hi, b.lo), mul_bound(a.hi, b.hi) };
+    return Range::of(*std::min_element(p, p + 4), *std::max_element(p, p + 4));
+}
+
+static Range range_div(const Range& a, const Range& b) {
+    if (a.empty() || b.empty()) {
+        return Range();
+    }
+    if ((b.lo > 0.0) || (b.hi < 0.0)) {
+        return range_mul(a, Range::of(1.0 / b.hi, 1.0 / b.lo));
+    }
+    return Range::unbounded();
+}
+
+static Range range_min(const Range& a, const Range& b) {
+    if (a.empty() || b.empty()) {
+        return Range();
+    }
+    return Range::of(std::min(a.lo, b.lo), std::min(a.hi, b.hi));
+}
+
+static Range range_max(const Range& a, const Range& b) {
+    if (a.empty() || b.empty()) {
+        return Range();
+    }
+    return Range::of(std::max(a.lo, b.lo), std::max(a.hi, b.hi));
+}
+
+static Range range_abs(const Range& a) {
+    if (a.empty() || (a.lo >= 0.0)) {
+        return a;
+    }
+    if (a.hi <= 0.0) {
+        return range_neg(a);
+    }
+    return Range::of(0.0, a.abs_max());
+}
+
+// sum of n products, as in dot()
+static Range range_dot(const Range& a, const Range& b, uint32_t n) {
+    const Range p = range_mul(a, b);
+    return range_mul(p, Range::of(n, n));
+}
+
+static bool is_image_sample_op(uint32_t op) {
+    return (op >= spv::OpImageSampleImplicitLod) && (op <= spv::OpImageDrefGather) && (op != spv::OpImageFetch);
+}
+
+// sampling ops with a depth-comparison result in the range 0..1
+static bool is_image_dref_op(uint32_t op) {
+    return (op == spv::OpImageSampleDrefImplicitLod) || (op == spv::OpImageSampleDrefExplicitLod)
+        || (op == spv::OpImageSampleProjDrefImplicitLod) || (op == spv::OpImageSampleProjDrefExplicitLod)
+        || (op == spv::OpImageDrefGather);
+}
+
+// the module state needed for the range analysis
+struct Module {
+    std::vector<SpvInstr> instrs;
+    int first_function_index = 0;
+    uint32_t glsl_ext_id = 0;
+    std::map<uint32_t, uint32_t> float_types;       // float32 scalar and vector type id => number of components
+    std::map<uint32_t, uint32_t> value_types;       // result id => type id
+    std::map<uint32_t, Range> constants;
+    std::set<uint32_t> results;                     // all result ids inside functions
+    std::map<uint32_t, uint32_t> pointer_bases;     // pointer id => variable id
+    std::map<uint32_t, uint32_t> image_sources;     // loaded image or sampled image id => image variable id
+    std::map<uint32_t, std::string> names;
+    std::set<uint32_t> relaxed;                     // ids which are already RelaxedPrecision
+    std::set<uint32_t> builtins;
+    std::set<uint32_t> tracked_vars;                // float function variables and fragment shader outputs
+    std::map<uint32_t, Range> ranges;               // value and tracked variable ranges
+    std::map<uint32_t, int> num_changes;
+
+    bool is_float_value(uint32_t id) const {
+        const auto it = value_types.find(id);
+        return (it != value_types.end()) && (float_types.count(it->second) > 0);
+    }
+    uint32_t num_components(uint32_t id) const {
+        const auto it = value_types.find(id);
+        return (it != value_types.end()) && (float_types.count(it->second) > 0) ? float_types.at(it->second) : 4;
+    }
+    uint32_t pointer_base(uint32_t id) const {
+        const auto it = pointer_bases.find(id);
+        return (it != pointer_bases.end()) ? it->second : id;
+    }
+    Range range(uint32_t id) const {
+        const auto const_it = constants.find(id);
+        if (const_it != constants.end()) {
+            return const_it->second;
+        }
+        const auto it = ranges.find(id);
+        if (it != ranges.end()) {
+            return it->second;
+        }
+        // float values and variables which haven't been computed yet (e.g. in loops) start as empty
+        // range, all other ids (e.g. matrix, struct or int values) are never computed and are unbounded
+        return (((results.count(id) > 0) && is_float_value(id)) || (tracked_vars.count(id) > 0)) ? Range() : Range::unbounded();
+    }
+    // merge a new range into a value or variable, returns true if the range has grown
+    bool update(uint32_t id, const Range& r) {
+        const Range old_range = range(id);
+        Range new_range = range_union(old_range, r);
+        if (new_range == old_range) {
+            return false;
+        }
+        if (++num_changes[id] > max_range_changes) {
+            new_range = Range::unbounded();
+        }
+        ranges[id] = new_range;
+        return true;
+    }
+};
+
+static Range eval_glsl_ext(const Module& m, const std::vector<uint32_t>& w) {
+    auto arg = [&m, &w](size_t i) { return m.range(w[5 + i]); };
+    switch (w[4]) {
+        case GLSLstd450Normalize:
+        case GLSLstd450Sin:
+        case GLSLstd450Cos:
+        case GLSLstd450FSign:
+            return Range::of(-1.0, 1.0);
+        case GLSLstd450Fract:
+        case GLSLstd450Step:
+        case GLSLstd450SmoothStep:
+            return Range::of(0.0, 1.0);
+        case GLSLstd450FAbs:
+            return range_abs(arg(0));
+        case GLSLstd450Floor:
+        case GLSLstd450Ceil:
+        case GLSLstd450Round:
+        case GLSLstd450RoundEven:
+        case GLSLstd450Trunc:
+            if (arg(0).empty()) {
+                return Range();
+            }
+            return Range::of(floor(arg(0).lo), ceil(arg(0).hi));
+        case GLSLstd450Sqrt:
+            if (arg(0).empty()) {
+                return Range();
+            }
+            return Range::of(sqrt(std::max(arg(0).lo, 0.0)), sqrt(std::max(arg(0).hi, 0.0)));
+        case GLSLstd450Exp:
+            if (arg(0).empty()) {
+                return Range();
+            }
+            return Range::of(exp(arg(0).lo), exp(arg(0).hi));
+        case GLSLstd450Exp2:
+            if (arg(0).empty()) {
+                return Range();
+            }
+            return Range::of(exp2(arg(0).lo), exp2(arg(0).hi));
+        case GLSLstd450FMin:
+        case GLSLstd450NMin:
+            return range_min(arg(0), arg(1));
+        case GLSLstd450FMax:
+        case GLSLstd450NMax:
+            return range_max(arg(0), arg(1));
+        case GLSLstd450FClamp:
+        case GLSLstd450NClamp:
+            return range_min(range_max(arg(0), arg(1)), arg(2));
+        case GLSLstd450FMix:
+            if ((arg(2).lo >= 0.0) && (arg(2).hi <= 1.0)) {
+                return range_union(arg(0), arg(1));
+            }
+            return range_add(range_mul(arg(0), range_sub(Range::of(1.0, 1.0), arg(2))), range_mul(arg(1), arg(2)));
+        case GLSLstd450Fma:
+            return range_add(range_mul(arg(0), arg(1)), arg(2));
+        case GLSLstd450Length:
+            if (arg(0).empty()) {
+                return Range();
+            }
+            return Range::of(0.0, sqrt((double)m.num_components(w[5])) * arg(0).abs_max());
+        case GLSLstd450Cross:
+            {
+                const Range p = range_mul(range_abs(arg(0)), range_abs(arg(1)));
+                if (p.empty()) {
+                    return Range();
+                }
+                return Range::of(-2.0 * p.hi, 2.0 * p.hi);
+            }
+        case GLSLstd450FaceForward:
+            if (arg(0).empty()) {
+                return Range();
+            }
+            return Range::of(-arg(0).abs_max(), arg(0).abs_max());
+        case GLSLstd450Reflect:
+            {
+                // I - 2 * dot(N, I) * N
+                const Range d = range_dot(arg(1), arg(0), m.num_components(w[5]));
+                return range_sub(arg(0), range_mul(Range::of(2.0, 2.0), range_mul(d, arg(1))));
+            }
+        default:
+            return Range::unbounded();
+    }
+}
+
+static Range eval(const Module& m, const std::vector<uint32_t>& w, const std::function<bool(const std::string&)>& is_normalized_image) {
+    const uint32_t op = w[0] & 0xFFFF;
+    switch (op) {
+        case spv::OpLoad:
+            {
+                const uint32_t var_id = m.pointer_base(w[3]);
+                return (m.tracked_vars.count(var_id) > 0) ? m.range(var_id) : Range::unbounded();
+            }
+        case spv::OpCopyObject:
+        case spv::OpFConvert:
+        case spv::OpCompositeExtract:
+            return m.range(w[3]);
+        case spv::OpFNegate:
+            return range_neg(m.range(w[3]));
+        case spv::OpFAdd:
+            return range_add(m.range(w[3]), m.range(w[4]));
+        case spv::OpFSub:
+            return range_sub(m.range(w[3]), m.range(w[4]));
+        case spv::OpFMul:
+        case spv::OpVectorTimesScalar:
+            return range_mul(m.range(w[3]), m.range(w[4]));
+        case spv::OpFDiv:
+            return range_div(m.range(w[3]), m.range(w[4]));
+        case spv::OpDot:
+            return range_dot(m.range(w[3]), m.range(w[4]), m.num_components(w[3]));
+        case spv::OpCompositeInsert:
+        case spv::OpVectorShuffle:
+            return range_union(m.range(w[3]), m.range(w[4]));
+        case spv::OpSelect:
+            return range_union(m.range(w[4]), m.range(w[5]));
+        case spv::OpCompositeConstruct:
+            {
+                Range r;
+                for (size_t i = 3; i < w.size(); i++) {
+                    r = range_union(r, m.range(w[i]));
+                }
+                return r;
+            }
+        case spv::OpPhi:
+            {
+                Range r;
+                for (size_t i = 3; i < w.size(); i += 2) {
+                    r = range_union(r, m.range(w[i]));
+                }
+                return r;
+            }
+        case spv::OpExtInst:
+            if (w[3] == m.glsl_ext_id) {
+                return eval_glsl_ext(m, w);
+            }
+            return Range::unbounded();
+        default:
+            if (is_image_dref_op(op)) {
+                return Range::of(0.0, 1.0);
+            }
+            if (is_image_sample_op(op)) {
+                const auto it = m.image_sources.find(w[3]);
+                if ((it != m.image_sources.end()) && (m.names.count(it->second) > 0) && is_normalized_image(m.names.at(it->second))) {
+                    return Range::of(-1.0, 1.0);
+                }
+            }
+            return Range::unbounded();
+    }
+}
+
+Precision::Result Precision::infer_mediump_spirv(std::vector<uint32_t>& words, const std::function<bool(const std::string&)>& is_normalized_image) {
+    Result res;
+    Module m;
+    if (!spv_split(words, m.instrs)) {
+        return res;
+    }
+    const std::vector<SpvInstr>& instrs = m.instrs;
+
+    // gather types, constants, names, decorations and variables
+    int num_entry_points = 0;
+    uint32_t execution_model = 0;
+    std::map<uint32_t, uint32_t> scalar_float_types;
+    std::map<uint32_t, std::pair<uint32_t,uint32_t>> pointer_types;    // id => (storage class, pointee type)
+    std::map<uint32_t, uint32_t> variables;                             // id => storage class
+    std::set<uint32_t> type_ids;
+    m.first_function_index = (int)instrs.size();
+    for (int i = 0; i < (int)instrs.size(); i++) {
+        const std::vector<uint32_t>& w = instrs[i].words;
+        const uint32_t op = instrs[i].op();
+        if (op == spv::OpFunction) {
+            m.first_function_index = i;
+            break;
+        }
+        if ((op >= spv::OpTypeVoid) && (op <= spv::OpTypeForwardPointer)) {
+            type_ids.insert(w[1]);
+        }
+        switch (op) {
+            case spv::OpEntryPoint:
+                execution_model = w[1];
+                num_entry_points++;
+                break;
+            case spv::OpExtInstImport:
+                if (spv_literal_string(w, 2) == "GLSL.std.450") {
+                    m.glsl_ext_id = w[1];
+                }
+                break;
+            case spv::OpName:
+                m.names[w[1]] = spv_literal_string(w, 2);
+                break;
+            case spv::OpDecorate:
+                if (w[2] == spv::DecorationRelaxedPrecision) {
+                    m.relaxed.insert(w[1]);
+                } else if (w[2] == spv::DecorationBuiltIn) {
+                    m.builtins.insert(w[1]);
+                }
+                break;
+            case spv::OpTypeFloat:
+                if (w[2] == 32) {
+                    m.float_types[w[1]] = 1;
+                }
+                break;
+            case spv::OpTypeVector:
+                if (m.float_types.count(w[2]) > 0) {
+                    m.float_types[w[1]] = w[3];
+                }
+                break;
+            case spv::OpTypePointer:
+                pointer_types[w[1]] = { w[2], w[3] };
+                break;
+            case spv::OpConstant:
+                m.value_types[w[2]] = w[1];
+                if ((m.float_types.count(w[1]) > 0) && (w.size() == 4)) {
+                    float f;
+                    memcpy(&f, &w[3], sizeof(f));
+                    m.constants[w[2]] = Range::of(f, f);
+                }
+                break;
+            case spv::OpConstantComposite:
+                m.value_types[w[2]] = w[1];
+                if (m.float_types.count(w[1]) > 0) {
+                    Range r;
+                    for (size_t k = 3; k < w.size(); k++) {
+                        r = range_union(r, m.range(w[k]));
+                    }
+                    m.constants[w[2]] = r;
+                }
+                break;
+            case spv::OpVariable:
+                variables[w[2]] = w[3];
+                m.value_types[w[2]] = w[1];
+                break;
+            default:
+                break;
+        }
+    }
+    if ((num_entry_points != 1) || (execution_model != spv::ExecutionModelFragment)) {
+        return res;
+    }
+
+    // instructions with a result type and result id
+    auto has_result = [&type_ids](const std::vector<uint32_t>& w) {
+        return (w.size() >= 3) && (type_ids.count(w[1]) > 0);
+    };
+
+    // gather function results, pointer bases, image sources and tracked variables
+    auto is_float_pointer = [&](uint32_t ptr_type_id) {
+        const auto it = pointer_types.find(ptr_type_id);
+        return (it != pointer_types.end()) && (m.float_types.count(it->second.second) > 0);
+    };
+    for (const auto& [var_id, storage_class]: variables) {
+        if ((storage_class == spv::StorageClassOutput) && (m.builtins.count(var_id) == 0) && is_float_pointer(m.value_types[var_id])) {
+            m.tracked_vars.insert(var_id);
+        }
+    }
+    for (int i = m.first_function_index; i < (int)instrs.size(); i++) {
+        const std::vector<uint32_t>& w = instrs[i].words;
+        const uint32_t op = instrs[i].op();
+        if (has_result(w)) {
+            m.value_types[w[2]] = w[1];
+            m.results.insert(w[2]);
+        }
+        switch (op) {
+            case spv::OpVariable:
+                if ((w[3] == spv::StorageClassFunction) && is_float_pointer(w[1])) {
+                    m.tracked_vars.insert(w[2]);
+                }
+                break;
+            case spv::OpAccessChain:
+            case spv::OpInBoundsAccessChain:
+                m.pointer_bases[w[2]] = m.pointer_base(w[3]);
+                break;
+            case spv::OpLoad:
+                m.image_sources[w[2]] = m.pointer_base(w[3]);
+                break;
+            case spv::OpSampledImage:
+            case spv::OpImage:
+                if (m.image_sources.count(w[3]) > 0) {
+                    m.image_sources[w[2]] = m.image_sources[w[3]];
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    // variables which are used other than by loads, stores and access chains can't be tracked
+    for (int i = m.first_function_index; i < (int)instrs.size(); i++) {
+        const std::vector<uint32_t>& w = instrs[i].words;
+        const uint32_t op = instrs[i].op();
+        size_t first_operand = 1;
+        if ((op == spv::OpLoad) || (op == spv::OpAccessChain) || (op == spv::OpInBoundsAccessChain) || (op == spv::OpVariable)) {
+            first_operand = 4;
+        } else if (op == spv::OpStore) {
+            first_operand = 2;
+        }
+        for (size_t k = first_operand; k < w.size(); k++) {
+            const uint32_t var_id = m.pointer_base(w[k]);
+            if ((m.tracked_vars.count(var_id) > 0) && ((var_id == w[k]) || (m.pointer_bases.count(w[k]) > 0))) {
+                m.tracked_vars.erase(var_id);
+            }
+        }
+    }
+
+    // propagate value ranges until nothing changes anymore
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int i = m.first_function_index; i < (int)instrs.size(); i++) {
+            const std::vector<uint32_t>& w = instrs[i].words;
+            const uint32_t op = instrs[i].op();
+            if (op == spv::OpStore) {
+                const uint32_t var_id = m.pointer_base(w[1]);
+                if (m.tracked_vars.count(var_id) > 0) {
+                    changed |= m.update(var_id, m.range(w[2]));
+                }
+            } else if ((op == spv::OpVariable) && (w.size() > 4) && (m.tracked_vars.count(w[2]) > 0)) {
+                changed |= m.update(w[2], m.range(w[4]));
+            } else if (has_result(w) && (op != spv::OpVariable) && m.is_float_value(w[2])) {
+                changed |= m.update(w[2], eval(m, w, is_normalized_image));
+            }
+        }
+    }
+
+    // values which end up in texture coordinates, integer conversions or untracked
+    // memory stay highp, this is propagated backward through all instructions
+    std::map<uint32_t, int> defs;
+    std::map<uint32_t, std::vector<uint32_t>> stored_values;     // tracked variable => stored value ids
+    std::vector<uint32_t> worklist;
+    for (int i = m.first_function_index; i < (int)instrs.size(); i++) {
+        const std::vector<uint32_t>& w = instrs[i].words;
+        const uint32_t op = instrs[i].op();
+        if (has_result(w)) {
+            defs[w[2]] = i;
+        }
+        if (is_image_sample_op(op) || (op == spv::OpImageFetch) || (op == spv::OpImageRead)) {
+            worklist.insert(worklist.end(), w.begin() + 4, w.end());
+        } else if ((op == spv::OpConvertFToU) || (op == spv::OpConvertFToS)) {
+            worklist.push_back(w[3]);
+        } else if ((op == spv::OpFunctionCall) || (op == spv::OpReturnValue)) {
+            worklist.insert(worklist.end(), w.begin() + 1, w.end());
+        } else if (op == spv::OpStore) {
+            const uint32_t var_id = m.pointer_base(w[1]);
+            if (m.tracked_vars.count(var_id) > 0) {
+                stored_values[var_id].push_back(w[2]);
+            } else {
+                worklist.push_back(w[2]);
+            }
+        } else if ((op == spv::OpVariable) && (w.size() > 4)) {
+            stored_values[w[2]].push_back(w[4]);
+        }
+    }
+    std::set<uint32_t> highp;
+    while (!worklist.empty()) {
+        const uint32_t id = worklist.back();
+        worklist.pop_back();
+        if (highp.count(id) > 0) {
+            continue;
+        }
+        highp.insert(id);
+        if (m.tracked_vars.count(id) > 0) {
+            worklist.insert(worklist.end(), stored_values[id].begin(), stored_values[id].end());
+            continue;
+        }
+        const auto def_it = defs.find(id);
+        if (def_it == defs.end()) {
+            continue;
+        }
+        const std::vector<uint32_t>& w = instrs[def_it->second].words;
+        if (instrs[def_it->second].op() == spv::OpLoad) {
+            worklist.push_back(m.pointer_base(w[3]));
+        } else {
+            worklist.insert(worklist.end(), w.begin() + 3, w.end());
+        }
+    }
+
+    // decorate the demoted values and variables
+    std::vector<SpvInstr> new_decorations;
+    auto demote = [&](uint32_t id) {
+        new_decorations.push_back(spv_make_instr(spv::OpDecorate, { id, spv::DecorationRelaxedPrecision }));
+        res.num_demoted++;
+        if ((m.names.count(id) > 0) && !m.names[id].empty()) {
+            res.demoted_names.push_back(m.names[id]);
+        }
+    };
+    for (uint32_t var_id: m.tracked_vars) {
+        if (variables.count(var_id) > 0) {
+            res.num_float_values++;
+            if (m.range(var_id).fits_mediump() && (highp.count(var_id) == 0) && (m.relaxed.count(var_id) == 0)) {
+                demote(var_id);
+            }
+        }
+    }
+    for (int i = m.first_function_index; i < (int)instrs.size(); i++) {
+        const std::vector<uint32_t>& w = instrs[i].words;
+        if (!has_result(w)) {
+            continue;
+        }
+        const uint32_t id = w[2];
+        if ((instrs[i].op() == spv::OpVariable) && (m.tracked_vars.count(id) == 0)) {
+            continue;
+        }
+        if ((instrs[i].op() == spv::OpVariable) || m.is_float_value(id)) {
+            res.num_float_values++;
+            if (m.range(id).fits_mediump() && (highp.count(id) == 0) && (m.relaxed.count(id) == 0)) {
+                demote(id);
+            }
+        }
+    }
+    if (new_decorations.empty()) {
+        return res;
+    }
+
+    // insert the new decorations at the end of the annotation section
+    std::vector<SpvInstr> out_instrs;
+    bool decorations_added = false;
+    for (const SpvInstr& instr: instrs) {
+        const uint32_t op = instr.op();
+        if (!decorations_added && !spv_is_preamble_op(op) && !spv_is_debug_op(op) && !spv_is_annotation_op(op)) {
+            out_instrs.insert(out_instrs.end(), new_decorations.begin(), new_decorations.end());
+            decorations_added = true;
+        }
+        out_instrs.push_back(instr);
+    }
+    spv_join(out_instrs, words[3], words);
+    return res;
+}
+
+std::vector<ErrMsg> Precision::infer_mediump(const Input& inp, Spirv& spirv) {
+    // only textures tagged with @image_normalized have a known value range, everything
+    // else may have a float, HDR or depth pixel format
+    auto is_normalized_image = [&inp](const std::string& name) {
+        const ImageSampleTypeTag* tag = inp.find_image_sample_type_tag(name);
+        return (inp.image_normalized_tags.count(name) > 0) && ((tag == nullptr) || (tag->type == ImageSampleType::FLOAT));
+    };
+    std::vector<ErrMsg> res;
+    for (SpirvBlob& blob: spirv.blobs) {
+        const Result result = infer_mediump_spirv(blob.bytecode, is_normalized_image);
+        if (result.num_demoted > 0) {
+            const Snippet& snippet = inp.snippets[blob.snippet_index];
+            const int line_index = snippet.lines.empty() ? 0 : snippet.lines[0];
+            std::string msg = fmt::format("--infer-mediump: demoted {} of {} float values in '{}' to mediump", result.num_demoted, result.num_float_values, snippet.name);
+            if (!result.demoted_names.empty()) {
+                msg += fmt::format(" (variables: {})", pystring::join(", ", result.demoted_names));
+            }
+            res.push_back(inp.warning(line_index, msg));
+        }
+    }
+    return res;
+}
+
+} // namespace shdc
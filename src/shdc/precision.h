@@ -0,0 +1,26 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <functional>
+#include "input.h"
+#include "spirv.h"
+#include "types/errmsg.h"
+
+namespace shdc {
+
+// SPIRV transform which infers mediump precision for fragment shader values
+// and variables with a provably small value range, and decorates them
+// as RelaxedPrecision before the GLSL ES translation (--infer-mediump)
+struct Precision {
+    struct Result {
+        int num_float_values = 0;
+        int num_demoted = 0;
+        std::vector<std::string> demoted_names;     // names of demoted variables
+    };
+    // rewrite all fragment shader SPIRV blobs, returns a warning per snippet listing the demoted variables
+    static std::vector<ErrMsg> infer_mediump(const Input& inp, Spirv& spirv);
+    // rewrite a single SPIRV blob, is_normalized_image() tells whether sampled values of an image are in the range -1..+1
+    static Result infer_mediump_spirv(std::vector<uint32_t>& words, const std::function<bool(const std::string&)>& is_normalized_image);
+};
+
+} // namespace shdc
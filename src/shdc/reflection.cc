@@ -4,6 +4,7 @@
 #include "reflection.h"
 #include "spirvcross.h"
 #include "types/reflection/bindings.h"
+#include <set>
 
 // workaround for Compiler.comparison_ids being protected
 class UnprotectedCompiler: spirv_cross::Compiler {
@@ -72,6 +73,34 @@ static ErrMsg validate_linking(const Input& inp, const Program& prog, const Prog
     return ErrMsg();
 }
 
+// check that the storage buffers in @soa tags exist and only have scalar and vector members
+static ErrMsg validate_soa_tags(const Input& inp, const Bindings& bindings) {
+    for (const auto& [sbuf_name, line_index]: inp.soa_tags) {
+        const StorageBuffer* sbuf = nullptr;
+        for (const StorageBuffer& item: bindings.storage_buffers) {
+            if (item.name == sbuf_name) {
+                sbuf = &item;
+            }
+        }
+        if (sbuf == nullptr) {
+            return inp.error(line_index, fmt::format("@soa: storage buffer '{}' not found", sbuf_name));
+        }
+        for (const Type& member: sbuf->struct_info.struct_items[0].struct_items) {
+            if ((Type::num_components(member.type) == 0) || (member.array_count > 0) || (inp.ctype_map.count(member.type_as_glsl()) > 0)) {
+                return inp.error(line_index, fmt::format("@soa: member '{}' of storage buffer '{}' must be a scalar or vector without @ctype mapping", member.name, sbuf_name));
+            }
+        }
+        // vector components are split into <member>_x etc., which may clash with other members
+        std::set<std::string> soa_names;
+        for (const SoaMember& soa_member: sbuf->soa_members()) {
+            if (!soa_names.insert(soa_member.name).second) {
+                return inp.error(line_index, fmt::format("@soa: member name '{}' of storage buffer '{}' is generated more than once, rename the clashing members", soa_member.name, sbuf_name));
+            }
+        }
+    }
+    return ErrMsg();
+}
+
 Reflection Reflection::build(const Args& args, const Input& inp, const std::array<Spirvcross,Slang::Num>& spirvcross_array) {
     Reflection res;
     ErrMsg err;
@@ -93,7 +122,7 @@ Reflection Reflection::build(const Args& args, const Input& inp, const std::arra
         prog_refl.name = prog.name;
         prog_refl.stages[ShaderStage::Vertex] = vs_src->stage_refl;
         prog_refl.stages[ShaderStage::Fragment] = fs_src->stage_refl;
-        prog_refl.bindings = merge_bindings({ vs_src->stage_refl.bindings, fs_src->stage_refl.bindings }, true, err);
+        prog_refl.bindings = merge_bindings({ vs_src->stage_refl->bindings, fs_src->stage_refl->bindings }, true, err);
         if (err.valid()) {
             res.error = inp.error(prog.line_index, err.msg);
             return res;
@@ -110,7 +139,7 @@ Reflection Reflection::build(const Args& args, const Input& inp, const std::arra
         if (res.error.valid()) {
             return res;
         }
-        res.progs.push_back(prog_refl);
+        res.progs.push_back(std::move(prog_refl));
     }
 
     // create a merged set of resource bindings across all programs
@@ -120,7 +149,9 @@ Reflection Reflection::build(const Args& args, const Input& inp, const std::arra
     res.bindings = merge_bindings(prog_bindings, false, err);
     if (err.valid()) {
         res.error = inp.error(0, err.msg);
+        return res;
     }
+    res.error = validate_soa_tags(inp, res.bindings);
     return res;
 }
 
@@ -204,6 +235,8 @@ StageReflection Reflection::parse_snippet_reflection(const Compiler& compiler, c
     refl.snippet_name = snippet.name;
 
     ShaderResources shd_resources = compiler.get_shader_resources();
+    // variables which are actually accessed by the (optimized) shader code
+    const auto active_vars = compiler.get_active_interface_variables();
     // shader stage
     switch (compiler.get_execution_model()) {
         case spv::ExecutionModelVertex:   refl.stage = ShaderStage::Vertex; break;
@@ -227,6 +260,7 @@ StageReflection Reflection::parse_snippet_reflection(const Compiler& compiler, c
         refl_attr.sem_name = "TEXCOORD";
         refl_attr.sem_index = refl_attr.slot;
         refl_attr.type_info = get_type_for_attribute(compiler, res_attr);
+        refl_attr.used = active_vars.count(res_attr.id) > 0;
 
         refl.inputs[refl_attr.slot] = refl_attr;
     }
@@ -253,6 +287,7 @@ StageReflection Reflection::parse_snippet_reflection(const Compiler& compiler, c
         refl_ub.hlsl_register_b_n = slot + Bindings::base_slot(Slang::HLSL5, refl.stage, res_type);
         refl_ub.msl_buffer_n = slot + Bindings::base_slot(Slang::METAL_SIM, refl.stage, res_type);
         refl_ub.wgsl_group0_binding_n = slot + Bindings::base_slot(Slang::WGSL, refl.stage, res_type);
+        refl_ub.spirv_set0_binding_n = slot + Bindings::base_slot(Slang::SPIRV_VK, refl.stage, res_type);
         refl_ub.flattened = Spirvcross::can_flatten_uniform_block(compiler, ub_res);
         refl_ub.struct_info = parse_toplevel_struct(compiler, ub_res, out_error);
         if (out_error.valid()) {
@@ -260,13 +295,23 @@ StageReflection Reflection::parse_snippet_reflection(const Compiler& compiler, c
         }
         // uniform blocks always have 16 byte alignment
         refl_ub.struct_info.align = 16;
+        refl_ub.used = active_vars.count(ub_res.id) > 0;
+        refl_ub.used_members.resize(refl_ub.struct_info.struct_items.size(), false);
+        if (refl_ub.used) {
+            for (const BufferRange& range: compiler.get_active_buffer_ranges(ub_res.id)) {
+                if (range.index < refl_ub.used_members.size()) {
+                    refl_ub.used_members[range.index] = true;
+                }
+            }
+        }
         refl_ub.name = refl_ub.struct_info.name;
         refl_ub.sokol_slot = inp.find_ub_slot(refl_ub.name);
         if (refl_ub.sokol_slot == -1) {
             out_error = inp.error(0, fmt::format("no binding found for uniformblock '{}' (might be unused in shader code?)\n", refl_ub.name));
             return refl;
         }
-        refl.bindings.uniform_blocks.push_back(refl_ub);
+        refl_ub.hash = refl_ub.compute_hash();
+        refl.bindings.add_uniform_block(refl_ub);
     }
     // storage buffers
     for (const Resource& sbuf_res: shd_resources.storage_buffers) {
@@ -291,11 +336,15 @@ StageReflection Reflection::parse_snippet_reflection(const Compiler& compiler, c
         refl_sbuf.hlsl_register_t_n = slot + Bindings::base_slot(Slang::HLSL5, refl.stage, res_type);
         refl_sbuf.msl_buffer_n = slot + Bindings::base_slot(Slang::METAL_SIM, refl.stage, res_type);
         refl_sbuf.wgsl_group1_binding_n = slot + Bindings::base_slot(Slang::WGSL, refl.stage, res_type);
+        refl_sbuf.spirv_set1_binding_n = slot + Bindings::base_slot(Slang::SPIRV_VK, refl.stage, res_type);
         // SPECIAL CASE GL: the GL storage buffer bind slot is identical with the sokol-bind slot
         // since GL also has a common bindspace across shader stages for storage buffers
         refl_sbuf.glsl_binding_n = refl_sbuf.sokol_slot;
         refl_sbuf.readonly = compiler.get_buffer_block_flags(sbuf_res.id).get(spv::DecorationNonWritable);
-        refl.bindings.storage_buffers.push_back(refl_sbuf);
+        refl_sbuf.used = active_vars.count(sbuf_res.id) > 0;
+        refl_sbuf.soa = inp.soa_tags.count(refl_sbuf.name) > 0;
+        refl_sbuf.hash = refl_sbuf.compute_hash();
+        refl.bindings.add_storage_buffer(refl_sbuf);
     }
 
     // (separate) images
@@ -307,6 +356,7 @@ StageReflection Reflection::parse_snippet_reflection(const Compiler& compiler, c
         refl_img.hlsl_register_t_n = slot + Bindings::base_slot(Slang::HLSL5, refl.stage, res_type);
         refl_img.msl_texture_n = slot + Bindings::base_slot(Slang::METAL_SIM, refl.stage, res_type);
         refl_img.wgsl_group1_binding_n = slot + Bindings::base_slot(Slang::WGSL, refl.stage, res_type);
+        refl_img.spirv_set1_binding_n = slot + Bindings::base_slot(Slang::SPIRV_VK, refl.stage, res_type);
         refl_img.name = img_res.name;
         const SPIRType& img_type = compiler.get_type(img_res.type_id);
         refl_img.type = spirtype_to_image_type(img_type);
@@ -316,12 +366,13 @@ StageReflection Reflection::parse_snippet_reflection(const Compiler& compiler, c
             refl_img.sample_type = spirtype_to_image_sample_type(compiler.get_type(img_type.image.type));
         }
         refl_img.multisampled = spirtype_to_image_multisampled(img_type);
+        refl_img.used = active_vars.count(img_res.id) > 0;
         refl_img.sokol_slot = inp.find_img_slot(refl_img.name);
         if (refl_img.sokol_slot == -1) {
             out_error = inp.error(0, fmt::format("no binding found for image '{}' (might be unused in shader code?)\n", refl_img.name));
             return refl;
         }
-        refl.bindings.images.push_back(refl_img);
+        refl.bindings.add_image(refl_img);
     }
     // (separate) samplers
     for (const Resource& smp_res: shd_resources.separate_samplers) {
@@ -333,6 +384,7 @@ StageReflection Reflection::parse_snippet_reflection(const Compiler& compiler, c
         refl_smp.hlsl_register_s_n = slot + Bindings::base_slot(Slang::HLSL5, refl.stage, res_type);
         refl_smp.msl_sampler_n = slot + Bindings::base_slot(Slang::METAL_SIM, refl.stage, res_type);
         refl_smp.wgsl_group1_binding_n = slot + Bindings::base_slot(Slang::WGSL, refl.stage, res_type);
+        refl_smp.spirv_set1_binding_n = slot + Bindings::base_slot(Slang::SPIRV_VK, refl.stage, res_type);
         refl_smp.name = smp_res.name;
         // HACK ALERT!
         if (((UnprotectedCompiler*)&compiler)->is_comparison_sampler(smp_type, smp_res.id)) {
@@ -340,22 +392,24 @@ StageReflection Reflection::parse_snippet_reflection(const Compiler& compiler, c
         } else {
             refl_smp.type = SamplerType::FILTERING;
         }
+        refl_smp.used = active_vars.count(smp_res.id) > 0;
         refl_smp.sokol_slot = inp.find_smp_slot(refl_smp.name);
         if (refl_smp.sokol_slot == -1) {
             out_error = inp.error(0, fmt::format("no binding found for sampler '{}' (might be unused in shader code?)\n", refl_smp.name));
             return refl;
         }
-        refl.bindings.samplers.push_back(refl_smp);
+        refl.bindings.add_sampler(refl_smp);
     }
     // combined image samplers
     for (auto& img_smp_res: compiler.get_combined_image_samplers()) {
         ImageSampler refl_img_smp;
         refl_img_smp.stage = refl.stage;
         refl_img_smp.sokol_slot = compiler.get_decoration(img_smp_res.combined_id, spv::DecorationBinding);
+        refl_img_smp.glsl_binding_n = refl_img_smp.sokol_slot + Bindings::base_slot(Slang::GLSL430, refl.stage, Bindings::Type::IMAGE_SAMPLER);
         refl_img_smp.name = compiler.get_name(img_smp_res.combined_id);
         refl_img_smp.image_name = compiler.get_name(img_smp_res.image_id);
         refl_img_smp.sampler_name = compiler.get_name(img_smp_res.sampler_id);
-        refl.bindings.image_samplers.push_back(refl_img_smp);
+        refl.bindings.add_image_sampler(refl_img_smp);
     }
     // patch textures with overridden image-sample-types
     for (auto& img: refl.bindings.images) {
@@ -383,13 +437,14 @@ Bindings Reflection::merge_bindings(const std::vector<Bindings>& in_bindings, bo
         for (const UniformBlock& ub: src_bindings.uniform_blocks) {
             const UniformBlock* other_ub = out_bindings.find_uniform_block_by_name(ub.name);
             if (other_ub) {
-                // another uniform block of the same name exists, make sure it's identical
-                if (!ub.equals(*other_ub)) {
+                // another uniform block of the same name exists, make sure it's identical,
+                // the deep comparison only needs to run if the structural hashes match
+                if ((ub.hash != other_ub->hash) || !ub.equals(*other_ub)) {
                     out_error = ErrMsg::error(fmt::format("conflicting uniform block definitions found for '{}'", ub.name));
                     return Bindings();
                 }
             } else {
-                out_bindings.uniform_blocks.push_back(ub);
+                out_bindings.add_uniform_block(ub);
             }
         }
 
@@ -398,12 +453,12 @@ Bindings Reflection::merge_bindings(const std::vector<Bindings>& in_bindings, bo
             const StorageBuffer* other_sbuf = out_bindings.find_storage_buffer_by_name(sbuf.name);
             if (other_sbuf) {
                 // another storage buffer of the same name exists, make sure it's identical
-                if (!sbuf.equals(*other_sbuf)) {
+                if ((sbuf.hash != other_sbuf->hash) || !sbuf.equals(*other_sbuf)) {
                     out_error = ErrMsg::error(fmt::format("conflicting storage buffer definitions found for '{}'", sbuf.name));
                     return Bindings();
                 }
             } else {
-                out_bindings.storage_buffers.push_back(sbuf);
+                out_bindings.add_storage_buffer(sbuf);
             }
         }
 
@@ -417,7 +472,7 @@ Bindings Reflection::merge_bindings(const std::vector<Bindings>& in_bindings, bo
                     return Bindings();
                 }
             } else {
-                out_bindings.images.push_back(img);
+                out_bindings.add_image(img);
             }
         }
 
@@ -431,7 +486,7 @@ Bindings Reflection::merge_bindings(const std::vector<Bindings>& in_bindings, bo
                     return Bindings();
                 }
             } else {
-                out_bindings.samplers.push_back(smp);
+                out_bindings.add_sampler(smp);
             }
         }
 
@@ -449,7 +504,7 @@ Bindings Reflection::merge_bindings(const std::vector<Bindings>& in_bindings, bo
                         return Bindings();
                     }
                 } else {
-                    out_bindings.image_samplers.push_back(img_smp);
+                    out_bindings.add_image_sampler(img_smp);
                 }
             }
         }
@@ -462,6 +517,7 @@ Bindings Reflection::merge_bindings(const std::vector<Bindings>& in_bindings, bo
         for (ImageSampler& img_smp: out_bindings.image_samplers) {
             img_smp.sokol_slot = sokol_slot++;
         }
+        out_bindings.rebuild_indexes();
     }
 
     return out_bindings;
@@ -0,0 +1,76 @@
+/*
+    Collect uniform blocks and storage buffers across input files into
+    a shared types header (--shared-types).
+*/
+#include "sharedtypes.h"
+#include "fmt/format.h"
+
+namespace shdc {
+
+using namespace refl;
+
+// structural hash of a struct type, ignoring per-file properties like the shader stage
+static uint64_t struct_hash(const Type& struct_info) {
+    Hash h;
+    struct_info.add_hash(h);
+    return h.value;
+}
+
+SharedTypes SharedTypes::build(const std::vector<Pipeline>& pips) {
+    SharedTypes res;
+    std::map<std::string, int> ub_sources;      // uniform block name => index of defining pipeline
+    std::map<std::string, int> sbuf_sources;    // storage buffer name => index of defining pipeline
+    for (int pip_index = 0; pip_index < (int)pips.size(); pip_index++) {
+        const Pipeline& pip = pips[pip_index];
+        res.inputs.push_back(pip.inp.base_path);
+        // the generated struct names and member types must be the same in all files
+        if (pip.inp.module != pips[0].inp.module) {
+            res.error = pip.inp.error(0, fmt::format("--shared-types: @module name '{}' differs from '{}' in '{}'",
+                pip.inp.module, pips[0].inp.module, pips[0].inp.base_path));
+            return res;
+        }
+        if (pip.inp.ctype_map != pips[0].inp.ctype_map) {
+            res.error = pip.inp.error(0, fmt::format("--shared-types: @ctype mappings differ from '{}'", pips[0].inp.base_path));
+            return res;
+        }
+        for (const UniformBlock& ub: pip.refl.bindings.uniform_blocks) {
+            const int i = res.bindings.uniform_block_index.find(ub.name);
+            if (i < 0) {
+                ub_sources[ub.name] = pip_index;
+                res.bindings.add_uniform_block(ub);
+                continue;
+            }
+            UniformBlock& other = res.bindings.uniform_blocks[i];
+            if ((struct_hash(ub.struct_info) != struct_hash(other.struct_info)) || !ub.struct_info.equals(other.struct_info)) {
+                res.error = pip.inp.error(0, fmt::format("--shared-types: uniform block '{}' differs from the definition in '{}'",
+                    ub.name, pips[ub_sources[ub.name]].inp.base_path));
+                return res;
+            }
+            if (ub.sokol_slot != other.sokol_slot) {
+                other.sokol_slot = -1;
+            }
+        }
+        for (const StorageBuffer& sbuf: pip.refl.bindings.storage_buffers) {
+            const int i = res.bindings.storage_buffer_index.find(sbuf.name);
+            if (i < 0) {
+                sbuf_sources[sbuf.name] = pip_index;
+                res.bindings.add_storage_buffer(sbuf);
+                continue;
+            }
+            StorageBuffer& other = res.bindings.storage_buffers[i];
+            if ((struct_hash(sbuf.struct_info) != struct_hash(other.struct_info)) || !sbuf.struct_info.equals(other.struct_info) || (sbuf.soa != other.soa)) {
+                res.error = pip.inp.error(0, fmt::format("--shared-types: storage buffer '{}' differs from the definition in '{}'",
+                    sbuf.name, pips[sbuf_sources[sbuf.name]].inp.base_path));
+                return res;
+            }
+            if (sbuf.sokol_slot != other.sokol_slot) {
+                other.sokol_slot = -1;
+            }
+        }
+    }
+    // the slot index must only contain consistent bind slots
+    res.bindings.rebuild_indexes();
+    return res;
+}
+
+} // namespace shdc
@@ -0,0 +1,21 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "pipeline.h"
+#include "types/errmsg.h"
+#include "types/reflection/bindings.h"
+
+namespace shdc {
+
+// uniform blocks and storage buffers collected across multiple input files
+// for a shared types header (--shared-types)
+struct SharedTypes {
+    ErrMsg error;
+    std::vector<std::string> inputs;    // all input file paths
+    refl::Bindings bindings;            // sokol_slot is -1 if the bind slot differs between input files
+
+    // collect and verify the uniform block and storage buffer definitions of all pipelines, error will be in .error
+    static SharedTypes build(const std::vector<Pipeline>& pips);
+};
+
+} // namespace shdc
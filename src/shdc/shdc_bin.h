@@ -0,0 +1,222 @@
+#if !defined(SHDC_BIN_H)
+#define SHDC_BIN_H
+/*
+    shdc_bin.h -- header-only reader for the sokol-shdc 'bare_bin' reflection format
+
+    The '-f bare_bin' output format writes the shader sources/blobs like
+    '-f bare' and additionally a binary reflection file
+    '[output]_[module_]reflection.bin' which can be mmap'ed or loaded into
+    memory in one go and accessed directly without parsing.
+
+    File layout:
+
+    - all values are 32-bit little-endian words, all records are 4-byte aligned
+    - references to other records are byte offsets from the start of the file
+    - arrays are (offset, num) pairs pointing to tightly packed records
+    - strings are offsets to zero-terminated UTF-8 strings, the empty string
+      is never offset 0
+    - enum values are identical with the shdc_* enums in libshdc.h
+
+    Usage:
+
+        const shdc_bin_header* hdr = shdc_bin_open(data, size);
+        if (hdr) {
+            const shdc_bin_program* prog = shdc_bin_find_program(hdr, "triangle");
+            const shdc_bin_code* code = shdc_bin_find_code(hdr, &prog->vs, SHDC_SLANGINDEX_GLSL430);
+            const char* path = shdc_bin_str(hdr, code->path);
+            const shdc_bin_uniform_block* ubs = SHDC_BIN_ITEMS(hdr, shdc_bin_uniform_block, prog->bindings.uniform_blocks);
+            for (uint32_t i = 0; i < prog->bindings.uniform_blocks.num; i++) {
+                ... ubs[i] ...
+            }
+        }
+
+    The data must stay valid and must be 4-byte aligned (mmap and malloc
+    always are). The reader functions assume a little-endian host.
+*/
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "libshdc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SHDC_BIN_MAGIC (0x4E494253)     // 'SBIN'
+#define SHDC_BIN_VERSION (2)
+
+// resolve an array reference into a typed pointer to its first item
+#define SHDC_BIN_ITEMS(hdr, type, arr) ((const type*)((const uint8_t*)(hdr) + (arr).offset))
+
+typedef struct shdc_bin_array {
+    uint32_t offset;
+    uint32_t num;
+} shdc_bin_array;
+
+// uniform block member or storage buffer struct item, struct_items contains shdc_bin_type items
+typedef struct shdc_bin_type {
+    uint32_t name;
+    uint32_t struct_typename;
+    uint32_t type;                  // shdc_base_type
+    uint32_t is_matrix;
+    uint32_t is_array;
+    int32_t offset;
+    int32_t size;
+    int32_t align;
+    int32_t matrix_stride;
+    int32_t array_count;            // may be zero for unbounded arrays
+    int32_t array_stride;
+    shdc_bin_array struct_items;
+} shdc_bin_type;
+
+typedef struct shdc_bin_uniform_block {
+    uint32_t stage;                 // shdc_shader_stage
+    int32_t sokol_slot;
+    int32_t hlsl_register_b_n;
+    int32_t msl_buffer_n;
+    int32_t wgsl_group0_binding_n;
+    int32_t spirv_set0_binding_n;
+    uint32_t name;
+    uint32_t inst_name;
+    uint32_t flattened;
+    shdc_bin_type struct_info;
+} shdc_bin_uniform_block;
+
+typedef struct shdc_bin_storage_buffer {
+    uint32_t stage;                 // shdc_shader_stage
+    int32_t sokol_slot;
+    int32_t hlsl_register_t_n;
+    int32_t msl_buffer_n;
+    int32_t wgsl_group1_binding_n;
+    int32_t spirv_set1_binding_n;
+    int32_t glsl_binding_n;
+    uint32_t name;
+    uint32_t inst_name;
+    uint32_t readonly;
+    shdc_bin_type struct_info;
+} shdc_bin_storage_buffer;
+
+typedef struct shdc_bin_image {
+    uint32_t stage;                 // shdc_shader_stage
+    int32_t sokol_slot;
+    int32_t hlsl_register_t_n;
+    int32_t msl_texture_n;
+    int32_t wgsl_group1_binding_n;
+    int32_t spirv_set1_binding_n;
+    uint32_t name;
+    uint32_t type;                  // shdc_image_type
+    uint32_t sample_type;           // shdc_image_sample_type
+    uint32_t multisampled;
+} shdc_bin_image;
+
+typedef struct shdc_bin_sampler {
+    uint32_t stage;                 // shdc_shader_stage
+    int32_t sokol_slot;
+    int32_t hlsl_register_s_n;
+    int32_t msl_sampler_n;
+    int32_t wgsl_group1_binding_n;
+    int32_t spirv_set1_binding_n;
+    uint32_t name;
+    uint32_t type;                  // shdc_sampler_type
+} shdc_bin_sampler;
+
+typedef struct shdc_bin_image_sampler {
+    uint32_t stage;                 // shdc_shader_stage
+    int32_t sokol_slot;
+    int32_t glsl_binding_n;
+    uint32_t name;
+    uint32_t image_name;
+    uint32_t sampler_name;
+} shdc_bin_image_sampler;
+
+typedef struct shdc_bin_bindings {
+    shdc_bin_array uniform_blocks;  // shdc_bin_uniform_block
+    shdc_bin_array storage_buffers; // shdc_bin_storage_buffer
+    shdc_bin_array images;          // shdc_bin_image
+    shdc_bin_array samplers;        // shdc_bin_sampler
+    shdc_bin_array image_samplers;  // shdc_bin_image_sampler
+} shdc_bin_bindings;
+
+typedef struct shdc_bin_attr {
+    int32_t slot;
+    uint32_t name;
+    uint32_t sem_name;
+    int32_t sem_index;
+    uint32_t type;                  // shdc_base_type
+} shdc_bin_attr;
+
+// per-slang output of a shader stage
+typedef struct shdc_bin_code {
+    uint32_t slang;                 // shdc_slang_index
+    uint32_t is_binary;             // path refers to a bytecode blob
+    uint32_t path;                  // path of the shader source or blob file
+    uint32_t entry_point;
+    uint32_t d3d11_target;          // only for HLSL, otherwise empty string
+} shdc_bin_code;
+
+typedef struct shdc_bin_stage {
+    uint32_t snippet_name;
+    uint32_t stage;                 // shdc_shader_stage
+    shdc_bin_array inputs;          // shdc_bin_attr
+    shdc_bin_array outputs;         // shdc_bin_attr
+    shdc_bin_bindings bindings;
+    shdc_bin_array code;            // shdc_bin_code, one per output slang
+} shdc_bin_stage;
+
+typedef struct shdc_bin_program {
+    uint32_t name;
+    shdc_bin_stage vs;
+    shdc_bin_stage fs;
+    shdc_bin_bindings bindings;     // merged vertex- and fragment-stage bindings
+} shdc_bin_program;
+
+typedef struct shdc_bin_header {
+    uint32_t magic;                 // SHDC_BIN_MAGIC
+    uint32_t version;               // SHDC_BIN_VERSION
+    uint32_t size;                  // overall file size in bytes
+    uint32_t slang_mask;            // combined shdc_slang bits
+    uint32_t module;                // value of the @module tag
+    shdc_bin_array programs;        // shdc_bin_program
+    shdc_bin_bindings bindings;     // merged bindings across all programs
+} shdc_bin_header;
+
+// validate the header and return a pointer to it, or NULL if the data isn't a compatible file
+static inline const shdc_bin_header* shdc_bin_open(const void* data, size_t size) {
+    if ((data == 0) || (size < sizeof(shdc_bin_header)) || (((uintptr_t)data) & 3)) {
+        return 0;
+    }
+    const shdc_bin_header* hdr = (const shdc_bin_header*)data;
+    if ((hdr->magic != SHDC_BIN_MAGIC) || (hdr->version != SHDC_BIN_VERSION) || (hdr->size > size)) {
+        return 0;
+    }
+    return hdr;
+}
+
+static inline const char* shdc_bin_str(const shdc_bin_header* hdr, uint32_t str) {
+    return (const char*)hdr + str;
+}
+
+static inline const shdc_bin_program* shdc_bin_find_program(const shdc_bin_header* hdr, const char* name) {
+    const shdc_bin_program* progs = SHDC_BIN_ITEMS(hdr, shdc_bin_program, hdr->programs);
+    for (uint32_t i = 0; i < hdr->programs.num; i++) {
+        if (0 == strcmp(shdc_bin_str(hdr, progs[i].name), name)) {
+            return &progs[i];
+        }
+    }
+    return 0;
+}
+
+static inline const shdc_bin_code* shdc_bin_find_code(const shdc_bin_header* hdr, const shdc_bin_stage* stage, shdc_slang_index slang) {
+    const shdc_bin_code* code = SHDC_BIN_ITEMS(hdr, shdc_bin_code, stage->code);
+    for (uint32_t i = 0; i < stage->code.num; i++) {
+        if (code[i].slang == (uint32_t)slang) {
+            return &code[i];
+        }
+    }
+    return 0;
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif // SHDC_BIN_H
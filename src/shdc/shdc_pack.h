@@ -0,0 +1,212 @@
+#if !defined(SHDC_PACK_H)
+#define SHDC_PACK_H
+/*
+    shdc_pack.h -- header-only reader for the sokol-shdc 'bare_pack' archive format
+
+    The '-f bare_pack' output format writes all shader sources and blobs of all
+    programs, stages and output shader languages, together with the binary
+    reflection info (see shdc_bin.h), into a single archive file
+    '[output]_[module_]shaders.pack'.
+
+    File layout:
+
+    - all values are 32-bit little-endian words
+    - the header is followed by the table of contents, which is an open-addressing
+      hash table with a power-of-2 number of slots, keyed by (program, stage, slang)
+      and looked up with shdc_pack_hash() and linear probing
+    - all payloads (and the embedded reflection data) are 16-byte aligned
+    - identical payloads are only stored once, multiple table-of-content
+      entries may point to the same payload
+    - source code payloads include a terminating zero byte
+    - with the '--compress' option, payloads are LZ4-compressed (raw LZ4 block
+      format) if that makes them smaller, check for SHDC_PACK_FLAG_COMPRESSED
+      and decompress with shdc_pack_decompress()
+
+    Usage:
+
+        const shdc_pack_header* pack = shdc_pack_open(data, size);
+        if (pack) {
+            const shdc_pack_entry* e = shdc_pack_find(pack, "triangle", SHDC_SHADERSTAGE_VERTEX, SHDC_SLANGINDEX_GLSL430);
+            if (e && !(e->flags & SHDC_PACK_FLAG_COMPRESSED)) {
+                const char* src = (const char*) shdc_pack_payload(pack, e);
+                ...
+            }
+            const shdc_bin_header* refl = shdc_pack_reflection(pack);
+            ...
+        }
+
+    The data must stay valid and must be 16-byte aligned for direct access
+    (mmap and most malloc implementations are). The reader functions assume
+    a little-endian host.
+*/
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "shdc_bin.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SHDC_PACK_MAGIC (0x4B415053)    // 'SPAK'
+#define SHDC_PACK_VERSION (1)
+#define SHDC_PACK_ALIGN (16)
+
+enum {
+    SHDC_PACK_FLAG_USED = (1<<0),       // table-of-content slot is used
+    SHDC_PACK_FLAG_BINARY = (1<<1),     // payload is bytecode, otherwise zero-terminated source code
+    SHDC_PACK_FLAG_COMPRESSED = (1<<2), // payload is LZ4-block-compressed
+};
+
+typedef struct shdc_pack_entry {
+    uint32_t hash;                  // shdc_pack_hash(program, stage, slang)
+    uint32_t program;               // offset of zero-terminated program name
+    uint32_t stage;                 // shdc_shader_stage
+    uint32_t slang;                 // shdc_slang_index
+    uint32_t flags;                 // SHDC_PACK_FLAG_*
+    uint32_t offset;                // payload offset
+    uint32_t size;                  // payload size in the file
+    uint32_t uncompressed_size;     // payload size after decompression
+} shdc_pack_entry;
+
+typedef struct shdc_pack_header {
+    uint32_t magic;                 // SHDC_PACK_MAGIC
+    uint32_t version;               // SHDC_PACK_VERSION
+    uint32_t size;                  // overall file size in bytes
+    uint32_t num_entries;           // number of used table-of-content slots
+    uint32_t toc_offset;            // offset of the shdc_pack_entry table
+    uint32_t toc_num_slots;         // power-of-2 number of table-of-content slots
+    uint32_t reflection_offset;     // offset of the embedded shdc_bin.h reflection data
+    uint32_t reflection_size;
+} shdc_pack_header;
+
+// FNV-1a hash over program name, stage and slang
+static inline uint32_t shdc_pack_hash(const char* program, uint32_t stage, uint32_t slang) {
+    uint32_t h = 0x811C9DC5;
+    while (*program) {
+        h = (h ^ (uint8_t)*program++) * 0x01000193;
+    }
+    h = (h ^ (stage & 0xFF)) * 0x01000193;
+    h = (h ^ (slang & 0xFF)) * 0x01000193;
+    return h;
+}
+
+// validate the header and return a pointer to it, or NULL if the data isn't a compatible file
+static inline const shdc_pack_header* shdc_pack_open(const void* data, size_t size) {
+    if ((data == 0) || (size < sizeof(shdc_pack_header)) || (((uintptr_t)data) & 3)) {
+        return 0;
+    }
+    const shdc_pack_header* hdr = (const shdc_pack_header*)data;
+    if ((hdr->magic != SHDC_PACK_MAGIC) || (hdr->version != SHDC_PACK_VERSION) || (hdr->size > size)) {
+        return 0;
+    }
+    return hdr;
+}
+
+static inline const shdc_pack_entry* shdc_pack_find(const shdc_pack_header* hdr, const char* program, shdc_shader_stage stage, shdc_slang_index slang) {
+    if (hdr->toc_num_slots == 0) {
+        return 0;
+    }
+    const shdc_pack_entry* toc = (const shdc_pack_entry*)((const uint8_t*)hdr + hdr->toc_offset);
+    const uint32_t mask = hdr->toc_num_slots - 1;
+    const uint32_t hash = shdc_pack_hash(program, (uint32_t)stage, (uint32_t)slang);
+    for (uint32_t i = 0; i < hdr->toc_num_slots; i++) {
+        const shdc_pack_entry* e = &toc[(hash + i) & mask];
+        if (0 == (e->flags & SHDC_PACK_FLAG_USED)) {
+            return 0;
+        }
+        if ((e->hash == hash)
+            && (e->stage == (uint32_t)stage)
+            && (e->slang == (uint32_t)slang)
+            && (0 == strcmp((const char*)hdr + e->program, program)))
+        {
+            return e;
+        }
+    }
+    return 0;
+}
+
+static inline const void* shdc_pack_payload(const shdc_pack_header* hdr, const shdc_pack_entry* e) {
+    return (const uint8_t*)hdr + e->offset;
+}
+
+static inline const shdc_bin_header* shdc_pack_reflection(const shdc_pack_header* hdr) {
+    return shdc_bin_open((const uint8_t*)hdr + hdr->reflection_offset, hdr->reflection_size);
+}
+
+// decompress a compressed payload into a buffer of at least e->uncompressed_size bytes, returns false on corrupt data
+static inline bool shdc_pack_decompress(const shdc_pack_header* hdr, const shdc_pack_entry* e, void* dst_ptr, size_t dst_size) {
+    const uint8_t* src = (const uint8_t*)shdc_pack_payload(hdr, e);
+    const size_t src_size = e->size;
+    uint8_t* dst = (uint8_t*)dst_ptr;
+    if (0 == (e->flags & SHDC_PACK_FLAG_COMPRESSED)) {
+        if (dst_size < src_size) {
+            return false;
+        }
+        memcpy(dst, src, src_size);
+        return true;
+    }
+    if (dst_size < e->uncompressed_size) {
+        return false;
+    }
+    dst_size = e->uncompressed_size;
+    size_t ip = 0;
+    size_t op = 0;
+    while (ip < src_size) {
+        const uint8_t token = src[ip++];
+        size_t num_literals = token >> 4;
+        if (num_literals == 15) {
+            uint8_t b;
+            do {
+                if (ip >= src_size) {
+                    return false;
+                }
+                b = src[ip++];
+                num_literals += b;
+            } while (b == 255);
+        }
+        if ((num_literals > (src_size - ip)) || (num_literals > (dst_size - op))) {
+            return false;
+        }
+        memcpy(dst + op, src + ip, num_literals);
+        ip += num_literals;
+        op += num_literals;
+        if (ip == src_size) {
+            // the last sequence only contains literals
+            break;
+        }
+        if ((src_size - ip) < 2) {
+            return false;
+        }
+        const size_t match_offset = (size_t)src[ip] | ((size_t)src[ip + 1] << 8);
+        ip += 2;
+        if ((match_offset == 0) || (match_offset > op)) {
+            return false;
+        }
+        size_t match_len = token & 15;
+        if (match_len == 15) {
+            uint8_t b;
+            do {
+                if (ip >= src_size) {
+                    return false;
+                }
+                b = src[ip++];
+                match_len += b;
+            } while (b == 255);
+        }
+        match_len += 4;
+        if (match_len > (dst_size - op)) {
+            return false;
+        }
+        // matches may overlap the output, so copy byte by byte
+        for (size_t i = 0; i < match_len; i++, op++) {
+            dst[op] = dst[op - match_offset];
+        }
+    }
+    return op == dst_size;
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif // SHDC_PACK_H
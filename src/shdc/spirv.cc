@@ -3,6 +3,8 @@
 */
 #include <stdlib.h>
 #include "spirv.h"
+#include "spirvutil.h"
+#include "types/hash.h"
 #include "fmt/format.h"
 #include "pystring.h"
 #include "ShaderLang.h"
@@ -34,7 +36,7 @@ static MergedSource merge_source(const Input& inp, const Snippet& snippet, Slang
     MergedSource res;
     res.linenr_offset += 1;
     res.src = "#version 450\n";
-    if (Slang::is_glsl(slang)) {
+    if (Slang::is_glsl(slang) || (slang == Slang::SPIRV_GL)) {
         res.linenr_offset += 1;
         res.src += "#define SOKOL_GLSL (1)\n";
     }
@@ -50,13 +52,33 @@ static MergedSource merge_source(const Input& inp, const Snippet& snippet, Slang
         res.linenr_offset += 1;
         res.src += "#define SOKOL_WGSL (1)\n";
     }
+    if (Slang::is_spirv(slang)) {
+        res.linenr_offset += 1;
+        res.src += "#define SOKOL_SPIRV (1)\n";
+    }
     for (const std::string& define : defines) {
         res.linenr_offset += 1;
         res.src += fmt::format("#define {} (1)\n", define);
     }
+    // @unroll and @dont_unroll are replaced with GL_EXT_control_flow_attributes loop attributes
+    std::string body;
+    bool has_loop_hints = false;
     for (int line_index : snippet.lines) {
-        res.src += fmt::format("{}\n", inp.lines[line_index].line);
+        const std::string& line = inp.lines[line_index].line;
+        // only lines with a tag need to be stripped, avoids a temporary string per line
+        const std::string tag = (line.find('@') != std::string::npos) ? pystring::strip(line) : std::string();
+        if ((tag == "@unroll") || (tag == "@dont_unroll")) {
+            has_loop_hints = true;
+            body.append("[[").append(tag, 1, std::string::npos).append("]]\n");
+        } else {
+            body.append(line).push_back('\n');
+        }
+    }
+    if (has_loop_hints) {
+        res.linenr_offset += 1;
+        res.src += "#extension GL_EXT_control_flow_attributes : require\n";
     }
+    res.src += body;
     return res;
 }
 
@@ -134,11 +156,17 @@ static void infolog_to_errors(const std::string& log, const Input& inp, int snip
     which translates to valid GLSL, but invalid WebGL GLSL - e.g. simple
     bounded for-loops are converted to what looks like an unbounded loop
     ("for (;;) { }") to WebGL
+
+    The pass recipe depends on the output shader language: GLSL300ES keeps
+    the WebGL-safe recipe, all other shader languages additionally get an SSA
+    rewrite, constant propagation and loop unrolling, so that bounded loops
+    marked with @unroll are fully unrolled and constant-folded
 */
 static void spirv_optimize(Slang::Enum slang, std::vector<uint32_t>& spirv) {
     if (slang == Slang::WGSL) {
         return;
     }
+    const bool webgl_safe = (slang == Slang::GLSL300ES);
     spv_target_env target_env;
     target_env = SPV_ENV_UNIVERSAL_1_2;
     spvtools::Optimizer optimizer(target_env);
@@ -157,6 +185,18 @@ static void spirv_optimize(Slang::Enum slang, std::vector<uint32_t>& spirv) {
     optimizer.RegisterPass(spvtools::CreateLocalAccessChainConvertPass());
     optimizer.RegisterPass(spvtools::CreateLocalSingleBlockLoadStoreElimPass());
     optimizer.RegisterPass(spvtools::CreateLocalSingleStoreElimPass());
+    if (!webgl_safe) {
+        // the loop analysis needs the induction variables in SSA form
+        optimizer.RegisterPass(spvtools::CreateLocalMultiStoreElimPass());
+        optimizer.RegisterPass(spvtools::CreateAggressiveDCEPass(true));
+        optimizer.RegisterPass(spvtools::CreateCCPPass());
+        optimizer.RegisterPass(spvtools::CreateAggressiveDCEPass(true));
+        // only unrolls loops with the Unroll loop control (@unroll)
+        optimizer.RegisterPass(spvtools::CreateLoopUnrollPass(true));
+        optimizer.RegisterPass(spvtools::CreateDeadBranchElimPass());
+        optimizer.RegisterPass(spvtools::CreateBlockMergePass());
+        optimizer.RegisterPass(spvtools::CreateCCPPass());
+    }
     optimizer.RegisterPass(spvtools::CreateSimplificationPass());
     optimizer.RegisterPass(spvtools::CreateAggressiveDCEPass(true));    // NOTE: call the "preserveInterface" version of CreateAggressiveDCEPass()
     optimizer.RegisterPass(spvtools::CreateVectorDCEPass());
@@ -165,9 +205,11 @@ static void spirv_optimize(Slang::Enum slang, std::vector<uint32_t>& spirv) {
     optimizer.RegisterPass(spvtools::CreateDeadBranchElimPass());
 // NOTE: it's the BlockMergePass which moves the init statement of a for-loop
 //       out of the for-statement, which makes it invalid for WebGL
-//    optimizer.RegisterPass(spvtools::CreateBlockMergePass());
-// NOTE: this is the pass which may create invalid WebGL code
-//    optimizer.RegisterPass(spvtools::CreateLocalMultiStoreElimPass());
+// NOTE: the LocalMultiStoreElimPass is the pass which may create invalid WebGL code
+    if (!webgl_safe) {
+        optimizer.RegisterPass(spvtools::CreateBlockMergePass());
+        optimizer.RegisterPass(spvtools::CreateLocalMultiStoreElimPass());
+    }
     optimizer.RegisterPass(spvtools::CreateIfConversionPass());
     optimizer.RegisterPass(spvtools::CreateSimplificationPass());
     optimizer.RegisterPass(spvtools::CreateAggressiveDCEPass(true));
@@ -182,8 +224,29 @@ static void spirv_optimize(Slang::Enum slang, std::vector<uint32_t>& spirv) {
     optimizer.Run(spirv.data(), spirv.size(), &spirv, spvOptOptions);
 }
 
+/* merge the bindings extracted from a snippet into Input, bindings of the same name must match */
+static bool merge_slots(const Input& inp, const char* kind, const std::map<std::string, int>& src, std::map<std::string, int>& dst, Spirv& out_spirv) {
+    for (const auto& item: src) {
+        const auto it = dst.find(item.first);
+        if (it == dst.end()) {
+            dst[item.first] = item.second;
+        } else if (it->second != item.second) {
+            out_spirv.errors.push_back(inp.error(0, fmt::format("different bindings for {} of same name '{}' ({} vs {})", kind, item.first, it->second, item.second)));
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool merge_bindings(Input& inp, const SpirvBlob& blob, Spirv& out_spirv) {
+    return merge_slots(inp, "uniform blocks", blob.ub_slots, inp.ub_slots, out_spirv)
+        && merge_slots(inp, "buffer blocks", blob.sbuf_slots, inp.sbuf_slots, out_spirv)
+        && merge_slots(inp, "samplers", blob.smp_slots, inp.smp_slots, out_spirv)
+        && merge_slots(inp, "textures", blob.img_slots, inp.img_slots, out_spirv);
+}
+
 /* compile a vertex or fragment shader to SPIRV */
-static bool compile(Input& inp, EShLanguage stage, Slang::Enum slang, const MergedSource& source, int snippet_index, Spirv& out_spirv) {
+static bool compile(Input& inp, EShLanguage stage, Slang::Enum slang, MergedSource& source, int snippet_index, Spirv& out_spirv) {
     const char* sources[1] = { source.src.c_str() };
     const int sourcesLen[1] = { (int) source.src.length() };
     const char* sourcesNames[1] = { inp.base_path.c_str() };
@@ -222,57 +285,30 @@ static bool compile(Input& inp, EShLanguage stage, Slang::Enum slang, const Merg
         return false;
     }
 
-    // extract binding information into Input
+    // extract binding information, merged into Input below
     bool refl_res = program.buildReflection(EShReflectionSeparateBuffers);
     if (!refl_res) {
         out_spirv.errors.push_back(inp.error(0, "program.buildReflection() failed!"));
     }
     for (int i = 0; i < program.getNumUniformBlocks(); i++) {
         const auto& ub = program.getUniformBlock(i);
-        const std::string& name = ub.name;
-        const int slot = inp.find_ub_slot(name);
-        const int binding = ub.getBinding();
-        if (slot == -1) {
-            inp.ub_slots[name] = binding;
-        } else if (slot != binding) {
-            out_spirv.errors.push_back(inp.error(0, fmt::format("different bindings for uniform blocks of same name '{}' ({} vs {})", name, slot, binding)));
-            return false;
-        }
+        spirv_blob.ub_slots[ub.name] = ub.getBinding();
     }
     for (int i = 0; i < program.getNumBufferBlocks(); i++) {
         const auto& sbuf = program.getBufferBlock(i);
-        const std::string& name = sbuf.name;
-        const int slot = inp.find_sbuf_slot(name);
-        const int binding = sbuf.getBinding();
-        if (slot == -1) {
-            inp.sbuf_slots[name] = binding;
-        } else if (slot != binding) {
-            out_spirv.errors.push_back(inp.error(0, fmt::format("different bindings for buffer blocks of same name '{}' ({} vs {})", name, slot, binding)));
-            return false;
-        }
+        spirv_blob.sbuf_slots[sbuf.name] = sbuf.getBinding();
     }
     for (int i = 0; i < program.getNumUniformVariables(); i++) {
         const auto& uniform = program.getUniform(i);
-        const std::string& name = uniform.name;
-        const int binding = uniform.getBinding();
         if (uniform.getType()->getSampler().sampler) {
-            const int slot = inp.find_smp_slot(name);
-            if (slot == -1) {
-                inp.smp_slots[name] = binding;
-            } else if (slot != binding) {
-                out_spirv.errors.push_back(inp.error(0, fmt::format("different bindings for samplers of same name '{}' ({} vs {})", name, slot, binding)));
-                return false;
-            }
+            spirv_blob.smp_slots[uniform.name] = uniform.getBinding();
         } else if (uniform.getType()->isTexture()) {
-            const int slot = inp.find_img_slot(name);
-            if (slot == -1) {
-                inp.img_slots[name] = binding;
-            } else if (slot != binding) {
-                out_spirv.errors.push_back(inp.error(0, fmt::format("different bindings for textures of same name '{}' ({} vs {})", name, slot, binding)));
-                return false;
-            }
+            spirv_blob.img_slots[uniform.name] = uniform.getBinding();
         }
     }
+    if (!merge_bindings(inp, spirv_blob, out_spirv)) {
+        return false;
+    }
 
     // translate intermediate representation to SPIRV
     const glslang::TIntermediate* im = program.getIntermediate(stage);
@@ -288,7 +324,8 @@ static bool compile(Input& inp, EShLanguage stage, Slang::Enum slang, const Merg
     spv_options.validate = false;
     spv_options.emitNonSemanticShaderDebugInfo = false;
     spv_options.emitNonSemanticShaderDebugSource = false;
-    spirv_blob.source = source.src;
+    // glslang is done with the source code, move it into the blob instead of copying
+    spirv_blob.source = std::make_shared<const std::string>(std::move(source.src));
     glslang::GlslangToSpv(*im, spirv_blob.bytecode, &spv_logger, &spv_options);
     std::string spirv_log = spv_logger.getAllMessages();
     if (!spirv_log.empty()) {
@@ -300,12 +337,78 @@ static bool compile(Input& inp, EShLanguage stage, Slang::Enum slang, const Merg
     spirv_optimize(slang, spirv_blob.bytecode);
 
     // and done
-    out_spirv.blobs.push_back(spirv_blob);
+    out_spirv.blobs.push_back(std::move(spirv_blob));
+    return true;
+}
+
+/* compile GLSL generated by SPIRVCross back into SPIRV with OpenGL semantics (ARB_gl_spirv) */
+ErrMsg Spirv::compile_gl_spirv(const Input& inp, const Snippet& snippet, const std::string& glsl_src, std::vector<uint32_t>& out_bytecode) {
+    const EShLanguage stage = (snippet.type == Snippet::VS) ? EShLangVertex : EShLangFragment;
+    const char* sources[1] = { glsl_src.c_str() };
+    const int sourcesLen[1] = { (int) glsl_src.length() };
+    const char* sourcesNames[1] = { inp.base_path.c_str() };
+    const EShMessages messages = (EShMessages)(EShMsgSpvRules | EShMsgDefault);
+    glslang::TShader shader(stage);
+    shader.setStringsWithLengthsAndNames(sources, sourcesLen, sourcesNames, 1);
+    shader.setEnvInput(glslang::EShSourceGlsl, stage, glslang::EShClientOpenGL, 100);
+    shader.setEnvClient(glslang::EShClientOpenGL, glslang::EShTargetOpenGL_450);
+    shader.setEnvTarget(glslang::EshTargetSpv, glslang::EShTargetSpv_1_0);
+    if (!shader.parse(GetDefaultResources(), 100, false, messages)) {
+        return inp.error(snippet.lines[0], fmt::format("failed to compile GL SPIRV for snippet '{}':\n{}", snippet.name, shader.getInfoLog()));
+    }
+    glslang::TProgram program;
+    program.addShader(&shader);
+    if (!program.link(messages)) {
+        return inp.error(snippet.lines[0], fmt::format("failed to link GL SPIRV for snippet '{}':\n{}", snippet.name, program.getInfoLog()));
+    }
+    const glslang::TIntermediate* im = program.getIntermediate(stage);
+    assert(im);
+    spv::SpvBuildLogger spv_logger;
+    glslang::SpvOptions spv_options;
+    spv_options.generateDebugInfo = false;
+    spv_options.stripDebugInfo = false;
+    spv_options.disableOptimizer = true;
+    spv_options.disassemble = false;
+    spv_options.validate = false;
+    out_bytecode.clear();
+    glslang::GlslangToSpv(*im, out_bytecode, &spv_logger, &spv_options);
+    std::string spirv_log = spv_logger.getAllMessages();
+    if (!spirv_log.empty()) {
+        fmt::print(stderr, "{}", spirv_log);
+    }
+    spirv_optimize(Slang::SPIRV_GL, out_bytecode);
+    return ErrMsg();
+}
+
+/* lookup a previously compiled snippet by content hash, returns true on cache hit */
+static bool compile_cached(Input& inp, EShLanguage stage, Slang::Enum slang, MergedSource& source, int snippet_index, Spirv& out_spirv, CompileCache* cache) {
+    if (nullptr == cache) {
+        return compile(inp, stage, slang, source, snippet_index, out_spirv);
+    }
+    const uint64_t key = Hash().add((uint64_t)stage).add(source.src).value;
+    auto& entries = cache->spirv[(int)slang];
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+        cache->hits++;
+        it->second.generation = cache->generation;
+        SpirvBlob blob = it->second.item;
+        blob.snippet_index = snippet_index;
+        if (!merge_bindings(inp, blob, out_spirv)) {
+            return false;
+        }
+        out_spirv.blobs.push_back(std::move(blob));
+        return true;
+    }
+    cache->misses++;
+    if (!compile(inp, stage, slang, source, snippet_index, out_spirv)) {
+        return false;
+    }
+    entries.emplace(key, CompileCache::Entry<SpirvBlob>{ out_spirv.blobs.back(), cache->generation });
     return true;
 }
 
 // compile all shader-snippets into SPIRV bytecode
-Spirv Spirv::compile_glsl_and_extract_bindings(Input& inp, Slang::Enum slang, const std::vector<std::string>& defines) {
+Spirv Spirv::compile_glsl_and_extract_bindings(Input& inp, Slang::Enum slang, const std::vector<std::string>& defines, CompileCache* cache) {
     Spirv out_spirv;
 
     // compile shader-snippets
@@ -313,15 +416,15 @@ Spirv Spirv::compile_glsl_and_extract_bindings(Input& inp, Slang::Enum slang, co
     for (const Snippet& snippet: inp.snippets) {
         if (snippet.type == Snippet::VS) {
             // vertex shader
-            const MergedSource src = merge_source(inp, snippet, slang, defines);
-            if (!compile(inp, EShLangVertex, slang, src, snippet_index, out_spirv)) {
+            MergedSource src = merge_source(inp, snippet, slang, defines);
+            if (!compile_cached(inp, EShLangVertex, slang, src, snippet_index, out_spirv, cache)) {
                 // spirv.errors contains error list
                 return out_spirv;
             }
         } else if (snippet.type == Snippet::FS) {
             // fragment shader
-            const MergedSource src = merge_source(inp, snippet, slang, defines);
-            if (!compile(inp, EShLangFragment, slang, src, snippet_index, out_spirv)) {
+            MergedSource src = merge_source(inp, snippet, slang, defines);
+            if (!compile_cached(inp, EShLangFragment, slang, src, snippet_index, out_spirv, cache)) {
                 // spirv.errors contains error list
                 return out_spirv;
             }
@@ -334,6 +437,39 @@ Spirv Spirv::compile_glsl_and_extract_bindings(Input& inp, Slang::Enum slang, co
     return out_spirv;
 }
 
+/*
+    the loop unroll pass silently leaves loops alone which it can't unroll
+    (for instance because the loop bound isn't a constant), those loops
+    still have the Unroll loop control in the optimized SPIRV
+*/
+std::vector<ErrMsg> Spirv::check_unrolled_loops(const Input& inp) const {
+    std::vector<ErrMsg> res;
+    for (const SpirvBlob& blob: blobs) {
+        std::vector<SpvInstr> instrs;
+        if (!spv_split(blob.bytecode, instrs)) {
+            continue;
+        }
+        int num_loops = 0;
+        for (const SpvInstr& instr: instrs) {
+            if ((instr.op() == spv::OpLoopMerge) && (instr.words.size() >= 4) && (instr.words[3] & spv::LoopControlUnrollMask)) {
+                num_loops++;
+            }
+        }
+        if (num_loops > 0) {
+            const Snippet& snippet = inp.snippets[blob.snippet_index];
+            int line_index = snippet.lines.empty() ? 0 : snippet.lines[0];
+            for (int snippet_line_index: snippet.lines) {
+                if (pystring::strip(inp.lines[snippet_line_index].line) == "@unroll") {
+                    line_index = snippet_line_index;
+                    break;
+                }
+            }
+            res.push_back(inp.warning(line_index, fmt::format("{} loop(s) marked with @unroll in snippet '{}' couldn't be unrolled (loop bound not a constant?)", num_loops, snippet.name)));
+        }
+    }
+    return res;
+}
+
 bool Spirv::write_to_file(const Args& args, const Input& inp, Slang::Enum slang) {
     std::string base_dir;
     std::string base_filename;
@@ -356,7 +492,7 @@ bool Spirv::write_to_file(const Args& args, const Input& inp, Slang::Enum slang)
             const std::string path = fmt::format("{}{}.glsl", base_path, snippet.name);
             FILE* fp = fopen(path.c_str(), "w");
             if (fp) {
-                fwrite(blob.source.c_str(), 1, blob.source.length(), fp);
+                fwrite(blob.source->c_str(), 1, blob.source->length(), fp);
                 fclose(fp);
             } else {
                 fmt::print("Failed to open '{}' for writing!\n", path);
@@ -382,7 +518,7 @@ void Spirv::dump_debug(const Input& inp, ErrMsg::Format err_fmt) const {
         fmt::print(stderr, "  snippet: {}\n", inp.snippets[blob.snippet_index].name);
         fmt::print(stderr, "  source:\n", inp.snippets[blob.snippet_index].name);
         std::vector<std::string> src_lines;
-        pystring::splitlines(blob.source, src_lines);
+        pystring::splitlines(*blob.source, src_lines);
         for (const std::string& src_line: src_lines) {
             fmt::print(stderr, "    {}\n", src_line);
         }
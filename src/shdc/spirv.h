@@ -6,6 +6,7 @@
 #include "types/errmsg.h"
 #include "types/spirv_blob.h"
 #include "types/slang.h"
+#include "types/compile_cache.h"
 
 namespace shdc {
 
@@ -16,7 +17,12 @@ struct Spirv {
 
     static void initialize_spirv_tools();
     static void finalize_spirv_tools();
-    static Spirv compile_glsl_and_extract_bindings(Input& inp, Slang::Enum slang, const std::vector<std::string>& defines);
+    // if a cache is provided, unchanged snippets are taken from the cache instead of being recompiled
+    static Spirv compile_glsl_and_extract_bindings(Input& inp, Slang::Enum slang, const std::vector<std::string>& defines, CompileCache* cache = nullptr);
+    // compile SPIRVCross generated GLSL into SPIRV for GL (needed for Slang::SPIRV_GL)
+    static ErrMsg compile_gl_spirv(const Input& inp, const Snippet& snippet, const std::string& glsl_src, std::vector<uint32_t>& out_bytecode);
+    // returns a warning for each snippet which still has loops marked with @unroll after optimization
+    std::vector<ErrMsg> check_unrolled_loops(const Input& inp) const;
     bool write_to_file(const Args& args, const Input& inp, Slang::Enum slang);
     void dump_debug(const Input& inp, ErrMsg::Format err_fmt) const;
 };
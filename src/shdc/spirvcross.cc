@@ -6,12 +6,14 @@
 #include "spirvcross.h"
 #include "reflection.h"
 #include "types/option.h"
+#include "types/hash.h"
 #include "fmt/format.h"
 #include "pystring.h"
 #include "spirv_hlsl.hpp"
 #include "spirv_msl.hpp"
 #include "spirv_reflect.hpp"
 #include "tint/tint.h"
+#include "spirv-tools/libspirv.hpp"
 
 #include "spirv_glsl.hpp"
 
@@ -41,7 +43,11 @@ static void fix_bind_slots(Compiler& compiler, Snippet::Type snippet_type, Slang
         uint32_t binding = Bindings::base_slot(slang, stage, Bindings::Type::UNIFORM_BLOCK);
         for (const Resource& res: shader_resources.uniform_buffers) {
             compiler.set_decoration(res.id, spv::DecorationDescriptorSet, 0);
-            compiler.set_decoration(res.id, spv::DecorationBinding, binding++);
+            // special case: GL SPIRV uniform blocks keep the original binding, which
+            // is the sokol bind slot (GL uniform blocks have a common bindspace across stages)
+            if (slang != Slang::SPIRV_GL) {
+                compiler.set_decoration(res.id, spv::DecorationBinding, binding++);
+            }
         }
     }
 
@@ -79,7 +85,7 @@ static void fix_bind_slots(Compiler& compiler, Snippet::Type snippet_type, Slang
             compiler.set_decoration(res.id, spv::DecorationDescriptorSet, 0);
             // special case: for GL storage buffers we actually keep the original binding,
             // so that the GL bind slot is (0..7) across all stages
-            if (!Slang::is_glsl(slang)) {
+            if (!Slang::is_glsl(slang) && (slang != Slang::SPIRV_GL)) {
                 compiler.set_decoration(res.id, spv::DecorationBinding, binding++);
             }
         }
@@ -88,11 +94,11 @@ static void fix_bind_slots(Compiler& compiler, Snippet::Type snippet_type, Slang
 
 // This directly patches the descriptor set and bindslot decorators in the input SPIRV
 // via SPIRVCross helper functions. This patched SPIRV is then used as input to Tint
-// for the SPIRV-to-WGSL translation.
-static void wgsl_patch_bind_slots(Compiler& compiler, Snippet::Type snippet_type, std::vector<uint32_t>& inout_bytecode) {
+// for the SPIRV-to-WGSL translation, or directly as Vulkan SPIRV output.
+static void patch_bind_slots(Compiler& compiler, Snippet::Type snippet_type, Slang::Enum slang, std::vector<uint32_t>& inout_bytecode) {
+    assert((slang == Slang::WGSL) || (slang == Slang::SPIRV_VK));
     ShaderResources shader_resources = compiler.get_shader_resources();
     const ShaderStage::Enum stage = ShaderStage::from_snippet_type(snippet_type);
-    const Slang::Enum slang = Slang::WGSL;
     const uint32_t ub_bindgroup = 0;
     const uint32_t img_smp_sbuf_bindgroup = 1;
 
@@ -327,7 +333,7 @@ static SpirvcrossSource to_glsl(const Input& inp, const SpirvBlob& blob, Slang::
     res.snippet_index = blob.snippet_index;
     if (!src.empty()) {
         res.source_code = std::move(src);
-        res.stage_refl = parse_reflection(inp, blob.bytecode, snippet, res.error);
+        res.stage_refl = std::make_shared<const StageReflection>(parse_reflection(inp, blob.bytecode, snippet, res.error));
     }
     res.valid = !res.error.valid();
     return res;
@@ -359,7 +365,7 @@ static SpirvcrossSource to_hlsl(const Input& inp, const SpirvBlob& blob, Slang::
     res.snippet_index = blob.snippet_index;
     if (!src.empty()) {
         res.source_code = std::move(src);
-        res.stage_refl = parse_reflection(inp, blob.bytecode, snippet, res.error);
+        res.stage_refl = std::make_shared<const StageReflection>(parse_reflection(inp, blob.bytecode, snippet, res.error));
     }
     res.valid = !res.error.valid();
     return res;
@@ -389,7 +395,7 @@ static SpirvcrossSource to_msl(const Input& inp, const SpirvBlob& blob, Slang::E
     res.snippet_index = blob.snippet_index;
     if (!src.empty()) {
         res.source_code = std::move(src);
-        res.stage_refl = parse_reflection(inp, blob.bytecode, snippet, res.error);
+        res.stage_refl = std::make_shared<const StageReflection>(parse_reflection(inp, blob.bytecode, snippet, res.error));
     }
     res.valid = !res.error.valid();
     return res;
@@ -399,7 +405,7 @@ static SpirvcrossSource to_wgsl(const Input& inp, const SpirvBlob& blob, Slang::
     std::vector<uint32_t> patched_bytecode = blob.bytecode;
     CompilerGLSL compiler_temp(blob.bytecode);
     fix_bind_slots(compiler_temp, snippet.type, slang);
-    wgsl_patch_bind_slots(compiler_temp, snippet.type, patched_bytecode);
+    patch_bind_slots(compiler_temp, snippet.type, slang, patched_bytecode);
     SpirvcrossSource res;
     res.snippet_index = blob.snippet_index;
     tint::reader::spirv::Options spirv_options;
@@ -410,7 +416,7 @@ static SpirvcrossSource to_wgsl(const Input& inp, const SpirvBlob& blob, Slang::
         tint::writer::wgsl::Result result = tint::writer::wgsl::Generate(&program, wgsl_options);
         if (result.success) {
             res.source_code = result.wgsl;
-            res.stage_refl = parse_reflection(inp, blob.bytecode, snippet, res.error);
+            res.stage_refl = std::make_shared<const StageReflection>(parse_reflection(inp, blob.bytecode, snippet, res.error));
         } else {
             res.error = inp.error(blob.snippet_index, result.error);
         }
@@ -421,6 +427,61 @@ static SpirvcrossSource to_wgsl(const Input& inp, const SpirvBlob& blob, Slang::
     return res;
 }
 
+static std::string disassemble_spirv(const std::vector<uint32_t>& bytecode, spv_target_env target_env) {
+    spvtools::SpirvTools spirv_tools(target_env);
+    std::string dasm_str;
+    spirv_tools.Disassemble(bytecode, &dasm_str, spvtools::SpirvTools::kDefaultDisassembleOption);
+    return dasm_str;
+}
+
+// Vulkan SPIRV is the glslang output with the bind slots patched to the
+// WebGPU-style descriptor set layout, the source code is the disassembly
+static SpirvcrossSource to_spirv_vk(const Input& inp, const SpirvBlob& blob, Slang::Enum slang, uint32_t opt_mask, const Snippet& snippet) {
+    SpirvcrossSource res;
+    res.snippet_index = blob.snippet_index;
+    res.spirv = blob.bytecode;
+    CompilerGLSL compiler_temp(blob.bytecode);
+    patch_bind_slots(compiler_temp, snippet.type, slang, res.spirv);
+    res.source_code = disassemble_spirv(res.spirv, SPV_ENV_VULKAN_1_0);
+    if (!res.source_code.empty()) {
+        res.stage_refl = std::make_shared<const StageReflection>(parse_reflection(inp, blob.bytecode, snippet, res.error));
+    }
+    res.valid = !res.error.valid();
+    return res;
+}
+
+// GL SPIRV (GL 4.6 or ARB_gl_spirv) doesn't allow separate images and samplers,
+// so this goes through SPIRVCross to get GLSL with combined image samplers and
+// explicit bindings, which is then compiled back into SPIRV with GL semantics
+static SpirvcrossSource to_spirv_gl(const Input& inp, const SpirvBlob& blob, Slang::Enum slang, uint32_t opt_mask, const Snippet& snippet) {
+    CompilerGLSL compiler(blob.bytecode);
+    CompilerGLSL::Options options;
+    options.emit_line_directives = false;
+    options.version = 450;
+    options.es = false;
+    options.vulkan_semantics = false;
+    options.enable_420pack_extension = true;
+    options.emit_uniform_buffer_as_plain_uniforms = false;
+    options.vertex.support_nonzero_base_instance = false;
+    options.vertex.fixup_clipspace = (0 != (opt_mask & Option::FIXUP_CLIPSPACE));
+    options.vertex.flip_vert_y = (0 != (opt_mask & Option::FLIP_VERT_Y));
+    compiler.set_common_options(options);
+    to_combined_image_samplers(compiler);
+    fix_bind_slots(compiler, snippet.type, slang);
+    const std::string glsl_src = compiler.compile();
+    SpirvcrossSource res;
+    res.snippet_index = blob.snippet_index;
+    if (!glsl_src.empty()) {
+        res.error = Spirv::compile_gl_spirv(inp, snippet, glsl_src, res.spirv);
+        if (!res.error.valid()) {
+            res.source_code = disassemble_spirv(res.spirv, SPV_ENV_OPENGL_4_5);
+            res.stage_refl = std::make_shared<const StageReflection>(parse_reflection(inp, blob.bytecode, snippet, res.error));
+        }
+    }
+    res.valid = !res.error.valid() && !res.spirv.empty();
+    return res;
+}
+
 struct SnippetRefls {
     const Snippet& vs_snippet;
     const Snippet& fs_snippet;
@@ -428,7 +489,27 @@ struct SnippetRefls {
     const StageReflection fs_refl;
 };
 
-Spirvcross Spirvcross::translate(const Input& inp, const Spirv& spirv, Slang::Enum slang) {
+/* content-hash key of everything that goes into translating a snippet */
+static uint64_t translate_cache_key(const Input& inp, const SpirvBlob& blob, Slang::Enum slang, uint32_t opt_mask, const Snippet& snippet) {
+    Hash hash;
+    hash.add(blob.bytecode).add((uint64_t)slang).add((uint64_t)opt_mask).add((uint64_t)snippet.type).add(snippet.name);
+    // reflection info also depends on the bindings and tags of the whole input file
+    for (const auto* slots: { &inp.ub_slots, &inp.img_slots, &inp.smp_slots, &inp.sbuf_slots }) {
+        hash.add((uint64_t)slots->size());
+        for (const auto& item: *slots) {
+            hash.add(item.first).add((uint64_t)item.second);
+        }
+    }
+    for (const auto& item: inp.image_sample_type_tags) {
+        hash.add(item.first).add((uint64_t)item.second.type);
+    }
+    for (const auto& item: inp.sampler_type_tags) {
+        hash.add(item.first).add((uint64_t)item.second.type);
+    }
+    return hash.value;
+}
+
+Spirvcross Spirvcross::translate(const Input& inp, const Spirv& spirv, Slang::Enum slang, CompileCache* cache) {
     Spirvcross spv_cross;
     try {
         for (const auto& blob: spirv.blobs) {
@@ -436,6 +517,26 @@ Spirvcross Spirvcross::translate(const Input& inp, const Spirv& spirv, Slang::En
             uint32_t opt_mask = inp.snippets[blob.snippet_index].options[(int)slang];
             const Snippet& snippet = inp.snippets[blob.snippet_index];
             assert((snippet.type == Snippet::VS) || (snippet.type == Snippet::FS));
+            uint64_t cache_key = 0;
+            if (cache) {
+                cache_key = translate_cache_key(inp, blob, slang, opt_mask, snippet);
+                auto it = cache->spirvcross[(int)slang].find(cache_key);
+                if (it != cache->spirvcross[(int)slang].end()) {
+                    // snippets may have moved around, patch the back-links
+                    cache->hits++;
+                    it->second.generation = cache->generation;
+                    src = it->second.item;
+                    src.snippet_index = blob.snippet_index;
+                    if (src.stage_refl->snippet_index != snippet.index) {
+                        auto stage_refl = std::make_shared<StageReflection>(*src.stage_refl);
+                        stage_refl->snippet_index = snippet.index;
+                        src.stage_refl = std::move(stage_refl);
+                    }
+                    spv_cross.sources.push_back(std::move(src));
+                    continue;
+                }
+                cache->misses++;
+            }
             spv_cross.error = validate_resource_restrictions(inp, blob);
             if (spv_cross.error.valid()) {
                 return spv_cross;
@@ -448,9 +549,16 @@ Spirvcross Spirvcross::translate(const Input& inp, const Spirv& spirv, Slang::En
                 src = to_msl(inp, blob, slang, opt_mask, snippet);
             } else if (Slang::is_wgsl(slang)) {
                 src = to_wgsl(inp, blob, slang, opt_mask, snippet);
+            } else if (slang == Slang::SPIRV_VK) {
+                src = to_spirv_vk(inp, blob, slang, opt_mask, snippet);
+            } else if (slang == Slang::SPIRV_GL) {
+                src = to_spirv_gl(inp, blob, slang, opt_mask, snippet);
             }
             if (src.valid) {
                 assert(src.snippet_index == blob.snippet_index);
+                if (cache) {
+                    cache->spirvcross[(int)slang].emplace(cache_key, CompileCache::Entry<SpirvcrossSource>{ src, cache->generation });
+                }
                 spv_cross.sources.push_back(std::move(src));
             } else {
                 const int line_index = snippet.lines[0];
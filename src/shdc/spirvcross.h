@@ -6,6 +6,7 @@
 #include "types/errmsg.h"
 #include "types/slang.h"
 #include "types/spirvcross_source.h"
+#include "types/compile_cache.h"
 #include "types/reflection/bindings.h"
 
 namespace shdc {
@@ -15,7 +16,8 @@ struct Spirvcross {
     ErrMsg error;
     std::vector<SpirvcrossSource> sources;
 
-    static Spirvcross translate(const Input& inp, const Spirv& spirv, Slang::Enum slang);
+    // if a cache is provided, unchanged snippets are taken from the cache instead of being translated again
+    static Spirvcross translate(const Input& inp, const Spirv& spirv, Slang::Enum slang, CompileCache* cache = nullptr);
     static bool can_flatten_uniform_block(const spirv_cross::Compiler& compiler, const spirv_cross::Resource& ub_res);
     const SpirvcrossSource* find_source_by_snippet_index(int snippet_index) const;
     void dump_debug(ErrMsg::Format err_fmt, Slang::Enum slang) const;
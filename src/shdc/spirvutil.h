@@ -0,0 +1,101 @@
+#pragma once
+// helper functions for SPIRV transform passes which work directly on the SPIRV words
+#include <vector>
+#include <string>
+#include <string.h>
+#include "spirv.hpp"
+
+namespace shdc {
+
+// a single SPIRV instruction, including the opcode/length word
+struct SpvInstr {
+    std::vector<uint32_t> words;
+
+    uint32_t op() const { return words[0] & 0xFFFF; }
+};
+
+// split a SPIRV blob into instructions, returns false if the blob is invalid
+inline bool spv_split(const std::vector<uint32_t>& words, std::vector<SpvInstr>& out_instrs) {
+    if ((words.size() < 5) || (words[0] != spv::MagicNumber)) {
+        return false;
+    }
+    for (size_t pos = 5; pos < words.size();) {
+        const uint32_t num_words = words[pos] >> 16;
+        if ((num_words == 0) || ((pos + num_words) > words.size())) {
+            return false;
+        }
+        out_instrs.push_back({ std::vector<uint32_t>(words.begin() + pos, words.begin() + pos + num_words) });
+        pos += num_words;
+    }
+    return true;
+}
+
+// join instructions back into a SPIRV blob with the header of the original blob and a new id bound
+inline void spv_join(const std::vector<SpvInstr>& instrs, uint32_t bound, std::vector<uint32_t>& inout_words) {
+    std::vector<uint32_t> res(inout_words.begin(), inout_words.begin() + 5);
+    res[3] = bound;
+    for (const SpvInstr& instr: instrs) {
+        res.insert(res.end(), instr.words.begin(), instr.words.end());
+    }
+    inout_words = std::move(res);
+}
+
+inline SpvInstr spv_make_instr(spv::Op op, const std::vector<uint32_t>& operands) {
+    SpvInstr instr;
+    instr.words.push_back(((uint32_t)(operands.size() + 1) << 16) | (uint32_t)op);
+    instr.words.insert(instr.words.end(), operands.begin(), operands.end());
+    return instr;
+}
+
+inline SpvInstr spv_make_name(uint32_t id, const std::string& name) {
+    std::vector<uint32_t> operands = { id };
+    // zero-terminated and zero-padded to a multiple of 4 bytes
+    std::vector<uint32_t> str((name.length() + 4) / 4, 0);
+    memcpy(str.data(), name.c_str(), name.length());
+    operands.insert(operands.end(), str.begin(), str.end());
+    return spv_make_instr(spv::OpName, operands);
+}
+
+// number of words of a literal string operand starting at words[start]
+inline size_t spv_literal_string_num_words(const std::vector<uint32_t>& words, size_t start) {
+    for (size_t i = start; i < words.size(); i++) {
+        const uint32_t w = words[i];
+        if (((w & 0xFF) == 0) || ((w & 0xFF00) == 0) || ((w & 0xFF0000) == 0) || ((w & 0xFF000000) == 0)) {
+            return i - start + 1;
+        }
+    }
+    return words.size() - start;
+}
+
+// decode a literal string operand starting at words[start]
+inline std::string spv_literal_string(const std::vector<uint32_t>& words, size_t start) {
+    std::string res;
+    for (size_t i = start; i < words.size(); i++) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            const char c = (char)((words[i] >> shift) & 0xFF);
+            if (c == 0) {
+                return res;
+            }
+            res.push_back(c);
+        }
+    }
+    return res;
+}
+
+// instructions which precede the debug section (capabilities, extensions, memory model, entry points, execution modes)
+inline bool spv_is_preamble_op(uint32_t op) {
+    return (op == spv::OpCapability) || (op == spv::OpExtension) || (op == spv::OpExtInstImport) || (op == spv::OpMemoryModel)
+        || (op == spv::OpEntryPoint) || (op == spv::OpExecutionMode) || (op == spv::OpExecutionModeId);
+}
+
+inline bool spv_is_debug_op(uint32_t op) {
+    return (op == spv::OpString) || (op == spv::OpSourceExtension) || (op == spv::OpSource) || (op == spv::OpSourceContinued)
+        || (op == spv::OpName) || (op == spv::OpMemberName) || (op == spv::OpModuleProcessed);
+}
+
+inline bool spv_is_annotation_op(uint32_t op) {
+    return (op == spv::OpDecorate) || (op == spv::OpMemberDecorate) || (op == spv::OpDecorationGroup)
+        || (op == spv::OpGroupDecorate) || (op == spv::OpGroupMemberDecorate) || (op == spv::OpDecorateId) || (op == spv::OpDecorateString);
+}
+
+} // namespace shdc
@@ -0,0 +1,172 @@
+/*
+    Static shader cost statistics (--stats).
+*/
+#include "stats.h"
+#include "spirv.hpp"
+#include "fmt/format.h"
+#include "pystring.h"
+#include <stdio.h>
+
+namespace shdc {
+
+using namespace refl;
+
+void StageStats::add(const StageStats& other) {
+    alu_ops += other.alu_ops;
+    texture_samples += other.texture_samples;
+    branches += other.branches;
+    loops += other.loops;
+    discards += other.discards;
+    derivatives += other.derivatives;
+    varyings += other.varyings;
+    uniform_bytes += other.uniform_bytes;
+    storage_buffer_bytes += other.storage_buffer_bytes;
+    source_bytes += other.source_bytes;
+}
+
+// count instructions by category, these are static instruction counts, loop bodies are only counted once
+static void count_spirv_instructions(const std::vector<uint32_t>& words, StageStats& stats) {
+    // skip the 5-word SPIRV header
+    size_t pos = 5;
+    while (pos < words.size()) {
+        const uint32_t op = words[pos] & 0xFFFF;
+        const uint32_t num_words = words[pos] >> 16;
+        if (num_words == 0) {
+            break;
+        }
+        if ((op == spv::OpExtInst)
+            || ((op >= spv::OpConvertFToU) && (op <= spv::OpBitcast))
+            || ((op >= spv::OpSNegate) && (op <= spv::OpBitCount)))
+        {
+            stats.alu_ops++;
+        } else if (((op >= spv::OpImageSampleImplicitLod) && (op <= spv::OpImageDrefGather))
+            || ((op >= spv::OpImageSparseSampleImplicitLod) && (op <= spv::OpImageSparseDrefGather)))
+        {
+            stats.texture_samples++;
+        } else if ((op >= spv::OpDPdx) && (op <= spv::OpFwidthCoarse)) {
+            stats.derivatives++;
+        } else if ((op == spv::OpBranchConditional) || (op == spv::OpSwitch)) {
+            stats.branches++;
+        } else if (op == spv::OpLoopMerge) {
+            stats.loops++;
+        } else if ((op == spv::OpKill) || (op == spv::OpTerminateInvocation) || (op == spv::OpDemoteToHelperInvocationEXT)) {
+            stats.discards++;
+        }
+        pos += num_words;
+    }
+}
+
+static const SpirvBlob* find_spirv_blob(const Spirv& spirv, int snippet_index) {
+    for (const SpirvBlob& blob: spirv.blobs) {
+        if (blob.snippet_index == snippet_index) {
+            return &blob;
+        }
+    }
+    return nullptr;
+}
+
+Stats Stats::build(const Args& args,
+                   const std::array<Spirv,Slang::Num>& spirv,
+                   const std::array<Spirvcross,Slang::Num>& spirvcross,
+                   const std::array<Bytecode,Slang::Num>& bytecode,
+                   const Reflection& refl)
+{
+    Stats res;
+    for (const ProgramReflection& prog: refl.progs) {
+        for (int i = 0; i < Slang::Num; i++) {
+            const Slang::Enum slang = Slang::from_index(i);
+            if (0 == (args.slang & Slang::bit(slang))) {
+                continue;
+            }
+            ProgramStats prog_stats;
+            prog_stats.name = prog.name;
+            prog_stats.slang = slang;
+            for (int stage_index = 0; stage_index < ShaderStage::Num; stage_index++) {
+                const StageReflection& stage_refl = prog.stage(ShaderStage::from_index(stage_index));
+                StageStats& stats = prog_stats.stages[stage_index];
+                const SpirvBlob* spirv_blob = find_spirv_blob(spirv[slang], stage_refl.snippet_index);
+                if (spirv_blob) {
+                    count_spirv_instructions(spirv_blob->bytecode, stats);
+                }
+                stats.varyings = (int)(ShaderStage::is_vs(stage_refl.stage) ? stage_refl.num_outputs() : stage_refl.num_inputs());
+                for (const UniformBlock& ub: stage_refl.bindings.uniform_blocks) {
+                    stats.uniform_bytes += (ub.struct_info.size + 15) & ~15;
+                }
+                for (const StorageBuffer& sbuf: stage_refl.bindings.storage_buffers) {
+                    stats.storage_buffer_bytes += sbuf.struct_info.size;
+                }
+                const BytecodeBlob* blob = bytecode[slang].find_blob_by_snippet_index(stage_refl.snippet_index);
+                if (blob) {
+                    stats.source_bytes = (int)blob->data.size();
+                } else {
+                    const SpirvcrossSource* src = spirvcross[slang].find_source_by_snippet_index(stage_refl.snippet_index);
+                    if (src) {
+                        stats.source_bytes = (int)src->source_code.length();
+                    }
+                }
+                prog_stats.total.add(stats);
+            }
+            res.progs.push_back(prog_stats);
+        }
+    }
+    return res;
+}
+
+static std::string json_str(const std::string& str) {
+    std::string res = "\"";
+    for (char c: str) {
+        if ((c == '"') || (c == '\\')) {
+            res += '\\';
+        }
+        res += c;
+    }
+    res += "\"";
+    return res;
+}
+
+static std::string stage_stats_json(const StageStats& s) {
+    return fmt::format("{{ \"alu_ops\": {}, \"texture_samples\": {}, \"branches\": {}, \"loops\": {}, \"discards\": {}, \"derivatives\": {}, \"varyings\": {}, \"uniform_bytes\": {}, \"storage_buffer_bytes\": {}, \"source_bytes\": {} }}",
+        s.alu_ops, s.texture_samples, s.branches, s.loops, s.discards, s.derivatives, s.varyings, s.uniform_bytes, s.storage_buffer_bytes, s.source_bytes);
+}
+
+static std::string stage_stats_csv(const std::string& prog, Slang::Enum slang, const char* stage, const StageStats& s) {
+    return fmt::format("{},{},{},{},{},{},{},{},{},{},{},{},{}\n",
+        prog, Slang::to_str(slang), stage, s.alu_ops, s.texture_samples, s.branches, s.loops, s.discards, s.derivatives, s.varyings, s.uniform_bytes, s.storage_buffer_bytes, s.source_bytes);
+}
+
+ErrMsg Stats::write(const Args& args, const Input& inp) const {
+    std::string content;
+    if (pystring::endswith(pystring::lower(args.stats), ".csv")) {
+        content = "program,slang,stage,alu_ops,texture_samples,branches,loops,discards,derivatives,varyings,uniform_bytes,storage_buffer_bytes,source_bytes\n";
+        for (const ProgramStats& prog: progs) {
+            for (int stage_index = 0; stage_index < ShaderStage::Num; stage_index++) {
+                content += stage_stats_csv(prog.name, prog.slang, ShaderStage::to_str(ShaderStage::from_index(stage_index)), prog.stages[stage_index]);
+            }
+            content += stage_stats_csv(prog.name, prog.slang, "total", prog.total);
+        }
+    } else {
+        content = fmt::format("{{\n  \"input\": {},\n  \"programs\": [\n", json_str(inp.base_path));
+        for (size_t i = 0; i < progs.size(); i++) {
+            const ProgramStats& prog = progs[i];
+            content += fmt::format("    {{\n      \"name\": {},\n      \"slang\": \"{}\",\n", json_str(prog.name), Slang::to_str(prog.slang));
+            for (int stage_index = 0; stage_index < ShaderStage::Num; stage_index++) {
+                content += fmt::format("      \"{}\": {},\n", ShaderStage::to_str(ShaderStage::from_index(stage_index)), stage_stats_json(prog.stages[stage_index]));
+            }
+            content += fmt::format("      \"total\": {}\n    }}{}\n", stage_stats_json(prog.total), (i + 1) < progs.size() ? "," : "");
+        }
+        content += "  ]\n}\n";
+    }
+    FILE* f = fopen(args.stats.c_str(), "w");
+    if (!f) {
+        return ErrMsg::error(inp.base_path, 0, fmt::format("failed to open stats file '{}'", args.stats));
+    }
+    const size_t written = fwrite(content.c_str(), 1, content.length(), f);
+    // a failed fclose() may mean that buffered data never made it to the file
+    const bool closed = (fclose(f) == 0);
+    if ((written != content.length()) || !closed) {
+        return ErrMsg::error(inp.base_path, 0, fmt::format("failed to write stats file '{}'", args.stats));
+    }
+    return ErrMsg();
+}
+
+} // namespace shdc
@@ -0,0 +1,52 @@
+#pragma once
+#include <array>
+#include <string>
+#include <vector>
+#include "args.h"
+#include "input.h"
+#include "spirv.h"
+#include "spirvcross.h"
+#include "bytecode.h"
+#include "reflection.h"
+#include "types/errmsg.h"
+#include "types/slang.h"
+
+namespace shdc {
+
+// static (not runtime) shader cost estimates, gathered from the optimized SPIRV
+// bytecode, the reflection info and the translated shader sources
+struct StageStats {
+    int alu_ops = 0;                // arithmetic, conversion, logic and extended instructions
+    int texture_samples = 0;        // image sample, fetch and gather instructions
+    int branches = 0;               // conditional branches and switches
+    int loops = 0;
+    int discards = 0;
+    int derivatives = 0;
+    int varyings = 0;               // vertex shader outputs or fragment shader inputs
+    int uniform_bytes = 0;
+    int storage_buffer_bytes = 0;   // size of a single storage buffer item
+    int source_bytes = 0;           // size of the translated source code or bytecode
+
+    void add(const StageStats& other);
+};
+
+struct ProgramStats {
+    std::string name;
+    Slang::Enum slang = Slang::Num;
+    std::array<StageStats, refl::ShaderStage::Num> stages;
+    StageStats total;
+};
+
+struct Stats {
+    std::vector<ProgramStats> progs;
+
+    static Stats build(const Args& args,
+                       const std::array<Spirv,Slang::Num>& spirv,
+                       const std::array<Spirvcross,Slang::Num>& spirvcross,
+                       const std::array<Bytecode,Slang::Num>& bytecode,
+                       const refl::Reflection& refl);
+    // write to args.stats as JSON, or as CSV if the file extension is .csv
+    ErrMsg write(const Args& args, const Input& inp) const;
+};
+
+} // namespace shdc
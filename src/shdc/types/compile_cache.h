@@ -0,0 +1,54 @@
+#pragma once
+#include <array>
+#include <unordered_map>
+#include <stdint.h>
+#include "slang.h"
+#include "spirv_blob.h"
+#include "spirvcross_source.h"
+
+namespace shdc {
+
+// content-hash keyed per-snippet compilation results, kept alive
+// across compilation runs in --watch mode so that only modified
+// snippets need to go through glslang and SPIRV-Cross again
+struct CompileCache {
+    template<class T> struct Entry {
+        T item;
+        int generation = 0;
+    };
+    int generation = 0;
+    int hits = 0;
+    int misses = 0;
+    std::array<std::unordered_map<uint64_t, Entry<SpirvBlob>>, Slang::Num> spirv;
+    std::array<std::unordered_map<uint64_t, Entry<SpirvcrossSource>>, Slang::Num> spirvcross;
+
+    // call before a compilation run
+    void begin();
+    // call after a compilation run, drops all entries which haven't been used
+    void end();
+};
+
+inline void CompileCache::begin() {
+    generation++;
+    hits = 0;
+    misses = 0;
+}
+
+template<class T> static void compile_cache_evict(std::unordered_map<uint64_t, CompileCache::Entry<T>>& map, int generation) {
+    for (auto it = map.begin(); it != map.end();) {
+        if (it->second.generation != generation) {
+            it = map.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+inline void CompileCache::end() {
+    for (int i = 0; i < Slang::Num; i++) {
+        compile_cache_evict(spirv[i], generation);
+        compile_cache_evict(spirvcross[i], generation);
+    }
+}
+
+} // namespace shdc
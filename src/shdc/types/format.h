@@ -17,6 +17,8 @@ struct Format	{
         SOKOL_C3,
         BARE,
         BARE_YAML,
+        BARE_BIN,
+        BARE_PACK,
         NUM,
         INVALID,
     };
@@ -38,6 +40,8 @@ inline const char* Format::to_str(Enum f) {
         case SOKOL_C3:     return "sokol_c3";
         case BARE:          return "bare";
         case BARE_YAML:     return "bare_yaml";
+        case BARE_BIN:      return "bare_bin";
+        case BARE_PACK:     return "bare_pack";
         default:            return "<invalid>";
     }
 }
@@ -65,6 +69,10 @@ inline Format::Enum Format::from_str(const std::string& str) {
         return BARE;
     } else if (str == "bare_yaml") {
         return BARE_YAML;
+    } else if (str == "bare_bin") {
+        return BARE_BIN;
+    } else if (str == "bare_pack") {
+        return BARE_PACK;
     } else {
         return INVALID;
     }
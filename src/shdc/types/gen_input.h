@@ -7,12 +7,21 @@
 
 namespace shdc::gen {
 
+// a generated file which is collected in memory instead of being written (see GenInput::output_files)
+struct GenOutputFile {
+    std::string path;
+    std::string content;
+    bool is_text = false;       // written in text mode
+};
+
 struct GenInput {
     const Args& args;
     const Input& inp;
     const std::array<Spirvcross,Slang::Num>& spirvcross;
     const std::array<Bytecode,Slang::Num>& bytecode;
     const refl::Reflection& refl;
+    const refl::Bindings* shared_types = nullptr;   // uniform blocks and storage buffers in the --shared-types header
+    std::vector<GenOutputFile>* output_files = nullptr; // optional, if provided, generated files are added here instead of written
 
     GenInput(const Args& args,
              const Input& inp,
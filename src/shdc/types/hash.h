@@ -0,0 +1,51 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+namespace shdc {
+
+// incremental 64-bit FNV-1a hash, used for content-hash keys
+struct Hash {
+    uint64_t value = 0xCBF29CE484222325ULL;
+
+    Hash& add(const void* ptr, size_t num_bytes);
+    Hash& add(const std::string& str);
+    Hash& add(uint64_t val);
+    Hash& add(const std::vector<uint32_t>& words);
+};
+
+inline Hash& Hash::add(const void* ptr, size_t num_bytes) {
+    const uint8_t* bytes = (const uint8_t*)ptr;
+    for (size_t i = 0; i < num_bytes; i++) {
+        value ^= bytes[i];
+        value *= 0x100000001B3ULL;
+    }
+    return *this;
+}
+
+inline Hash& Hash::add(const std::string& str) {
+    // include the length so that concatenated strings can't collide
+    add((uint64_t)str.length());
+    return add(str.data(), str.length());
+}
+
+inline Hash& Hash::add(uint64_t val) {
+    uint8_t bytes[8];
+    for (int i = 0; i < 8; i++) {
+        bytes[i] = (uint8_t)(val >> (i * 8));
+    }
+    return add(bytes, sizeof(bytes));
+}
+
+inline Hash& Hash::add(const std::vector<uint32_t>& words) {
+    add((uint64_t)words.size());
+    for (uint32_t word: words) {
+        uint8_t bytes[4] = { (uint8_t)word, (uint8_t)(word >> 8), (uint8_t)(word >> 16), (uint8_t)(word >> 24) };
+        add(bytes, sizeof(bytes));
+    }
+    return *this;
+}
+
+} // namespace shdc
@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <utility>
 
 namespace shdc {
 
@@ -10,13 +11,13 @@ struct Line {
     int index = 0;          // line index == line nr - 1
 
     Line();
-    Line(const std::string& ln, int fn, int ix);
+    Line(std::string ln, int fn, int ix);
 };
 
 inline Line::Line() { };
 
-inline Line::Line(const std::string& ln, int fn, int ix):
-    line(ln),
+inline Line::Line(std::string ln, int fn, int ix):
+    line(std::move(ln)),
     filename(fn),
     index(ix)
 { };
@@ -0,0 +1,99 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+namespace shdc {
+
+// Minimal perfect hash over a set of unique keys (hash-and-displace), used
+// to generate O(1) name lookups in reflection functions. A key consists of
+// one or more strings. Lookup:
+//
+//  slot = hash(seeds[hash(0, key) % num], key) % num
+//
+// NOTE: the hash function must be identical with the code-generated
+// hash function in the target language (see SokolCGenerator).
+struct PerfectHash {
+    bool valid = false;
+    std::vector<uint32_t> seeds;    // per-bucket seed, num keys entries
+    std::vector<int> slots;         // slot => key index
+
+    static uint32_t hash(uint32_t seed, const std::vector<std::string>& key);
+    static PerfectHash build(const std::vector<std::vector<std::string>>& keys);
+};
+
+// FNV-1a over all key strings including their terminating zero, followed by the murmur3 finalizer
+inline uint32_t PerfectHash::hash(uint32_t seed, const std::vector<std::string>& key) {
+    uint32_t h = 0x811C9DC5u ^ (seed * 0x9E3779B9u);
+    for (const std::string& str: key) {
+        for (char c: str) {
+            h = (h ^ (uint8_t)c) * 0x01000193u;
+        }
+        h = h * 0x01000193u;
+    }
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return h;
+}
+
+inline PerfectHash PerfectHash::build(const std::vector<std::vector<std::string>>& keys) {
+    const uint32_t num = (uint32_t)keys.size();
+    PerfectHash res;
+    res.seeds.resize(num, 0);
+    res.slots.resize(num, -1);
+    if (num == 0) {
+        res.valid = true;
+        return res;
+    }
+    // distribute keys into buckets, and place the largest buckets first
+    std::vector<std::vector<int>> buckets(num);
+    for (uint32_t key_index = 0; key_index < num; key_index++) {
+        buckets[hash(0, keys[key_index]) % num].push_back((int)key_index);
+    }
+    std::vector<uint32_t> order(num);
+    for (uint32_t i = 0; i < num; i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&buckets](uint32_t a, uint32_t b) {
+        return buckets[a].size() > buckets[b].size();
+    });
+    // for each bucket find a seed which maps all its keys into free slots
+    const uint32_t max_seed = 1<<20;
+    std::vector<uint32_t> bucket_slots;
+    for (uint32_t bucket_index: order) {
+        const std::vector<int>& bucket = buckets[bucket_index];
+        if (bucket.empty()) {
+            break;
+        }
+        bool found = false;
+        for (uint32_t seed = 1; !found && (seed < max_seed); seed++) {
+            bucket_slots.clear();
+            found = true;
+            for (int key_index: bucket) {
+                const uint32_t slot = hash(seed, keys[key_index]) % num;
+                if ((res.slots[slot] != -1) || (std::find(bucket_slots.begin(), bucket_slots.end(), slot) != bucket_slots.end())) {
+                    found = false;
+                    break;
+                }
+                bucket_slots.push_back(slot);
+            }
+            if (found) {
+                res.seeds[bucket_index] = seed;
+                for (size_t i = 0; i < bucket.size(); i++) {
+                    res.slots[bucket_slots[i]] = bucket[i];
+                }
+            }
+        }
+        if (!found) {
+            return res;
+        }
+    }
+    res.valid = true;
+    return res;
+}
+
+} // namespace shdc
@@ -1,4 +1,5 @@
 #pragma once
+#include <unordered_map>
 #include "uniform_block.h"
 #include "image.h"
 #include "sampler.h"
@@ -29,14 +30,39 @@ struct Bindings {
         IMAGE_SAMPLER,
     };
 
+    // name and sokol-slot hash index into one of the resource arrays, for
+    // duplicate slots (across programs) the first resource wins
+    struct Index {
+        std::unordered_map<std::string, int> by_name;
+        std::unordered_map<int, int> by_slot;
+        void add(const std::string& name, int slot, int index);
+        void clear();
+        int find(const std::string& name) const;
+        int find(int slot) const;
+    };
+
+    // NOTE: only add resources with the add_*() functions, this keeps the indexes up to date
     std::vector<UniformBlock> uniform_blocks;
     std::vector<StorageBuffer> storage_buffers;
     std::vector<Image> images;
     std::vector<Sampler> samplers;
     std::vector<ImageSampler> image_samplers;
+    Index uniform_block_index;
+    Index storage_buffer_index;
+    Index image_index;
+    Index sampler_index;
+    Index image_sampler_index;
 
     static uint32_t base_slot(Slang::Enum slang, ShaderStage::Enum stage, Type type);
 
+    void add_uniform_block(const UniformBlock& ub);
+    void add_storage_buffer(const StorageBuffer& sbuf);
+    void add_image(const Image& img);
+    void add_sampler(const Sampler& smp);
+    void add_image_sampler(const ImageSampler& img_smp);
+    // must be called after names or sokol-slots have been changed in place
+    void rebuild_indexes();
+
     const UniformBlock* find_uniform_block_by_sokol_slot(int slot) const;
     const StorageBuffer* find_storage_buffer_by_sokol_slot(int slot) const;
     const Image* find_image_by_sokol_slot(int slot) const;
@@ -53,30 +79,33 @@ struct Bindings {
 };
 
 // returns the 3D API specific base-binding slot for a shader dialect, stage and resource type
+// NOTE: Vulkan SPIRV uses the same descriptor set layout as WGSL (set 0 for uniform
+// blocks, set 1 for images, samplers and storage buffers), GL SPIRV the same
+// combined image sampler bindings as GLSL
 // NOTE: the special Slang::REFLECTION always returns zero, this can be used
 // to figure out the sokol-gfx bindslots
 inline uint32_t Bindings::base_slot(Slang::Enum slang, ShaderStage::Enum stage, Type type) {
     int res = 0;
     switch (type) {
         case Type::UNIFORM_BLOCK:
-            if (Slang::is_wgsl(slang)) {
+            if (Slang::is_wgsl(slang) || (slang == Slang::SPIRV_VK)) {
                 res = ShaderStage::is_vs(stage) ? 0 : MaxUniformBlocks;
             }
             break;
         case Type::IMAGE_SAMPLER:
-            if (Slang::is_glsl(slang)) {
+            if (Slang::is_glsl(slang) || (slang == Slang::SPIRV_GL)) {
                 res = ShaderStage::is_vs(stage) ? 0 : MaxImageSamplers;
             }
             break;
         case Type::IMAGE:
-            if (Slang::is_wgsl(slang)) {
+            if (Slang::is_wgsl(slang) || (slang == Slang::SPIRV_VK)) {
                 if (ShaderStage::is_fs(stage)) {
                     res += 64;
                 }
             }
             break;
         case Type::SAMPLER:
-            if (Slang::is_wgsl(slang)) {
+            if (Slang::is_wgsl(slang) || (slang == Slang::SPIRV_VK)) {
                 res = MaxImages;
                 if (ShaderStage::is_fs(stage)) {
                     res += 64;
@@ -88,7 +117,7 @@ inline uint32_t Bindings::base_slot(Slang::Enum slang, ShaderStage::Enum stage,
                 res = MaxUniformBlocks;
             } else if (Slang::is_hlsl(slang)) {
                 res = MaxImages;
-            } else if (Slang::is_wgsl(slang)) {
+            } else if (Slang::is_wgsl(slang) || (slang == Slang::SPIRV_VK)) {
                 res = MaxImages + MaxSamplers;
                 if (ShaderStage::is_fs(stage)) {
                     res += 64;
@@ -99,94 +128,122 @@ inline uint32_t Bindings::base_slot(Slang::Enum slang, ShaderStage::Enum stage,
     return res;
 }
 
-inline const UniformBlock* Bindings::find_uniform_block_by_sokol_slot(int slot) const {
-    for (const UniformBlock& ub: uniform_blocks) {
-        if (ub.sokol_slot == slot) {
-            return &ub;
-        }
+inline void Bindings::Index::add(const std::string& name, int slot, int index) {
+    by_name.emplace(name, index);
+    by_slot.emplace(slot, index);
+}
+
+inline void Bindings::Index::clear() {
+    by_name.clear();
+    by_slot.clear();
+}
+
+inline int Bindings::Index::find(const std::string& name) const {
+    const auto it = by_name.find(name);
+    return (it != by_name.end()) ? it->second : -1;
+}
+
+inline int Bindings::Index::find(int slot) const {
+    const auto it = by_slot.find(slot);
+    return (it != by_slot.end()) ? it->second : -1;
+}
+
+inline void Bindings::add_uniform_block(const UniformBlock& ub) {
+    uniform_block_index.add(ub.name, ub.sokol_slot, (int)uniform_blocks.size());
+    uniform_blocks.push_back(ub);
+}
+
+inline void Bindings::add_storage_buffer(const StorageBuffer& sbuf) {
+    storage_buffer_index.add(sbuf.name, sbuf.sokol_slot, (int)storage_buffers.size());
+    storage_buffers.push_back(sbuf);
+}
+
+inline void Bindings::add_image(const Image& img) {
+    image_index.add(img.name, img.sokol_slot, (int)images.size());
+    images.push_back(img);
+}
+
+inline void Bindings::add_sampler(const Sampler& smp) {
+    sampler_index.add(smp.name, smp.sokol_slot, (int)samplers.size());
+    samplers.push_back(smp);
+}
+
+inline void Bindings::add_image_sampler(const ImageSampler& img_smp) {
+    image_sampler_index.add(img_smp.name, img_smp.sokol_slot, (int)image_samplers.size());
+    image_samplers.push_back(img_smp);
+}
+
+inline void Bindings::rebuild_indexes() {
+    uniform_block_index.clear();
+    for (int i = 0; i < (int)uniform_blocks.size(); i++) {
+        uniform_block_index.add(uniform_blocks[i].name, uniform_blocks[i].sokol_slot, i);
+    }
+    storage_buffer_index.clear();
+    for (int i = 0; i < (int)storage_buffers.size(); i++) {
+        storage_buffer_index.add(storage_buffers[i].name, storage_buffers[i].sokol_slot, i);
+    }
+    image_index.clear();
+    for (int i = 0; i < (int)images.size(); i++) {
+        image_index.add(images[i].name, images[i].sokol_slot, i);
     }
-    return nullptr;
+    sampler_index.clear();
+    for (int i = 0; i < (int)samplers.size(); i++) {
+        sampler_index.add(samplers[i].name, samplers[i].sokol_slot, i);
+    }
+    image_sampler_index.clear();
+    for (int i = 0; i < (int)image_samplers.size(); i++) {
+        image_sampler_index.add(image_samplers[i].name, image_samplers[i].sokol_slot, i);
+    }
+}
+
+inline const UniformBlock* Bindings::find_uniform_block_by_sokol_slot(int slot) const {
+    const int i = uniform_block_index.find(slot);
+    return (i >= 0) ? &uniform_blocks[i] : nullptr;
 }
 
 inline const StorageBuffer* Bindings::find_storage_buffer_by_sokol_slot(int slot) const {
-    for (const StorageBuffer& sbuf: storage_buffers) {
-        if (sbuf.sokol_slot == slot) {
-            return &sbuf;
-        }
-    }
-    return nullptr;
+    const int i = storage_buffer_index.find(slot);
+    return (i >= 0) ? &storage_buffers[i] : nullptr;
 }
 
 inline const Image* Bindings::find_image_by_sokol_slot(int slot) const {
-    for (const Image& img: images) {
-        if (img.sokol_slot == slot) {
-            return &img;
-        }
-    }
-    return nullptr;
+    const int i = image_index.find(slot);
+    return (i >= 0) ? &images[i] : nullptr;
 }
 
 inline const Sampler* Bindings::find_sampler_by_sokol_slot(int slot) const {
-    for (const Sampler& smp: samplers) {
-        if (smp.sokol_slot == slot) {
-            return &smp;
-        }
-    }
-    return nullptr;
+    const int i = sampler_index.find(slot);
+    return (i >= 0) ? &samplers[i] : nullptr;
 }
 
 inline const ImageSampler* Bindings::find_image_sampler_by_sokol_slot(int slot) const {
-    for (const ImageSampler& img_smp: image_samplers) {
-        if (img_smp.sokol_slot == slot) {
-            return &img_smp;
-        }
-    }
-    return nullptr;
+    const int i = image_sampler_index.find(slot);
+    return (i >= 0) ? &image_samplers[i] : nullptr;
 }
 
 inline const UniformBlock* Bindings::find_uniform_block_by_name(const std::string& name) const {
-    for (const UniformBlock& ub: uniform_blocks) {
-        if (ub.name == name) {
-            return &ub;
-        }
-    }
-    return nullptr;
+    const int i = uniform_block_index.find(name);
+    return (i >= 0) ? &uniform_blocks[i] : nullptr;
 }
 
 inline const StorageBuffer* Bindings::find_storage_buffer_by_name(const std::string& name) const {
-    for (const StorageBuffer& sbuf: storage_buffers) {
-        if (sbuf.name == name) {
-            return &sbuf;
-        }
-    }
-    return nullptr;
+    const int i = storage_buffer_index.find(name);
+    return (i >= 0) ? &storage_buffers[i] : nullptr;
 }
 
 inline const Image* Bindings::find_image_by_name(const std::string& name) const {
-    for (const Image& img: images) {
-        if (img.name == name) {
-            return &img;
-        }
-    }
-    return nullptr;
+    const int i = image_index.find(name);
+    return (i >= 0) ? &images[i] : nullptr;
 }
 
 inline const Sampler* Bindings::find_sampler_by_name(const std::string& name) const {
-    for (const Sampler& smp: samplers) {
-        if (smp.name == name) {
-            return &smp;
-        }
-    }
-    return nullptr;
+    const int i = sampler_index.find(name);
+    return (i >= 0) ? &samplers[i] : nullptr;
 }
 
 inline const ImageSampler* Bindings::find_image_sampler_by_name(const std::string& name) const {
-    for (const ImageSampler& img_smp: image_samplers) {
-        if (img_smp.name == name) {
-            return &img_smp;
-        }
-    }
-    return nullptr;
+    const int i = image_sampler_index.find(name);
+    return (i >= 0) ? &image_samplers[i] : nullptr;
 }
 
 inline void Bindings::dump_debug(const std::string& indent) const {
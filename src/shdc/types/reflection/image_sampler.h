@@ -5,10 +5,11 @@
 
 namespace shdc::refl {
 
-// special combined-image-samplers for GLSL output with GL semantics
+// special combined-image-samplers for GLSL and GL SPIRV output with GL semantics
 struct ImageSampler {
     ShaderStage::Enum stage = ShaderStage::Invalid;
     int sokol_slot = -1;
+    int glsl_binding_n = -1;
     std::string name;
     std::string image_name;
     std::string sampler_name;
@@ -30,6 +31,7 @@ inline void ImageSampler::dump_debug(const std::string& indent) const {
     fmt::print(stderr, "{}-\n", indent);
     fmt::print(stderr, "{}stage: {}\n", indent2, ShaderStage::to_str(stage));
     fmt::print(stderr, "{}sokol_slot: {}\n", indent2, sokol_slot);
+    fmt::print(stderr, "{}glsl_binding_n: {}\n", indent2, glsl_binding_n);
     fmt::print(stderr, "{}name: {}\n", indent2, name);
     fmt::print(stderr, "{}image_name: {}\n", indent2, image_name);
     fmt::print(stderr, "{}sampler_name: {}\n", indent2, sampler_name);
@@ -1,12 +1,13 @@
 #pragma once
 #include <array>
+#include <memory>
 #include "stage_reflection.h"
 
 namespace shdc::refl {
 
 struct ProgramReflection {
     std::string name;
-    std::array<StageReflection, ShaderStage::Num> stages;
+    std::array<std::shared_ptr<const StageReflection>, ShaderStage::Num> stages;    // shared with SpirvcrossSource
     Bindings bindings;  // merged stage bindings
 
     const StageReflection& stage(ShaderStage::Enum s) const;
@@ -19,23 +20,23 @@ struct ProgramReflection {
 
 inline const StageReflection& ProgramReflection::stage(ShaderStage::Enum s) const {
     assert((s >= 0) && (s < ShaderStage::Num));
-    return stages[s];
+    return *stages[s];
 }
 
 inline const StageReflection& ProgramReflection::vs() const {
-    return stages[ShaderStage::Vertex];
+    return *stages[ShaderStage::Vertex];
 }
 
 inline const StageReflection& ProgramReflection::fs() const {
-    return stages[ShaderStage::Fragment];
+    return *stages[ShaderStage::Fragment];
 }
 
 inline const std::string& ProgramReflection::vs_name() const {
-    return stages[ShaderStage::Vertex].snippet_name;
+    return stages[ShaderStage::Vertex]->snippet_name;
 }
 
 inline const std::string& ProgramReflection::fs_name() const {
-    return stages[ShaderStage::Fragment].snippet_name;
+    return stages[ShaderStage::Fragment]->snippet_name;
 }
 
 inline void ProgramReflection::dump_debug(const std::string& indent) const {
@@ -45,7 +46,7 @@ inline void ProgramReflection::dump_debug(const std::string& indent) const {
     fmt::print(stderr, "{}stages:\n", indent2);
     bindings.dump_debug(indent2);
     for (const auto& stage: stages) {
-        stage.dump_debug(indent2);
+        stage->dump_debug(indent2);
     }
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include "type.h"
+#include "vertex_format.h"
 
 namespace shdc::refl {
 
@@ -11,6 +12,8 @@ struct StageAttr {
     std::string sem_name;
     int sem_index = 0;
     Type type_info;
+    bool used = true;   // false if the shader code never reads the stage input
+    VertexFormat::Enum packed_format = VertexFormat::INVALID;   // compact vertex format found by --vertex-formats
 
     bool equals(const StageAttr& rhs) const;
     void dump_debug(const std::string& indent) const;
@@ -30,6 +33,8 @@ inline void StageAttr::dump_debug(const std::string& indent) const {
     fmt::print(stderr, "{}name: {}\n", indent2, name);
     fmt::print(stderr, "{}sem_name: {}\n", indent2, sem_name);
     fmt::print(stderr, "{}sem_index: {}\n", indent2, sem_index);
+    fmt::print(stderr, "{}used: {}\n", indent2, used);
+    fmt::print(stderr, "{}packed_format: {}\n", indent2, VertexFormat::to_str(packed_format));
 }
 
 } // namespace
@@ -1,24 +1,39 @@
 #pragma once
 #include <string>
+#include <vector>
 #include "fmt/format.h"
 #include "shader_stage.h"
 #include "type.h"
 
 namespace shdc::refl {
 
+// an array in the @soa representation of a storage buffer item, one per scalar member and vector component
+struct SoaMember {
+    std::string name;       // the member name, with an _x, _y, _z or _w suffix for vector components
+    std::string aos_name;   // name of the member in the item struct
+    int component = -1;     // the vector component, or -1 for scalar members
+    Type::Enum scalar_type = Type::Invalid;
+};
+
 struct StorageBuffer {
     ShaderStage::Enum stage = ShaderStage::Invalid;
     int sokol_slot = -1;
     int hlsl_register_t_n = -1;
     int msl_buffer_n = -1;
     int wgsl_group1_binding_n = -1;
+    int spirv_set1_binding_n = -1;
     int glsl_binding_n = -1;
     std::string name;   // shortcut for struct_info.name
     std::string inst_name;
     bool readonly;
+    bool used = true;   // false if the shader code never accesses the storage buffer
+    bool soa = false;   // @soa tag: generate a CPU-side SoA struct and a pack function
     Type struct_info;
+    uint64_t hash = 0;  // structural hash over the items compared in equals()
 
     bool equals(const StorageBuffer& other) const;
+    uint64_t compute_hash() const;
+    std::vector<SoaMember> soa_members() const;
     void dump_debug(const std::string& indent) const;
 };
 
@@ -31,6 +46,31 @@ inline bool StorageBuffer::equals(const StorageBuffer& other) const {
         && (struct_info.equals(other.struct_info));
 }
 
+inline uint64_t StorageBuffer::compute_hash() const {
+    Hash h;
+    h.add((uint64_t)stage).add((uint64_t)sokol_slot).add(name).add(inst_name).add((uint64_t)readonly);
+    struct_info.add_hash(h);
+    return h.value;
+}
+
+inline std::vector<SoaMember> StorageBuffer::soa_members() const {
+    static const char* comp_names[4] = { "x", "y", "z", "w" };
+    std::vector<SoaMember> res;
+    for (const Type& member: struct_info.struct_items[0].struct_items) {
+        const int num_comps = Type::num_components(member.type);
+        // std430 bools are 32-bit integers
+        const Type::Enum scalar_type = (Type::scalar_type(member.type) == Type::Bool) ? Type::Int : Type::scalar_type(member.type);
+        if (num_comps == 1) {
+            res.push_back({ member.name, member.name, -1, scalar_type });
+        } else {
+            for (int c = 0; c < num_comps; c++) {
+                res.push_back({ fmt::format("{}_{}", member.name, comp_names[c]), member.name, c, scalar_type });
+            }
+        }
+    }
+    return res;
+}
+
 inline void StorageBuffer::dump_debug(const std::string& indent) const {
     const std::string indent2 = indent + "  ";
     fmt::print(stderr, "{}-\n", indent);
@@ -39,9 +79,12 @@ inline void StorageBuffer::dump_debug(const std::string& indent) const {
     fmt::print(stderr, "{}hlsl_register_t_n: {}\n", indent2, hlsl_register_t_n);
     fmt::print(stderr, "{}msl_buffer_n: {}\n", indent2, msl_buffer_n);
     fmt::print(stderr, "{}wgsl_group1_binding_n: {}\n", indent2, wgsl_group1_binding_n);
+    fmt::print(stderr, "{}spirv_set1_binding_n: {}\n", indent2, spirv_set1_binding_n);
     fmt::print(stderr, "{}glsl_binding_n: {}\n", indent2, glsl_binding_n);
     fmt::print(stderr, "{}inst_name: {}\n", indent2, inst_name);
     fmt::print(stderr, "{}readonly: {}\n", indent2, readonly);
+    fmt::print(stderr, "{}used: {}\n", indent2, used);
+    fmt::print(stderr, "{}soa: {}\n", indent2, soa);
     fmt::print(stderr, "{}struct:\n", indent2);
     struct_info.dump_debug(indent2);
 }
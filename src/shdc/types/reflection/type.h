@@ -2,6 +2,7 @@
 #include <string>
 #include <vector>
 #include "fmt/format.h"
+#include "../hash.h"
 
 namespace shdc::refl {
 
@@ -52,10 +53,13 @@ struct Type {
     std::vector<Type> struct_items;
 
     bool equals(const Type& other) const;
+    void add_hash(Hash& hash) const;
     std::string type_as_str() const;
     std::string type_as_glsl() const;
     static std::string type_to_str(Type::Enum e);
     static std::string type_to_glsl(Type::Enum e);
+    static int num_components(Type::Enum e);
+    static Type::Enum scalar_type(Type::Enum e);
     void dump_debug(const std::string& indent) const;
     static bool is_valid_glsl_type(const std::string& str);
     static std::string valid_glsl_types_as_str();
@@ -106,6 +110,25 @@ inline bool Type::equals(const Type& other) const {
     return true;
 }
 
+// add all items which are compared in equals() to a structural hash
+inline void Type::add_hash(Hash& hash) const {
+    hash.add(name)
+        .add(struct_typename)
+        .add((uint64_t)type)
+        .add((uint64_t)is_matrix)
+        .add((uint64_t)is_array)
+        .add((uint64_t)offset)
+        .add((uint64_t)size)
+        .add((uint64_t)align)
+        .add((uint64_t)matrix_stride)
+        .add((uint64_t)array_count)
+        .add((uint64_t)array_stride)
+        .add((uint64_t)struct_items.size());
+    for (const Type& item: struct_items) {
+        item.add_hash(hash);
+    }
+}
+
 inline std::string Type::type_as_str() const {
     return type_to_str(type);
 }
@@ -183,6 +206,38 @@ inline std::string Type::type_to_glsl(Type::Enum e) {
     }
 }
 
+// number of components of scalar and vector types, 0 for matrices and structs
+inline int Type::num_components(Type::Enum e) {
+    switch (e) {
+        case Bool: case Int: case UInt: case Float:
+            return 1;
+        case Bool2: case Int2: case UInt2: case Float2:
+            return 2;
+        case Bool3: case Int3: case UInt3: case Float3:
+            return 3;
+        case Bool4: case Int4: case UInt4: case Float4:
+            return 4;
+        default:
+            return 0;
+    }
+}
+
+// component type of scalar and vector types, Invalid for matrices and structs
+inline Type::Enum Type::scalar_type(Type::Enum e) {
+    switch (e) {
+        case Bool: case Bool2: case Bool3: case Bool4:
+            return Bool;
+        case Int: case Int2: case Int3: case Int4:
+            return Int;
+        case UInt: case UInt2: case UInt3: case UInt4:
+            return UInt;
+        case Float: case Float2: case Float3: case Float4:
+            return Float;
+        default:
+            return Invalid;
+    }
+}
+
 inline bool Type::is_valid_glsl_type(const std::string& str) {
     return (str == "bool") ||
         (str == "bvec2") ||
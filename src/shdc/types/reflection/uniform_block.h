@@ -13,12 +13,17 @@ struct UniformBlock {
     int hlsl_register_b_n = -1;
     int msl_buffer_n = -1;
     int wgsl_group0_binding_n = -1;
+    int spirv_set0_binding_n = -1;
     std::string name;   // shortcut for struct_info.name
     std::string inst_name;
     bool flattened = false;
+    bool used = true;                   // false if the shader code never reads the uniform block
+    std::vector<bool> used_members;     // per struct_info.struct_items, false if the member is never read
     Type struct_info;
+    uint64_t hash = 0;                  // structural hash over the items compared in equals()
 
     bool equals(const UniformBlock& other) const;
+    uint64_t compute_hash() const;
     void dump_debug(const std::string& indent) const;
 };
 
@@ -30,6 +35,13 @@ inline bool UniformBlock::equals(const UniformBlock& other) const {
         && struct_info.equals(other.struct_info);
 }
 
+inline uint64_t UniformBlock::compute_hash() const {
+    Hash h;
+    h.add((uint64_t)stage).add(name).add((uint64_t)flattened);
+    struct_info.add_hash(h);
+    return h.value;
+}
+
 inline void UniformBlock::dump_debug(const std::string& indent) const {
     const std::string indent2 = indent + "  ";
     fmt::print(stderr, "{}-\n", indent);
@@ -38,8 +50,10 @@ inline void UniformBlock::dump_debug(const std::string& indent) const {
     fmt::print(stderr, "{}hlsl_register_b_n: {}\n", indent2, hlsl_register_b_n);
     fmt::print(stderr, "{}msl_buffer_n: {}\n", indent2, msl_buffer_n);
     fmt::print(stderr, "{}wgsl_group0_binding_n: {}\n", indent2, wgsl_group0_binding_n);
+    fmt::print(stderr, "{}spirv_set0_binding_n: {}\n", indent2, spirv_set0_binding_n);
     fmt::print(stderr, "{}inst_name: {}\n", indent2, inst_name);
     fmt::print(stderr, "{}flattened: {}\n", indent2, flattened);
+    fmt::print(stderr, "{}used: {}\n", indent2, used);
     fmt::print(stderr, "{}struct:\n", indent2);
     struct_info.dump_debug(indent2);
 }
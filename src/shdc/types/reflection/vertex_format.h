@@ -0,0 +1,117 @@
+#pragma once
+#include <string>
+#include "type.h"
+
+namespace shdc::refl {
+
+// vertex attribute formats (see sg_vertex_format)
+struct VertexFormat {
+    enum Enum {
+        INVALID,
+        FLOAT,
+        FLOAT2,
+        FLOAT3,
+        FLOAT4,
+        INT,
+        INT2,
+        INT3,
+        INT4,
+        UINT,
+        UINT2,
+        UINT3,
+        UINT4,
+        BYTE4N,
+        UBYTE4N,
+        SHORT2N,
+        USHORT2N,
+        SHORT4N,
+        USHORT4N,
+        UINT10_N2,
+        HALF2,
+        HALF4,
+    };
+    static const char* to_str(Enum e);
+    static int byte_size(Enum e);
+    static Enum from_type(Type::Enum t);
+};
+
+// the sg_vertex_format name without the SG_VERTEXFORMAT_ prefix
+inline const char* VertexFormat::to_str(Enum e) {
+    switch (e) {
+        case FLOAT:     return "FLOAT";
+        case FLOAT2:    return "FLOAT2";
+        case FLOAT3:    return "FLOAT3";
+        case FLOAT4:    return "FLOAT4";
+        case INT:       return "INT";
+        case INT2:      return "INT2";
+        case INT3:      return "INT3";
+        case INT4:      return "INT4";
+        case UINT:      return "UINT";
+        case UINT2:     return "UINT2";
+        case UINT3:     return "UINT3";
+        case UINT4:     return "UINT4";
+        case BYTE4N:    return "BYTE4N";
+        case UBYTE4N:   return "UBYTE4N";
+        case SHORT2N:   return "SHORT2N";
+        case USHORT2N:  return "USHORT2N";
+        case SHORT4N:   return "SHORT4N";
+        case USHORT4N:  return "USHORT4N";
+        case UINT10_N2: return "UINT10_N2";
+        case HALF2:     return "HALF2";
+        case HALF4:     return "HALF4";
+        default:        return "INVALID";
+    }
+}
+
+inline int VertexFormat::byte_size(Enum e) {
+    switch (e) {
+        case FLOAT:
+        case INT:
+        case UINT:
+        case BYTE4N:
+        case UBYTE4N:
+        case SHORT2N:
+        case USHORT2N:
+        case UINT10_N2:
+        case HALF2:
+            return 4;
+        case FLOAT2:
+        case INT2:
+        case UINT2:
+        case SHORT4N:
+        case USHORT4N:
+        case HALF4:
+            return 8;
+        case FLOAT3:
+        case INT3:
+        case UINT3:
+            return 12;
+        case FLOAT4:
+        case INT4:
+        case UINT4:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+// the full-precision vertex format matching a vertex shader input type
+inline VertexFormat::Enum VertexFormat::from_type(Type::Enum t) {
+    switch (t) {
+        case Type::Float:   return FLOAT;
+        case Type::Float2:  return FLOAT2;
+        case Type::Float3:  return FLOAT3;
+        case Type::Float4:  return FLOAT4;
+        case Type::Int:     return INT;
+        case Type::Int2:    return INT2;
+        case Type::Int3:    return INT3;
+        case Type::Int4:    return INT4;
+        case Type::UInt:    return UINT;
+        case Type::UInt2:   return UINT2;
+        case Type::UInt3:   return UINT3;
+        case Type::UInt4:   return UINT4;
+        default:            return INVALID;
+    }
+}
+
+} // namespace
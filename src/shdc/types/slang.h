@@ -17,6 +17,8 @@ struct Slang {
         METAL_IOS,
         METAL_SIM,
         WGSL,
+        SPIRV_VK,
+        SPIRV_GL,
         REFLECTION,     // special 'virtual slang' for extracting reflection info
         Num,
     };
@@ -29,6 +31,7 @@ struct Slang {
     static bool is_hlsl(Enum c);
     static bool is_msl(Enum c);
     static bool is_wgsl(Enum c);
+    static bool is_spirv(Enum c);
     static bool is_reflection(Enum c);
     static Slang::Enum first_valid(uint32_t mask);
 };
@@ -53,6 +56,8 @@ inline const char* Slang::to_str(Enum c) {
         case METAL_IOS:     return "metal_ios";
         case METAL_SIM:     return "metal_sim";
         case WGSL:          return "wgsl";
+        case SPIRV_VK:      return "spirv_vk";
+        case SPIRV_GL:      return "spirv_gl";
         case REFLECTION:    return "reflection";
         default:            return "<invalid>";
     }
@@ -109,6 +114,16 @@ inline bool Slang::is_wgsl(Enum c) {
     return WGSL == c;
 }
 
+inline bool Slang::is_spirv(Enum c) {
+    switch (c) {
+        case SPIRV_VK:
+        case SPIRV_GL:
+            return true;
+        default:
+            return false;
+    }
+}
+
 inline bool Slang::is_reflection(Enum c) {
     return REFLECTION == c;
 }
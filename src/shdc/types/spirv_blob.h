@@ -1,14 +1,20 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <map>
+#include <memory>
 
 namespace shdc {
 
 // a SPIRV-bytecode blob with "back-link" to Input.snippets and some limited reflection info
 struct SpirvBlob {
     int snippet_index = -1;         // index into Input.snippets
-    std::string source;             // source code this blob was compiled from
+    std::shared_ptr<const std::string> source; // source code this blob was compiled from (shared with CompileCache entries)
     std::vector<uint32_t> bytecode; // the resulting SPIRV blob
+    std::map<std::string, int> ub_slots;    // bindings extracted by glslang, merged into Input
+    std::map<std::string, int> img_slots;
+    std::map<std::string, int> smp_slots;
+    std::map<std::string, int> sbuf_slots;
 
     SpirvBlob(int snippet_index);
 };
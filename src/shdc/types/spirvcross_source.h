@@ -1,4 +1,6 @@
 #pragma once
+#include <memory>
+#include <vector>
 #include "errmsg.h"
 #include "reflection/stage_reflection.h"
 
@@ -8,9 +10,10 @@ namespace shdc {
 struct SpirvcrossSource {
     bool valid = false;
     int snippet_index = -1;
-    std::string source_code;
+    std::string source_code;        // for SPIRV output languages the disassembly of spirv
+    std::vector<uint32_t> spirv;    // only for Slang::SPIRV_VK and Slang::SPIRV_GL
     ErrMsg error;
-    refl::StageReflection stage_refl;
+    std::shared_ptr<const refl::StageReflection> stage_refl;  // shared with refl::ProgramReflection
 };
 
 } // namespace shdc
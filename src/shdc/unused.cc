@@ -0,0 +1,202 @@
+/*
+    Report uniform block members, vertex attributes and resources which
+    are never read by the shader code (--unused-report).
+*/
+#include "unused.h"
+#include "layout.h"
+#include "fmt/format.h"
+#include "pystring.h"
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <set>
+
+namespace shdc {
+
+using namespace refl;
+
+// split a source line into identifier-ish tokens
+static void tokenize(const std::string& line, std::vector<std::string>& out_tokens) {
+    std::string str = line;
+    for (char& c: str) {
+        if ((c == '(') || (c == ')') || (c == '{') || (c == '}') || (c == '[') || (c == ']') || (c == ';') || (c == ',') || (c == '=')) {
+            c = ' ';
+        }
+    }
+    pystring::split(str, out_tokens);
+}
+
+// find the position in the snippet's lines of a declaration like 'uniform texture2D tex;', returns -1 if not found
+static int find_decl_pos(const Input& inp, const Snippet& snippet, const std::string& keyword, const std::string& name) {
+    std::vector<std::string> tokens;
+    for (int pos = 0; pos < (int)snippet.lines.size(); pos++) {
+        tokenize(inp.lines[snippet.lines[pos]].line, tokens);
+        auto keyword_it = std::find(tokens.begin(), tokens.end(), keyword);
+        if ((keyword_it != tokens.end()) && (std::find(keyword_it + 1, tokens.end(), name) != tokens.end())) {
+            return pos;
+        }
+    }
+    return -1;
+}
+
+static int find_decl_line(const Input& inp, const Snippet& snippet, const std::string& keyword, const std::string& name) {
+    const int pos = find_decl_pos(inp, snippet, keyword, name);
+    return (pos >= 0) ? snippet.lines[pos] : -1;
+}
+
+// find the line index of a uniform block member declaration, returns -1 if not found
+static int find_member_line(const Input& inp, const Snippet& snippet, const std::string& block_name, const std::string& member_name) {
+    const int block_pos = find_decl_pos(inp, snippet, "uniform", block_name);
+    if (block_pos < 0) {
+        return -1;
+    }
+    std::vector<std::string> tokens;
+    for (int pos = block_pos + 1; pos < (int)snippet.lines.size(); pos++) {
+        const std::string& line = inp.lines[snippet.lines[pos]].line;
+        tokenize(line, tokens);
+        if ((tokens.size() > 1) && (std::find(tokens.begin() + 1, tokens.end(), member_name) != tokens.end())) {
+            return snippet.lines[pos];
+        }
+        if (line.find('}') != std::string::npos) {
+            break;
+        }
+    }
+    return -1;
+}
+
+// a resource which is bound in several shader stages of a program is only
+// unused if no stage reads it, uniform block members are merged the same way
+struct ProgramUsage {
+    std::map<std::string, bool> used;                       // key is '[kind]:[name]'
+    std::map<std::string, std::vector<bool>> used_members;  // key is the uniform block name
+
+    void add(const std::string& kind, const std::string& name, bool is_used) {
+        used[kind + ":" + name] |= is_used;
+    }
+    void add_members(const UniformBlock& ub) {
+        std::vector<bool>& dst = used_members[ub.name];
+        dst.resize(ub.struct_info.struct_items.size(), false);
+        for (size_t i = 0; (i < ub.used_members.size()) && (i < dst.size()); i++) {
+            dst[i] = dst[i] || ub.used_members[i];
+        }
+    }
+};
+
+std::vector<ErrMsg> Unused::report(const Input& inp, const Reflection& refl) {
+    // programs which share a snippet have the same unused items, each item
+    // is reported once at its source location with all affected programs
+    struct Item {
+        int line_index;
+        std::string msg;
+        std::vector<std::string> progs;
+    };
+    std::vector<Item> unused_items;
+    std::map<std::pair<int, std::string>, size_t> unused_item_index;
+    for (const ProgramReflection& prog: refl.progs) {
+        const int prog_line_index = inp.programs.at(prog.name).line_index;
+        ProgramUsage usage;
+        for (const auto& stage_ptr: prog.stages) {
+            const Bindings& bindings = stage_ptr->bindings;
+            for (const UniformBlock& ub: bindings.uniform_blocks) {
+                usage.add("ub", ub.name, ub.used);
+                if (ub.used) {
+                    usage.add_members(ub);
+                }
+            }
+            for (const StorageBuffer& sbuf: bindings.storage_buffers) {
+                usage.add("sbuf", sbuf.name, sbuf.used);
+            }
+            for (const Image& img: bindings.images) {
+                usage.add("img", img.name, img.used);
+            }
+            for (const Sampler& smp: bindings.samplers) {
+                usage.add("smp", smp.name, smp.used);
+            }
+        }
+        // items which can't be found in the source are reported at the @program tag
+        auto warn = [&unused_items, &unused_item_index, &prog, prog_line_index](int line_index, const std::string& msg) {
+            const auto key = std::make_pair((line_index >= 0) ? line_index : prog_line_index, msg);
+            const auto it = unused_item_index.find(key);
+            if (it == unused_item_index.end()) {
+                unused_item_index[key] = unused_items.size();
+                unused_items.push_back({ key.first, msg, { prog.name } });
+            } else if (unused_items[it->second].progs.back() != prog.name) {
+                unused_items[it->second].progs.push_back(prog.name);
+            }
+        };
+        // report each resource of the program only once, in the first stage which binds it
+        std::set<std::string> reported;
+        auto is_unused = [&usage, &reported](const std::string& kind, const std::string& name) {
+            const std::string key = kind + ":" + name;
+            return !usage.used[key] && reported.insert(key).second;
+        };
+        for (const auto& stage_ptr: prog.stages) {
+            const StageReflection& stage_refl = *stage_ptr;
+            const Snippet& snippet = inp.snippets[stage_refl.snippet_index];
+            const Bindings& bindings = stage_refl.bindings;
+            if (ShaderStage::is_vs(stage_refl.stage)) {
+                for (const StageAttr& attr: stage_refl.inputs) {
+                    if ((attr.slot >= 0) && !attr.used) {
+                        warn(find_decl_line(inp, snippet, "in", attr.name), fmt::format("vertex attribute '{}' is never read", attr.name));
+                    }
+                }
+            }
+            for (const UniformBlock& ub: bindings.uniform_blocks) {
+                const int block_line_index = find_decl_line(inp, snippet, "uniform", ub.name);
+                if (is_unused("ub", ub.name)) {
+                    warn(block_line_index, fmt::format("uniform block '{}' is never read", ub.name));
+                    continue;
+                }
+                if (!usage.used["ub:" + ub.name] || !reported.insert("ub_members:" + ub.name).second) {
+                    continue;
+                }
+                const std::vector<bool>& used_members = usage.used_members[ub.name];
+                const std::vector<LayoutItem> items = Layout::items_from_struct(ub.struct_info);
+                std::vector<LayoutItem> used_items;
+                for (size_t i = 0; i < items.size(); i++) {
+                    if ((i < used_members.size()) && used_members[i]) {
+                        used_items.push_back(items[i]);
+                    } else {
+                        const std::string& member_name = ub.struct_info.struct_items[i].name;
+                        warn(find_member_line(inp, snippet, ub.name, member_name), fmt::format("uniform block member '{}.{}' is never read", ub.name, member_name));
+                    }
+                }
+                if (used_items.size() < items.size()) {
+                    // suggest a trimmed layout which only contains the used members
+                    std::vector<int> order(items.size());
+                    std::iota(order.begin(), order.end(), 0);
+                    const std::vector<int> trimmed_order = Layout::optimize(used_items);
+                    std::vector<std::string> decls;
+                    for (int item_index: trimmed_order) {
+                        decls.push_back(used_items[item_index].decl);
+                    }
+                    warn(block_line_index, fmt::format("uniform block '{}' without unused members needs {} instead of {} bytes: '{};'",
+                        ub.name, Layout::block_size(used_items, trimmed_order), Layout::block_size(items, order), pystring::join("; ", decls)));
+                }
+            }
+            for (const StorageBuffer& sbuf: bindings.storage_buffers) {
+                if (is_unused("sbuf", sbuf.name)) {
+                    warn(find_decl_line(inp, snippet, "buffer", sbuf.name), fmt::format("storage buffer '{}' is never accessed", sbuf.name));
+                }
+            }
+            for (const Image& img: bindings.images) {
+                if (is_unused("img", img.name)) {
+                    warn(find_decl_line(inp, snippet, "uniform", img.name), fmt::format("image '{}' is never sampled", img.name));
+                }
+            }
+            for (const Sampler& smp: bindings.samplers) {
+                if (is_unused("smp", smp.name)) {
+                    warn(find_decl_line(inp, snippet, "uniform", smp.name), fmt::format("sampler '{}' is never used", smp.name));
+                }
+            }
+        }
+    }
+    std::vector<ErrMsg> res;
+    for (const Item& item: unused_items) {
+        const std::string progs = pystring::join("', '", item.progs);
+        res.push_back(inp.warning(item.line_index, fmt::format("{} '{}': {}", (item.progs.size() > 1) ? "programs" : "program", progs, item.msg)));
+    }
+    return res;
+}
+
+} // namespace shdc
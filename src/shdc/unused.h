@@ -0,0 +1,16 @@
+#pragma once
+#include <vector>
+#include "input.h"
+#include "reflection.h"
+#include "types/errmsg.h"
+
+namespace shdc {
+
+// detection of uniform block members, vertex attributes and resources which are
+// never read by the shader code after SPIRV optimization (--unused-report)
+struct Unused {
+    // return one warning for each unused item, located at its declaration in the source and listing all programs with that item
+    static std::vector<ErrMsg> report(const Input& inp, const refl::Reflection& refl);
+};
+
+} // namespace shdc
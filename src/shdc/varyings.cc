@@ -0,0 +1,385 @@
+/*
+    Pack vertex shader outputs and fragment shader inputs into vec4 slots.
+*/
+#include "varyings.h"
+#include "spirvutil.h"
+#include "fmt/format.h"
+#include <algorithm>
+#include <map>
+
+namespace shdc {
+
+// a vertex shader output or fragment shader input which can be packed
+struct PackableVarying {
+    uint32_t var_id = 0;
+    uint32_t location = 0;
+    uint32_t num_components = 0;
+    uint32_t value_type_id = 0;
+    std::vector<uint32_t> key;      // interpolation and precision decorations, must be identical within a vec4
+};
+
+// a varying after packing, component is the first component in the packed vec4
+struct PackedVarying {
+    uint32_t packed_var_id = 0;
+    uint32_t component = 0;
+    uint32_t num_components = 0;
+};
+
+bool Varyings::pack_spirv(std::vector<uint32_t>& words, std::string& out_error) {
+    std::vector<SpvInstr> instrs;
+    if (!spv_split(words, instrs)) {
+        out_error = "invalid SPIRV blob";
+        return false;
+    }
+    uint32_t bound = words[3];
+
+    // gather types, constants, global variables and decorations
+    int entry_point_index = -1;
+    int num_entry_points = 0;
+    std::map<uint32_t, uint32_t> float_types;           // id => width
+    std::map<uint32_t, std::pair<uint32_t,uint32_t>> vector_types;   // id => (component type, count)
+    std::map<uint32_t, std::pair<uint32_t,uint32_t>> pointer_types;  // id => (storage class, pointee type)
+    std::map<uint32_t, uint32_t> int_types;             // id => width
+    std::map<uint32_t, std::pair<uint32_t,uint32_t>> int_constants;  // id => (type, value)
+    std::map<uint32_t, std::pair<uint32_t,uint32_t>> variables;      // id => (pointer type, storage class)
+    std::map<uint32_t, std::vector<std::vector<uint32_t>>> decorations;     // id => (decoration + args)
+    int first_function_index = (int)instrs.size();
+    for (int i = 0; i < (int)instrs.size(); i++) {
+        const std::vector<uint32_t>& w = instrs[i].words;
+        switch (instrs[i].op()) {
+            case spv::OpEntryPoint:
+                entry_point_index = i;
+                num_entry_points++;
+                break;
+            case spv::OpTypeFloat:
+                float_types[w[1]] = w[2];
+                break;
+            case spv::OpTypeInt:
+                int_types[w[1]] = w[2];
+                break;
+            case spv::OpTypeVector:
+                vector_types[w[1]] = { w[2], w[3] };
+                break;
+            case spv::OpTypePointer:
+                pointer_types[w[1]] = { w[2], w[3] };
+                break;
+            case spv::OpConstant:
+                if ((w.size() == 4) && (int_types.count(w[1]) > 0)) {
+                    int_constants[w[2]] = { w[1], w[3] };
+                }
+                break;
+            case spv::OpVariable:
+                if (i < first_function_index) {
+                    variables[w[2]] = { w[1], w[3] };
+                }
+                break;
+            case spv::OpDecorate:
+                decorations[w[1]].push_back(std::vector<uint32_t>(w.begin() + 2, w.end()));
+                break;
+            case spv::OpFunction:
+                if (i < first_function_index) {
+                    first_function_index = i;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    if (num_entry_points != 1) {
+        // nothing to do
+        return true;
+    }
+    spv::StorageClass storage_class;
+    switch (instrs[entry_point_index].words[1]) {
+        case spv::ExecutionModelVertex:   storage_class = spv::StorageClassOutput; break;
+        case spv::ExecutionModelFragment: storage_class = spv::StorageClassInput; break;
+        default: return true;
+    }
+
+    // find varyings of type float, vec2 and vec3 which only have a location, interpolation and precision decorations
+    std::vector<PackableVarying> candidates;
+    for (const auto& [var_id, var]: variables) {
+        if (var.second != (uint32_t)storage_class) {
+            continue;
+        }
+        const auto ptr_it = pointer_types.find(var.first);
+        if (ptr_it == pointer_types.end()) {
+            continue;
+        }
+        PackableVarying varying;
+        varying.var_id = var_id;
+        varying.value_type_id = ptr_it->second.second;
+        const auto vec_it = vector_types.find(varying.value_type_id);
+        if ((float_types.count(varying.value_type_id) > 0) && (float_types[varying.value_type_id] == 32)) {
+            varying.num_components = 1;
+        } else if ((vec_it != vector_types.end())
+            && (float_types.count(vec_it->second.first) > 0) && (float_types[vec_it->second.first] == 32)
+            && ((vec_it->second.second == 2) || (vec_it->second.second == 3)))
+        {
+            varying.num_components = vec_it->second.second;
+        } else {
+            continue;
+        }
+        bool has_location = false;
+        bool packable = true;
+        for (const std::vector<uint32_t>& deco: decorations[var_id]) {
+            switch (deco[0]) {
+                case spv::DecorationLocation:
+                    has_location = true;
+                    varying.location = deco[1];
+                    break;
+                case spv::DecorationFlat:
+                case spv::DecorationNoPerspective:
+                case spv::DecorationCentroid:
+                case spv::DecorationSample:
+                case spv::DecorationRelaxedPrecision:
+                    varying.key.push_back(deco[0]);
+                    break;
+                default:
+                    packable = false;
+                    break;
+            }
+        }
+        if (has_location && packable) {
+            std::sort(varying.key.begin(), varying.key.end());
+            candidates.push_back(varying);
+        }
+    }
+
+    // first-fit-decreasing bin packing into vec4s, only varyings with identical decorations may share a vec4
+    std::stable_sort(candidates.begin(), candidates.end(), [](const PackableVarying& a, const PackableVarying& b) {
+        return a.location < b.location;
+    });
+    std::map<std::vector<uint32_t>, std::vector<PackableVarying>> groups;
+    for (const PackableVarying& varying: candidates) {
+        groups[varying.key].push_back(varying);
+    }
+    struct Bin {
+        std::vector<uint32_t> key;
+        std::vector<PackableVarying> items;
+        uint32_t num_components = 0;
+        uint32_t location = 0;
+    };
+    std::vector<Bin> bins;
+    for (auto& [key, group]: groups) {
+        std::stable_sort(group.begin(), group.end(), [](const PackableVarying& a, const PackableVarying& b) {
+            return a.num_components > b.num_components;
+        });
+        const size_t first_bin = bins.size();
+        for (const PackableVarying& varying: group) {
+            size_t bin_index = first_bin;
+            while ((bin_index < bins.size()) && ((bins[bin_index].num_components + varying.num_components) > 4)) {
+                bin_index++;
+            }
+            if (bin_index == bins.size()) {
+                Bin bin;
+                bin.key = key;
+                bin.location = varying.location;
+                bins.push_back(bin);
+            }
+            Bin& bin = bins[bin_index];
+            bin.items.push_back(varying);
+            bin.num_components += varying.num_components;
+            bin.location = std::min(bin.location, varying.location);
+        }
+    }
+    bins.erase(std::remove_if(bins.begin(), bins.end(), [](const Bin& bin) { return bin.items.size() < 2; }), bins.end());
+    if (bins.empty()) {
+        return true;
+    }
+
+    // lookup or create the required types and constants
+    std::vector<SpvInstr> new_globals;
+    auto find_or_add = [&instrs, &new_globals, &bound, first_function_index](spv::Op op, const std::vector<uint32_t>& operands, int result_index) -> uint32_t {
+        auto matches = [&](const SpvInstr& instr) {
+            if ((instr.op() != (uint32_t)op) || (instr.words.size() != (operands.size() + 2))) {
+                return false;
+            }
+            for (size_t i = 0, w = 1; i < operands.size(); i++, w++) {
+                if (w == (size_t)(result_index + 1)) {
+                    w++;
+                }
+                if (instr.words[w] != operands[i]) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        for (int i = 0; i < first_function_index; i++) {
+            if (matches(instrs[i])) {
+                return instrs[i].words[result_index + 1];
+            }
+        }
+        for (const SpvInstr& instr: new_globals) {
+            if (matches(instr)) {
+                return instr.words[result_index + 1];
+            }
+        }
+        const uint32_t id = bound++;
+        std::vector<uint32_t> all_operands = operands;
+        all_operands.insert(all_operands.begin() + result_index, id);
+        new_globals.push_back(spv_make_instr(op, all_operands));
+        return id;
+    };
+    uint32_t float_type_id = 0;
+    for (const auto& [id, width]: float_types) {
+        if (width == 32) {
+            float_type_id = id;
+            break;
+        }
+    }
+    uint32_t int_type_id = 0;
+    for (const auto& [id, width]: int_types) {
+        if (width == 32) {
+            int_type_id = id;
+            break;
+        }
+    }
+    if (0 == int_type_id) {
+        int_type_id = find_or_add(spv::OpTypeInt, { 32, 0 }, 0);
+    }
+    const uint32_t vec4_type_id = find_or_add(spv::OpTypeVector, { float_type_id, 4 }, 0);
+    const uint32_t vec4_ptr_type_id = find_or_add(spv::OpTypePointer, { (uint32_t)storage_class, vec4_type_id }, 0);
+    const uint32_t float_ptr_type_id = find_or_add(spv::OpTypePointer, { (uint32_t)storage_class, float_type_id }, 0);
+    // all index constants are created upfront, so that new_globals is complete before rewriting the function bodies
+    uint32_t index_constants[4];
+    for (uint32_t i = 0; i < 4; i++) {
+        index_constants[i] = find_or_add(spv::OpConstant, { int_type_id, i }, 1);
+    }
+
+    // create the packed variables
+    std::map<uint32_t, PackedVarying> packed;
+    std::vector<SpvInstr> new_names;
+    std::vector<SpvInstr> new_decorations;
+    for (const Bin& bin: bins) {
+        const uint32_t packed_var_id = bound++;
+        new_globals.push_back(spv_make_instr(spv::OpVariable, { vec4_ptr_type_id, packed_var_id, (uint32_t)storage_class }));
+        // the name must be identical in the vertex and fragment shader because GLSL ES links varyings by name
+        new_names.push_back(spv_make_name(packed_var_id, fmt::format("shdc_varying_{}", bin.location)));
+        new_decorations.push_back(spv_make_instr(spv::OpDecorate, { packed_var_id, spv::DecorationLocation, bin.location }));
+        for (uint32_t deco: bin.key) {
+            new_decorations.push_back(spv_make_instr(spv::OpDecorate, { packed_var_id, deco }));
+        }
+        uint32_t component = 0;
+        for (const PackableVarying& varying: bin.items) {
+            packed[varying.var_id] = { packed_var_id, component, varying.num_components };
+            component += varying.num_components;
+        }
+    }
+
+    // rewrite the module
+    std::vector<SpvInstr> out_instrs;
+    bool names_added = false;
+    bool decorations_added = false;
+    for (int i = 0; i < (int)instrs.size(); i++) {
+        const SpvInstr& instr = instrs[i];
+        const std::vector<uint32_t>& w = instr.words;
+        const uint32_t op = instr.op();
+        if (!names_added && !spv_is_preamble_op(op) && !spv_is_debug_op(op)) {
+            out_instrs.insert(out_instrs.end(), new_names.begin(), new_names.end());
+            names_added = true;
+        }
+        if (names_added && !decorations_added && !spv_is_annotation_op(op)) {
+            out_instrs.insert(out_instrs.end(), new_decorations.begin(), new_decorations.end());
+            decorations_added = true;
+        }
+        if (i == first_function_index) {
+            out_instrs.insert(out_instrs.end(), new_globals.begin(), new_globals.end());
+        }
+        if (i < first_function_index) {
+            if (op == spv::OpEntryPoint) {
+                // replace the packed varyings in the interface list
+                const size_t interface_start = 3 + spv_literal_string_num_words(w, 3);
+                std::vector<uint32_t> operands(w.begin() + 1, w.begin() + interface_start);
+                for (size_t k = interface_start; k < w.size(); k++) {
+                    if (packed.count(w[k]) == 0) {
+                        operands.push_back(w[k]);
+                    }
+                }
+                for (const SpvInstr& var: new_globals) {
+                    if (var.op() == spv::OpVariable) {
+                        operands.push_back(var.words[2]);
+                    }
+                }
+                out_instrs.push_back(spv_make_instr(spv::OpEntryPoint, operands));
+                continue;
+            }
+            if (((op == spv::OpName) || (op == spv::OpDecorate)) && (packed.count(w[1]) > 0)) {
+                continue;
+            }
+            if ((op == spv::OpVariable) && (packed.count(w[2]) > 0)) {
+                continue;
+            }
+            out_instrs.push_back(instr);
+            continue;
+        }
+        // function bodies: rewrite loads, stores and access chains of the packed varyings
+        if ((op == spv::OpLoad) && (packed.count(w[3]) > 0)) {
+            const PackedVarying& pv = packed[w[3]];
+            const uint32_t vec4_id = bound++;
+            out_instrs.push_back(spv_make_instr(spv::OpLoad, { vec4_type_id, vec4_id, pv.packed_var_id }));
+            if (pv.num_components == 1) {
+                out_instrs.push_back(spv_make_instr(spv::OpCompositeExtract, { w[1], w[2], vec4_id, pv.component }));
+            } else {
+                std::vector<uint32_t> operands = { w[1], w[2], vec4_id, vec4_id };
+                for (uint32_t c = 0; c < pv.num_components; c++) {
+                    operands.push_back(pv.component + c);
+                }
+                out_instrs.push_back(spv_make_instr(spv::OpVectorShuffle, operands));
+            }
+        } else if ((op == spv::OpStore) && (packed.count(w[1]) > 0)) {
+            const PackedVarying& pv = packed[w[1]];
+            for (uint32_t c = 0; c < pv.num_components; c++) {
+                const uint32_t ptr_id = bound++;
+                out_instrs.push_back(spv_make_instr(spv::OpAccessChain, { float_ptr_type_id, ptr_id, pv.packed_var_id, index_constants[pv.component + c] }));
+                if (pv.num_components == 1) {
+                    out_instrs.push_back(spv_make_instr(spv::OpStore, { ptr_id, w[2] }));
+                } else {
+                    const uint32_t elm_id = bound++;
+                    out_instrs.push_back(spv_make_instr(spv::OpCompositeExtract, { float_type_id, elm_id, w[2], c }));
+                    out_instrs.push_back(spv_make_instr(spv::OpStore, { ptr_id, elm_id }));
+                }
+            }
+        } else if (((op == spv::OpAccessChain) || (op == spv::OpInBoundsAccessChain)) && (packed.count(w[3]) > 0)) {
+            const PackedVarying& pv = packed[w[3]];
+            uint32_t index_id = 0;
+            if (w.size() != 5) {
+                out_error = "unsupported access chain into packed varying";
+                return false;
+            } else if ((int_constants.count(w[4]) > 0) && ((pv.component + int_constants[w[4]].second) < 4)) {
+                index_id = index_constants[pv.component + int_constants[w[4]].second];
+            } else if (pv.component == 0) {
+                index_id = w[4];
+            } else {
+                out_error = "dynamic indexing into packed varying not supported";
+                return false;
+            }
+            out_instrs.push_back(spv_make_instr((spv::Op)op, { w[1], w[2], pv.packed_var_id, index_id }));
+        } else {
+            for (size_t k = 1; k < w.size(); k++) {
+                if (packed.count(w[k]) > 0) {
+                    out_error = fmt::format("unsupported use of packed varying in SPIRV instruction (opcode {})", op);
+                    return false;
+                }
+            }
+            out_instrs.push_back(instr);
+        }
+    }
+
+    spv_join(out_instrs, bound, words);
+    return true;
+}
+
+ErrMsg Varyings::pack(const Input& inp, Spirv& spirv) {
+    for (SpirvBlob& blob: spirv.blobs) {
+        std::string error;
+        if (!pack_spirv(blob.bytecode, error)) {
+            const Snippet& snippet = inp.snippets[blob.snippet_index];
+            const int line_index = snippet.lines.empty() ? 0 : snippet.lines[0];
+            return inp.error(line_index, fmt::format("--pack-varyings: {} in '{}'", error, snippet.name));
+        }
+    }
+    return ErrMsg();
+}
+
+} // namespace shdc
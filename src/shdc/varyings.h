@@ -0,0 +1,24 @@
+#pragma once
+#include <vector>
+#include <string>
+#include "input.h"
+#include "spirv.h"
+#include "types/errmsg.h"
+
+namespace shdc {
+
+// SPIRV transform which packs float, vec2 and vec3 vertex shader outputs and
+// fragment shader inputs into shared vec4 slots (--pack-varyings)
+//
+// Packing only depends on the declarations (location, type, interpolation
+// and precision decorations) which must be identical on both sides of a
+// @program, so that the vertex and fragment shader are rewritten consistently
+// even though they are compiled separately.
+struct Varyings {
+    // rewrite all SPIRV blobs, returns an error if a varying is used in an unsupported way
+    static ErrMsg pack(const Input& inp, Spirv& spirv);
+    // rewrite a single SPIRV blob, returns false and an error message on failure
+    static bool pack_spirv(std::vector<uint32_t>& words, std::string& out_error);
+};
+
+} // namespace shdc
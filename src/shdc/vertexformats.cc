@@ -0,0 +1,376 @@
+/*
+    Find compact vertex formats for vertex attributes by looking at how
+    the vertex shader uses them (--vertex-formats).
+*/
+#include "vertexformats.h"
+#include "spirvutil.h"
+#include "GLSL.std.450.h"
+#include "fmt/format.h"
+#include "pystring.h"
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <set>
+
+namespace shdc {
+
+using namespace refl;
+
+// how a vertex attribute value is used, as bit mask
+enum AttrUsage {
+    USAGE_DIRECTION = (1<<0),           // only the direction matters (normalize())
+    USAGE_BIASED_DIRECTION = (1<<1),    // normalize() after scale and bias, e.g. normalize(n * 2.0 - 1.0)
+    USAGE_UNORM = (1<<2),               // clamped to 0..1
+    USAGE_SNORM = (1<<3),               // clamped to -1..1
+    USAGE_PASSTHROUGH = (1<<4),         // written unmodified to a vertex shader output
+    USAGE_OTHER = (1<<5),               // anything else, needs full precision
+};
+
+// the maximum length of an instruction chain from an attribute load to its use
+static const int max_trace_depth = 16;
+
+// the vertex shader state needed for tracing attribute uses
+struct VertexModule {
+    std::vector<SpvInstr> instrs;
+    uint32_t glsl_ext_id = 0;
+    std::map<uint32_t, std::string> names;
+    std::map<uint32_t, uint32_t> locations;
+    std::set<uint32_t> builtins;
+    std::map<uint32_t, uint32_t> variables;                 // global variable id => storage class
+    std::map<uint32_t, std::pair<float,float>> constants;   // float constant id => (min, max) of all components
+    std::map<uint32_t, uint32_t> vector_sizes;              // result id => number of vector components
+    std::map<uint32_t, uint32_t> pointer_bases;             // access chain id => variable id
+    std::map<uint32_t, std::vector<std::pair<int,int>>> uses;   // id => (instruction index, word index)
+
+    uint32_t pointer_base(uint32_t id) const {
+        const auto it = pointer_bases.find(id);
+        return (it != pointer_bases.end()) ? it->second : id;
+    }
+    bool is_const(uint32_t id) const {
+        return constants.count(id) > 0;
+    }
+};
+
+// find all uses of a value derived from a vertex attribute
+static uint32_t trace(const VertexModule& m, uint32_t id, bool scaled, bool biased, int depth) {
+    const auto uses_it = m.uses.find(id);
+    if (uses_it == m.uses.end()) {
+        return 0;
+    }
+    if (depth > max_trace_depth) {
+        return USAGE_OTHER;
+    }
+    uint32_t usage = 0;
+    for (const auto& [instr_index, word_index]: uses_it->second) {
+        const std::vector<uint32_t>& w = m.instrs[instr_index].words;
+        // the other operand of binary instructions
+        const uint32_t other = (w.size() < 5) ? 0 : ((word_index == 3) ? w[4] : w[3]);
+        switch (m.instrs[instr_index].op()) {
+            case spv::OpCompositeExtract:
+            case spv::OpCopyObject:
+                usage |= trace(m, w[2], scaled, biased, depth + 1);
+                break;
+            case spv::OpVectorShuffle:
+                {
+                    // only pass through if all selected components come from the traced value
+                    const uint32_t num_first = m.vector_sizes.count(w[3]) ? m.vector_sizes.at(w[3]) : 4;
+                    bool selected_only = true;
+                    for (size_t k = 5; k < w.size(); k++) {
+                        if ((w[k] != 0xFFFFFFFF) && (w[3] != w[4]) && ((word_index == 3) != (w[k] < num_first))) {
+                            selected_only = false;
+                        }
+                    }
+                    usage |= selected_only ? trace(m, w[2], scaled, biased, depth + 1) : USAGE_OTHER;
+                }
+                break;
+            case spv::OpFMul:
+            case spv::OpVectorTimesScalar:
+                usage |= m.is_const(other) ? trace(m, w[2], true, biased, depth + 1) : USAGE_OTHER;
+                break;
+            case spv::OpFAdd:
+            case spv::OpFSub:
+                usage |= m.is_const(other) ? trace(m, w[2], scaled, true, depth + 1) : USAGE_OTHER;
+                break;
+            case spv::OpFNegate:
+                usage |= trace(m, w[2], true, biased, depth + 1);
+                break;
+            case spv::OpExtInst:
+                if (w[3] != m.glsl_ext_id) {
+                    usage |= USAGE_OTHER;
+                    break;
+                }
+                switch (w[4]) {
+                    case GLSLstd450Normalize:
+                        usage |= biased ? USAGE_BIASED_DIRECTION : USAGE_DIRECTION;
+                        break;
+                    case GLSLstd450FClamp:
+                    case GLSLstd450NClamp:
+                        if ((word_index == 5) && !scaled && !biased && m.is_const(w[6]) && m.is_const(w[7])) {
+                            const float lo = m.constants.at(w[6]).first;
+                            const float hi = m.constants.at(w[7]).second;
+                            if ((lo >= 0.0f) && (hi <= 1.0f)) {
+                                usage |= USAGE_UNORM;
+                            } else if ((lo >= -1.0f) && (hi <= 1.0f)) {
+                                usage |= USAGE_SNORM;
+                            } else {
+                                usage |= USAGE_OTHER;
+                            }
+                        } else {
+                            usage |= USAGE_OTHER;
+                        }
+                        break;
+                    case GLSLstd450Fma:
+                        if ((word_index != 7) && m.is_const((word_index == 5) ? w[6] : w[5]) && m.is_const(w[7])) {
+                            usage |= trace(m, w[2], true, true, depth + 1);
+                        } else {
+                            usage |= USAGE_OTHER;
+                        }
+                        break;
+                    default:
+                        usage |= USAGE_OTHER;
+                        break;
+                }
+                break;
+            case spv::OpStore:
+                {
+                    const uint32_t var_id = m.pointer_base(w[1]);
+                    const auto var_it = m.variables.find(var_id);
+                    if ((word_index == 2) && !scaled && !biased && (var_it != m.variables.end())
+                        && (var_it->second == spv::StorageClassOutput) && (m.builtins.count(var_id) == 0))
+                    {
+                        usage |= USAGE_PASSTHROUGH;
+                    } else {
+                        usage |= USAGE_OTHER;
+                    }
+                }
+                break;
+            default:
+                usage |= USAGE_OTHER;
+                break;
+        }
+    }
+    return usage;
+}
+
+// pick a compact vertex format for an attribute with num_components from its usage
+static VertexFormat::Enum compact_format(uint32_t usage, int num_components, std::string& out_reason) {
+    if ((usage == 0) || (usage & USAGE_OTHER) || (num_components < 2)) {
+        return VertexFormat::INVALID;
+    }
+    if ((usage & ~(USAGE_DIRECTION|USAGE_SNORM)) == 0) {
+        if (usage == USAGE_DIRECTION) {
+            out_reason = "only used in normalize()";
+        } else if (usage == USAGE_SNORM) {
+            out_reason = "only used clamped to -1..+1";
+        } else {
+            out_reason = "only used in normalize() or clamped to -1..+1";
+        }
+        return (num_components == 2) ? VertexFormat::SHORT2N : VertexFormat::SHORT4N;
+    }
+    if (usage == USAGE_UNORM) {
+        out_reason = "only used clamped to 0..+1";
+        return VertexFormat::UBYTE4N;
+    }
+    if (usage == USAGE_BIASED_DIRECTION) {
+        out_reason = "only used in normalize() after scale and bias, the vertex data must be in the range 0..+1";
+        switch (num_components) {
+            case 2: return VertexFormat::USHORT2N;
+            case 3: return VertexFormat::UINT10_N2;
+            default: return VertexFormat::USHORT4N;
+        }
+    }
+    if (usage == USAGE_PASSTHROUGH) {
+        out_reason = "only passed through to the fragment shader, check that half precision is sufficient";
+        return (num_components == 2) ? VertexFormat::HALF2 : VertexFormat::HALF4;
+    }
+    return VertexFormat::INVALID;
+}
+
+static int num_float_components(Type::Enum type) {
+    switch (type) {
+        case Type::Float:   return 1;
+        case Type::Float2:  return 2;
+        case Type::Float3:  return 3;
+        case Type::Float4:  return 4;
+        default:            return 0;
+    }
+}
+
+// find the line index of a vertex attribute declaration, falls back to the first line of the snippet
+static int find_attr_line(const Input& inp, const Snippet& snippet, const std::string& name) {
+    std::vector<std::string> tokens;
+    for (int line_index: snippet.lines) {
+        pystring::split(pystring::replace(inp.lines[line_index].line, ";", " ; "), tokens);
+        if ((std::find(tokens.begin(), tokens.end(), "in") != tokens.end()) && (std::find(tokens.begin(), tokens.end(), name) != tokens.end())) {
+            return line_index;
+        }
+    }
+    return snippet.lines.empty() ? 0 : snippet.lines[0];
+}
+
+// gather the usage of each vertex attribute of a vertex shader blob, by attribute name
+static std::map<std::string, uint32_t> attr_usages(const SpirvBlob& blob) {
+    std::map<std::string, uint32_t> res;
+    VertexModule m;
+    if (!spv_split(blob.bytecode, m.instrs)) {
+        return res;
+    }
+    int num_entry_points = 0;
+    uint32_t execution_model = 0;
+    std::set<uint32_t> type_ids;
+    std::map<uint32_t, uint32_t> vector_types;      // type id => number of components
+    int first_function_index = (int)m.instrs.size();
+    for (int i = 0; i < (int)m.instrs.size(); i++) {
+        const std::vector<uint32_t>& w = m.instrs[i].words;
+        const uint32_t op = m.instrs[i].op();
+        if (op == spv::OpFunction) {
+            first_function_index = i;
+            break;
+        }
+        if ((op >= spv::OpTypeVoid) && (op <= spv::OpTypeForwardPointer)) {
+            type_ids.insert(w[1]);
+        }
+        switch (op) {
+            case spv::OpEntryPoint:
+                execution_model = w[1];
+                num_entry_points++;
+                break;
+            case spv::OpExtInstImport:
+                if (spv_literal_string(w, 2) == "GLSL.std.450") {
+                    m.glsl_ext_id = w[1];
+                }
+                break;
+            case spv::OpName:
+                m.names[w[1]] = spv_literal_string(w, 2);
+                break;
+            case spv::OpDecorate:
+                if (w[2] == spv::DecorationLocation) {
+                    m.locations[w[1]] = w[3];
+                } else if (w[2] == spv::DecorationBuiltIn) {
+                    m.builtins.insert(w[1]);
+                }
+                break;
+            case spv::OpTypeVector:
+                vector_types[w[1]] = w[3];
+                break;
+            case spv::OpConstant:
+                if (w.size() == 4) {
+                    float f;
+                    memcpy(&f, &w[3], sizeof(f));
+                    m.constants[w[2]] = { f, f };
+                }
+                break;
+            case spv::OpConstantComposite:
+                {
+                    bool all_const = true;
+                    std::pair<float,float> range = { 1e38f, -1e38f };
+                    for (size_t k = 3; k < w.size(); k++) {
+                        if (!m.is_const(w[k])) {
+                            all_const = false;
+                            break;
+                        }
+                        range.first = std::min(range.first, m.constants[w[k]].first);
+                        range.second = std::max(range.second, m.constants[w[k]].second);
+                    }
+                    if (all_const) {
+                        m.constants[w[2]] = range;
+                    }
+                }
+                break;
+            case spv::OpVariable:
+                m.variables[w[2]] = w[3];
+                break;
+            default:
+                break;
+        }
+    }
+    if ((num_entry_points != 1) || (execution_model != spv::ExecutionModelVertex)) {
+        return res;
+    }
+    for (int i = first_function_index; i < (int)m.instrs.size(); i++) {
+        const std::vector<uint32_t>& w = m.instrs[i].words;
+        const uint32_t op = m.instrs[i].op();
+        const bool has_result = (w.size() >= 3) && (type_ids.count(w[1]) > 0);
+        if (has_result && (vector_types.count(w[1]) > 0)) {
+            m.vector_sizes[w[2]] = vector_types[w[1]];
+        }
+        if ((op == spv::OpAccessChain) || (op == spv::OpInBoundsAccessChain)) {
+            m.pointer_bases[w[2]] = m.pointer_base(w[3]);
+        }
+        for (size_t k = has_result ? 3 : 1; k < w.size(); k++) {
+            m.uses[w[k]].push_back({ i, (int)k });
+        }
+    }
+    for (const auto& [var_id, storage_class]: m.variables) {
+        if ((storage_class != spv::StorageClassInput) || (m.builtins.count(var_id) > 0) || (m.locations.count(var_id) == 0) || (m.names.count(var_id) == 0)) {
+            continue;
+        }
+        // attributes are read by loads, either directly or through an access chain
+        uint32_t usage = 0;
+        std::vector<uint32_t> pointers = { var_id };
+        for (const auto& [ptr_id, base_id]: m.pointer_bases) {
+            if (base_id == var_id) {
+                pointers.push_back(ptr_id);
+            }
+        }
+        for (uint32_t ptr_id: pointers) {
+            if (m.uses.count(ptr_id) == 0) {
+                continue;
+            }
+            for (const auto& [instr_index, word_index]: m.uses.at(ptr_id)) {
+                const SpvInstr& instr = m.instrs[instr_index];
+                if ((instr.op() == spv::OpLoad) && (word_index == 3)) {
+                    usage |= trace(m, instr.words[2], false, false, 0);
+                } else if (((instr.op() != spv::OpAccessChain) && (instr.op() != spv::OpInBoundsAccessChain)) || (word_index != 3)) {
+                    usage |= USAGE_OTHER;
+                }
+            }
+        }
+        res[m.names[var_id]] = usage;
+    }
+    return res;
+}
+
+std::vector<ErrMsg> VertexFormats::analyze(const Input& inp, const Spirv& spirv, Reflection& inout_refl) {
+    std::vector<ErrMsg> res;
+    for (const SpirvBlob& blob: spirv.blobs) {
+        const std::map<std::string, uint32_t> usages = attr_usages(blob);
+        if (usages.empty()) {
+            continue;
+        }
+        const Snippet& snippet = inp.snippets[blob.snippet_index];
+        // the stage reflection is shared with the spirvcross output, so the packed formats
+        // go into a copy which then replaces the stage in each program using the vertex shader
+        std::shared_ptr<StageReflection> packed_refl;
+        for (ProgramReflection& prog: inout_refl.progs) {
+            if (prog.vs().snippet_index != blob.snippet_index) {
+                continue;
+            }
+            if (packed_refl) {
+                prog.stages[ShaderStage::Vertex] = packed_refl;
+                continue;
+            }
+            packed_refl = std::make_shared<StageReflection>(prog.vs());
+            prog.stages[ShaderStage::Vertex] = packed_refl;
+            for (StageAttr& attr: packed_refl->inputs) {
+                const auto usage_it = usages.find(attr.name);
+                if ((attr.slot < 0) || (usage_it == usages.end())) {
+                    continue;
+                }
+                std::string reason;
+                attr.packed_format = compact_format(usage_it->second, num_float_components(attr.type_info.type), reason);
+                if (attr.packed_format != VertexFormat::INVALID) {
+                    const VertexFormat::Enum full_format = VertexFormat::from_type(attr.type_info.type);
+                    res.push_back(inp.warning(find_attr_line(inp, snippet, attr.name), fmt::format(
+                        "vertex attribute '{}' could use SG_VERTEXFORMAT_{} ({} bytes) instead of SG_VERTEXFORMAT_{} ({} bytes): {}",
+                        attr.name, VertexFormat::to_str(attr.packed_format), VertexFormat::byte_size(attr.packed_format),
+                        VertexFormat::to_str(full_format), VertexFormat::byte_size(full_format), reason)));
+                }
+            }
+        }
+    }
+    return res;
+}
+
+} // namespace shdc
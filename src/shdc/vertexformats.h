@@ -0,0 +1,17 @@
+#pragma once
+#include <vector>
+#include "input.h"
+#include "spirv.h"
+#include "reflection.h"
+#include "types/errmsg.h"
+
+namespace shdc {
+
+// analysis of how vertex shaders use their vertex attributes, to find compact
+// vertex formats which need less vertex fetch bandwidth (--vertex-formats)
+struct VertexFormats {
+    // set StageAttr::packed_format in the reflection info, returns a warning for each attribute with a compact format
+    static std::vector<ErrMsg> analyze(const Input& inp, const Spirv& spirv, refl::Reflection& inout_refl);
+};
+
+} // namespace shdc
@@ -0,0 +1,169 @@
+/*
+    wait for file changes, uses inotify on Linux and falls back
+    to polling file modification times on other platforms
+*/
+#include "watch.h"
+#include <thread>
+#include <chrono>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "pystring.h"
+#if defined(__linux__)
+#include <errno.h>
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace shdc {
+
+#if defined(__linux__)
+Watch::Watch() {
+    fd = inotify_init1(IN_CLOEXEC);
+}
+
+Watch::~Watch() {
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+// NOTE: watch the parent directories instead of the files themselves,
+// most editors save by writing a temporary file and renaming it over
+// the original, which would silently kill a watch on the file's inode
+bool Watch::set_paths(const std::vector<std::string>& paths) {
+    if (fd < 0) {
+        return false;
+    }
+    std::set<std::pair<std::string, std::string>> new_watched;
+    std::set<std::string> dirs;
+    for (const std::string& path: paths) {
+        std::string dir, file;
+        pystring::os::path::split(dir, file, path);
+        if (dir.empty()) {
+            dir = ".";
+        }
+        new_watched.insert({ dir, file });
+        dirs.insert(dir);
+    }
+    // remove watches of directories which are no longer needed, and add the new ones,
+    // existing watches are kept so that their pending events aren't lost
+    for (auto it = dir_to_wd.begin(); it != dir_to_wd.end();) {
+        if (dirs.count(it->first) == 0) {
+            inotify_rm_watch(fd, it->second);
+            wd_to_dir.erase(it->second);
+            it = dir_to_wd.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (const std::string& dir: dirs) {
+        if (dir_to_wd.count(dir) == 0) {
+            const uint32_t mask = IN_CLOSE_WRITE | IN_MODIFY | IN_MOVED_TO | IN_CREATE | IN_DELETE;
+            const int wd = inotify_add_watch(fd, dir.c_str(), mask);
+            if (wd >= 0) {
+                dir_to_wd[dir] = wd;
+                wd_to_dir[wd] = dir;
+            }
+        }
+    }
+    watched = std::move(new_watched);
+    return !dir_to_wd.empty();
+}
+
+bool Watch::wait_for_change() {
+    alignas(struct inotify_event) char buf[4096];
+    bool changed = false;
+    while (!changed) {
+        const ssize_t len = read(fd, buf, sizeof(buf));
+        if (len < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        } else if (len == 0) {
+            return false;
+        }
+        for (ssize_t offset = 0; offset < len;) {
+            const struct inotify_event* event = (const struct inotify_event*)&buf[offset];
+            if ((event->len > 0) && (wd_to_dir.count(event->wd) > 0)) {
+                if (watched.count({ wd_to_dir[event->wd], event->name }) > 0) {
+                    changed = true;
+                }
+            }
+            offset += sizeof(struct inotify_event) + event->len;
+        }
+    }
+    // an editor save usually produces a burst of events, wait until things settle down
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    for (;;) {
+        const int res = poll(&pfd, 1, 20);
+        if ((res < 0) && (errno == EINTR)) {
+            continue;
+        }
+        if (res <= 0) {
+            break;
+        }
+        if ((read(fd, buf, sizeof(buf)) < 0) && (errno != EINTR)) {
+            break;
+        }
+    }
+    return true;
+}
+#else
+static bool file_stamp(const std::string& path, std::pair<int64_t, int64_t>& out_stamp) {
+    struct stat st;
+    if (0 != stat(path.c_str(), &st)) {
+        out_stamp = { -1, -1 };
+        return false;
+    }
+    out_stamp = { (int64_t)st.st_mtime, (int64_t)st.st_size };
+    return true;
+}
+
+Watch::Watch() { }
+
+Watch::~Watch() { }
+
+// files which are already watched keep their old stamp, so that changes since
+// then (e.g. while compiling) are still detected by the next wait_for_change()
+bool Watch::set_paths(const std::vector<std::string>& paths) {
+    std::map<std::string, std::pair<int64_t, int64_t>> new_stamps;
+    bool any_valid = false;
+    for (const std::string& path: paths) {
+        const auto it = stamps.find(path);
+        if (it != stamps.end()) {
+            new_stamps[path] = it->second;
+            any_valid |= (it->second.first != -1);
+        } else {
+            any_valid |= file_stamp(path, new_stamps[path]);
+        }
+    }
+    stamps = std::move(new_stamps);
+    return any_valid;
+}
+
+bool Watch::wait_for_change() {
+    for (;;) {
+        bool changed = false;
+        for (auto& [path, old_stamp]: stamps) {
+            std::pair<int64_t, int64_t> stamp;
+            file_stamp(path, stamp);
+            if (stamp != old_stamp) {
+                changed = true;
+            }
+        }
+        if (changed) {
+            // give the writer a moment to finish, and take the new stamps afterwards
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            for (auto& [path, old_stamp]: stamps) {
+                file_stamp(path, old_stamp);
+            }
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+}
+#endif
+
+} // namespace shdc
@@ -0,0 +1,36 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <map>
+#include <set>
+#include <stdint.h>
+
+namespace shdc {
+
+// file change notifications for the --watch mode, the Watch object is created
+// before the first compilation and kept alive, so that changes which happen
+// while compiling aren't lost
+struct Watch {
+    Watch();
+    ~Watch();
+    Watch(const Watch&) = delete;
+    Watch& operator=(const Watch&) = delete;
+    // update the set of watched files (e.g. when @include files were added or removed),
+    // returns false if the files can't be watched at all
+    bool set_paths(const std::vector<std::string>& paths);
+    // block until one of the watched files has been modified, created or removed since
+    // the previous call, or since it was added with set_paths(), returns false on error
+    bool wait_for_change();
+
+private:
+    #if defined(__linux__)
+    int fd = -1;
+    std::map<std::string, int> dir_to_wd;
+    std::map<int, std::string> wd_to_dir;
+    std::set<std::pair<std::string, std::string>> watched;   // (dir, filename)
+    #else
+    std::map<std::string, std::pair<int64_t, int64_t>> stamps;  // path => (mtime, size)
+    #endif
+};
+
+} // namespace shdc
@@ -0,0 +1,34 @@
+# compare the --alloc-stats output of two sokol-shdc executables over the sokol-samples
+# shaders in test/sapp, usage: alloc_stats_diff.py before_exe after_exe [slangs]
+# prints the summed allocations and bytes per phase and the difference in percent
+import sys, os, glob, subprocess, tempfile
+
+def run(exe, slangs, out_dir):
+    phases = {}
+    test_dir = os.path.dirname(os.path.abspath(__file__))
+    for path in sorted(glob.glob(f'{test_dir}/sapp/*.glsl')):
+        out = f'{out_dir}/{os.path.basename(path)}.h'
+        res = subprocess.run([exe, '-i', path, '-o', out, '-l', slangs, '--alloc-stats'], stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+        if res.returncode != 0:
+            sys.exit(f'{exe} failed on {path}:\n{res.stdout}')
+        for line in res.stdout.splitlines():
+            tokens = line.split()
+            if (len(tokens) == 5) and (tokens[2] == 'allocs') and (tokens[4] == 'bytes'):
+                allocs, num_bytes = phases.get(tokens[0], (0, 0))
+                phases[tokens[0]] = (allocs + int(tokens[1]), num_bytes + int(tokens[3]))
+    return phases
+
+def delta(before, after):
+    return f'{(after - before) * 100.0 / before:+.1f}%' if before > 0 else '-'
+
+if len(sys.argv) < 3:
+    sys.exit('usage: alloc_stats_diff.py before_exe after_exe [slangs]')
+slangs = sys.argv[3] if len(sys.argv) > 3 else 'glsl430:glsl300es:hlsl5:metal_macos:wgsl'
+with tempfile.TemporaryDirectory() as out_dir:
+    before = run(sys.argv[1], slangs, out_dir)
+    after = run(sys.argv[2], slangs, out_dir)
+print(f'{"phase":<12} {"allocs before":>14} {"after":>10} {"delta":>8} {"bytes before":>14} {"after":>14} {"delta":>8}')
+for name in list(before) + [name for name in after if name not in before]:
+    a0, b0 = before.get(name, (0, 0))
+    a1, b1 = after.get(name, (0, 0))
+    print(f'{name:<12} {a0:>14} {a1:>10} {delta(a0, a1):>8} {b0:>14} {b1:>14} {delta(b0, b1):>8}')
@@ -0,0 +1,160 @@
+/*
+    Validate a bare_bin reflection file: header magic, version and size,
+    every array and string offset must be inside the file, strings must be
+    zero-terminated. Prints the path of each per-slang shader file as
+    'code: [is_binary] [path]' so that the caller can compare the files.
+
+    usage: bin_check reflection.bin
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include "shdc_bin.h"
+
+static const uint8_t* base;
+static uint32_t file_size;
+static int num_errors = 0;
+
+static void error(const char* msg, uint32_t offset) {
+    fprintf(stderr, "%s (offset %u)\n", msg, offset);
+    num_errors++;
+}
+
+static void check_str(uint32_t str) {
+    if ((str == 0) || (str >= file_size) || (memchr(base + str, 0, file_size - str) == 0)) {
+        error("string out of bounds", str);
+    }
+}
+
+static bool check_array(shdc_bin_array arr, size_t item_size) {
+    if ((arr.offset & 3) || ((uint64_t)arr.offset + (uint64_t)arr.num * item_size > file_size)) {
+        error("array out of bounds", arr.offset);
+        return false;
+    }
+    return true;
+}
+
+static void check_type(const shdc_bin_type* type) {
+    check_str(type->name);
+    check_str(type->struct_typename);
+    if (check_array(type->struct_items, sizeof(shdc_bin_type))) {
+        const shdc_bin_type* items = SHDC_BIN_ITEMS(base, shdc_bin_type, type->struct_items);
+        for (uint32_t i = 0; i < type->struct_items.num; i++) {
+            check_type(&items[i]);
+        }
+    }
+}
+
+static void check_bindings(const shdc_bin_bindings* b) {
+    if (check_array(b->uniform_blocks, sizeof(shdc_bin_uniform_block))) {
+        const shdc_bin_uniform_block* items = SHDC_BIN_ITEMS(base, shdc_bin_uniform_block, b->uniform_blocks);
+        for (uint32_t i = 0; i < b->uniform_blocks.num; i++) {
+            check_str(items[i].name);
+            check_str(items[i].inst_name);
+            check_type(&items[i].struct_info);
+        }
+    }
+    if (check_array(b->storage_buffers, sizeof(shdc_bin_storage_buffer))) {
+        const shdc_bin_storage_buffer* items = SHDC_BIN_ITEMS(base, shdc_bin_storage_buffer, b->storage_buffers);
+        for (uint32_t i = 0; i < b->storage_buffers.num; i++) {
+            check_str(items[i].name);
+            check_str(items[i].inst_name);
+            check_type(&items[i].struct_info);
+        }
+    }
+    if (check_array(b->images, sizeof(shdc_bin_image))) {
+        const shdc_bin_image* items = SHDC_BIN_ITEMS(base, shdc_bin_image, b->images);
+        for (uint32_t i = 0; i < b->images.num; i++) {
+            check_str(items[i].name);
+        }
+    }
+    if (check_array(b->samplers, sizeof(shdc_bin_sampler))) {
+        const shdc_bin_sampler* items = SHDC_BIN_ITEMS(base, shdc_bin_sampler, b->samplers);
+        for (uint32_t i = 0; i < b->samplers.num; i++) {
+            check_str(items[i].name);
+        }
+    }
+    if (check_array(b->image_samplers, sizeof(shdc_bin_image_sampler))) {
+        const shdc_bin_image_sampler* items = SHDC_BIN_ITEMS(base, shdc_bin_image_sampler, b->image_samplers);
+        for (uint32_t i = 0; i < b->image_samplers.num; i++) {
+            check_str(items[i].name);
+            check_str(items[i].image_name);
+            check_str(items[i].sampler_name);
+        }
+    }
+}
+
+static void check_attrs(shdc_bin_array arr) {
+    if (check_array(arr, sizeof(shdc_bin_attr))) {
+        const shdc_bin_attr* items = SHDC_BIN_ITEMS(base, shdc_bin_attr, arr);
+        for (uint32_t i = 0; i < arr.num; i++) {
+            check_str(items[i].name);
+            check_str(items[i].sem_name);
+        }
+    }
+}
+
+static void check_stage(const shdc_bin_header* hdr, const shdc_bin_stage* stage) {
+    check_str(stage->snippet_name);
+    check_attrs(stage->inputs);
+    check_attrs(stage->outputs);
+    check_bindings(&stage->bindings);
+    if (check_array(stage->code, sizeof(shdc_bin_code))) {
+        const shdc_bin_code* items = SHDC_BIN_ITEMS(base, shdc_bin_code, stage->code);
+        for (uint32_t i = 0; i < stage->code.num; i++) {
+            check_str(items[i].path);
+            check_str(items[i].entry_point);
+            check_str(items[i].d3d11_target);
+            if (shdc_bin_find_code(hdr, stage, (shdc_slang_index)items[i].slang) != &items[i]) {
+                error("duplicate slang in stage", stage->code.offset);
+            }
+            if (num_errors == 0) {
+                printf("code: %u %s\n", items[i].is_binary, shdc_bin_str(hdr, items[i].path));
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: bin_check reflection.bin\n");
+        return 10;
+    }
+    FILE* f = fopen(argv[1], "rb");
+    if (!f) {
+        fprintf(stderr, "failed to open %s\n", argv[1]);
+        return 10;
+    }
+    fseek(f, 0, SEEK_END);
+    file_size = (uint32_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    // malloc'ed data is 4-byte aligned
+    uint8_t* data = (uint8_t*)malloc(file_size);
+    if (fread(data, 1, file_size, f) != file_size) {
+        fprintf(stderr, "failed to read %s\n", argv[1]);
+        return 10;
+    }
+    fclose(f);
+    base = data;
+    const shdc_bin_header* hdr = shdc_bin_open(data, file_size);
+    if (!hdr || (hdr->magic != 0x4E494253) || (hdr->version != 2) || (hdr->size != file_size)) {
+        fprintf(stderr, "invalid header\n");
+        return 10;
+    }
+    check_str(hdr->module);
+    check_bindings(&hdr->bindings);
+    if (check_array(hdr->programs, sizeof(shdc_bin_program))) {
+        const shdc_bin_program* progs = SHDC_BIN_ITEMS(base, shdc_bin_program, hdr->programs);
+        for (uint32_t i = 0; i < hdr->programs.num; i++) {
+            check_str(progs[i].name);
+            if (shdc_bin_find_program(hdr, shdc_bin_str(hdr, progs[i].name)) != &progs[i]) {
+                error("duplicate program name", progs[i].name);
+            }
+            check_stage(hdr, &progs[i].vs);
+            check_stage(hdr, &progs[i].fs);
+            check_bindings(&progs[i].bindings);
+        }
+    }
+    printf("programs: %u errors: %d\n", hdr->programs.num, num_errors);
+    free(data);
+    return (num_errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,27 @@
+#pragma once
+/*
+    Stand-in for the HandmadeMath.h v2 vector and matrix types used by
+    '@ctype_preset hmm', with the same sizes and alignment as the real
+    types (HMM_Vec4 is 16-byte aligned because of its __m128 member).
+*/
+#include <stdalign.h>
+
+typedef union HMM_Vec2 {
+    struct { float X, Y; };
+    float Elements[2];
+} HMM_Vec2;
+
+typedef union HMM_Vec3 {
+    struct { float X, Y, Z; };
+    float Elements[3];
+} HMM_Vec3;
+
+typedef union HMM_Vec4 {
+    struct { float X, Y, Z, W; };
+    alignas(16) float Elements[4];
+} HMM_Vec4;
+
+typedef union HMM_Mat4 {
+    float Elements[4][4];
+    HMM_Vec4 Columns[4];
+} HMM_Mat4;
@@ -0,0 +1,54 @@
+// --infer-mediump: values sampled from albedo_tex are normalized and are
+// demoted to mediump in fs_norm, hdr_tex has no @image_normalized tag, so
+// nothing is demoted in fs_hdr, in fs_mat an unbounded matrix component is
+// combined with constants and must stay highp
+@image_normalized albedo_tex
+
+@vs vs
+in vec4 position;
+in vec2 texcoord0;
+out vec2 uv;
+
+void main() {
+    gl_Position = position;
+    uv = texcoord0;
+}
+@end
+
+@fs fs_norm
+layout(binding=0) uniform texture2D albedo_tex;
+layout(binding=0) uniform sampler smp;
+in vec2 uv;
+out vec4 frag_color;
+
+void main() {
+    frag_color = texture(sampler2D(albedo_tex, smp), uv) * 0.5;
+}
+@end
+
+@fs fs_hdr
+layout(binding=1) uniform texture2D hdr_tex;
+layout(binding=0) uniform sampler smp;
+in vec2 uv;
+out vec4 frag_color;
+
+void main() {
+    frag_color = texture(sampler2D(hdr_tex, smp), uv);
+}
+@end
+
+@fs fs_mat
+layout(binding=0) uniform fs_params {
+    mat4 color_mat;
+};
+out vec4 frag_color;
+
+void main() {
+    mat4 m = color_mat * color_mat;
+    frag_color = vec4(m[0].x, 0.0, 0.0, 1.0);
+}
+@end
+
+@program norm vs fs_norm
+@program hdr vs fs_hdr
+@program mat vs fs_mat
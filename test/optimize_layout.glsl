@@ -0,0 +1,37 @@
+@optimize_layout vs_params fs_params
+
+@vs vs
+layout(binding=0) uniform vs_params {
+    float scale;
+    vec3 offset;
+    vec2 uv_scale;
+    mat4 mvp;
+    vec2 uv_offset;
+};
+
+in vec4 position;
+in vec2 texcoord0;
+out vec2 uv;
+
+void main() {
+    gl_Position = mvp * vec4(position.xyz * scale + offset, 1.0);
+    uv = texcoord0 * uv_scale + uv_offset;
+}
+@end
+
+@fs fs
+layout(binding=1) uniform fs_params {
+    float alpha;
+    vec3 color;
+    float brightness;
+};
+
+in vec2 uv;
+out vec4 frag_color;
+
+void main() {
+    frag_color = vec4(color * brightness, alpha);
+}
+@end
+
+@program shd vs fs
@@ -0,0 +1,83 @@
+/*
+    Compare a bare_pack archive written with --compress against one written
+    without, every entry must decompress with shdc_pack_decompress() to the
+    same bytes as the uncompressed entry.
+
+    usage: pack_check compressed.pack uncompressed.pack
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "shdc_pack.h"
+
+static void* load(const char* path, size_t* out_size) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        return 0;
+    }
+    fseek(f, 0, SEEK_END);
+    const size_t size = (size_t)ftell(f);
+    fseek(f, 0, SEEK_SET);
+    // payloads must be 16-byte aligned in memory
+    void* data = aligned_alloc(SHDC_PACK_ALIGN, (size + SHDC_PACK_ALIGN - 1) & ~(size_t)(SHDC_PACK_ALIGN - 1));
+    if (data && (fread(data, 1, size, f) != size)) {
+        free(data);
+        data = 0;
+    }
+    fclose(f);
+    *out_size = size;
+    return data;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "usage: pack_check compressed.pack uncompressed.pack\n");
+        return 10;
+    }
+    size_t size0 = 0, size1 = 0;
+    void* data0 = load(argv[1], &size0);
+    void* data1 = load(argv[2], &size1);
+    const shdc_pack_header* pack = shdc_pack_open(data0, size0);
+    const shdc_pack_header* ref = shdc_pack_open(data1, size1);
+    if (!pack || !ref) {
+        fprintf(stderr, "failed to open pack files\n");
+        return 10;
+    }
+    const shdc_pack_entry* toc = (const shdc_pack_entry*)((const uint8_t*)pack + pack->toc_offset);
+    int num_entries = 0;
+    int num_compressed = 0;
+    int num_short = 0;
+    for (uint32_t i = 0; i < pack->toc_num_slots; i++) {
+        const shdc_pack_entry* e = &toc[i];
+        if (0 == (e->flags & SHDC_PACK_FLAG_USED)) {
+            continue;
+        }
+        const char* program = (const char*)pack + e->program;
+        const shdc_pack_entry* ref_e = shdc_pack_find(ref, program, (shdc_shader_stage)e->stage, (shdc_slang_index)e->slang);
+        if (!ref_e || (ref_e->flags & SHDC_PACK_FLAG_COMPRESSED) || (ref_e->size != e->uncompressed_size)) {
+            fprintf(stderr, "%s: entry (%u, %u) missing or different in uncompressed pack\n", program, e->stage, e->slang);
+            return 10;
+        }
+        uint8_t* buf = (uint8_t*)malloc(e->uncompressed_size + 1);
+        if (!shdc_pack_decompress(pack, e, buf, e->uncompressed_size)) {
+            fprintf(stderr, "%s: entry (%u, %u) failed to decompress\n", program, e->stage, e->slang);
+            return 10;
+        }
+        if (0 != memcmp(buf, shdc_pack_payload(ref, ref_e), e->uncompressed_size)) {
+            fprintf(stderr, "%s: entry (%u, %u) differs after decompression\n", program, e->stage, e->slang);
+            return 10;
+        }
+        free(buf);
+        num_entries++;
+        if (e->flags & SHDC_PACK_FLAG_COMPRESSED) {
+            num_compressed++;
+        }
+        if (e->uncompressed_size < 12) {
+            num_short++;
+        }
+    }
+    printf("entries: %d compressed: %d short: %d\n", num_entries, num_compressed, num_short);
+    free(data0);
+    free(data1);
+    return 0;
+}
@@ -0,0 +1,18 @@
+# stand-in compiler for the bare_pack --compress test in fips-files/verbs/run_tests.py,
+# usage: pack_payload_cmd.py stage out, writes a payload which is shorter than the
+# LZ4 minimum match distance for vertex shaders, and a payload with long literal
+# and match runs (length extension bytes) for fragment shaders
+import sys
+
+data = b''
+if sys.argv[1] == 'vs':
+    data = bytes([1, 2, 3, 4, 5])
+else:
+    x = 12345
+    def rnd():
+        global x
+        x = (x * 1103515245 + 12345) & 0xFFFFFFFF
+        return (x >> 16) & 0xFF
+    data = bytes(rnd() for _ in range(600)) + b'a' * 1000 + bytes(rnd() for _ in range(20))
+with open(sys.argv[2], 'wb') as f:
+    f.write(data)
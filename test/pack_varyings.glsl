@@ -0,0 +1,49 @@
+// --pack-varyings: the smooth float, vec2 and vec3 varyings are packed into
+// shdc_varying_0 (normal, fade) and shdc_varying_1 (uv0, uv1), spill doesn't
+// fit into either vec4 and stays unpacked, the flat varyings are packed
+// separately into shdc_varying_6, the vec4 color is never packed
+@vs vs
+in vec4 position;
+in vec3 normal0;
+in vec4 color0;
+in vec2 texcoord0;
+
+layout(location=0) out float fade;
+layout(location=1) out vec2 uv0;
+layout(location=2) out vec3 normal;
+layout(location=3) out float spill;
+layout(location=4) out vec4 color;
+layout(location=5) out vec2 uv1;
+layout(location=6) flat out float flat_id;
+layout(location=7) flat out vec2 flat_uv;
+
+void main() {
+    gl_Position = position;
+    fade = position.z;
+    uv0 = texcoord0;
+    normal = normal0;
+    spill = position.w;
+    color = color0;
+    uv1 = texcoord0 * 2.0;
+    flat_id = float(gl_VertexIndex);
+    flat_uv = texcoord0;
+}
+@end
+
+@fs fs
+layout(location=0) in float fade;
+layout(location=1) in vec2 uv0;
+layout(location=2) in vec3 normal;
+layout(location=3) in float spill;
+layout(location=4) in vec4 color;
+layout(location=5) in vec2 uv1;
+layout(location=6) flat in float flat_id;
+layout(location=7) flat in vec2 flat_uv;
+out vec4 frag_color;
+
+void main() {
+    frag_color = color * fade * spill + vec4(normal, flat_id) + vec4(uv0, uv1) + vec4(flat_uv, 0.0, 0.0);
+}
+@end
+
+@program pack vs fs
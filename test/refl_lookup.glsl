@@ -0,0 +1,86 @@
+// names for the perfect-hash reflection lookups, see test_refl_lookup in run_tests.py
+@module refl
+
+@vs vs_lit
+layout(binding=0) uniform vs_params {
+    mat4 mvp;
+    mat4 model;
+    vec4 light_dir;
+    vec3 eye_pos;
+    float time;
+    vec4 tints[4];
+};
+
+layout(location=0) in vec4 position;
+layout(location=1) in vec3 normal;
+layout(location=2) in vec2 texcoord0;
+layout(location=3) in vec4 color0;
+layout(location=4) in vec4 tangent;
+layout(location=5) in vec4 bone_weights;
+
+out vec3 nrm;
+out vec2 uv;
+out vec4 color;
+
+void main() {
+    gl_Position = mvp * (model * position) * bone_weights.x;
+    nrm = normal + tangent.xyz * time + eye_pos + light_dir.xyz;
+    uv = texcoord0;
+    color = color0 * tints[gl_InstanceIndex & 3];
+}
+@end
+
+@fs fs_lit
+layout(binding=1) uniform fs_params {
+    vec4 base_color;
+    float roughness;
+    float metallic;
+    int mode;
+};
+layout(binding=0) uniform texture2D albedo_tex;
+layout(binding=1) uniform texture2D normal_tex;
+layout(binding=0) uniform sampler smp;
+layout(binding=1) uniform sampler normal_smp;
+
+struct light {
+    vec4 pos_radius;
+};
+layout(binding=2) readonly buffer lights {
+    light lts[];
+};
+
+in vec3 nrm;
+in vec2 uv;
+in vec4 color;
+out vec4 frag_color;
+
+void main() {
+    vec4 n = texture(sampler2D(normal_tex, normal_smp), uv);
+    vec4 c = texture(sampler2D(albedo_tex, smp), uv) * color * base_color;
+    frag_color = c * (roughness + metallic) * float(mode) + n * lts[0].pos_radius + vec4(nrm, 0.0);
+}
+@end
+
+@program lit vs_lit fs_lit
+
+@vs vs_unlit
+layout(location=0) in vec4 position;
+layout(location=1) in vec4 color0;
+out vec4 color;
+
+void main() {
+    gl_Position = position;
+    color = color0;
+}
+@end
+
+@fs fs_unlit
+in vec4 color;
+out vec4 frag_color;
+
+void main() {
+    frag_color = color;
+}
+@end
+
+@program unlit vs_unlit fs_unlit
@@ -0,0 +1,87 @@
+/*
+    Check the perfect-hash name lookups in the C reflection functions generated
+    from refl_lookup.glsl against the bind slot and uniform offset constants,
+    every name must be found and unknown names must return -1.
+
+    usage: refl_lookup_check (prints the number of failed checks)
+*/
+#include <stdio.h>
+#include <string.h>
+#include "sokol_gfx_stub.h"
+#include "refl_lookup.h"
+
+static int num_checks = 0;
+static int num_failed = 0;
+
+static void check(int actual, int expected, const char* what) {
+    num_checks++;
+    if (actual != expected) {
+        printf("FAILED: %s: %d (expected %d)\n", what, actual, expected);
+        num_failed++;
+    }
+}
+
+#define CHECK(expr, expected) check((expr), (expected), #expr)
+#define CHECK_UNIFORM(prog, ub, u, utype, count) \
+    CHECK(refl_##prog##_uniform_offset(#ub, #u), UNIFORM_OFFSET_refl_##ub##_##u); \
+    CHECK(refl_##prog##_uniform_offset(#ub, #u), (int)offsetof(refl_##ub##_t, u)); \
+    CHECK(refl_##prog##_uniform_desc(#ub, #u).type, utype); \
+    CHECK(refl_##prog##_uniform_desc(#ub, #u).array_count, count); \
+    CHECK(strcmp(refl_##prog##_uniform_desc(#ub, #u).glsl_name, #u), 0)
+
+int main() {
+    // program 'lit', all names
+    CHECK(refl_lit_attr_slot("position"), ATTR_refl_lit_position);
+    CHECK(refl_lit_attr_slot("normal"), ATTR_refl_lit_normal);
+    CHECK(refl_lit_attr_slot("texcoord0"), ATTR_refl_lit_texcoord0);
+    CHECK(refl_lit_attr_slot("color0"), ATTR_refl_lit_color0);
+    CHECK(refl_lit_attr_slot("tangent"), ATTR_refl_lit_tangent);
+    CHECK(refl_lit_attr_slot("bone_weights"), ATTR_refl_lit_bone_weights);
+    CHECK(refl_lit_image_slot("albedo_tex"), IMG_refl_albedo_tex);
+    CHECK(refl_lit_image_slot("normal_tex"), IMG_refl_normal_tex);
+    CHECK(refl_lit_sampler_slot("smp"), SMP_refl_smp);
+    CHECK(refl_lit_sampler_slot("normal_smp"), SMP_refl_normal_smp);
+    CHECK(refl_lit_uniformblock_slot("vs_params"), UB_refl_vs_params);
+    CHECK(refl_lit_uniformblock_slot("fs_params"), UB_refl_fs_params);
+    CHECK((int)refl_lit_uniformblock_size("vs_params"), (int)sizeof(refl_vs_params_t));
+    CHECK((int)refl_lit_uniformblock_size("fs_params"), (int)sizeof(refl_fs_params_t));
+    CHECK(refl_lit_storagebuffer_slot("lights"), SBUF_refl_lights);
+    CHECK_UNIFORM(lit, vs_params, mvp, SG_UNIFORMTYPE_MAT4, 0);
+    CHECK_UNIFORM(lit, vs_params, model, SG_UNIFORMTYPE_MAT4, 0);
+    CHECK_UNIFORM(lit, vs_params, light_dir, SG_UNIFORMTYPE_FLOAT4, 0);
+    CHECK_UNIFORM(lit, vs_params, eye_pos, SG_UNIFORMTYPE_FLOAT3, 0);
+    CHECK_UNIFORM(lit, vs_params, time, SG_UNIFORMTYPE_FLOAT, 0);
+    CHECK_UNIFORM(lit, vs_params, tints, SG_UNIFORMTYPE_FLOAT4, 4);
+    CHECK_UNIFORM(lit, fs_params, base_color, SG_UNIFORMTYPE_FLOAT4, 0);
+    CHECK_UNIFORM(lit, fs_params, roughness, SG_UNIFORMTYPE_FLOAT, 0);
+    CHECK_UNIFORM(lit, fs_params, metallic, SG_UNIFORMTYPE_FLOAT, 0);
+    CHECK_UNIFORM(lit, fs_params, mode, SG_UNIFORMTYPE_INT, 0);
+
+    // program 'unlit', all names
+    CHECK(refl_unlit_attr_slot("position"), ATTR_refl_unlit_position);
+    CHECK(refl_unlit_attr_slot("color0"), ATTR_refl_unlit_color0);
+
+    // names which aren't in the tables: unknown names, prefixes of known names,
+    // names of the other program, swapped or mismatched uniform block and member names
+    CHECK(refl_lit_attr_slot("nope"), -1);
+    CHECK(refl_lit_attr_slot(""), -1);
+    CHECK(refl_lit_attr_slot("pos"), -1);
+    CHECK(refl_lit_attr_slot("position0"), -1);
+    CHECK(refl_lit_image_slot("smp"), -1);
+    CHECK(refl_lit_sampler_slot("albedo_tex"), -1);
+    CHECK(refl_lit_uniformblock_slot("params"), -1);
+    CHECK((int)refl_lit_uniformblock_size("lights"), 0);
+    CHECK(refl_lit_storagebuffer_slot("lts"), -1);
+    CHECK(refl_lit_uniform_offset("vs_params", "base_color"), -1);
+    CHECK(refl_lit_uniform_offset("mvp", "vs_params"), -1);
+    CHECK(refl_lit_uniform_offset("vs_paramsmvp", ""), -1);
+    CHECK(refl_lit_uniform_desc("fs_params", "time").type, SG_UNIFORMTYPE_INVALID);
+    CHECK(refl_unlit_attr_slot("normal"), -1);
+    CHECK(refl_unlit_image_slot("albedo_tex"), -1);
+    CHECK(refl_unlit_sampler_slot("smp"), -1);
+    CHECK(refl_unlit_uniformblock_slot("vs_params"), -1);
+    CHECK(refl_unlit_uniform_offset("vs_params", "mvp"), -1);
+
+    printf("checks: %d failed: %d\n", num_checks, num_failed);
+    return (num_failed == 0) ? 0 : 1;
+}
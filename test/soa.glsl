@@ -0,0 +1,37 @@
+// @soa: SoA struct and pack function for a storage buffer item with
+// scalar, vector, integer and bool members
+@module sim
+@soa particles
+
+@vs vs
+struct particle {
+    vec3 pos;
+    float size;
+    vec4 color;
+    ivec2 cell;
+    uint flags;
+    bool alive;
+};
+layout(binding=0) readonly buffer particles {
+    particle prt[];
+};
+
+out vec4 color;
+
+void main() {
+    particle p = prt[gl_VertexIndex];
+    gl_Position = vec4(p.pos + vec3(p.cell, 0.0), p.alive ? p.size : 0.0);
+    color = p.color * float(p.flags);
+}
+@end
+
+@fs fs
+in vec4 color;
+out vec4 frag_color;
+
+void main() {
+    frag_color = color;
+}
+@end
+
+@program particles vs fs
@@ -0,0 +1,83 @@
+/*
+    Check the std430 item struct, SoA struct and pack function generated
+    for the @soa storage buffer in soa.glsl.
+
+    usage: soa_check (prints the number of failed checks)
+*/
+#include <stdio.h>
+#include <string.h>
+#include "sokol_gfx_stub.h"
+#include "soa.h"
+
+#define NUM_ITEMS (8)
+#define FIRST (3)
+#define COUNT (4)
+
+static int num_checks = 0;
+static int num_failed = 0;
+
+static void check(bool cond, const char* what) {
+    num_checks++;
+    if (!cond) {
+        printf("FAILED: %s\n", what);
+        num_failed++;
+    }
+}
+
+#define CHECK(cond) check((cond), #cond)
+
+int main() {
+    // std430 layout of the item struct
+    CHECK(sizeof(sim_particle_t) == 48);
+    CHECK(offsetof(sim_particle_t, pos) == 0);
+    CHECK(offsetof(sim_particle_t, size) == 12);
+    CHECK(offsetof(sim_particle_t, color) == 16);
+    CHECK(offsetof(sim_particle_t, cell) == 32);
+    CHECK(offsetof(sim_particle_t, flags) == 40);
+    CHECK(offsetof(sim_particle_t, alive) == 44);
+
+    float pos[3][NUM_ITEMS], size[NUM_ITEMS], color[4][NUM_ITEMS];
+    int32_t cell[2][NUM_ITEMS], alive[NUM_ITEMS];
+    uint32_t flags[NUM_ITEMS];
+    for (int i = 0; i < NUM_ITEMS; i++) {
+        for (int c = 0; c < 3; c++) {
+            pos[c][i] = (float)(i * 10 + c);
+        }
+        size[i] = (float)i + 0.5f;
+        for (int c = 0; c < 4; c++) {
+            color[c][i] = (float)(i * 100 + c);
+        }
+        cell[0][i] = -i;
+        cell[1][i] = i * 2;
+        flags[i] = 0x80000000u | (uint32_t)i;
+        alive[i] = i & 1;
+    }
+    const sim_particle_soa_t src = {
+        .pos_x = pos[0], .pos_y = pos[1], .pos_z = pos[2],
+        .size = size,
+        .color_x = color[0], .color_y = color[1], .color_z = color[2], .color_w = color[3],
+        .cell_x = cell[0], .cell_y = cell[1],
+        .flags = flags,
+        .alive = alive,
+    };
+
+    // one guard item after the packed range must stay untouched
+    sim_particle_t dst[COUNT + 1];
+    memset(dst, 0xAB, sizeof(dst));
+    sim_particle_t guard;
+    memcpy(&guard, &dst[COUNT], sizeof(guard));
+    sim_particle_soa_pack(dst, &src, FIRST, COUNT);
+    for (int i = 0; i < COUNT; i++) {
+        const int s = FIRST + i;
+        CHECK(dst[i].pos[0] == pos[0][s] && dst[i].pos[1] == pos[1][s] && dst[i].pos[2] == pos[2][s]);
+        CHECK(dst[i].size == size[s]);
+        CHECK(dst[i].color[0] == color[0][s] && dst[i].color[1] == color[1][s]);
+        CHECK(dst[i].color[2] == color[2][s] && dst[i].color[3] == color[3][s]);
+        CHECK(dst[i].cell[0] == cell[0][s] && dst[i].cell[1] == cell[1][s]);
+        CHECK(dst[i].flags == flags[s]);
+        CHECK(dst[i].alive == alive[s]);
+    }
+    CHECK(memcmp(&dst[COUNT], &guard, sizeof(guard)) == 0);
+    printf("checks: %d failed: %d\n", num_checks, num_failed);
+    return (num_failed == 0) ? 0 : 1;
+}
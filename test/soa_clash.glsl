@@ -0,0 +1,28 @@
+// @soa: the vec2 member pos is split into pos_x and pos_y, which clashes
+// with the float member pos_x, sokol-shdc must report an error
+@soa particles
+
+@vs vs
+struct particle {
+    vec2 pos;
+    float pos_x;
+};
+layout(binding=0) readonly buffer particles {
+    particle prt[];
+};
+
+void main() {
+    particle p = prt[gl_VertexIndex];
+    gl_Position = vec4(p.pos, p.pos_x, 1.0);
+}
+@end
+
+@fs fs
+out vec4 frag_color;
+
+void main() {
+    frag_color = vec4(1.0);
+}
+@end
+
+@program soa_clash vs fs
@@ -0,0 +1,236 @@
+#if !defined(SOKOL_GFX_INCLUDED)
+#define SOKOL_GFX_INCLUDED
+/*
+    Minimal stand-in for sokol_gfx.h, only declares the types, constants and
+    functions referenced by the sokol-shdc C output (with the same names and
+    struct layouts as sokol_gfx.h), so that the C compile tests in
+    fips-files/verbs/run_tests.py don't depend on a sokol checkout.
+
+    sg_apply_uniforms() records its arguments in sg_stub_applied_* instead
+    of doing anything.
+*/
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+enum {
+    SG_MAX_VERTEXBUFFER_BINDSLOTS = 8,
+    SG_MAX_VERTEX_ATTRIBUTES = 16,
+    SG_MAX_UNIFORMBLOCK_BINDSLOTS = 8,
+    SG_MAX_UNIFORMBLOCK_MEMBERS = 16,
+    SG_MAX_IMAGE_BINDSLOTS = 16,
+    SG_MAX_SAMPLER_BINDSLOTS = 16,
+    SG_MAX_STORAGEBUFFER_BINDSLOTS = 8,
+    SG_MAX_IMAGE_SAMPLER_PAIRS = 16,
+};
+
+typedef struct sg_range {
+    const void* ptr;
+    size_t size;
+} sg_range;
+
+typedef enum sg_backend {
+    SG_BACKEND_GLCORE,
+    SG_BACKEND_GLES3,
+    SG_BACKEND_D3D11,
+    SG_BACKEND_METAL_IOS,
+    SG_BACKEND_METAL_MACOS,
+    SG_BACKEND_METAL_SIMULATOR,
+    SG_BACKEND_WGPU,
+    SG_BACKEND_DUMMY,
+} sg_backend;
+
+typedef enum sg_shader_stage {
+    SG_SHADERSTAGE_NONE,
+    SG_SHADERSTAGE_VERTEX,
+    SG_SHADERSTAGE_FRAGMENT,
+    SG_SHADERSTAGE_COMPUTE,
+} sg_shader_stage;
+
+typedef enum sg_image_type {
+    _SG_IMAGETYPE_DEFAULT,
+    SG_IMAGETYPE_2D,
+    SG_IMAGETYPE_CUBE,
+    SG_IMAGETYPE_3D,
+    SG_IMAGETYPE_ARRAY,
+} sg_image_type;
+
+typedef enum sg_image_sample_type {
+    _SG_IMAGESAMPLETYPE_DEFAULT,
+    SG_IMAGESAMPLETYPE_FLOAT,
+    SG_IMAGESAMPLETYPE_DEPTH,
+    SG_IMAGESAMPLETYPE_SINT,
+    SG_IMAGESAMPLETYPE_UINT,
+    SG_IMAGESAMPLETYPE_UNFILTERABLE_FLOAT,
+} sg_image_sample_type;
+
+typedef enum sg_sampler_type {
+    _SG_SAMPLERTYPE_DEFAULT,
+    SG_SAMPLERTYPE_FILTERING,
+    SG_SAMPLERTYPE_NONFILTERING,
+    SG_SAMPLERTYPE_COMPARISON,
+} sg_sampler_type;
+
+typedef enum sg_uniform_type {
+    SG_UNIFORMTYPE_INVALID,
+    SG_UNIFORMTYPE_FLOAT,
+    SG_UNIFORMTYPE_FLOAT2,
+    SG_UNIFORMTYPE_FLOAT3,
+    SG_UNIFORMTYPE_FLOAT4,
+    SG_UNIFORMTYPE_INT,
+    SG_UNIFORMTYPE_INT2,
+    SG_UNIFORMTYPE_INT3,
+    SG_UNIFORMTYPE_INT4,
+    SG_UNIFORMTYPE_MAT4,
+} sg_uniform_type;
+
+typedef enum sg_uniform_layout {
+    _SG_UNIFORMLAYOUT_DEFAULT,
+    SG_UNIFORMLAYOUT_NATIVE,
+    SG_UNIFORMLAYOUT_STD140,
+} sg_uniform_layout;
+
+typedef enum sg_vertex_format {
+    SG_VERTEXFORMAT_INVALID,
+    SG_VERTEXFORMAT_FLOAT,
+    SG_VERTEXFORMAT_FLOAT2,
+    SG_VERTEXFORMAT_FLOAT3,
+    SG_VERTEXFORMAT_FLOAT4,
+    SG_VERTEXFORMAT_INT,
+    SG_VERTEXFORMAT_INT2,
+    SG_VERTEXFORMAT_INT3,
+    SG_VERTEXFORMAT_INT4,
+    SG_VERTEXFORMAT_UINT,
+    SG_VERTEXFORMAT_UINT2,
+    SG_VERTEXFORMAT_UINT3,
+    SG_VERTEXFORMAT_UINT4,
+    SG_VERTEXFORMAT_BYTE4,
+    SG_VERTEXFORMAT_BYTE4N,
+    SG_VERTEXFORMAT_UBYTE4,
+    SG_VERTEXFORMAT_UBYTE4N,
+    SG_VERTEXFORMAT_SHORT2,
+    SG_VERTEXFORMAT_SHORT2N,
+    SG_VERTEXFORMAT_USHORT2,
+    SG_VERTEXFORMAT_USHORT2N,
+    SG_VERTEXFORMAT_SHORT4,
+    SG_VERTEXFORMAT_SHORT4N,
+    SG_VERTEXFORMAT_USHORT4,
+    SG_VERTEXFORMAT_USHORT4N,
+    SG_VERTEXFORMAT_UINT10_N2,
+    SG_VERTEXFORMAT_HALF2,
+    SG_VERTEXFORMAT_HALF4,
+} sg_vertex_format;
+
+typedef enum sg_vertex_step {
+    _SG_VERTEXSTEP_DEFAULT,
+    SG_VERTEXSTEP_PER_VERTEX,
+    SG_VERTEXSTEP_PER_INSTANCE,
+} sg_vertex_step;
+
+typedef struct sg_vertex_buffer_layout_state {
+    int stride;
+    sg_vertex_step step_func;
+    int step_rate;
+} sg_vertex_buffer_layout_state;
+
+typedef struct sg_vertex_attr_state {
+    int buffer_index;
+    int offset;
+    sg_vertex_format format;
+} sg_vertex_attr_state;
+
+typedef struct sg_vertex_layout_state {
+    sg_vertex_buffer_layout_state buffers[SG_MAX_VERTEXBUFFER_BINDSLOTS];
+    sg_vertex_attr_state attrs[SG_MAX_VERTEX_ATTRIBUTES];
+} sg_vertex_layout_state;
+
+typedef struct sg_shader_function {
+    const char* source;
+    sg_range bytecode;
+    const char* entry;
+    const char* d3d11_target;
+} sg_shader_function;
+
+typedef struct sg_shader_vertex_attr {
+    const char* glsl_name;
+    const char* hlsl_sem_name;
+    uint8_t hlsl_sem_index;
+} sg_shader_vertex_attr;
+
+typedef struct sg_glsl_shader_uniform {
+    sg_uniform_type type;
+    uint16_t array_count;
+    const char* glsl_name;
+} sg_glsl_shader_uniform;
+
+typedef struct sg_shader_uniform_block {
+    sg_shader_stage stage;
+    uint32_t size;
+    uint8_t hlsl_register_b_n;
+    uint8_t msl_buffer_n;
+    uint8_t wgsl_group0_binding_n;
+    sg_uniform_layout layout;
+    sg_glsl_shader_uniform glsl_uniforms[SG_MAX_UNIFORMBLOCK_MEMBERS];
+} sg_shader_uniform_block;
+
+typedef struct sg_shader_storage_buffer {
+    sg_shader_stage stage;
+    bool readonly;
+    uint8_t hlsl_register_t_n;
+    uint8_t msl_buffer_n;
+    uint8_t wgsl_group1_binding_n;
+    uint8_t glsl_binding_n;
+} sg_shader_storage_buffer;
+
+typedef struct sg_shader_image {
+    sg_shader_stage stage;
+    sg_image_type image_type;
+    sg_image_sample_type sample_type;
+    bool multisampled;
+    uint8_t hlsl_register_t_n;
+    uint8_t msl_texture_n;
+    uint8_t wgsl_group1_binding_n;
+} sg_shader_image;
+
+typedef struct sg_shader_sampler {
+    sg_shader_stage stage;
+    sg_sampler_type sampler_type;
+    uint8_t hlsl_register_s_n;
+    uint8_t msl_sampler_n;
+    uint8_t wgsl_group1_binding_n;
+} sg_shader_sampler;
+
+typedef struct sg_shader_image_sampler_pair {
+    sg_shader_stage stage;
+    uint8_t image_slot;
+    uint8_t sampler_slot;
+    const char* glsl_name;
+} sg_shader_image_sampler_pair;
+
+typedef struct sg_shader_desc {
+    sg_shader_function vertex_func;
+    sg_shader_function fragment_func;
+    sg_shader_vertex_attr attrs[SG_MAX_VERTEX_ATTRIBUTES];
+    sg_shader_uniform_block uniform_blocks[SG_MAX_UNIFORMBLOCK_BINDSLOTS];
+    sg_shader_storage_buffer storage_buffers[SG_MAX_STORAGEBUFFER_BINDSLOTS];
+    sg_shader_image images[SG_MAX_IMAGE_BINDSLOTS];
+    sg_shader_sampler samplers[SG_MAX_SAMPLER_BINDSLOTS];
+    sg_shader_image_sampler_pair image_sampler_pairs[SG_MAX_IMAGE_SAMPLER_PAIRS];
+    const char* label;
+} sg_shader_desc;
+
+static int sg_stub_applied_ub_slot = -1;
+static sg_range sg_stub_applied_data;
+static int sg_stub_num_applied = 0;
+
+static inline void sg_apply_uniforms(int ub_slot, const sg_range* data) {
+    sg_stub_applied_ub_slot = ub_slot;
+    sg_stub_applied_data = *data;
+    sg_stub_num_applied++;
+}
+
+static inline sg_backend sg_query_backend(void) {
+    return SG_BACKEND_GLCORE;
+}
+
+#endif // SOKOL_GFX_INCLUDED
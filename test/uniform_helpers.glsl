@@ -0,0 +1,38 @@
+// uniform block with HandmadeMath types for the --uniform-helpers test in run_tests.py
+@module hlp
+@ctype_preset hmm
+@header #include "hmm_stub.h"
+
+@vs vs
+layout(binding=0) uniform vs_params {
+    mat4 mvp;
+    vec4 color;
+    vec3 light_dir;
+    float intensity;
+    vec2 uv_scale;
+    vec4 tints[2];
+};
+
+in vec4 position;
+in vec2 texcoord0;
+out vec4 col;
+out vec2 uv;
+
+void main() {
+    gl_Position = mvp * position;
+    col = color * tints[gl_VertexIndex & 1] * max(dot(light_dir, position.xyz), 0.0) * intensity;
+    uv = texcoord0 * uv_scale;
+}
+@end
+
+@fs fs
+in vec4 col;
+in vec2 uv;
+out vec4 frag_color;
+
+void main() {
+    frag_color = col * vec4(uv, 1.0, 1.0);
+}
+@end
+
+@program helpers vs fs
@@ -0,0 +1,80 @@
+/*
+    Compile the --uniform-helpers layout asserts generated from
+    uniform_helpers.glsl with the HandmadeMath types of '@ctype_preset hmm',
+    and check the uniform block batch helpers.
+
+    usage: uniform_helpers_check (prints the number of failed checks)
+*/
+#include <stdio.h>
+#include <string.h>
+#include "sokol_gfx_stub.h"
+#include "uniform_helpers.h"
+
+static int num_checks = 0;
+static int num_failed = 0;
+
+static void check(bool cond, const char* what) {
+    num_checks++;
+    if (!cond) {
+        printf("FAILED: %s\n", what);
+        num_failed++;
+    }
+}
+
+#define CHECK(cond) check((cond), #cond)
+
+typedef struct {
+    hlp_vs_params_batch_t* batch;
+    int num_draws;
+    bool in_order;
+} draw_state_t;
+
+static void draw(int index, void* user_data) {
+    draw_state_t* state = (draw_state_t*)user_data;
+    // each draw call must follow the sg_apply_uniforms() call for its item
+    state->in_order &= (index == state->num_draws)
+        && (sg_stub_applied_ub_slot == UB_hlp_vs_params)
+        && (sg_stub_applied_data.ptr == &state->batch->items[index])
+        && (sg_stub_applied_data.size == sizeof(hlp_vs_params_t))
+        && (((const hlp_vs_params_t*)sg_stub_applied_data.ptr)->intensity == (float)index);
+    state->num_draws++;
+}
+
+int main() {
+    // space for 3 items and some unused bytes
+    static SOKOL_SHDC_ALIGN(16) uint8_t staging[3 * sizeof(hlp_vs_params_t) + 8];
+    hlp_vs_params_batch_t batch = hlp_vs_params_batch(staging, sizeof(staging));
+    CHECK(batch.capacity == 3);
+    CHECK(batch.count == 0);
+    CHECK(hlp_vs_params_batch_range(&batch).size == 0);
+    for (int i = 0; i < 3; i++) {
+        hlp_vs_params_t* item = hlp_vs_params_batch_push(&batch);
+        CHECK(item == (hlp_vs_params_t*)staging + i);
+        if (item) {
+            memset(item, 0, sizeof(*item));
+            item->mvp.Columns[3].W = 1.0f;
+            item->light_dir.Y = 1.0f;
+            item->intensity = (float)i;
+            item->tints[1].X = 0.5f;
+        }
+    }
+    CHECK(hlp_vs_params_batch_push(&batch) == 0);
+    CHECK(batch.count == 3);
+    const sg_range range = hlp_vs_params_batch_range(&batch);
+    CHECK((range.ptr == staging) && (range.size == 3 * sizeof(hlp_vs_params_t)));
+
+    draw_state_t state = { &batch, 0, true };
+    CHECK(hlp_vs_params_batch_submit(&batch, draw, &state) == 3);
+    CHECK((state.num_draws == 3) && state.in_order);
+    CHECK(sg_stub_num_applied == 3);
+    CHECK(batch.count == 0);
+    CHECK(hlp_vs_params_batch_submit(&batch, draw, &state) == 0);
+    CHECK(sg_stub_num_applied == 3);
+
+    CHECK(hlp_vs_params_batch_push(&batch) == (hlp_vs_params_t*)staging);
+    hlp_vs_params_batch_reset(&batch);
+    CHECK(batch.count == 0);
+
+    printf("checks: %d failed: %d\n", num_checks, num_failed);
+    return (num_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,31 @@
+// a uniform block with scalar, vector, matrix and array members
+// for the --uniform-shadow test in run_tests.py
+@module shd
+
+@vs vs
+layout(binding=0) uniform params {
+    float scale;
+    vec3 offset;
+    mat4 mvp;
+    vec4 colors[3];
+};
+
+in vec4 position;
+out vec4 color;
+
+void main() {
+    gl_Position = mvp * vec4(position.xyz * scale + offset, 1.0);
+    color = colors[gl_VertexIndex % 3];
+}
+@end
+
+@fs fs
+in vec4 color;
+out vec4 frag_color;
+
+void main() {
+    frag_color = color;
+}
+@end
+
+@program shadow vs fs
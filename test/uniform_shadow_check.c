@@ -0,0 +1,119 @@
+/*
+    Check the dirty tracking of the --uniform-shadow helpers generated
+    from uniform_shadow.glsl.
+
+    usage: uniform_shadow_check (prints the number of failed checks)
+*/
+#include <stdio.h>
+#include <string.h>
+#include "sokol_gfx_stub.h"
+#include "uniform_shadow.h"
+
+static int num_checks = 0;
+static int num_failed = 0;
+
+static void check(bool cond, const char* what) {
+    num_checks++;
+    if (!cond) {
+        printf("FAILED: %s\n", what);
+        num_failed++;
+    }
+}
+
+#define CHECK(cond) check((cond), #cond)
+
+// the dirty bits and range which setting a member at offset with size must produce
+static uint32_t slot_bits(size_t offset, size_t size) {
+    uint32_t bits = 0;
+    for (size_t slot = offset / 16; slot < (offset + size + 15) / 16; slot++) {
+        bits |= 1u << slot;
+    }
+    return bits;
+}
+
+static bool range_is(const shd_params_shadow_t* s, size_t offset, size_t size) {
+    const sg_range range = shd_params_dirty_range(s);
+    const size_t first = offset / 16;
+    const size_t last = (offset + size + 15) / 16;
+    return (range.ptr == ((const uint8_t*)&s->data) + first * 16) && (range.size == (last - first) * 16);
+}
+
+int main() {
+    // 9 slots, so all dirty bits are in the first word
+    CHECK(sizeof(shd_params_t) == 144);
+    CHECK(sizeof(((shd_params_shadow_t*)0)->dirty) == sizeof(uint32_t));
+    const uint32_t all_bits = slot_bits(0, sizeof(shd_params_t));
+
+    shd_params_shadow_t s;
+    shd_params_shadow_init(&s);
+    CHECK(shd_params_changed(&s));
+    CHECK(s.dirty[0] == all_bits);
+    CHECK(range_is(&s, 0, sizeof(shd_params_t)));
+    CHECK(shd_params_apply(&s));
+    CHECK((sg_stub_num_applied == 1) && (sg_stub_applied_ub_slot == UB_shd_params));
+    CHECK((sg_stub_applied_data.ptr == &s.data) && (sg_stub_applied_data.size == sizeof(shd_params_t)));
+    CHECK(!shd_params_changed(&s));
+    CHECK(s.dirty[0] == 0);
+    CHECK(shd_params_dirty_range(&s).size == 0);
+    CHECK(!shd_params_apply(&s));
+    CHECK(sg_stub_num_applied == 1);
+
+    // float
+    shd_params_set_scale(&s, 2.0f);
+    CHECK(s.data.scale == 2.0f);
+    CHECK(s.dirty[0] == slot_bits(offsetof(shd_params_t, scale), sizeof(float)));
+    CHECK(range_is(&s, offsetof(shd_params_t, scale), sizeof(float)));
+    CHECK(shd_params_apply(&s));
+    shd_params_set_scale(&s, 2.0f);
+    CHECK(!shd_params_changed(&s));
+
+    // vec3
+    const float offset[3] = { 1.0f, 2.0f, 3.0f };
+    shd_params_set_offset(&s, offset);
+    CHECK(0 == memcmp(&s.data.offset, offset, sizeof(offset)));
+    CHECK(s.dirty[0] == slot_bits(offsetof(shd_params_t, offset), sizeof(offset)));
+    CHECK(range_is(&s, offsetof(shd_params_t, offset), sizeof(offset)));
+    shd_params_clear_dirty(&s);
+    shd_params_set_offset(&s, offset);
+    CHECK(!shd_params_changed(&s));
+
+    // mat4
+    float mvp[16] = { 0 };
+    mvp[0] = mvp[5] = mvp[10] = mvp[15] = 1.0f;
+    shd_params_set_mvp(&s, mvp);
+    CHECK(s.dirty[0] == slot_bits(offsetof(shd_params_t, mvp), sizeof(mvp)));
+    CHECK(range_is(&s, offsetof(shd_params_t, mvp), sizeof(mvp)));
+    shd_params_clear_dirty(&s);
+    mvp[15] = 2.0f;
+    shd_params_set_mvp(&s, mvp);
+    CHECK(s.dirty[0] == slot_bits(offsetof(shd_params_t, mvp), sizeof(mvp)));
+    shd_params_clear_dirty(&s);
+
+    // vec4 array
+    float colors[3][4] = { { 1.0f, 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, 1.0f, 1.0f } };
+    shd_params_set_colors(&s, colors);
+    CHECK(0 == memcmp(&s.data.colors, colors, sizeof(colors)));
+    CHECK(s.dirty[0] == slot_bits(offsetof(shd_params_t, colors), sizeof(colors)));
+    CHECK(range_is(&s, offsetof(shd_params_t, colors), sizeof(colors)));
+    shd_params_clear_dirty(&s);
+    shd_params_set_colors(&s, colors);
+    CHECK(!shd_params_changed(&s));
+
+    // the dirty range spans from the first to the last changed slot
+    shd_params_set_scale(&s, 3.0f);
+    colors[2][0] = 0.5f;
+    shd_params_set_colors(&s, colors);
+    CHECK(s.dirty[0] == (slot_bits(offsetof(shd_params_t, scale), sizeof(float)) | slot_bits(offsetof(shd_params_t, colors), sizeof(colors))));
+    CHECK(range_is(&s, 0, offsetof(shd_params_t, colors) + sizeof(colors)));
+    CHECK(shd_params_apply(&s));
+    CHECK(sg_stub_num_applied == 3);
+
+    // invalidate marks everything dirty without changes
+    shd_params_invalidate(&s);
+    CHECK(s.dirty[0] == all_bits);
+    CHECK(shd_params_apply(&s));
+    CHECK(sg_stub_num_applied == 4);
+
+    printf("checks: %d failed: %d\n", num_checks, num_failed);
+    return (num_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,53 @@
+// @unroll: the loop in fs_const has a constant trip count and is fully
+// unrolled, the loop in fs_dyn depends on a uniform and can't be unrolled,
+// which is reported as a warning
+@vs vs
+in vec4 position;
+out vec2 uv;
+
+void main() {
+    gl_Position = position;
+    uv = position.xy;
+}
+@end
+
+@block lights
+layout(binding=0) uniform fs_params {
+    vec4 light_pos[4];
+    vec4 light_color[4];
+    int num_lights;
+};
+@end
+
+@fs fs_const
+@include_block lights
+in vec2 uv;
+out vec4 frag_color;
+
+void main() {
+    vec3 color = vec3(0.0);
+    @unroll
+    for (int i = 0; i < 4; i++) {
+        color += light_color[i].rgb * max(0.0, 1.0 - length(light_pos[i].xy - uv));
+    }
+    frag_color = vec4(color, 1.0);
+}
+@end
+
+@fs fs_dyn
+@include_block lights
+in vec2 uv;
+out vec4 frag_color;
+
+void main() {
+    vec3 color = vec3(0.0);
+    @unroll
+    for (int i = 0; i < num_lights; i++) {
+        color += light_color[i].rgb * max(0.0, 1.0 - length(light_pos[i].xy - uv));
+    }
+    frag_color = vec4(color, 1.0);
+}
+@end
+
+@program const vs fs_const
+@program dyn vs fs_dyn
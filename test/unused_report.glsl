@@ -0,0 +1,31 @@
+// --unused-report: 'params' is bound in both stages, 'scale' is only read by
+// the vertex shader and 'tint' only by the fragment shader, so only 'unused'
+// is reported, and only once for both programs which share the snippets
+@block params
+layout(binding=0) uniform params {
+    vec4 scale;
+    vec4 tint;
+    vec4 unused;
+};
+@end
+
+@vs vs
+@include_block params
+in vec4 position;
+
+void main() {
+    gl_Position = position * scale;
+}
+@end
+
+@fs fs
+@include_block params
+out vec4 frag_color;
+
+void main() {
+    frag_color = tint;
+}
+@end
+
+@program a vs fs
+@program b vs fs
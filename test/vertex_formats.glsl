@@ -0,0 +1,37 @@
+// vertex attributes with compact vertex formats for the --vertex-formats test in run_tests.py
+@module vf
+
+@vs vs
+layout(binding=0) uniform vs_params {
+    mat4 mvp;
+};
+
+layout(location=0) in vec4 position;
+layout(location=1) in vec3 normal;
+layout(location=2) in vec4 color0;
+layout(location=3) in vec2 texcoord0;
+
+out vec3 nrm;
+out vec4 color;
+out vec2 uv;
+
+void main() {
+    gl_Position = mvp * position;
+    nrm = normalize(normal);
+    color = color0;
+    uv = texcoord0;
+}
+@end
+
+@fs fs
+in vec3 nrm;
+in vec4 color;
+in vec2 uv;
+out vec4 frag_color;
+
+void main() {
+    frag_color = color * vec4(uv, nrm.z, 1.0);
+}
+@end
+
+@program mesh vs fs
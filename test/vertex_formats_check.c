@@ -0,0 +1,43 @@
+/*
+    Check the packed vertex struct and vertex layout function generated
+    with --vertex-formats from vertex_formats.glsl.
+
+    usage: vertex_formats_check (prints the number of failed checks)
+*/
+#include <stdio.h>
+#include <string.h>
+#include "sokol_gfx_stub.h"
+#include "vertex_formats.h"
+
+static int num_checks = 0;
+static int num_failed = 0;
+
+static void check(bool cond, const char* what) {
+    num_checks++;
+    if (!cond) {
+        printf("FAILED: %s\n", what);
+        num_failed++;
+    }
+}
+
+#define CHECK(cond) check((cond), #cond)
+#define CHECK_ATTR(layout, attr, fmt) \
+    CHECK(layout.attrs[ATTR_vf_mesh_##attr].buffer_index == 1); \
+    CHECK(layout.attrs[ATTR_vf_mesh_##attr].offset == (int)offsetof(vf_mesh_vertex_t, attr)); \
+    CHECK(layout.attrs[ATTR_vf_mesh_##attr].format == fmt)
+
+int main() {
+    // FLOAT4 + SHORT4N + HALF4 + HALF2, tightly packed
+    CHECK(sizeof(vf_mesh_vertex_t) == 16 + 8 + 8 + 4);
+    CHECK(sizeof(((vf_mesh_vertex_t*)0)->normal) == 4 * sizeof(int16_t));
+    const sg_vertex_layout_state layout = vf_mesh_vertex_layout(1);
+    CHECK(layout.buffers[0].stride == 0);
+    CHECK(layout.buffers[1].stride == (int)sizeof(vf_mesh_vertex_t));
+    CHECK_ATTR(layout, position, SG_VERTEXFORMAT_FLOAT4);
+    CHECK_ATTR(layout, normal, SG_VERTEXFORMAT_SHORT4N);
+    CHECK_ATTR(layout, color0, SG_VERTEXFORMAT_HALF4);
+    CHECK_ATTR(layout, texcoord0, SG_VERTEXFORMAT_HALF2);
+    CHECK(layout.attrs[4].format == SG_VERTEXFORMAT_INVALID);
+    printf("checks: %d failed: %d\n", num_checks, num_failed);
+    return (num_failed == 0) ? 0 : 1;
+}